@@ -0,0 +1,112 @@
+#!/bin/bash
+#
+# Checkpoint I/O benchmark suite of FTI (see 'make fti-bench').
+#
+# Runs ftibench.exe over the I/O modes, levels, data sizes, variable
+# counts, HDF5 chunk sizes (ckpt_io = 5 only) and inline/head settings
+# below, then dCP with the given dirty ratios and the recovery of every
+# level. All the sweeps are set by the environment, e.g.
+#
+#   IOS="1 3" LEVELS="1 4" SIZES="256" OUT=before.csv ./fti-bench.sh
+#   IOS="1 5" CHUNKS="0 1024 4096" LEVELS=4 ./fti-bench.sh
+#   VARS="8 100000" SIZES=16 LEVELS=1 ./fti-bench.sh
+#
+# Every run appends one row to OUT (CSV, or JSON lines if OUT ends in
+# .json). The nodes are simulated on this machine (Local_test = 1).
+
+MPIRUN=${MPIRUN:-mpirun}
+NODES=${NODES:-2}           # simulated nodes
+PPN=${PPN:-2}               # application processes per node
+GROUP=${GROUP:-2}           # nodes per L2/L3 group
+IOS=${IOS:-"1 2 3"}         # 1 POSIX, 2 MPI-IO, 3 FTI-FF, 5 HDF5
+LEVELS=${LEVELS:-"1 2 3 4"}
+HEADS=${HEADS:-"0 1"}       # 0 inline, 1 post-processing by a head
+SIZES=${SIZES:-"16 64"}     # MB per process
+VARS=${VARS:-"8"}            # protected arrays per process
+CHUNKS=${CHUNKS:-"0 1024"}  # h5_chunk_size in KB, 0 for one chunk per dataset
+CKPTS=${CKPTS:-10}          # measured checkpoints per run
+DCP=${DCP:-1}               # 1 to run the dCP sweep (POSIX and FTI-FF)
+DIRTY=${DIRTY:-"10 50 100"} # percent of the data rewritten per checkpoint
+RECOVER=${RECOVER:-1}       # 1 to run the recovery sweep
+REPS=${REPS:-3}             # recoveries per I/O mode and level
+OUT=${OUT:-fti-bench.csv}
+DIR=${DIR:-fti-bench.d}
+BIN=${BIN:-./ftibench.exe}
+CONFIG=${CONFIG:-configBkp.fti}
+
+# largest variable ID of the sweeps
+MAXVARS=1024
+for vars in $VARS; do
+    [ $vars -lt $MAXVARS ] || MAXVARS=$((vars + 1))
+done
+
+# config <label> <io> <head> <dcp> [chunk]: writes DIR/<label>/config.fti
+config() {
+    local d=$DIR/$1
+    mkdir -p $d
+    sed -e "s|^Head .*|Head = $3|" \
+        -e "s|^Node_size .*|Node_size = $((PPN + $3))|" \
+        -e "s|^Group_size .*|Group_size = $GROUP|" \
+        -e "s|^ckpt_io .*|ckpt_io = $2|" \
+        -e "s|^Ckpt_dir .*|Ckpt_dir = $d/Local|" \
+        -e "s|^Glbl_dir .*|Glbl_dir = $d/Global|" \
+        -e "s|^Meta_dir .*|Meta_dir = $d/Meta|" \
+        -e "s|^Verbosity .*|Verbosity = 3|" \
+        -e "s|^Inline_L\([234]\) .*|Inline_L\1 = $((1 - $3))|" \
+        -e "/^\[Basic\]/a max_var_id = $MAXVARS\nEnable_dCP = $4\ndCP_Mode = 1\ndCP_Block_Size = 16384" \
+        -e "/^\[Advanced\]/a h5_chunk_size = ${5:-0}" \
+        $CONFIG > $d/config.fti
+}
+
+# run <label> <head> <mode> <size> <vars> <level> <dirty>
+run() {
+    $MPIRUN -n $((NODES * (PPN + $2))) $BIN $DIR/$1/config.fti $3 $4 $5 $CKPTS $6 $7 $OUT $1
+}
+
+mkdir -p $DIR
+for io in $IOS; do
+    for head in $HEADS; do
+        for size in $SIZES; do
+            for vars in $VARS; do
+                chunks=0
+                [ "$io" = "5" ] && chunks=$CHUNKS
+                for chunk in $chunks; do
+                    for level in $LEVELS; do
+                        label=io$io-h$head-$size\MB-$vars\v-L$level
+                        [ "$io" = "5" ] && label=$label-c$chunk\KB
+                        rm -rf $DIR/$label
+                        config $label $io $head 0 $chunk
+                        run $label $head ckpt $size $vars $level 100
+                    done
+                done
+            done
+        done
+    done
+done
+
+if [ "$DCP" = "1" ]; then
+    for io in $IOS; do
+        [ "$io" = "1" ] || [ "$io" = "3" ] || continue
+        for dirty in $DIRTY; do
+            label=io$io-dcp-$dirty\pct
+            rm -rf $DIR/$label
+            config $label $io 0 1
+            run $label 0 ckpt ${SIZES##* } ${VARS%% *} 8 $dirty
+        done
+    done
+fi
+
+if [ "$RECOVER" = "1" ]; then
+    for io in $IOS; do
+        for level in $LEVELS; do
+            label=io$io-recover-L$level
+            for rep in $(seq $REPS); do
+                rm -rf $DIR/$label
+                config $label $io 0 0
+                # FTI sets Failure and Exec_ID in the config for the restart
+                OUT=/dev/null run $label 0 keep ${SIZES##* } ${VARS%% *} $level 100 > /dev/null
+                run $label 0 recover ${SIZES##* } ${VARS%% *} $level 100
+            done
+        done
+    done
+fi
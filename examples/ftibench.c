@@ -0,0 +1,247 @@
+/**
+ *  @file   ftibench.c
+ *  @date   October, 2026
+ *  @brief  Checkpoint and recovery benchmark driven by fti-bench.sh.
+ *
+ *  Every rank protects nbVars arrays of doubles with a total of sizeMB
+ *  megabytes, as two dimensional datasets of rows of ROW_LENGTH doubles
+ *  if the arrays hold at least one row (the chunks of the HDF5 files,
+ *  'h5_chunk_size', split the rows). Many small arrays measure the per
+ *  variable bookkeeping of FTI rather than the I/O. In the modes 'ckpt' and 'keep' it takes one warm-up
+ *  checkpoint and nbCkpts measured checkpoints of the given level (1-4,
+ *  or 8 for L4 dCP), rewriting dirty percent of every array before each
+ *  of them. The slowest rank determines the time of a checkpoint.
+ *
+ *  The mode 'keep' leaves the last checkpoint behind instead of calling
+ *  FTI_Finalize, as a crashed run would (only without heads). The next
+ *  run in mode 'recover', with the same arguments, measures FTI_Init
+ *  (which rebuilds the checkpoint files of L2/L3) and FTI_Recover and
+ *  verifies the recovered data.
+ *
+ *  One row per run is appended to the output file, in JSON lines if its
+ *  name ends in '.json' and in CSV otherwise. Times are in seconds and
+ *  the bandwidth in GB/s is that of the median time.
+ *
+ *  usage: ftibench.exe <config> <ckpt|keep|recover> [sizeMB] [nbVars]
+ *                      [nbCkpts] [level] [dirty] [output] [label]
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fti.h>
+
+
+#define ROW_LENGTH  1024
+#define CSV_HEADER  "label,mode,procs,mb_per_rank,vars,level,dirty,samples," \
+                    "mean_s,min_s,p50_s,p90_s,p99_s,max_s,gb_per_s,errors\n"
+
+
+static int cmpDouble(const void *a, const void *b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* nearest rank percentile of the sorted samples */
+static double percentile(double *t, int n, int p)
+{
+    int k = (p * n + 99) / 100;
+    return t[(k > 0) ? k - 1 : 0];
+}
+
+static double value(int rank, int var, size_t k, int it)
+{
+    return rank + var + k * 0.5 + it;
+}
+
+/* rewrites the first dirty percent of every array for iteration it */
+static void touch(double **vars, int nbVars, size_t nbElems, int dirty, int rank, int it)
+{
+    size_t nbDirty = nbElems * dirty / 100, k;
+    int i;
+    for (i = 0; i < nbVars; i++) {
+        for (k = 0; k < nbDirty; k++) {
+            vars[i][k] = value(rank, i, k, it);
+        }
+    }
+}
+
+static void report(const char *output, const char *label, const char *mode, int nbProcs,
+        double mbRank, int nbVars, int level, int dirty, double *t, int n, int errors)
+{
+    double mean = 0;
+    int i;
+    for (i = 0; i < n; i++) {
+        mean += t[i];
+    }
+    mean /= n;
+    qsort(t, n, sizeof(double), cmpDouble);
+    double p50 = percentile(t, n, 50);
+    double gbps = mbRank * nbProcs * 1024 * 1024 / p50 / 1e9;
+
+    printf("%s %s: %d ranks, %.1f MB/rank, %d vars, L%d, %d%% dirty: mean %.4f s, p50 %.4f s, "
+           "p90 %.4f s, p99 %.4f s (%.3f GB/s)%s\n", label, mode, nbProcs, mbRank, nbVars, level,
+           dirty, mean, p50, percentile(t, n, 90), percentile(t, n, 99), gbps,
+           errors ? ", RECOVERED DATA DIFFERS" : "");
+    if (output == NULL) {
+        return;
+    }
+
+    FILE *fd = fopen(output, "a");
+    if (fd == NULL) {
+        printf("cannot open %s\n", output);
+        return;
+    }
+    size_t len = strlen(output);
+    if (len > 5 && strcmp(output + len - 5, ".json") == 0) {
+        fprintf(fd, "{\"label\":\"%s\",\"mode\":\"%s\",\"procs\":%d,\"mb_per_rank\":%.3f,\"vars\":%d,"
+                "\"level\":%d,\"dirty\":%d,\"samples\":%d,\"mean_s\":%.6f,\"min_s\":%.6f,\"p50_s\":%.6f,"
+                "\"p90_s\":%.6f,\"p99_s\":%.6f,\"max_s\":%.6f,\"gb_per_s\":%.4f,\"errors\":%d}\n",
+                label, mode, nbProcs, mbRank, nbVars, level, dirty, n, mean, t[0], p50,
+                percentile(t, n, 90), percentile(t, n, 99), t[n - 1], gbps, errors);
+    } else {
+        if (ftell(fd) == 0) {
+            fprintf(fd, CSV_HEADER);
+        }
+        fprintf(fd, "%s,%s,%d,%.3f,%d,%d,%d,%d,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.4f,%d\n",
+                label, mode, nbProcs, mbRank, nbVars, level, dirty, n, mean, t[0], p50,
+                percentile(t, n, 90), percentile(t, n, 99), t[n - 1], gbps, errors);
+    }
+    fclose(fd);
+}
+
+
+int main(int argc, char **argv)
+{
+    int rank, nbProcs, worldSize, i, j;
+    size_t k;
+
+    if (argc < 3) {
+        printf("usage: %s <config> <ckpt|keep|recover> [sizeMB] [nbVars] [nbCkpts] [level] "
+               "[dirty] [output] [label]\n", argv[0]);
+        return 1;
+    }
+    const char *mode = argv[2];
+    int sizeMB = (argc > 3) ? atoi(argv[3]) : 64;
+    int nbVars = (argc > 4) ? atoi(argv[4]) : 8;
+    int nbCkpts = (argc > 5) ? atoi(argv[5]) : 10;
+    int level = (argc > 6) ? atoi(argv[6]) : 1;
+    int dirty = (argc > 7) ? atoi(argv[7]) : 100;
+    const char *output = (argc > 8) ? argv[8] : NULL;
+    const char *label = (argc > 9) ? argv[9] : argv[1];
+    int recover = (strcmp(mode, "recover") == 0);
+    if ((!recover && strcmp(mode, "ckpt") != 0 && strcmp(mode, "keep") != 0) ||
+            sizeMB < 1 || nbVars < 1 || nbCkpts < 1 || dirty < 0 || dirty > 100 ||
+            ((level < 1 || level > 4) && level != 8)) {
+        printf("invalid arguments\n");
+        return 1;
+    }
+
+    MPI_Init(&argc, &argv);
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t0 = MPI_Wtime();
+    FTI_Init(argv[1], MPI_COMM_WORLD);
+    double tInit = MPI_Wtime() - t0;
+    MPI_Comm_size(MPI_COMM_WORLD, &worldSize);
+    MPI_Comm_size(FTI_COMM_WORLD, &nbProcs);
+    MPI_Comm_rank(FTI_COMM_WORLD, &rank);
+
+    size_t nbElems = ((size_t)sizeMB * 1024 * 1024) / (sizeof(double) * nbVars);
+    if (nbElems >= ROW_LENGTH) {
+        nbElems -= nbElems % ROW_LENGTH;
+    } else if (nbElems == 0) {
+        nbElems = 1;
+    }
+    double mbRank = (double)nbVars * nbElems * sizeof(double) / (1024 * 1024);
+    int it = 0;
+    double **vars = malloc(sizeof(double*) * nbVars);
+    for (i = 0; i < nbVars; i++) {
+        vars[i] = malloc(sizeof(double) * nbElems);
+        for (k = 0; k < nbElems; k++) {
+            vars[i][k] = value(rank, i, k, 0);
+        }
+    }
+    MPI_Barrier(FTI_COMM_WORLD);
+    t0 = MPI_Wtime();
+    for (i = 0; i < nbVars; i++) {
+        FTI_Protect(i, vars[i], nbElems, FTI_DBLE);
+        if (nbElems >= ROW_LENGTH) {
+            int dims[2] = { (int)(nbElems / ROW_LENGTH), ROW_LENGTH };
+            char name[32];
+            snprintf(name, sizeof(name), "var%d", i);
+            FTI_DefineDataset(i, 2, dims, name, NULL);
+        }
+    }
+    FTI_Protect(nbVars, &it, 1, FTI_INTG);
+    double tProtect = MPI_Wtime() - t0;
+    MPI_Allreduce(MPI_IN_PLACE, &tProtect, 1, MPI_DOUBLE, MPI_MAX, FTI_COMM_WORLD);
+    if (rank == 0) {
+        printf("%s %s: FTI_Protect of %d vars %.4f s\n", label, mode, nbVars, tProtect);
+    }
+
+    if (recover) {
+        int errors = 0;
+        double t, tMax, tInitMax;
+        if (FTI_Status() == 0) {
+            if (rank == 0) {
+                printf("no checkpoint to recover, run the mode 'keep' first\n");
+            }
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        t0 = MPI_Wtime();
+        if (FTI_Recover() != FTI_SCES) {
+            errors++;
+        }
+        t = MPI_Wtime() - t0;
+        size_t nbDirty = nbElems * dirty / 100;
+        for (i = 0; i < nbVars && !errors; i++) {
+            for (k = 0; k < nbElems; k++) {
+                if (vars[i][k] != value(rank, i, k, (k < nbDirty) ? it : 0)) {
+                    errors++;
+                    break;
+                }
+            }
+        }
+        t += tInit;
+        MPI_Allreduce(&tInit, &tInitMax, 1, MPI_DOUBLE, MPI_MAX, FTI_COMM_WORLD);
+        MPI_Allreduce(&t, &tMax, 1, MPI_DOUBLE, MPI_MAX, FTI_COMM_WORLD);
+        MPI_Allreduce(MPI_IN_PLACE, &errors, 1, MPI_INT, MPI_SUM, FTI_COMM_WORLD);
+        if (rank == 0) {
+            printf("%s recover: FTI_Init %.4f s, FTI_Recover %.4f s\n", label, tInitMax, tMax - tInitMax);
+            report(output, label, mode, nbProcs, mbRank, nbVars, level, dirty, &tMax, 1, errors);
+        }
+    } else {
+        double *times = malloc(sizeof(double) * nbCkpts);
+        for (j = 0; j <= nbCkpts; j++) {
+            it = j + 1;
+            touch(vars, nbVars, nbElems, dirty, rank, it);
+            MPI_Barrier(FTI_COMM_WORLD);
+            t0 = MPI_Wtime();
+            int res = FTI_Checkpoint(it, level);
+            double t = MPI_Wtime() - t0;
+            if (res != FTI_DONE && rank == 0) {
+                printf("checkpoint %d failed (%d)\n", it, res);
+            }
+            if (j > 0) {
+                MPI_Allreduce(&t, &times[j - 1], 1, MPI_DOUBLE, MPI_MAX, FTI_COMM_WORLD);
+            }
+        }
+        if (rank == 0) {
+            report(output, label, mode, nbProcs, mbRank, nbVars, level, dirty, times, nbCkpts, 0);
+        }
+        free(times);
+    }
+
+    // leave the checkpoint behind for the mode 'recover' (heads need FTI_Finalize)
+    if (strcmp(mode, "keep") != 0 || worldSize != nbProcs) {
+        FTI_Finalize();
+    }
+    for (i = 0; i < nbVars; i++) {
+        free(vars[i]);
+    }
+    free(vars);
+    MPI_Finalize();
+    return 0;
+}
@@ -191,9 +191,11 @@ extern "C" {
         int  result;                /**< holds result of I/O specific write     */
         int lastCkptID;             /**< holds last successful cp ID            */
         int countVar;               /**< counts datasets written                */
-        bool* isWritten;            /**< holds IDs of datasets in cp file       */
+        bool* isWritten;            /**< flags datasets (by keymap location)    */
+        int nbFlags;                /**< number of entries in isWritten         */
         double t0;                  /**< timing for CP statistics               */
         double t1;                  /**< timing for CP statistics               */
+        double tTrace;              /**< start of the CP on the trace clock     */
         char fn[FTI_BUFS];          /**< Name of the checkpoint file            */
         void *fd;  
     } FTIT_iCPInfo;
@@ -413,30 +415,42 @@ extern "C" {
         FTIT_typeField      field[FTI_BUFS];        /**< Fields of the complex type.        */
     } FTIT_complexType;
 
+    /** @typedef    FTIT_datasetAttr
+     *  @brief      Names and dimensions of a dataset.
+     *
+     *  These fields are rarely needed while checkpointing. They are stored
+     *  in a side table of the dataset layer (see 'FTI_AppendDataset'), so
+     *  that the loops over all datasets do not pull them into the cache.
+     */
+    typedef struct FTIT_datasetAttr {
+        int                 dimLength[32];      /**< Lenght of each dimention.                      */
+        char                name[FTI_BUFS];     /**< Name of the dataset.                           */
+        char                idChar[FTI_BUFS];   /**< THis is glue for ALYA                          */
+    } FTIT_datasetAttr;
+
     /** @typedef    FTIT_dataset
      *  @brief      Dataset metadata.
      *
-     *  This type stores the metadata related with a dataset.
+     *  This type stores the metadata related with a dataset. The fields
+     *  used for every checkpoint come first.
      */
     typedef struct FTIT_dataset {
         int                 id;                 /**< ID to search/update dataset.                   */
         bool                recovered;          /**< True if dataset metadata was restored.         */
+        bool                isDevicePtr;        /**< True if this data are stored in a device memory*/
         void                *ptr;               /**< Pointer to the dataset.                        */
-        long                count;              /**< Number of elements in dataset.                 */
-        FTIT_type*          type;               /**< Data type for the dataset.                     */
-        int                 eleSize;            /**< Element size for the dataset.                  */
         long                size;               /**< Total size of the dataset.                     */
         long                sizeStored;         /**< Total size of the dataset in last checkpoint.  */
+        size_t				filePos;            /**< offset of buffer in ckpt file                  */ 
+        FTIT_type*          type;               /**< Data type for the dataset.                     */
+        long                count;              /**< Number of elements in dataset.                 */
+        int                 eleSize;            /**< Element size for the dataset.                  */
         int                 rank;               /**< Rank of dataset (for HDF5).                    */
-        int                 dimLength[32];      /**< Lenght of each dimention.                      */
-        char                name[FTI_BUFS];     /**< Name of the dataset.                           */
-        FTIT_H5Group*       h5group;            /**< Group of this dataset                          */
-        bool                isDevicePtr;        /**< True if this data are stored in a device memory*/
         void                *devicePtr;         /**< Pointer to data in the device                  */
+        FTIT_datasetAttr    *attr;              /**< Names and dimensions (side table).             */
+        FTIT_H5Group*       h5group;            /**< Group of this dataset                          */
         FTIT_sharedData     sharedData;         /**< Info if dataset is sub-set (VPR)               */
         FTIT_dcpDatasetPosix dcpInfoPosix;      /**< dCP info for posix I/O                         */
-        char                idChar[FTI_BUFS];   /**< THis is glue for ALYA                          */
-        size_t				filePos;            /**< offset of buffer in ckpt file                  */ 
     } FTIT_dataset;
 
     /** @typedef    FTIT_metadata
@@ -464,7 +478,14 @@ extern "C" {
         bool            dcpFtiff;         /**< Enable differential ckpt.      */
         bool            dcpPosix;         /**< Enable differential ckpt.      */
         bool            keepL4Ckpt;         /**< TRUE if l4 ckpts to keep       */        
+        bool            adaptiveIntv;       /**< TRUE to adapt ckpt. intervals  */
         bool            keepHeadsAlive;     /**< TRUE if heads return           */
+        bool            shmEnabled;         /**< TRUE if local tier in shm      */
+        bool            shmHandoff;         /**< TRUE if ckpt. data to heads in shm */
+        bool            headThread;         /**< TRUE if post-proc. in a thread */
+        bool            traceEnabled;       /**< TRUE to trace the checkpoints  */
+        bool            traceChrome;        /**< TRUE to write a JSON timeline  */
+        int             traceEvents;        /**< Events kept in the trace ring. */
         int             dcpMode;            /**< dCP mode.                      */
         int             dcpBlockSize;       /**< Block size for dCP hash        */
         char            cfgFile[FTI_BUFS];  /**< Configuration file name.       */
@@ -473,29 +494,57 @@ extern "C" {
         int             blockSize;          /**< Communication block size.      */
         int             transferSize;       /**< Transfer size local to PFS     */
         int             maxVarId;
-#ifdef LUSTRE
+        int             mpioCbNodes;        /**< MPI-IO aggregators (ckpt_io=2).    */
+        int             mpioCbBufferSize;   /**< MPI-IO coll. buffer size (bytes).  */
+        int             mpioStripeUnit;     /**< MPI-IO striping unit (bytes).      */
+        int             mpioStripeFactor;   /**< MPI-IO striping factor.            */
+        int             coalesceSize;       /**< Max. size of gathered vars (bytes).*/
+        int             coalesceBuffer;     /**< Size of the gather buffer (bytes). */
         int             stripeUnit;         /**< Striping Unit for Lustre FS    */
         int             stripeOffset;       /**< Striping Offset for Lustre FS  */
         int             stripeFactor;       /**< Striping Factor for Lustre FS  */
-#endif
+        int             stripeOstCount;     /**< Number of OSTs (<0: query).    */
+        long            stripeTarget;       /**< Bytes per OST of an L4 file.   */
         int             ckptTag;            /**< MPI tag for ckpt requests.         */
         int             stageTag;           /**< MPI tag for staging comm.          */
         int             finalTag;           /**< MPI tag for finalize comm.         */
         int             generalTag;         /**< MPI tag for general comm.          */
+        int             headBackoffMax;     /**< Max. idle backoff of heads (usec). */
+        int             headThreadCpu;      /**< First CPU for helper threads.      */
+        int             stageWorkers;       /**< Number of stage worker threads.    */
+        int             reclaimThreads;     /**< Threads deleting old checkpoints.  */
+        int             reclaimMaxPending;  /**< Max. directories queued for them.  */
+        int             icpAsyncBuffer;     /**< Copies queued for the iCP writer (MB). */
+        int             stageDeadline;      /**< Seconds stages yield to ckpts.     */
+        int             stagePackFile;      /**< Max. size of packed files (bytes). */
+        int             stagePackSize;      /**< Max. size of stage archives (bytes)*/
+        int             groupStrategy;      /**< Strategy to form L2/L3 groups.     */
+        int             domainSize;         /**< Nodes per failure domain (names).  */
         int             test;               /**< TRUE if local test.                */
         int             l3WordSize;         /**< RS encoding word size.             */
         int             ioMode;             /**< IO mode for L4 ckpt.               */
         bool            h5SingleFileEnable; /**< TRUE if VPR enabled                */
         bool            h5SingleFileKeep;   /**< TRUE if VPR files to keep          */
+        bool            h5SingleFileAsync;  /**< TRUE to write VPR in background    */
+        int             h5ChunkSize;        /**< Max. HDF5 chunk size (bytes).      */
+        bool            h5Checksum;         /**< TRUE to checksum HDF5 chunks.      */
+        int             h5Alignment;        /**< HDF5 object alignment (bytes).     */
+        int             h5MetaBlockSize;    /**< HDF5 metadata block size (bytes).  */
+        int             h5MdcSize;          /**< HDF5 metadata cache size (bytes).  */
+        int             h5CbNodes;          /**< MPI-IO aggregators for VPR files.  */
+        int             h5CbBufferSize;     /**< MPI-IO coll. buffer size (bytes).  */
         char            h5SingleFileDir[FTI_BUFS]; /**< HDF5 single file dir        */
         char            h5SingleFilePrefix[FTI_BUFS]; /**< HDF5 single file prefix  */
         char            stageDir[FTI_BUFS]; /**< Staging directory.                 */
         char            localDir[FTI_BUFS]; /**< Local directory.                   */
+        char            shmDir[FTI_BUFS];   /**< Node-local shared memory mount.    */
         char            glbalDir[FTI_BUFS]; /**< Global directory.                  */
         char            metadDir[FTI_BUFS]; /**< Metadata directory.                */
+        char            traceDir[FTI_BUFS]; /**< Directory of the trace files.      */
         char            lTmpDir[FTI_BUFS];  /**< Local temporary directory.         */
         char            gTmpDir[FTI_BUFS];  /**< Global temporary directory.        */
         char            mTmpDir[FTI_BUFS];  /**< Metadata temporary directory.      */
+        char            nodeCoordsFile[FTI_BUFS]; /**< Node coordinate file.        */
         size_t          cHostBufSize;       /**< Host buffer size for GPU data. */
         char 	 		suffix[4];			/** Suffix of the checkpoint files		*/
         FTIT_dcpConfigurationPosix dcpInfoPosix;      /**< dCP info for posix I/O   */
@@ -522,12 +571,15 @@ extern "C" {
         int             groupID;            /**< Group ID in the node.          */
         int             amIaHead;           /**< TRUE if FTI process.           */
         int             headRank;           /**< Rank of the head in this node. */
+        int             headID;             /**< Index of the head in the node. */
+        int             nbBody;             /**< Number of app. proc. per head. */
+        int             bodyOffset;         /**< Node pos. of first body proc.  */
         int             headRankNode;       /**< Rank of the head in node comm. */
         int             nodeRank;           /**< Rank of the node.              */
         int             groupRank;          /**< My rank in the group comm.     */
         int             right;              /**< Proc. on the right of the ring.*/
         int             left;               /**< Proc. on the left of the ring. */
-        int             body[FTI_BUFS];     /**< List of app. proc. in the node.*/
+        int             body[FTI_BUFS];     /**< List of app. proc. of the head.*/
     } FTIT_topology;
 
 
@@ -552,6 +604,9 @@ extern "C" {
         int             ckptCnt;            /**< Checkpoint counter.                    */
         int             ckptDcpIntv;        /**< Checkpoint interval.                   */
         int             ckptDcpCnt;         /**< Checkpoint counter.                    */
+        unsigned int    ckptDue;            /**< Minute of next adaptive checkpoint.    */
+        double          ckptCost;           /**< Measured ckpt. cost (sec., smoothed).  */
+        double          mtbf;               /**< Configured MTBF of the level (sec.).   */
     } FTIT_checkpoint;
 
     /** @typedef    FTIT_injection
@@ -629,10 +684,15 @@ extern "C" {
         double          lastIterTime;       /**< Time spent in the last iter.   */
         double          meanIterTime;       /**< Mean iteration time.           */
         double          globMeanIter;       /**< Global mean iteration time.    */
+        double          iterSyncSum;        /**< Sum of the mean iter. times.   */
+        MPI_Request     iterSyncReq;        /**< Pending iter. time reduction.  */
         double          totalIterTime;      /**< Total main loop time spent.    */
         unsigned int    syncIter;           /**< To check mean iter. time.      */
         int             syncIterMax;        /**< Maximal synch. intervall.      */
         unsigned int    minuteCnt;          /**< Checkpoint minute counter.     */
+        double          upTime;             /**< Run time of previous exec. (s) */
+        double          initTime;           /**< Wall time of FTI_Init.         */
+        int             failures[5];        /**< Failures recovered per level.  */
         bool            hasCkpt;            /**< Indicator that ckpt exists     */
         bool            h5SingleFile;       /**< Indicator if HDF5 single file  */
         unsigned int    ckptCnt;            /**< Checkpoint number counter.     */
@@ -662,6 +722,7 @@ extern "C" {
         MPI_Comm        globalComm;         /**< Global communicator.           */
         MPI_Comm        groupComm;          /**< Group communicator.            */
         MPI_Comm        nodeComm;
+        MPI_Comm        postComm;           /**< Comm. used in post-processing. */
         FTIT_dcpExecutionPosix dcpInfoPosix;      /**< dCP info for posix I/O   */
         int (*ckptFunc[2]) 					/** A function pointer pointing to  */									
             (FTIT_configuration* , 		/** the function which actually 	*/
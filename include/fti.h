@@ -100,7 +100,9 @@ extern "C" {
   int FTI_Checkpoint(int id, int level);
   int FTI_GetStageDir( char* stageDir, int maxLen );
   int FTI_GetStageStatus( int ID );
+  int FTI_GetStageProgress( int ID, long* done, long* total );
   int FTI_SendFile( char* lpath, char *rpath );
+  int FTI_SendFiles( char* lpattern, char *rdir );
   int FTI_Recover();
   int FTI_Snapshot();
   int FTI_Finalize();
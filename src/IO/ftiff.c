@@ -224,10 +224,11 @@ int FTIFF_ReadDbFTIFF( FTIT_configuration *FTI_Conf, FTIT_execution *FTI_Exec,
 
             if(!data) {
                 FTIT_dataset dataNew;
-                FTI_InitDataset( FTI_Exec, &dataNew, currentdbvar->id );
+                FTIT_datasetAttr attrNew;
+                FTI_InitDataset( FTI_Exec, &dataNew, &attrNew, currentdbvar->id );
                 dataNew.sizeStored = currentdbvar->chunksize;
                 dataNew.recovered = true;
-                FTI_Data->push_back( &dataNew, currentdbvar->id );
+                FTI_AppendDataset( FTI_Data, &dataNew, currentdbvar->id );
             } else {
                 data->sizeStored += currentdbvar->chunksize;
             }
@@ -1874,7 +1875,7 @@ int FTIFF_LoadMetaPostprocessing( FTIT_execution* FTI_Exec, FTIT_topology* FTI_T
     else
         strncpy( dir, FTI_Conf->lTmpDir, FTI_BUFS);
 
-    if( FTIFF_RequestFileName( dir, FTI_Topo->body[proc-1], level, FTI_Ckpt[level].isDcp, 0, file ) != FTI_SCES ) {
+    if( FTIFF_RequestFileName( dir, FTI_Topo->body[proc - FTI_Topo->bodyOffset], level, FTI_Ckpt[level].isDcp, 0, file ) != FTI_SCES ) {
         return FTI_NSCS;
     }
 
@@ -40,6 +40,37 @@
 #include "../interface.h"
 #include <sys/types.h>
 #include <dirent.h>
+#include <pthread.h>
+#include <limits.h>
+
+/** @typedef    FTIT_h5Async
+ *  @brief      State of a VPR checkpoint written in the background.
+ *
+ *  With 'Basic:h5_single_file_async' the VPR file and its datasets are
+ *  created by the application, the protected data is copied into a
+ *  snapshot buffer and a writer thread stores the subsets and closes the
+ *  file while the application continues. The HDF5 library is not called by
+ *  the application until the writer has been joined (FTI_WaitVPR).
+ *
+ *  The file is written as '<name>.tmp' and renamed only once all ranks
+ *  wrote their subsets, so that a restart never finds a partial file.
+ */
+typedef struct FTIT_h5Async {
+    pthread_t               thread;     /**< writer thread                  */
+    bool                    pending;    /**< TRUE if a write is in flight   */
+    bool                    snapshot;   /**< TRUE if the next file is async */
+    int                     status;     /**< result of the last write       */
+    int                     ckptId;     /**< ID of the ckpt. being written  */
+    double                  t0;         /**< start time of the ckpt.        */
+    MPI_Comm                comm;       /**< duplicate of FTI_COMM_WORLD    */
+    char*                   buffer;     /**< snapshot of the protected data */
+    size_t                  bufferSize; /**< size of the snapshot buffer    */
+    void**                  ptr;        /**< snapshot address per variable  */
+    int                     nbPtr;      /**< number of entries in ptr       */
+    WriteHDF5Info_t*        fd;         /**< VPR file being written         */
+} FTIT_h5Async;
+
+static FTIT_h5Async FTI_H5Async = { .pending = false, .comm = MPI_COMM_NULL };
 
 
 /*-------------------------------------------------------------------------*/
@@ -262,7 +293,10 @@ void FTI_CloseGroup(FTIT_H5Group* ftiGroup, FTIT_H5Group** FTI_Group)
   'gid'. It steps down in sub groups and checks datasets of consistency.
   The consistency check is performed if the dataset was created with the 
   fletcher32 filter activated. A dataset read will return a negative value 
-  in that case if dataset corrupted.
+  in that case if dataset corrupted. The filters apply to whole chunks, so
+  HDF5 reads and verifies a chunk to return any element of it. Thus, one
+  element of every chunk is read, and the first element of datasets that
+  are not chunked; the memory needed does not depend on the chunk size.
 
  **/
 /*-------------------------------------------------------------------------*/
@@ -286,26 +320,59 @@ int FTI_ScanGroup( hid_t gid, char* fn )
                 if( did > 0 ) {
                     hid_t sid = H5Dget_space(did);
                     hid_t tid = H5Dget_type(did);
+                    hid_t dcpl = H5Dget_create_plist(did);
                     int drank = H5Sget_simple_extent_ndims( sid );
                     size_t typeSize = H5Tget_size( tid );
-                    hsize_t *count = (hsize_t*) calloc( drank, sizeof(hsize_t) );
+                    hsize_t *dims = (hsize_t*) calloc( drank, sizeof(hsize_t) );
+                    hsize_t *chunk = (hsize_t*) calloc( drank, sizeof(hsize_t) );
                     hsize_t *offset = (hsize_t*) calloc( drank, sizeof(hsize_t) );
-                    count[0] = 1;
+                    H5Sget_simple_extent_dims( sid, dims, NULL );
+                    size_t nbElem = 1;
+                    int k;
+                    for( k=0; k<drank; k++ ) {
+                        chunk[k] = 1;
+                        nbElem *= dims[k];
+                    }
+                    if( H5Pget_layout( dcpl ) == H5D_CHUNKED ) {
+                        H5Pget_chunk( dcpl, drank, chunk );
+                    }
                     char* buffer = (char*) malloc( typeSize );
-                    hid_t msid = H5Screate_simple( drank, count, NULL );
-                    H5Sselect_hyperslab(sid, H5S_SELECT_SET, offset, NULL, count, NULL);
-                    // read element to trigger checksum comparison
-                    herr_t status = H5Dread(did, tid, msid, sid, H5P_DEFAULT, buffer);
-                    if( status < 0 ) {
-                        snprintf( errstr, FTI_BUFS, "unable to read from dataset '%s' in file '%s'!", dname, fn );
-                        FTI_Print( errstr, FTI_WARN );
-                        res += FTI_NSCS;
+                    // read the first element of every chunk to trigger the
+                    // checksum comparisons
+                    hsize_t one = 1;
+                    hid_t msid = H5Screate_simple( 1, &one, NULL );
+                    bool last = (nbElem == 0 || buffer == NULL);
+                    while( !last ) {
+                        if( drank > 0 ) {
+                            H5Sselect_elements(sid, H5S_SELECT_SET, 1, offset);
+                        }
+                        herr_t status = H5Dread(did, tid, msid, sid, H5P_DEFAULT, buffer);
+                        if( status < 0 ) {
+                            snprintf( errstr, FTI_BUFS, "unable to read from dataset '%s' in file '%s'!", dname, fn );
+                            FTI_Print( errstr, FTI_WARN );
+                            res += FTI_NSCS;
+                            break;
+                        }
+                        if( H5Pget_layout( dcpl ) != H5D_CHUNKED ) {
+                            break;
+                        }
+                        // next chunk, the fastest dimension first
+                        for( k=drank-1; k>=0; k-- ) {
+                            offset[k] += chunk[k];
+                            if( offset[k] < dims[k] ) {
+                                break;
+                            }
+                            offset[k] = 0;
+                        }
+                        last = (k < 0);
                     }
-                    H5Dclose(did);
                     H5Sclose(msid);
+                    H5Dclose(did);
+                    H5Pclose(dcpl);
                     H5Sclose(sid);
                     H5Tclose(tid);
-                    free( count );
+                    free( dims );
+                    free( chunk );
                     free( offset );
                     free( buffer );
                 } else {
@@ -333,7 +400,7 @@ int FTI_ScanGroup( hid_t gid, char* fn )
         FTI_Print( errstr, FTI_WARN );
         res += FTI_NSCS;
     }
-    return FTI_SCES;
+    return res;
 }
 
 /*-------------------------------------------------------------------------*/
@@ -349,6 +416,74 @@ size_t FTI_GetHDF5FilePos(void *fileDesc)
 }
 
 
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Creates the file access property list for checkpoint files.
+  @param      FTI_Conf        Configuration metadata.
+  @param      shared          TRUE to access the file with MPI-IO (VPR).
+  @return     hid_t           The property list, negative on failure.
+
+  Objects larger than the alignment are aligned on the file system block
+  size, and the metadata blocks and cache are sized from the configuration
+  so that the metadata of many datasets does not interleave with the data.
+  Shared files pass the collective buffering hints to MPI-IO, so that the
+  subsets of all ranks are aggregated by 'Advanced:h5_cb_nodes' writers,
+  and write the file metadata collectively.
+ **/
+/*-------------------------------------------------------------------------*/
+hid_t FTI_H5FileAccess(FTIT_configuration* FTI_Conf, bool shared)
+{
+    hid_t plid = H5Pcreate( H5P_FILE_ACCESS );
+    if ( plid < 0 ) {
+        return plid;
+    }
+    if ( shared ) {
+        MPI_Info info = MPI_INFO_NULL;
+        if ( FTI_Conf->h5CbNodes > 0 || FTI_Conf->h5CbBufferSize > 0 ) {
+            char str[FTI_BUFS];
+            MPI_Info_create( &info );
+            MPI_Info_set( info, "romio_cb_write", "enable" );
+            if ( FTI_Conf->h5CbNodes > 0 ) {
+                snprintf( str, FTI_BUFS, "%d", FTI_Conf->h5CbNodes );
+                MPI_Info_set( info, "cb_nodes", str );
+            }
+            if ( FTI_Conf->h5CbBufferSize > 0 ) {
+                snprintf( str, FTI_BUFS, "%d", FTI_Conf->h5CbBufferSize );
+                MPI_Info_set( info, "cb_buffer_size", str );
+            }
+        }
+        H5Pset_fapl_mpio( plid, FTI_COMM_WORLD, info );
+        if ( info != MPI_INFO_NULL ) {
+            MPI_Info_free( &info );
+        }
+#if H5_VERSION_GE(1,10,0)
+        H5Pset_coll_metadata_write( plid, true );
+#endif
+    }
+    if ( FTI_Conf->h5Alignment > 0 ) {
+        H5Pset_alignment( plid, FTI_Conf->h5Alignment, FTI_Conf->h5Alignment );
+    }
+    if ( FTI_Conf->h5MetaBlockSize > 0 ) {
+        H5Pset_meta_block_size( plid, FTI_Conf->h5MetaBlockSize );
+    }
+    if ( FTI_Conf->h5MdcSize > 0 ) {
+        H5AC_cache_config_t mdc;
+        mdc.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+        if ( H5Pget_mdc_config( plid, &mdc ) >= 0 ) {
+            mdc.set_initial_size = 1;
+            mdc.initial_size = FTI_Conf->h5MdcSize;
+            if ( mdc.max_size < mdc.initial_size ) {
+                mdc.max_size = mdc.initial_size;
+            }
+            if ( mdc.min_size > mdc.initial_size ) {
+                mdc.min_size = mdc.initial_size;
+            }
+            H5Pset_mdc_config( plid, &mdc );
+        }
+    }
+    return plid;
+}
+
 /*-------------------------------------------------------------------------*/
 /**
   @brief      Opens and HDF5 file (Only for write).
@@ -361,14 +496,13 @@ int FTI_HDF5Open(char *fn, void *fileDesc)
     WriteHDF5Info_t *fd = (WriteHDF5Info_t*) fileDesc;
     char str[FTI_BUFS];
     //Creating new hdf5 file
-    if( fd->FTI_Exec->h5SingleFile ) { 
-        hid_t plid = H5Pcreate( H5P_FILE_ACCESS );
-        H5Pset_fapl_mpio(plid, FTI_COMM_WORLD, MPI_INFO_NULL);
-        fd->file_id = H5Fcreate(fn, H5F_ACC_TRUNC, H5P_DEFAULT, plid);       
-        H5Pclose( plid );
-    } else {
-        fd->file_id = H5Fcreate(fn, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    hid_t plid = FTI_H5FileAccess( fd->FTI_Conf, fd->FTI_Exec->h5SingleFile );
+    if ( plid < 0 ) {
+        FTI_Print("Could not create HDF5 file access property list.", FTI_EROR);
+        return FTI_NSCS;
     }
+    fd->file_id = H5Fcreate(fn, H5F_ACC_TRUNC, H5P_DEFAULT, plid);
+    H5Pclose( plid );
     if (fd->file_id < 0) {
         sprintf(str, "FTI checkpoint file (%s) could not be opened.", fn);
         FTI_Print(str, FTI_EROR);
@@ -678,37 +812,117 @@ int FTI_AdvanceOffset(hsize_t sep,  hsize_t *start, hsize_t *add, hsize_t *dims,
 }
 
 
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Computes the chunk shape of a dataset.
+  @param      rank            Number of dimensions of the dataset.
+  @param      dims            Length of each dimension.
+  @param      eleSize         Size of an element in bytes.
+  @param      maxBytes        Target size of a chunk in bytes.
+  @param      chunk           Stores the length of the chunk per dimension.
+  @return     integer         1 if the dataset can be chunked, 0 otherwise.
+
+  The fastest varying dimensions are kept whole as long as they fit in
+  maxBytes, and the slowest one that does not fit is split, so that a chunk
+  is a contiguous block of the dataset in memory. Datasets smaller than
+  maxBytes, or all datasets if maxBytes is 0, are a single chunk. Empty
+  datasets cannot be chunked.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_H5ChunkDims(int rank, hsize_t *dims, size_t eleSize, size_t maxBytes, hsize_t *chunk)
+{
+    int i;
+    hsize_t maxElements = (eleSize > 0) ? maxBytes / eleSize : 0;
+    hsize_t inner = 1;
+
+    if ( maxElements == 0 ) {
+        maxElements = 1;
+    }
+    for ( i = 0; i < rank; i++ ) {
+        if ( dims[i] == 0 ) {
+            return 0;
+        }
+        chunk[i] = dims[i];
+        inner *= dims[i];
+    }
+    if ( maxBytes == 0 || inner <= maxElements ) {
+        return 1;
+    }
+
+    for ( i = 0; i < rank; i++ ) {
+        inner /= dims[i];
+        if ( inner <= maxElements ) {
+            chunk[i] = maxElements / inner;
+            if ( chunk[i] > dims[i] ) {
+                chunk[i] = dims[i];
+            }
+            for ( i = i + 1; i < rank; i++ ) {
+                chunk[i] = dims[i];
+            }
+            break;
+        }
+        chunk[i] = 1;
+    }
+    return 1;
+}
+
 /*-------------------------------------------------------------------------*/
 /**
   @brief      Writes a  protected variable to the checkpoint file.
   @param      data     The protected variable to be written. 
+  @param      FTI_Conf        Configuration metadata.
   @return     integer         Return FTI_SCES  when successfuly write the data to the file 
 
   The function Write the data of a single FTI_Protect variable to the HDF5 file. 
   If the data are on the HOST CPU side, all the data are tranfered with a single call.
   If the data are on the GPU side, we use hyperslabs to slice the data and asynchronously
   move data from the GPU side to the host side and then to the filesytem.
+  If 'Advanced:h5_checksum' is set, the dataset is chunked and every chunk
+  protected by a fletcher32 checksum. The chunks are at most
+  'Advanced:h5_chunk_size', or the whole dataset if it is 0. Without
+  checksum, datasets up to one chunk are stored contiguously.
  **/
 /*-------------------------------------------------------------------------*/
 
-int FTI_WriteHDF5Var(FTIT_dataset *data)
+int FTI_WriteHDF5Var(FTIT_dataset *data, FTIT_configuration* FTI_Conf)
 {
     int j;
     hsize_t dimLength[32];
+    hsize_t chunk[32];
     char str[FTI_BUFS];
     int res;
     hid_t dcpl;
 
     for (j = 0; j < data->rank; j++) {
-        dimLength[j] = data->dimLength[j];
+        dimLength[j] = data->attr->dimLength[j];
     }
 
     dcpl = H5Pcreate (H5P_DATASET_CREATE);
-    res = H5Pset_fletcher32 (dcpl);
-    res = H5Pset_chunk (dcpl, data->rank, dimLength);
+    bool chunked = FTI_H5ChunkDims( data->rank, dimLength, data->eleSize, (size_t)FTI_Conf->h5ChunkSize, chunk );
+    if ( chunked && !FTI_Conf->h5Checksum ) {
+        // without checksum, a single chunk is stored contiguously
+        chunked = false;
+        for (j = 0; j < data->rank; j++) {
+            if ( chunk[j] != dimLength[j] ) {
+                chunked = true;
+            }
+        }
+    }
+    if ( chunked ) {
+        res = H5Pset_chunk (dcpl, data->rank, chunk);
+        if ( res >= 0 && FTI_Conf->h5Checksum ) {
+            res = H5Pset_fletcher32 (dcpl);
+        }
+        if (res < 0) {
+            sprintf(str, "Chunked layout of dataset #%d could not be set, storing it contiguously", data->id);
+            FTI_Print(str, FTI_WARN);
+            H5Pclose (dcpl);
+            dcpl = H5Pcreate (H5P_DATASET_CREATE);
+        }
+    }
 
     hid_t dataspace = H5Screate_simple( data->rank, dimLength, NULL);
-    hid_t dataset = H5Dcreate2 ( data->h5group->h5groupID, data->name,data->type->h5datatype, dataspace,  H5P_DEFAULT, dcpl , H5P_DEFAULT);
+    hid_t dataset = H5Dcreate2 ( data->h5group->h5groupID, data->attr->name,data->type->h5datatype, dataspace,  H5P_DEFAULT, dcpl , H5P_DEFAULT);
 
     // If my data are stored in the CPU side
     // Just store the data to the file and return;
@@ -836,7 +1050,7 @@ int FTI_ReadHDF5Var(FTIT_dataset *data)
     char str[FTI_BUFS];
     int res;
 
-    hid_t dataset = H5Dopen(data->h5group->h5groupID, data->name, H5P_DEFAULT);
+    hid_t dataset = H5Dopen(data->h5group->h5groupID, data->attr->name, H5P_DEFAULT);
     hid_t dataspace = H5Dget_space(dataset);
 
     // If my data are stored in the CPU side
@@ -870,7 +1084,7 @@ int FTI_ReadHDF5Var(FTIT_dataset *data)
     hsize_t dimLength[32];
     int j;
     for (j = 0; j < data->rank; j++) {
-        dimLength[j] = data->dimLength[j];
+        dimLength[j] = data->attr->dimLength[j];
     }
 
     // This code is only executed in the GPU case.
@@ -995,7 +1209,7 @@ int FTI_WriteHDF5Data(FTIT_dataset *data, void *write_info)
     if( fd->FTI_Exec->h5SingleFile ) { 
         res = FTI_WriteSharedFileData( *data );
     } else {
-        res = FTI_WriteHDF5Var(data); 
+        res = FTI_WriteHDF5Var(data, fd->FTI_Conf);
     }
     if ( res != FTI_SCES ) {
         int j;
@@ -1047,28 +1261,47 @@ int  FTI_HDF5Close(void *fileDesc)
         FTI_Print("FTI checkpoint file could not be closed.", FTI_EROR);
         return FTI_NSCS;
     }
-    if( fd->FTI_Exec->h5SingleFile ) {
-        bool removeLastFile = !fd->FTI_Conf->h5SingleFileKeep && (bool)strcmp( fd->FTI_Exec->h5SingleFileLast, "" );
-        if( removeLastFile && !fd->FTI_Topo->splitRank ) {
-            status = remove( fd->FTI_Exec->h5SingleFileLast );
-            if ( (status != ENOENT) && (status != 0) ) {
-                char errstr[FTI_BUFS];
-                snprintf( errstr, FTI_BUFS, "failed to remove last VPR file '%s'", fd->FTI_Exec->h5SingleFileLast );
-                FTI_Print( errstr, FTI_EROR );
-            } else {
-                status = FTI_SCES;
-            }
-        }
-        if( status == FTI_SCES ) {
-            snprintf( fd->FTI_Exec->h5SingleFileLast, FTI_BUFS, "%s/%s-ID%08d.h5", fd->FTI_Conf->h5SingleFileDir, 
-                    fd->FTI_Conf->h5SingleFilePrefix, fd->FTI_Exec->ckptId );
-        }
+    // files written in the background are committed by the writer
+    if( fd->FTI_Exec->h5SingleFile && !fd->tmpFile ) {
+        status = FTI_RemoveLastVPR( fd, fd->FTI_Exec->ckptId );
     }
 
     return status;
 
 }
 
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Replaces the last VPR file by the one just written.
+  @param      fd              VPR file just closed.
+  @param      ckptId          Checkpoint ID of the VPR file.
+  @return     integer         FTI_SCES if successful.
+
+  Removes the previous VPR file (unless 'h5_single_file_keep') and records
+  the new one as the last VPR file.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_RemoveLastVPR( WriteHDF5Info_t* fd, int ckptId )
+{
+    int status = FTI_SCES;
+    bool removeLastFile = !fd->FTI_Conf->h5SingleFileKeep && (bool)strcmp( fd->FTI_Exec->h5SingleFileLast, "" );
+    if( removeLastFile && !fd->FTI_Topo->splitRank ) {
+        status = remove( fd->FTI_Exec->h5SingleFileLast );
+        if ( (status != ENOENT) && (status != 0) ) {
+            char errstr[FTI_BUFS];
+            snprintf( errstr, FTI_BUFS, "failed to remove last VPR file '%s'", fd->FTI_Exec->h5SingleFileLast );
+            FTI_Print( errstr, FTI_EROR );
+        } else {
+            status = FTI_SCES;
+        }
+    }
+    if( status == FTI_SCES ) {
+        snprintf( fd->FTI_Exec->h5SingleFileLast, FTI_BUFS, "%s/%s-ID%08d.h5", fd->FTI_Conf->h5SingleFileDir, 
+                fd->FTI_Conf->h5SingleFilePrefix, ckptId );
+    }
+    return status;
+}
+
 
 /*-------------------------------------------------------------------------*/
 /**
@@ -1119,7 +1352,8 @@ void *FTI_InitHDF5(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, FTIT_
         snprintf(fn, FTI_BUFS, "%s/%s", FTI_Conf->lTmpDir, FTI_Exec->ckptMeta.ckptFile);
     }
     if( FTI_Exec->h5SingleFile ) {
-        snprintf( fn, FTI_BUFS, "%s/%s-ID%08d.h5", FTI_Conf->h5SingleFileDir, FTI_Conf->h5SingleFilePrefix, FTI_Exec->ckptId );
+        snprintf( fn, FTI_BUFS, "%s/%s-ID%08d.h5%s", FTI_Conf->h5SingleFileDir, FTI_Conf->h5SingleFilePrefix, 
+                FTI_Exec->ckptId, FTI_H5Async.snapshot ? ".tmp" : "" );
     }
 
     int i;
@@ -1128,6 +1362,7 @@ void *FTI_InitHDF5(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, FTIT_
     fd->FTI_Data = FTI_Data;
     fd->FTI_Conf = FTI_Conf;
     fd->FTI_Topo = FTI_Topo;
+    fd->tmpFile = FTI_Exec->h5SingleFile && FTI_H5Async.snapshot;
 
     FTI_HDF5Open(fn, fd); 
 
@@ -1158,8 +1393,27 @@ int FTI_WriteHDF5(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         FTIT_topology* FTI_Topo, FTIT_checkpoint* FTI_Ckpt,
         FTIT_keymap* FTI_Data)
 {
+    // the snapshot is taken first, it decides the name of the VPR file
+    FTI_H5Async.snapshot = ( FTI_Exec->ckptMeta.level == FTI_L4_H5_SINGLE ) && FTI_Conf->h5SingleFileEnable &&
+        FTI_Conf->h5SingleFileAsync && ( FTI_SnapshotVPR( FTI_Exec, FTI_Data ) == FTI_SCES );
+
     // write data
     WriteHDF5Info_t *fd = FTI_InitHDF5(FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt, FTI_Data);
+    FTI_H5Async.snapshot = false;
+    if ( fd == NULL ) {
+        return FTI_NSCS;
+    }
+    if ( FTI_Exec->h5SingleFile ) {
+        if ( fd->tmpFile ) {
+            return FTI_StartVPRWriter( FTI_Exec, fd );
+        }
+        int res = FTI_WriteGlobalDatasets( fd, NULL, FTI_COMM_WORLD );
+        if ( FTI_HDF5Close(fd) != FTI_SCES ) {
+            res = FTI_NSCS;
+        }
+        free(fd);
+        return res;
+    }
     FTIT_dataset* data;
     if( FTI_Data->data( &data, FTI_Exec->nbVar) != FTI_SCES ) return FTI_NSCS;
     int i= 0; for (; i < FTI_Exec->nbVar; i++) {
@@ -1170,6 +1424,193 @@ int FTI_WriteHDF5(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     return FTI_SCES;
 }
 
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Copies the subsets of the global datasets to the snapshot.
+  @param      FTI_Exec        Execution metadata.
+  @param      FTI_Data        Dataset metadata.
+  @return     integer         FTI_SCES if all ranks took the snapshot.
+
+  Collective over the application ranks. If any rank cannot take the
+  snapshot (memory, data on the device), the VPR file is written
+  synchronously by all ranks.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_SnapshotVPR( FTIT_execution* FTI_Exec, FTIT_keymap* FTI_Data )
+{
+    FTIT_dataset* data;
+    size_t size = 0, pos = 0;
+    int i, res = FTI_SCES, allRes;
+
+    if( FTI_Data->data( &data, FTI_Exec->nbVar ) != FTI_SCES ) {
+        res = FTI_NSCS;
+    }
+    for( i = 0; (res == FTI_SCES) && (i < FTI_Exec->nbVar); i++ ) {
+#ifdef GPUSUPPORT
+        if( data[i].isDevicePtr ) {
+            FTI_Print( "VPR data on the device cannot be written in the background.", FTI_DBUG );
+            res = FTI_NSCS;
+        }
+#endif
+        if( data[i].sharedData.dataset ) {
+            size += data[i].size;
+        }
+    }
+    if( (res == FTI_SCES) && (size > FTI_H5Async.bufferSize) ) {
+        char* buffer = realloc( FTI_H5Async.buffer, size );
+        if( buffer ) {
+            FTI_H5Async.buffer = buffer;
+            FTI_H5Async.bufferSize = size;
+        } else {
+            FTI_Print( "Unable to allocate the VPR snapshot buffer.", FTI_WARN );
+            res = FTI_NSCS;
+        }
+    }
+    if( (res == FTI_SCES) && (FTI_Exec->nbVar > FTI_H5Async.nbPtr) ) {
+        void** ptr = realloc( FTI_H5Async.ptr, sizeof(void*) * FTI_Exec->nbVar );
+        if( ptr ) {
+            FTI_H5Async.ptr = ptr;
+            FTI_H5Async.nbPtr = FTI_Exec->nbVar;
+        } else {
+            res = FTI_NSCS;
+        }
+    }
+
+    MPI_Allreduce( &res, &allRes, 1, MPI_INT, MPI_MIN, FTI_COMM_WORLD );
+    if( allRes != FTI_SCES ) {
+        return FTI_NSCS;
+    }
+
+    for( i = 0; i < FTI_Exec->nbVar; i++ ) {
+        FTI_H5Async.ptr[i] = NULL;
+        if( data[i].sharedData.dataset ) {
+            FTI_H5Async.ptr[i] = FTI_H5Async.buffer + pos;
+            memcpy( FTI_H5Async.ptr[i], data[i].ptr, data[i].size );
+            pos += data[i].size;
+        }
+    }
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Writes the snapshot into the VPR file (writer thread).
+  @param      arg             Unused.
+  @return     void*           NULL.
+ **/
+/*-------------------------------------------------------------------------*/
+static void* FTI_VPRWriter( void* arg )
+{
+    WriteHDF5Info_t* fd = FTI_H5Async.fd;
+    char fn[FTI_BUFS], tmpFn[FTI_BUFS], str[FTI_BUFS];
+    int res, allRes;
+
+    snprintf( fn, FTI_BUFS, "%s/%s-ID%08d.h5", fd->FTI_Conf->h5SingleFileDir, fd->FTI_Conf->h5SingleFilePrefix, 
+            FTI_H5Async.ckptId );
+    snprintf( tmpFn, FTI_BUFS, "%s.tmp", fn );
+
+    res = FTI_WriteGlobalDatasets( fd, FTI_H5Async.ptr, FTI_H5Async.comm );
+    if( FTI_HDF5Close( fd ) != FTI_SCES ) {
+        res = FTI_NSCS;
+    }
+    MPI_Allreduce( &res, &allRes, 1, MPI_INT, MPI_MIN, FTI_H5Async.comm );
+
+    // the file gets its name only once every rank wrote its subsets
+    if( !fd->FTI_Topo->splitRank ) {
+        if( allRes == FTI_SCES && rename( tmpFn, fn ) != 0 ) {
+            snprintf( str, FTI_BUFS, "VPR file '%s' could not be renamed to '%s'.", tmpFn, fn );
+            FTI_Print( str, FTI_EROR );
+            allRes = FTI_NSCS;
+        }
+        if( allRes != FTI_SCES ) {
+            unlink( tmpFn );
+        }
+    }
+    MPI_Bcast( &allRes, 1, MPI_INT, 0, FTI_H5Async.comm );
+
+    // a failed file is discarded, the last VPR file stays the recovery point
+    if( allRes == FTI_SCES ) {
+        allRes = FTI_RemoveLastVPR( fd, FTI_H5Async.ckptId );
+    }
+    FTI_H5Async.status = allRes;
+    free( fd );
+    FTI_H5Async.fd = NULL;
+
+    return NULL;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Tells if a VPR file is being written in the background.
+  @return     bool            TRUE if the writer has not been joined.
+ **/
+/*-------------------------------------------------------------------------*/
+bool FTI_PendingVPR( void )
+{
+    return FTI_H5Async.pending;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Hands the open VPR file to the writer thread.
+  @param      FTI_Exec        Execution metadata.
+  @param      fd              VPR file with the global datasets created.
+  @return     integer         FTI_SCES if the writer could be started.
+
+  If the thread cannot be started, the snapshot is written synchronously.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_StartVPRWriter( FTIT_execution* FTI_Exec, WriteHDF5Info_t* fd )
+{
+    if( FTI_H5Async.comm == MPI_COMM_NULL ) {
+        MPI_Comm_dup( FTI_COMM_WORLD, &FTI_H5Async.comm );
+    }
+    FTI_H5Async.fd = fd;
+    FTI_H5Async.ckptId = FTI_Exec->ckptId;
+    FTI_H5Async.t0 = MPI_Wtime();
+    FTI_H5Async.status = FTI_NSCS;
+
+    if( pthread_create( &FTI_H5Async.thread, NULL, FTI_VPRWriter, NULL ) != 0 ) {
+        FTI_Print( "Unable to start the VPR writer thread, writing synchronously.", FTI_WARN );
+        FTI_VPRWriter( NULL );
+        return FTI_H5Async.status;
+    }
+    FTI_H5Async.pending = true;
+
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Waits until the VPR file written in the background is closed.
+  @return     integer         FTI_SCES if the last VPR write succeeded.
+
+  Called before any operation that uses the HDF5 library or changes the
+  protected variables, groups or global datasets. A failed background
+  write is only reported here, FTI_Checkpoint already returned.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_WaitVPR( void )
+{
+    char str[FTI_BUFS];
+
+    if( !FTI_H5Async.pending ) {
+        return FTI_SCES;
+    }
+    pthread_join( FTI_H5Async.thread, NULL );
+    FTI_H5Async.pending = false;
+
+    if( FTI_H5Async.status == FTI_SCES ) {
+        snprintf( str, FTI_BUFS, "Ckpt. ID %d (Variate Processor Recovery File) written in the background in %.2f sec.",
+                FTI_H5Async.ckptId, MPI_Wtime() - FTI_H5Async.t0 );
+        FTI_Print( str, FTI_INFO );
+    } else {
+        snprintf( str, FTI_BUFS, "Ckpt. ID %d (Variate Processor Recovery File) could not be written.", FTI_H5Async.ckptId );
+        FTI_Print( str, FTI_WARN );
+    }
+    return FTI_H5Async.status;
+}
+
 
 
 /*-------------------------------------------------------------------------*/
@@ -1198,8 +1639,7 @@ int FTI_RecoverHDF5(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, FTIT
 
     //Open hdf5 file
     if( FTI_Exec->h5SingleFile ) { 
-        hid_t plid = H5Pcreate( H5P_FILE_ACCESS );
-        H5Pset_fapl_mpio( plid, FTI_COMM_WORLD, MPI_INFO_NULL );
+        hid_t plid = FTI_H5FileAccess( FTI_Conf, true );
         file_id = H5Fopen( fn, H5F_ACC_RDONLY, plid );
         H5Pclose( plid );
     } else {
@@ -1229,11 +1669,20 @@ int FTI_RecoverHDF5(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, FTIT
         FTI_OpenGlobalDatasets( FTI_Exec );
     }
 
+    herr_t res = FTI_SCES;
+    if( FTI_Exec->h5SingleFile ) {
+        // the subsets of the ranks are recovered per global dataset
+        FTIT_globalDataset* dataset = FTI_Exec->globalDatasets;
+        while( dataset ) {
+            if( FTI_ReadGlobalDataset( dataset, FTI_Data ) != FTI_SCES ) {
+                res = FTI_NSCS;
+            }
+            dataset = dataset->next;
+        }
+    }
+
     for (i = 0; i < FTI_Exec->nbVar; i++) {
-        herr_t res;
-        if( FTI_Exec->h5SingleFile ) { 
-            res = FTI_ReadSharedFileData( data[i] );
-        } else {
+        if( !FTI_Exec->h5SingleFile ) {
             res = FTI_ReadHDF5Var(&data[i]);
         }
         if (res < 0) {
@@ -1297,8 +1746,7 @@ int FTI_RecoverVarHDF5(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, F
     hid_t file_id;    
     //Open hdf5 file
     if( FTI_Exec->h5SingleFile ) { 
-        hid_t plid = H5Pcreate( H5P_FILE_ACCESS );
-        H5Pset_fapl_mpio( plid, FTI_COMM_WORLD, MPI_INFO_NULL );
+        hid_t plid = FTI_H5FileAccess( FTI_Conf, true );
         file_id = H5Fopen( fn, H5F_ACC_RDONLY, plid );
         H5Pclose( plid );
     } else {
@@ -1504,6 +1952,379 @@ herr_t FTI_ReadSharedFileData( FTIT_dataset FTI_Data )
 
 }
 
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Takes part in a collective read without reading data.
+  @param      dataset         Global dataset.
+  @return     integer         FTI_SCES if successful.
+ **/
+/*-------------------------------------------------------------------------*/
+herr_t FTI_ReadSharedFileNone( FTIT_globalDataset* dataset )
+{
+    char errstr[FTI_BUFS];
+    char dummy;
+    hsize_t one = 1;
+    herr_t status = FTI_SCES;
+
+    hid_t msid = H5Screate_simple( 1, &one, NULL );
+    hid_t plid = H5Pcreate( H5P_DATASET_XFER );
+    if( (msid < 0) || (plid < 0) ) {
+        snprintf( errstr, FTI_BUFS, "Unable to create empty selection for dataset #%d", dataset->id );
+        FTI_Print(errstr,FTI_EROR);
+        return FTI_NSCS;
+    }
+    H5Sselect_none( msid );
+    H5Sselect_none( dataset->fileSpace );
+    H5Pset_dxpl_mpio( plid, H5FD_MPIO_COLLECTIVE );
+
+    if( H5Dread( dataset->hid, dataset->hdf5TypeId, msid, dataset->fileSpace, plid, &dummy ) < 0 ) {
+        snprintf( errstr, FTI_BUFS, "Unable to take part in the read of dataset #%d", dataset->id );
+        FTI_Print(errstr,FTI_EROR);
+        status = FTI_NSCS;
+    }
+
+    H5Sclose( msid );
+    H5Pclose( plid );
+
+    return status;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Copies a box of elements between two row-major arrays.
+  @param      dst             Destination array.
+  @param      dstOff          Global coordinates of the first dst element.
+  @param      dstDim          Extent of dst in each dimension.
+  @param      src             Source array.
+  @param      srcOff          Global coordinates of the first src element.
+  @param      srcDim          Extent of src in each dimension.
+  @param      boxOff          Global coordinates of the box.
+  @param      boxCnt          Extent of the box in each dimension.
+  @param      ndim            Number of dimensions.
+  @param      eleSize         Size of an element in bytes.
+
+  The box has to be contained in both arrays. Rows along the last
+  dimension are copied at once.
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_CopyBox( char* dst, hsize_t* dstOff, hsize_t* dstDim,
+        char* src, hsize_t* srcOff, hsize_t* srcDim,
+        hsize_t* boxOff, hsize_t* boxCnt, int ndim, size_t eleSize )
+{
+    hsize_t idx[FTI_HDF5_MAX_DIM];
+    int i;
+
+    for( i = 0; i < ndim; i++ ) {
+        if( boxCnt[i] == 0 ) {
+            return;
+        }
+        idx[i] = 0;
+    }
+    size_t line = boxCnt[ndim-1] * eleSize;
+
+    while( true ) {
+        size_t d = 0, s = 0;
+        for( i = 0; i < ndim; i++ ) {
+            d = d * dstDim[i] + (boxOff[i] + idx[i] - dstOff[i]);
+            s = s * srcDim[i] + (boxOff[i] + idx[i] - srcOff[i]);
+        }
+        memcpy( dst + d * eleSize, src + s * eleSize, line );
+        for( i = ndim - 2; i >= 0; i-- ) {
+            if( ++idx[i] < boxCnt[i] ) {
+                break;
+            }
+            idx[i] = 0;
+        }
+        if( i < 0 ) {
+            break;
+        }
+    }
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Clips a subset to a range of rows of the global dataset.
+  @param      sub             Offset and count of the subset (2*ndim).
+  @param      row0            First row of the range.
+  @param      row1            Row after the range.
+  @param      ndim            Number of dimensions.
+  @param      boxOff          Stores the offset of the intersection.
+  @param      boxCnt          Stores the count of the intersection.
+  @return     size_t          Number of elements in the intersection.
+ **/
+/*-------------------------------------------------------------------------*/
+static size_t FTI_ClipSubset( hsize_t* sub, hsize_t row0, hsize_t row1, int ndim,
+        hsize_t* boxOff, hsize_t* boxCnt )
+{
+    hsize_t first = (sub[0] > row0) ? sub[0] : row0;
+    hsize_t last = (sub[0] + sub[ndim] < row1) ? sub[0] + sub[ndim] : row1;
+    size_t nbElem = (last > first) ? last - first : 0;
+    int i;
+
+    memcpy( boxOff, sub, sizeof(hsize_t) * ndim );
+    memcpy( boxCnt, sub + ndim, sizeof(hsize_t) * ndim );
+    boxOff[0] = first;
+    boxCnt[0] = nbElem;
+    for( i = 1; i < ndim; i++ ) {
+        nbElem *= boxCnt[i];
+    }
+    return nbElem;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Reads the local subsets of a global dataset one by one.
+  @param      dataset         Global dataset.
+  @param      FTI_Data        Dataset metadata.
+  @return     integer         FTI_SCES if successful.
+
+  Every subset is read with its own collective transfer. Ranks with fewer
+  subsets take part in the remaining rounds with an empty selection.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_ReadSubsets( FTIT_globalDataset* dataset, FTIT_keymap* FTI_Data )
+{
+    int i, rounds, res = FTI_SCES;
+
+    MPI_Allreduce( &dataset->numSubSets, &rounds, 1, MPI_INT, MPI_MAX, FTI_COMM_WORLD );
+    for( i = 0; i < rounds; i++ ) {
+        FTIT_dataset* var = NULL;
+        if( i < dataset->numSubSets ) {
+            FTI_Data->get( &var, dataset->varId[i] );
+        }
+        if( var ) {
+            if( FTI_ReadSharedFileData( *var ) < 0 ) {
+                res = FTI_NSCS;
+            }
+        } else if( FTI_ReadSharedFileNone( dataset ) != FTI_SCES ) {
+            res = FTI_NSCS;
+        }
+    }
+    return res;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Reads a block of rows of a global dataset and redistributes it.
+  @param      dataset         Global dataset.
+  @param      nbProc          Number of application ranks.
+  @param      allSub          Subset descriptors of all ranks.
+  @param      subCnt          Number of descriptor entries per rank.
+  @param      subDispl        Offset of the entries of each rank in allSub.
+  @param      myVar           Local subset variables.
+  @param      mySub           Subset descriptors of this rank.
+  @param      nbSub           Number of local subsets.
+  @param      slab            Buffer for the block of rows of this rank.
+  @param      slabOff         Coordinates of the block.
+  @param      slabDim         Extent of the block.
+  @param      buf             Send and receive buffer.
+  @param      cnt             Bytes sent to and received from each rank.
+  @param      displ           Offsets in the send and receive buffer.
+  @return     integer         FTI_SCES if successful.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_ExchangeRows( FTIT_globalDataset* dataset, int nbProc, hsize_t* allSub,
+        int* subCnt, int* subDispl, FTIT_dataset** myVar, hsize_t* mySub, int nbSub, char* slab,
+        hsize_t* slabOff, hsize_t* slabDim, char** buf, int** cnt, int** displ )
+{
+    char errstr[FTI_BUFS];
+    hsize_t boxOff[FTI_HDF5_MAX_DIM], boxCnt[FTI_HDF5_MAX_DIM];
+    int ndim = dataset->rank;
+    int desc = 2 * ndim;
+    size_t eleSize = H5Tget_size( dataset->hdf5TypeId );
+    hsize_t *dims = dataset->dimension;
+    int res = FTI_SCES;
+    int j, k, p;
+
+    // read my block of rows collectively
+    hid_t msid = H5Screate_simple( ndim, slabDim, NULL );
+    hid_t plid = H5Pcreate( H5P_DATASET_XFER );
+    H5Pset_dxpl_mpio( plid, H5FD_MPIO_COLLECTIVE );
+    if( slabDim[0] > 0 ) {
+        H5Sselect_hyperslab( dataset->fileSpace, H5S_SELECT_SET, slabOff, NULL, slabDim, NULL );
+    } else {
+        H5Sselect_none( msid );
+        H5Sselect_none( dataset->fileSpace );
+    }
+    if( H5Dread( dataset->hid, dataset->hdf5TypeId, msid, dataset->fileSpace, plid, slab ) < 0 ) {
+        snprintf( errstr, FTI_BUFS, "Unable to read rows %llu to %llu of dataset #%d",
+                (unsigned long long)slabOff[0], (unsigned long long)(slabOff[0] + slabDim[0]), dataset->id );
+        FTI_Print( errstr, FTI_EROR );
+        res = FTI_NSCS;
+    }
+    H5Sclose( msid );
+    H5Pclose( plid );
+
+    // cut the subsets of every rank out of my block
+    char *pos = buf[0];
+    for( p = 0; p < nbProc; p++ ) {
+        for( j = 0; j < subCnt[p]; j += desc ) {
+            size_t nbElem = FTI_ClipSubset( allSub + subDispl[p] + j, slabOff[0], slabOff[0] + slabDim[0], ndim, boxOff, boxCnt );
+            FTI_CopyBox( pos, boxOff, boxCnt, slab, slabOff, slabDim, boxOff, boxCnt, ndim, eleSize );
+            pos += nbElem * eleSize;
+        }
+    }
+
+    MPI_Alltoallv( buf[0], cnt[0], displ[0], MPI_BYTE, buf[1], cnt[1], displ[1], MPI_BYTE, FTI_COMM_WORLD );
+
+    // place the pieces received from every rank into my subsets
+    pos = buf[1];
+    for( p = 0; p < nbProc; p++ ) {
+        hsize_t row0 = (hsize_t)( ((unsigned long long)dims[0] * p) / nbProc );
+        hsize_t row1 = (hsize_t)( ((unsigned long long)dims[0] * (p+1)) / nbProc );
+        for( k = 0; k < nbSub; k++ ) {
+            hsize_t *sub = mySub + k*desc;
+            size_t nbElem = FTI_ClipSubset( sub, row0, row1, ndim, boxOff, boxCnt );
+            FTI_CopyBox( myVar[k]->ptr, sub, sub + ndim, pos, boxOff, boxCnt, boxOff, boxCnt, ndim, eleSize );
+            pos += nbElem * eleSize;
+        }
+    }
+
+    return res;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Recovers the subsets of a global dataset from the VPR file.
+  @param      dataset         Global dataset.
+  @param      FTI_Data        Dataset metadata.
+  @return     integer         FTI_SCES if successful.
+
+  The subsets requested by the ranks of this execution need not match the
+  ones written, e.g. after a restart on a different number of processes.
+  Instead of reading its own, possibly many and small, hyperslabs, every
+  rank reads one contiguous block of rows of the dataset with a single
+  collective transfer. The subsets are then cut out of the blocks and
+  exchanged with MPI_Alltoallv. If the buffers cannot be allocated, or
+  the exchange exceeds the MPI count range, the subsets are read one by one.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_ReadGlobalDataset( FTIT_globalDataset* dataset, FTIT_keymap* FTI_Data )
+{
+    char errstr[FTI_BUFS];
+    int nbProc, myRank, i, j, k, p;
+    int ndim = dataset->rank;
+    int desc = 2 * ndim;
+    hsize_t *dims = dataset->dimension;
+    hsize_t boxOff[FTI_HDF5_MAX_DIM], boxCnt[FTI_HDF5_MAX_DIM];
+    hsize_t slabOff[FTI_HDF5_MAX_DIM], slabDim[FTI_HDF5_MAX_DIM];
+    size_t eleSize = H5Tget_size( dataset->hdf5TypeId );
+    int res = FTI_SCES, allRes;
+
+    if( ndim < 1 || ndim > FTI_HDF5_MAX_DIM || eleSize == 0 ) {
+        return FTI_ReadSubsets( dataset, FTI_Data );
+    }
+
+    MPI_Comm_size( FTI_COMM_WORLD, &nbProc );
+    MPI_Comm_rank( FTI_COMM_WORLD, &myRank );
+
+    // rank p reads the rows [ dims[0]*p/nbProc, dims[0]*(p+1)/nbProc )
+    for( i = 0; i < ndim; i++ ) {
+        slabOff[i] = 0;
+        slabDim[i] = dims[i];
+    }
+    slabOff[0] = (hsize_t)( ((unsigned long long)dims[0] * myRank) / nbProc );
+    slabDim[0] = (hsize_t)( ((unsigned long long)dims[0] * (myRank+1)) / nbProc ) - slabOff[0];
+
+    // exchange the subset descriptors (offset, count) of all ranks
+    int nbSub = dataset->numSubSets;
+    int nbDesc = nbSub * desc;
+    int *subCnt = talloc( int, nbProc );
+    int *subDispl = talloc( int, nbProc );
+    int *cnt[2] = { talloc( int, nbProc ), talloc( int, nbProc ) };
+    int *displ[2] = { talloc( int, nbProc ), talloc( int, nbProc ) };
+    hsize_t *mySub = talloc( hsize_t, nbDesc + 1 );
+    FTIT_dataset **myVar = talloc( FTIT_dataset*, nbSub + 1 );
+
+    for( k = 0; k < nbSub; k++ ) {
+        myVar[k] = NULL;
+        FTI_Data->get( &myVar[k], dataset->varId[k] );
+        if( !myVar[k] ) {
+            snprintf( errstr, FTI_BUFS, "subset variable %d of dataset #%d not found", dataset->varId[k], dataset->id );
+            FTI_Print( errstr, FTI_EROR );
+            res = FTI_NSCS;
+            nbSub = k;
+            nbDesc = nbSub * desc;
+            break;
+        }
+        memcpy( mySub + k*desc, myVar[k]->sharedData.offset, sizeof(hsize_t) * ndim );
+        memcpy( mySub + k*desc + ndim, myVar[k]->sharedData.count, sizeof(hsize_t) * ndim );
+    }
+
+    MPI_Allgather( &nbDesc, 1, MPI_INT, subCnt, 1, MPI_INT, FTI_COMM_WORLD );
+    int total = 0;
+    for( p = 0; p < nbProc; p++ ) {
+        subDispl[p] = total;
+        total += subCnt[p];
+    }
+    hsize_t *allSub = talloc( hsize_t, total + 1 );
+    MPI_Allgatherv( mySub, nbDesc, MPI_UNSIGNED_LONG_LONG, allSub, subCnt, subDispl,
+            MPI_UNSIGNED_LONG_LONG, FTI_COMM_WORLD );
+
+    // bytes sent to every rank from my block and received from their blocks
+    size_t sendTotal = 0, recvTotal = 0;
+    for( p = 0; p < nbProc; p++ ) {
+        hsize_t row0 = (hsize_t)( ((unsigned long long)dims[0] * p) / nbProc );
+        hsize_t row1 = (hsize_t)( ((unsigned long long)dims[0] * (p+1)) / nbProc );
+        size_t bytes = 0;
+        for( j = 0; j < subCnt[p]; j += desc ) {
+            bytes += FTI_ClipSubset( allSub + subDispl[p] + j, slabOff[0], slabOff[0] + slabDim[0], ndim, boxOff, boxCnt ) * eleSize;
+        }
+        displ[0][p] = (int)sendTotal;
+        cnt[0][p] = (int)bytes;
+        sendTotal += bytes;
+        bytes = 0;
+        for( k = 0; k < nbSub; k++ ) {
+            bytes += FTI_ClipSubset( mySub + k*desc, row0, row1, ndim, boxOff, boxCnt ) * eleSize;
+        }
+        displ[1][p] = (int)recvTotal;
+        cnt[1][p] = (int)bytes;
+        recvTotal += bytes;
+        if( sendTotal > INT_MAX || recvTotal > INT_MAX ) {
+            res = FTI_NSCS;
+        }
+    }
+
+    size_t rowSize = eleSize;
+    for( i = 1; i < ndim; i++ ) {
+        rowSize *= dims[i];
+    }
+    char *slab = NULL;
+    char *buf[2] = { NULL, NULL };
+    if( res == FTI_SCES ) {
+        slab = malloc( slabDim[0] * rowSize + 1 );
+        buf[0] = malloc( sendTotal + 1 );
+        buf[1] = malloc( recvTotal + 1 );
+        if( !slab || !buf[0] || !buf[1] ) {
+            res = FTI_NSCS;
+        }
+    }
+
+    MPI_Allreduce( &res, &allRes, 1, MPI_INT, MPI_MIN, FTI_COMM_WORLD );
+    if( allRes == FTI_SCES ) {
+        res = FTI_ExchangeRows( dataset, nbProc, allSub, subCnt, subDispl, myVar, mySub, nbSub,
+                slab, slabOff, slabDim, buf, cnt, displ );
+    } else {
+        FTI_Print( "VPR recovery falls back to reading the subsets one by one.", FTI_DBUG );
+        res = FTI_ReadSubsets( dataset, FTI_Data );
+    }
+
+    free( slab );
+    free( buf[0] );
+    free( buf[1] );
+    free( allSub );
+    free( mySub );
+    free( myVar );
+    free( subCnt );
+    free( subDispl );
+    for( i = 0; i < 2; i++ ) {
+        free( cnt[i] );
+        free( displ[i] );
+    }
+
+    return res;
+}
+
 /*-------------------------------------------------------------------------*/
 /**
   @brief      Closes global datasets in VPR file 
@@ -1596,6 +2417,94 @@ herr_t FTI_WriteSharedFileData( FTIT_dataset FTI_Data )
 
 }
 
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Takes part in a collective write without writing data.
+  @param      dataset         Global dataset.
+  @return     integer         FTI_SCES if successful.
+ **/
+/*-------------------------------------------------------------------------*/
+herr_t FTI_WriteSharedFileNone( FTIT_globalDataset* dataset )
+{
+    char errstr[FTI_BUFS];
+    char dummy = 0;
+    hsize_t one = 1;
+    herr_t status = FTI_SCES;
+
+    hid_t msid = H5Screate_simple( 1, &one, NULL );
+    hid_t plid = H5Pcreate( H5P_DATASET_XFER );
+    if( (msid < 0) || (plid < 0) ) {
+        snprintf( errstr, FTI_BUFS, "Unable to create empty selection for dataset #%d", dataset->id );
+        FTI_Print(errstr,FTI_EROR);
+        return FTI_NSCS;
+    }
+    H5Sselect_none( msid );
+    H5Sselect_none( dataset->fileSpace );
+    H5Pset_dxpl_mpio( plid, H5FD_MPIO_COLLECTIVE );
+
+    if( H5Dwrite( dataset->hid, dataset->hdf5TypeId, msid, dataset->fileSpace, plid, &dummy ) < 0 ) {
+        snprintf( errstr, FTI_BUFS, "Unable to take part in the write of dataset #%d", dataset->id );
+        FTI_Print(errstr,FTI_EROR);
+        status = FTI_NSCS;
+    }
+
+    H5Sclose( msid );
+    H5Pclose( plid );
+
+    return status;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Writes the subsets of all global datasets into the VPR file.
+  @param      fd              VPR file descriptor.
+  @param      ptr             Data address per variable (NULL: protected).
+  @param      comm            Communicator of the application ranks.
+  @return     integer         FTI_SCES if successful.
+
+  The subsets are written dataset by dataset with collective transfers.
+  A rank may hold any number of subsets of a dataset, so every dataset is
+  written in as many rounds as the rank with the most subsets needs; ranks
+  without a subset in a round take part with an empty selection. Thus the
+  collective calls always match and MPI-IO can aggregate the subsets of
+  all ranks in each round.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_WriteGlobalDatasets( WriteHDF5Info_t* fd, void** ptr, MPI_Comm comm )
+{
+    FTIT_execution* FTI_Exec = fd->FTI_Exec;
+    FTIT_dataset* data;
+    int res = FTI_SCES;
+
+    if( fd->FTI_Data->data( &data, FTI_Exec->nbVar ) != FTI_SCES ) return FTI_NSCS;
+
+    FTIT_globalDataset* dataset = FTI_Exec->globalDatasets;
+    while( dataset ) {
+        int i, rounds;
+        MPI_Allreduce( &dataset->numSubSets, &rounds, 1, MPI_INT, MPI_MAX, comm );
+        for( i = 0; i < rounds; i++ ) {
+            FTIT_dataset* var = NULL;
+            if( i < dataset->numSubSets ) {
+                fd->FTI_Data->get( &var, dataset->varId[i] );
+            }
+            if( var ) {
+                FTIT_dataset subset = *var;
+                if( ptr ) {
+                    subset.ptr = ptr[var - data];
+                }
+                if( FTI_WriteSharedFileData( subset ) != FTI_SCES ) {
+                    res = FTI_NSCS;
+                }
+            } else if( FTI_WriteSharedFileNone( dataset ) != FTI_SCES ) {
+                res = FTI_NSCS;
+            }
+        }
+        dataset = dataset->next;
+    }
+
+    return res;
+}
+
 int FTI_GetDatasetRankReco( hid_t did ) 
 {
 
@@ -1726,7 +2635,8 @@ int FTI_H5CheckSingleFile( FTIT_configuration* FTI_Conf, int *ckptId )
     while((entry = readdir(dir)) != NULL) {   
         if(strcmp(entry->d_name,".") && strcmp(entry->d_name,"..")) {
             int len = strlen( entry->d_name ); 
-            if( len > 14 ) {
+            // files still named '.tmp' were not completely written
+            if( len > 14 && strcmp( entry->d_name + len - 3, ".h5" ) == 0 ) {
                 char fileRoot[FTI_BUFS];
                 bzero( fileRoot, FTI_BUFS );
                 memcpy( fileRoot, entry->d_name, len - 14 );
@@ -1780,6 +2690,17 @@ int FTI_H5CheckSingleFile( FTIT_configuration* FTI_Conf, int *ckptId )
 
 void FTI_FreeVPRMem( FTIT_execution* FTI_Exec, FTIT_keymap* FTI_Data ) 
 {
+    FTI_WaitVPR();
+    free( FTI_H5Async.buffer );
+    free( FTI_H5Async.ptr );
+    FTI_H5Async.buffer = NULL;
+    FTI_H5Async.ptr = NULL;
+    FTI_H5Async.bufferSize = 0;
+    FTI_H5Async.nbPtr = 0;
+    if( FTI_H5Async.comm != MPI_COMM_NULL ) {
+        MPI_Comm_free( &FTI_H5Async.comm );
+    }
+
     FTIT_globalDataset * dataset = FTI_Exec->globalDatasets;
     while( dataset ) {
         free( dataset->dimension );
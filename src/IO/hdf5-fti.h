@@ -13,7 +13,9 @@ int FTI_RecoverVarHDF5(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, F
 int FTI_ReadHDF5Var(FTIT_dataset *data);
 int FTI_GetDatasetRankReco( hid_t did );
 int FTI_GetDatasetSpanReco( hid_t did, hsize_t * span );
-int FTI_WriteHDF5Var(FTIT_dataset* data);
+int FTI_WriteHDF5Var(FTIT_dataset* data, FTIT_configuration* FTI_Conf);
+int FTI_H5ChunkDims(int rank, hsize_t *dims, size_t eleSize, size_t maxBytes, hsize_t *chunk);
+hid_t FTI_H5FileAccess(FTIT_configuration* FTI_Conf, bool shared);
 int FTI_CheckHDF5File(char* fn, long fs, char* checksum);
 int FTI_OpenGlobalDatasets( FTIT_execution* FTI_Exec );
 herr_t FTI_ReadSharedFileData( FTIT_dataset FTI_Data );
@@ -28,6 +30,12 @@ void FTI_CreateGroup(FTIT_H5Group* ftiGroup, hid_t parentGroup, FTIT_H5Group** F
 void FTI_OpenGroup(FTIT_H5Group* ftiGroup, hid_t parentGroup, FTIT_H5Group** FTI_Group);
 void FTI_CloseGroup(FTIT_H5Group* ftiGroup, FTIT_H5Group** FTI_Group);
 int FTI_CreateGlobalDatasets( FTIT_execution* FTI_Exec );
+herr_t FTI_WriteSharedFileNone( FTIT_globalDataset* dataset );
+herr_t FTI_ReadSharedFileNone( FTIT_globalDataset* dataset );
+int FTI_ReadGlobalDataset( FTIT_globalDataset* dataset, FTIT_keymap* FTI_Data );
+int FTI_SnapshotVPR( FTIT_execution* FTI_Exec, FTIT_keymap* FTI_Data );
+int FTI_WaitVPR( void );
+bool FTI_PendingVPR( void );
 int FTI_CloseGlobalDatasets( FTIT_execution* FTI_Exec );
 #endif
 
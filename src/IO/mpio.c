@@ -40,6 +40,64 @@
 #include "../interface.h"
 
 
+/** Max. bytes of a block of the memory/file datatypes (fits an int).    **/
+#define FTI_MPIO_MAX_BLOCK  ((size_t)1 << 30)
+/** Max. bytes written by one collective call.                           **/
+#define FTI_MPIO_MAX_ROUND  ((size_t)1 << 30)
+
+
+/** Datatypes describing where the datasets of this rank live in memory
+    and in the rank's region of the checkpoint file. They are kept from
+    one checkpoint to the next as long as the layout does not change.   **/
+static struct {
+    int             nbSeg;              /**< Number of segments.            */
+    MPI_Aint        *addr;              /**< Memory address of segments.    */
+    MPI_Aint        *disp;              /**< File displ. of segments.       */
+    int             *len;               /**< Bytes in each segment.         */
+    int             nbRounds;           /**< Local number of collectives.   */
+    MPI_Datatype    *memType;           /**< Memory datatype of each round. */
+    MPI_Datatype    *fileType;          /**< File view of each round.       */
+} FTI_MPIOView = { 0, NULL, NULL, NULL, 0, NULL, NULL };
+
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Sets the MPI-IO hints of the configuration.
+  @param      FTI_Conf        Configuration metadata.
+  @param      info            The MPI info object to fill.
+  @param      flag            'r' to read the file, 'w' to write it.
+  @return     integer         FTI_SCES on success.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_MPIOSetHints(FTIT_configuration* FTI_Conf, MPI_Info info, char flag)
+{
+    char str[FTI_BUFS];
+
+    if ( flag == 'r' )
+        MPI_Info_set(info, "romio_cb_read", "enable");
+    else if ( flag == 'w' )
+        MPI_Info_set(info, "romio_cb_write", "enable");
+
+    if ( FTI_Conf->mpioCbNodes > 0 ) {
+        snprintf(str, FTI_BUFS, "%d", FTI_Conf->mpioCbNodes);
+        MPI_Info_set(info, "cb_nodes", str);
+    }
+    if ( FTI_Conf->mpioCbBufferSize > 0 ) {
+        snprintf(str, FTI_BUFS, "%d", FTI_Conf->mpioCbBufferSize);
+        MPI_Info_set(info, "cb_buffer_size", str);
+    }
+    if ( FTI_Conf->mpioStripeUnit > 0 ) {
+        snprintf(str, FTI_BUFS, "%d", FTI_Conf->mpioStripeUnit);
+        MPI_Info_set(info, "striping_unit", str);
+    }
+    if ( FTI_Conf->mpioStripeFactor > 0 ) {
+        snprintf(str, FTI_BUFS, "%d", FTI_Conf->mpioStripeFactor);
+        MPI_Info_set(info, "striping_factor", str);
+    }
+    return FTI_SCES;
+}
+
+
 /*-------------------------------------------------------------------------*/
 /**
   @brief      Opens and file (Only for write).
@@ -52,29 +110,28 @@ int FTI_MPIOOpen(char *fn, void *fileDesc){
     int res = FTI_SCES;
     char str[FTI_BUFS], mpi_err[FTI_BUFS];
     MPI_Info_create(&(fd->info));
-
-    if ( fd->flag == 'r' )
-        MPI_Info_set(fd->info, "romio_cb_read", "enable");
-    else if (fd->flag == 'w' )		
-        MPI_Info_set(fd->info, "romio_cb_write", "enable");
-
-    MPI_Info_set(fd->info, "stripping_unit", "4194304");
-#ifdef LUSTRE
-    if (fd->FTI_Topo->splitRank == 0) {
-        res = llapi_file_create(gfn, fd->FTI_Conf->stripeUnit, fd->FTI_Conf->stripeOffset, fd->FTI_Conf->stripeFactor, 0);
-        if (res) {
-            char error_msg[FTI_BUFS];
-            error_msg[0] = 0;
-            strerror_r(-res, error_msg, FTI_BUFS);
-            snprintf(str, FTI_BUFS, "[Lustre] %s.", error_msg);
-            FTI_Print(str, FTI_WARN);
-        } else {
-            snprintf(str, FTI_BUFS, "[LUSTRE] file:%s striping_unit:%i striping_factor:%i striping_offset:%i",
-                    ckptFile, FTI_Conf->stripeUnit, FTI_Conf->stripeFactor, FTI_Conf->stripeOffset);
-            FTI_Print(str, FTI_DBUG);
+    FTI_MPIOSetHints(fd->FTI_Conf, fd->info, fd->flag);
+
+    fd->queue = false;
+    fd->failed = false;
+    fd->nbSeg = 0;
+    fd->maxSeg = 0;
+    fd->segAddr = NULL;
+    fd->segDisp = NULL;
+    fd->segLen = NULL;
+
+    // create the file with the planned striping layout before opening it
+    if (fd->flag == 'w' && fd->fileSize > 0) {
+        if (fd->FTI_Topo->splitRank == 0) {
+            if (FTI_CreateStriped(fd->FTI_Conf, fn, fd->fileSize, 0) != FTI_SCES) {
+                snprintf(str, FTI_BUFS, "Unable to stripe %s, it is created with the default layout.", fn);
+                FTI_Print(str, FTI_WARN);
+            }
         }
-    }
+#ifdef LUSTRE
+        MPI_Barrier(FTI_COMM_WORLD);
 #endif
+    }
 
     if ( fd->flag == 'r' )
         res = MPI_File_open(FTI_COMM_WORLD, fn, MPI_MODE_RDWR, fd->info, &(fd->pfh));
@@ -92,19 +149,234 @@ int FTI_MPIOOpen(char *fn, void *fileDesc){
     return FTI_SCES;
 }
 
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Drops the segments queued for the collective write.
+  @param      fd              The file descriptor.
+  @return     void.
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_MPIOFreeSegments(WriteMPIInfo_t *fd)
+{
+    free(fd->segAddr);
+    free(fd->segDisp);
+    free(fd->segLen);
+    fd->segAddr = NULL;
+    fd->segDisp = NULL;
+    fd->segLen = NULL;
+    fd->nbSeg = 0;
+    fd->maxSeg = 0;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Queues a memory region for the collective write.
+  @param      fd              The file descriptor.
+  @param      ptr             Start of the region.
+  @param      size            Size of the region.
+  @param      disp            Position of the region in the rank's part
+                              of the file.
+  @return     integer         FTI_SCES on success.
+
+  Regions larger than FTI_MPIO_MAX_BLOCK are split, so that every block
+  length fits the int of the MPI datatype constructors.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_MPIOQueue(WriteMPIInfo_t *fd, void *ptr, size_t size, size_t disp)
+{
+    size_t pos = 0;
+    while (pos < size) {
+        if (fd->nbSeg == fd->maxSeg) {
+            int maxSeg = (fd->maxSeg > 0) ? 2 * fd->maxSeg : 64;
+            MPI_Aint *addr = realloc(fd->segAddr, sizeof(MPI_Aint) * maxSeg);
+            if (addr) fd->segAddr = addr;
+            MPI_Aint *segDisp = realloc(fd->segDisp, sizeof(MPI_Aint) * maxSeg);
+            if (segDisp) fd->segDisp = segDisp;
+            int *len = realloc(fd->segLen, sizeof(int) * maxSeg);
+            if (len) fd->segLen = len;
+            if (!addr || !segDisp || !len) {
+                FTI_Print("Cannot allocate the MPI-IO segment list.", FTI_EROR);
+                return FTI_NSCS;
+            }
+            fd->maxSeg = maxSeg;
+        }
+        size_t bSize = size - pos;
+        if (bSize > FTI_MPIO_MAX_BLOCK) {
+            bSize = FTI_MPIO_MAX_BLOCK;
+        }
+        MPI_Get_address((char*)ptr + pos, &fd->segAddr[fd->nbSeg]);
+        fd->segDisp[fd->nbSeg] = (MPI_Aint)(disp + pos);
+        fd->segLen[fd->nbSeg] = (int)bSize;
+        fd->nbSeg++;
+        pos += bSize;
+    }
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Frees the cached datatypes of the MPI-IO checkpoints.
+  @return     void.
+ **/
+/*-------------------------------------------------------------------------*/
+void FTI_FreeMPIOView(void)
+{
+    int i;
+    for (i = 0; i < FTI_MPIOView.nbRounds; i++) {
+        MPI_Type_free(&FTI_MPIOView.memType[i]);
+        MPI_Type_free(&FTI_MPIOView.fileType[i]);
+    }
+    free(FTI_MPIOView.memType);
+    free(FTI_MPIOView.fileType);
+    free(FTI_MPIOView.addr);
+    free(FTI_MPIOView.disp);
+    free(FTI_MPIOView.len);
+    FTI_MPIOView.memType = NULL;
+    FTI_MPIOView.fileType = NULL;
+    FTI_MPIOView.addr = NULL;
+    FTI_MPIOView.disp = NULL;
+    FTI_MPIOView.len = NULL;
+    FTI_MPIOView.nbRounds = 0;
+    FTI_MPIOView.nbSeg = 0;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Builds the datatypes for the queued segments.
+  @param      fd              The file descriptor.
+  @return     integer         FTI_SCES on success.
+
+  The segments are packed in rounds of at most FTI_MPIO_MAX_ROUND bytes.
+  For each round, an hindexed datatype on absolute addresses describes
+  the data in memory and another one the file view. If the segments are
+  the same as for the previous checkpoint, the cached datatypes are used.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_MPIOBuildView(WriteMPIInfo_t *fd)
+{
+    int i, first, round;
+
+    if (FTI_MPIOView.addr && FTI_MPIOView.nbSeg == fd->nbSeg &&
+            memcmp(FTI_MPIOView.addr, fd->segAddr, sizeof(MPI_Aint) * fd->nbSeg) == 0 &&
+            memcmp(FTI_MPIOView.disp, fd->segDisp, sizeof(MPI_Aint) * fd->nbSeg) == 0 &&
+            memcmp(FTI_MPIOView.len, fd->segLen, sizeof(int) * fd->nbSeg) == 0) {
+        FTI_MPIOFreeSegments(fd);
+        return FTI_SCES;
+    }
+
+    FTI_FreeMPIOView();
+    FTI_MPIOView.nbSeg = fd->nbSeg;
+    FTI_MPIOView.addr = fd->segAddr;
+    FTI_MPIOView.disp = fd->segDisp;
+    FTI_MPIOView.len = fd->segLen;
+    fd->segAddr = NULL;
+    fd->segDisp = NULL;
+    fd->segLen = NULL;
+    FTI_MPIOFreeSegments(fd);
+
+    // segments are at most FTI_MPIO_MAX_BLOCK, so each one fits a round
+    int nbRounds = 0;
+    size_t roundSize = FTI_MPIO_MAX_ROUND;
+    for (i = 0; i < FTI_MPIOView.nbSeg; i++) {
+        if (roundSize + FTI_MPIOView.len[i] > FTI_MPIO_MAX_ROUND) {
+            nbRounds++;
+            roundSize = 0;
+        }
+        roundSize += FTI_MPIOView.len[i];
+    }
+    FTI_MPIOView.memType = talloc(MPI_Datatype, nbRounds);
+    FTI_MPIOView.fileType = talloc(MPI_Datatype, nbRounds);
+
+    first = 0;
+    for (round = 0; round < nbRounds; round++) {
+        int last = first;
+        roundSize = 0;
+        while (last < FTI_MPIOView.nbSeg && roundSize + FTI_MPIOView.len[last] <= FTI_MPIO_MAX_ROUND) {
+            roundSize += FTI_MPIOView.len[last];
+            last++;
+        }
+        MPI_Type_create_hindexed(last - first, &FTI_MPIOView.len[first], &FTI_MPIOView.addr[first],
+                MPI_BYTE, &FTI_MPIOView.memType[round]);
+        MPI_Type_commit(&FTI_MPIOView.memType[round]);
+        MPI_Type_create_hindexed(last - first, &FTI_MPIOView.len[first], &FTI_MPIOView.disp[first],
+                MPI_BYTE, &FTI_MPIOView.fileType[round]);
+        MPI_Type_commit(&FTI_MPIOView.fileType[round]);
+        FTI_MPIOView.nbRounds++;
+        first = last;
+    }
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Writes the queued segments with collective calls.
+  @param      fd              The file descriptor.
+  @return     integer         FTI_SCES on success.
+
+  Usually this is a single MPI_File_write_at_all per checkpoint. Ranks
+  with more than FTI_MPIO_MAX_ROUND bytes need more rounds; ranks having
+  less data take part in the extra rounds with an empty write.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_MPIOWriteSegments(WriteMPIInfo_t *fd)
+{
+    int round, nbRounds, res = FTI_SCES;
+
+    if (FTI_MPIOBuildView(fd) != FTI_SCES) {
+        return FTI_NSCS;
+    }
+    MPI_Allreduce(&FTI_MPIOView.nbRounds, &nbRounds, 1, MPI_INT, MPI_MAX, FTI_COMM_WORLD);
+
+    for (round = 0; round < nbRounds; round++) {
+        int err;
+        if (round < FTI_MPIOView.nbRounds) {
+            MPI_File_set_view(fd->pfh, fd->offset, MPI_BYTE, FTI_MPIOView.fileType[round], "native", fd->info);
+            err = MPI_File_write_at_all(fd->pfh, 0, MPI_BOTTOM, 1, FTI_MPIOView.memType[round], MPI_STATUS_IGNORE);
+        }
+        else {
+            MPI_File_set_view(fd->pfh, fd->offset, MPI_BYTE, MPI_BYTE, "native", fd->info);
+            err = MPI_File_write_at_all(fd->pfh, 0, NULL, 0, MPI_BYTE, MPI_STATUS_IGNORE);
+        }
+        if (err != 0) {
+            errno = 0;
+            int reslen;
+            char str[FTI_BUFS], mpi_err[FTI_BUFS];
+            MPI_Error_string(err, mpi_err, &reslen);
+            snprintf(str, FTI_BUFS, "unable to write the checkpoint file [MPI ERROR - %i] %s", err, mpi_err);
+            FTI_Print(str, FTI_EROR);
+            fd->err = err;
+            res = FTI_NSCS;
+        }
+    }
+    return res;
+}
+
 /*-------------------------------------------------------------------------*/
 /**
   @brief      Closes the file  
   @param      fileDesc          The fileDescriptor 
   @return     integer         Return FTI_SCES  when successfuly write the data to the file 
 
+  Data queued by FTI_WriteMPIOData is written before closing the file,
+  unless a dataset failed on any rank.
  **/
 /*-------------------------------------------------------------------------*/
 int FTI_MPIOClose(void *fileDesc){
     WriteMPIInfo_t *fd = (WriteMPIInfo_t*) fileDesc;
+    int res = (fd->failed) ? FTI_NSCS : FTI_SCES;
+    if (fd->flag == 'w' && fd->queue) {
+        int failed = fd->failed, anyFailed;
+        MPI_Allreduce(&failed, &anyFailed, 1, MPI_INT, MPI_MAX, FTI_COMM_WORLD);
+        if (!anyFailed) {
+            res = FTI_MPIOWriteSegments(fd);
+        } else {
+            FTI_MPIOFreeSegments(fd);
+            res = FTI_NSCS;
+        }
+    }
     MPI_Info_free(&(fd->info));
     MPI_File_close(&(fd->pfh));
-    return FTI_SCES;
+    return res;
 }
 
 
@@ -141,6 +413,7 @@ int FTI_MPIOWrite(void *src, size_t size, void *fileDesc)
             MPI_Error_string(fd->err, mpi_err, &reslen);
             snprintf(str, FTI_BUFS, "unable to create file [MPI ERROR - %i] %s", fd->err, mpi_err);
             FTI_Print(str, FTI_EROR);
+            MPI_Type_free(&dType);
             return FTI_NSCS;
         }
         MPI_Type_free(&dType);
@@ -196,7 +469,6 @@ int FTI_MPIORead(void *dest, size_t size, void *fileDesc){
 /*-------------------------------------------------------------------------*/
 void *FTI_InitMPIO(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, FTIT_topology* FTI_Topo, FTIT_checkpoint *FTI_Ckpt, FTIT_keymap *FTI_Data){
     char gfn[FTI_BUFS], ckptFile[FTI_BUFS];
-    int i;
     MPI_Offset offset = 0;
     MPI_Offset chunkSize = FTI_Exec->ckptSize;
     WriteMPIInfo_t *write_info = (WriteMPIInfo_t*) malloc (sizeof(WriteMPIInfo_t));
@@ -205,24 +477,27 @@ void *FTI_InitMPIO(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, FTIT_
     write_info->FTI_Topo= FTI_Topo;
     write_info->loffset = 0;
     write_info->flag = 'w';
+    write_info->fileSize = 0;
 
     FTI_Print("I/O mode: MPI-IO.", FTI_DBUG);
     snprintf(FTI_Exec->ckptMeta.ckptFile, FTI_BUFS, "Ckpt%d-Rank%d.fti", FTI_Exec->ckptId, FTI_Topo->myRank);
     snprintf(ckptFile, FTI_BUFS, "Ckpt%d-mpiio.fti", FTI_Exec->ckptId);
     snprintf(gfn, FTI_BUFS, "%s/%s", FTI_Conf->gTmpDir, ckptFile);
-    FTI_MPIOOpen(gfn, write_info);
-
-
-    // collect chunksizes of other ranks
-    MPI_Offset* chunkSizes = talloc(MPI_Offset, FTI_Topo->nbApprocs * FTI_Topo->nbNodes);
-    MPI_Allgather(&chunkSize, 1, MPI_OFFSET, chunkSizes, 1, MPI_OFFSET, FTI_COMM_WORLD);
 
-    // set file offset
-    for (i = 0; i < FTI_Topo->splitRank; i++) {
-        offset += chunkSizes[i];
+    // file offset is the sum of the chunk sizes of the lower ranks
+    MPI_Exscan(&chunkSize, &offset, 1, MPI_OFFSET, MPI_SUM, FTI_COMM_WORLD);
+    if (FTI_Topo->splitRank == 0) {
+        offset = 0;
     }
-    free(chunkSizes);
     write_info->offset = offset;
+
+    // the striping layout depends on the size of the whole file
+    if (FTI_StripeOsts(FTI_Conf) > 0) {
+        MPI_Allreduce(&chunkSize, &write_info->fileSize, 1, MPI_OFFSET, MPI_SUM, FTI_COMM_WORLD);
+    }
+    FTI_MPIOOpen(gfn, write_info);
+    // iCP datasets may be modified after FTI_AddVarICP, write them right away
+    write_info->queue = (FTI_Exec->iCPInfo.status == FTI_ICP_NINI);
     return (void *)write_info;
 }
 
@@ -238,6 +513,13 @@ void *FTI_InitMPIO(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, FTIT_
   @param      FTI_Data        Dataset metadata.
   @return     integer         FTI_SCES if successful.
 
+  CPU data is only queued here and written by FTI_MPIOClose, together
+  with all other datasets of the rank, in a single collective call. In
+  iCP, the data is written right away.
+
+  The file is not closed on failure, since the other ranks still close it
+  collectively. In a queued write, the failure is reported by
+  FTI_MPIOClose on all ranks.
  **/
 /*-------------------------------------------------------------------------*/
 int FTI_WriteMPIOData(FTIT_dataset * data, void *fd){
@@ -245,16 +527,22 @@ int FTI_WriteMPIOData(FTIT_dataset * data, void *fd){
 
     char str[FTI_BUFS];
     int res;
-    if ( !(data->isDevicePtr) ){
+    if (write_info->failed) {
+        write_info->loffset += data->size;
+        return (write_info->queue) ? FTI_SCES : FTI_NSCS;
+    }
+    if ( !(data->isDevicePtr) && write_info->queue ){
+        snprintf(str, FTI_BUFS, "Dataset #%d Queuing CPU Data.", data->id);
+        FTI_Print(str,FTI_DBUG);
+        res = FTI_MPIOQueue(write_info, data->ptr, data->size, write_info->loffset);
+    }
+    else if ( !(data->isDevicePtr) ){
         snprintf(str, FTI_BUFS, "Dataset #%d Writing CPU Data.", data->id);
         FTI_Print(str,FTI_DBUG);
+        MPI_Offset offset = write_info->offset;
+        write_info->offset += write_info->loffset;
         res = FTI_MPIOWrite(data->ptr, data->size, write_info);
-        if (res != FTI_SCES ){
-            snprintf(str, FTI_BUFS, "Dataset #%d could not be written.", data->id);
-            FTI_Print(str, FTI_EROR);
-            FTI_MPIOClose(write_info);
-            return res;
-        }
+        write_info->offset = offset;
     }
 #ifdef GPUSUPPORT
     // dowload data from the GPU if necessary
@@ -262,16 +550,25 @@ int FTI_WriteMPIOData(FTIT_dataset * data, void *fd){
     else {
         snprintf(str, FTI_BUFS, "Dataset #%d Writing GPU Data.", data->id);
         FTI_Print(str,FTI_DBUG);
-        if ((res = FTI_Try(
-                        FTI_TransferDeviceMemToFileAsync(data, FTI_MPIOWrite, write_info),
-                        "moving data from GPU to storage")) != FTI_SCES) {
-            snprintf(str, FTI_BUFS, "Dataset #%d could not be written.", data->id);
-            FTI_Print(str, FTI_EROR);
-            FTI_MPIOClose(write_info);
-            return res;
-        }
+        MPI_Offset offset = write_info->offset;
+        write_info->offset += write_info->loffset;
+        res = FTI_Try(FTI_TransferDeviceMemToFileAsync(data, FTI_MPIOWrite, write_info),
+                        "moving data from GPU to storage");
+        write_info->offset = offset;
+    }
+#else
+    else {
+        res = FTI_NSCS;
     }
 #endif
+    if (res != FTI_SCES) {
+        snprintf(str, FTI_BUFS, "Dataset #%d could not be written.", data->id);
+        FTI_Print(str, FTI_EROR);
+        FTI_MPIOFreeSegments(write_info);
+        write_info->failed = true;
+        write_info->loffset += data->size;
+        return (write_info->queue) ? FTI_SCES : FTI_NSCS;
+    }
     write_info->loffset+= data->size;
     return FTI_SCES;
 }
@@ -47,6 +47,9 @@ int FTI_ActivateHeadsPosix(FTIT_configuration* FTI_Conf,FTIT_execution* FTI_Exec
     if (status != FTI_SCES) { //If Writing checkpoint failed
         value = FTI_REJW; //Send reject checkpoint token to head
     }
+    if (status != FTI_SCES && FTI_Conf->shmHandoff) {
+        FTI_HandoffUnlink(FTI_Exec);
+    }
     MPI_Send(&value, 1, MPI_INT, FTI_Topo->headRank, FTI_Conf->ckptTag, FTI_Exec->globalComm);
     int isDCP = (int)FTI_Ckpt[4].isDcp;
     MPI_Send(&isDCP, 1, MPI_INT, FTI_Topo->headRank, FTI_Conf->ckptTag, FTI_Exec->globalComm);
@@ -83,6 +86,40 @@ int FTI_PosixOpen(char *fn, void *fileDesc)
         return FTI_NSCS;
     }
     MD5_Init(&(fd->integrity));
+    fd->handoff.ptr = NULL;
+    memset(&(fd->stage), 0, sizeof(FTIT_coalesce));
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Writes the small variables gathered in the staging buffer.
+  @param      fileDesc          The fileDescriptor 
+  @return     integer         FTI_SCES on success.
+
+  The gathered variables are written with a single call to FTI_PosixWrite,
+  which also updates the checksum and the handoff to the heads. A failure
+  is remembered, so that closing the file reports it.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_PosixFlush(void *fileDesc)
+{
+    WritePosixInfo_t *fd = (WritePosixInfo_t *) fileDesc;
+    FTIT_coalesce *stage = &(fd->stage);
+
+    if (stage->failed) {
+        return FTI_NSCS;
+    }
+    if (stage->used == 0) {
+        return FTI_SCES;
+    }
+    if (FTI_PosixWrite(stage->buf, stage->used, fd) != FTI_SCES) {
+        stage->failed = true;
+        stage->used = 0;
+        return FTI_NSCS;
+    }
+    stage->pos += stage->used;
+    stage->used = 0;
     return FTI_SCES;
 }
 
@@ -97,9 +134,18 @@ int FTI_PosixOpen(char *fn, void *fileDesc)
 int FTI_PosixClose(void *fileDesc)
 {
     WritePosixInfo_t *fd = (WritePosixInfo_t *) fileDesc;
+    int res = FTI_PosixFlush(fileDesc);
+    free(fd->stage.buf);
+    fd->stage.buf = NULL;
+    if (fd->stage.failed) {
+        // the file was closed by the failing FTI_PosixWrite
+        FTI_HandoffDetach(&(fd->handoff));
+        return FTI_NSCS;
+    }
     FTI_PosixSync(fileDesc);
     fclose(fd->f);
-    return FTI_SCES;
+    FTI_HandoffDetach(&(fd->handoff));
+    return res;
 }
 
 
@@ -127,7 +173,22 @@ int FTI_PosixWrite(void *src, size_t size, void *fileDesc)
         fwrite_errno = errno;
     }
 
+    double t = FTI_TraceStart();
     MD5_Update (&(fd->integrity), src, size);
+    FTI_TraceEvent(FTI_TRACE_HASH, -1, t, size);
+
+    // mirror data into the shared memory segment for the head
+    if (fd->handoff.ptr != NULL) {
+        if (fd->handoff.pos + size <= fd->handoff.size) {
+            memcpy((char*)fd->handoff.ptr + fd->handoff.pos, src, size);
+            fd->handoff.pos += size;
+        } else {
+            FTI_Print("Checkpoint exceeds shared memory segment, heads will read the local file.", FTI_WARN);
+            fd->handoff.pos = 0;
+            FTI_HandoffDetach(&(fd->handoff));
+        }
+    }
+
     if (ferror(fd->f)){
         char error_msg[FTI_BUFS];
         error_msg[0] = 0;
@@ -155,12 +216,16 @@ int FTI_PosixWrite(void *src, size_t size, void *fileDesc)
 int FTI_PosixSeek(size_t pos, void *fileDesc)
 {
     WritePosixInfo_t *fd = (WritePosixInfo_t *) fileDesc;
+    if ( FTI_PosixFlush(fileDesc) != FTI_SCES ) {
+        return FTI_NSCS;
+    }
     if ( fseek( fd->f, pos, SEEK_SET ) == -1 ) {
         char error_msg[FTI_BUFS];
         sprintf(error_msg, "Unable to Seek : [POSIX ERROR -%s.]", strerror(errno));
         FTI_Print(error_msg, FTI_EROR );
         return FTI_NSCS;
     }
+    fd->stage.pos = pos;
     return FTI_SCES;
 }
 
@@ -175,6 +240,10 @@ int FTI_PosixSeek(size_t pos, void *fileDesc)
 size_t FTI_GetPosixFilePos(void *fileDesc)
 {
     WritePosixInfo_t *fd = (WritePosixInfo_t *) fileDesc;
+    // while coalescing, the position is tracked without asking the stream
+    if (fd->stage.buf != NULL) {
+        return fd->stage.pos + fd->stage.used;
+    }
     return ftell(fd->f);
 }
 
@@ -203,7 +272,9 @@ int FTI_PosixRead(void *dest, size_t size, void *fileDesc)
 /*-------------------------------------------------------------------------*/
 int FTI_PosixSync(void *fileDesc)
 {
+    double t = FTI_TraceStart();
     fsync(fileno(((WritePosixInfo_t *) fileDesc)->f));
+    FTI_TraceEvent(FTI_TRACE_FSYNC, -1, t, 0);
     return FTI_SCES;
 }
 
@@ -233,6 +304,11 @@ void* FTI_InitPosix(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, FTIT
 
     if (level == 4 && FTI_Ckpt[4].isInline) { //If inline L4 save directly to global directory
         snprintf(fn, FTI_BUFS, "%s/%s", FTI_Conf->gTmpDir, FTI_Exec->ckptMeta.ckptFile);
+        if (FTI_CreateStriped(FTI_Conf, fn, FTI_Exec->ckptSize, FTI_StripeIndex(FTI_Topo, FTI_Topo->nodeRank)) != FTI_SCES) {
+            char str[FTI_BUFS];
+            snprintf(str, FTI_BUFS, "Unable to stripe %s, it is created with the default layout.", fn);
+            FTI_Print(str, FTI_WARN);
+        }
     }
     else {
         snprintf(fn, FTI_BUFS, "%s/%s", FTI_Conf->lTmpDir, FTI_Exec->ckptMeta.ckptFile);
@@ -241,6 +317,25 @@ void* FTI_InitPosix(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, FTIT
     write_info->flag = 'w';
     write_info->offset = 0;
     FTI_PosixOpen(fn,write_info);
+
+    // expose the checkpoint data to the head through shared memory, if the
+    // head reads it with FTI_HandoffOpen (only FTI_FlushPosix does for L4,
+    // MPI-IO and SIONlib flush from the local files)
+    bool handoff = (level == 2 || level == 3) || (level == 4 &&
+            (FTI_Conf->ioMode == FTI_IO_POSIX || FTI_Conf->ioMode == FTI_IO_IME));
+    if (FTI_Conf->shmHandoff && handoff && !FTI_Ckpt[level].isInline) {
+        FTI_HandoffCreate(FTI_Exec, &(write_info->handoff), FTI_Exec->ckptSize);
+    }
+
+    // gather small variables to write them with one call
+    if (FTI_Conf->coalesceSize > 0 && write_info->f != NULL) {
+        write_info->stage.buf = (char*) malloc(FTI_Conf->coalesceBuffer);
+        if (write_info->stage.buf == NULL) {
+            FTI_Print("Unable to allocate the coalescing buffer, small variables are written one by one.", FTI_WARN);
+        }
+        write_info->stage.size = FTI_Conf->coalesceBuffer;
+        write_info->stage.limit = FTI_Conf->coalesceSize;
+    }
     return write_info;
 }
 
@@ -259,9 +354,33 @@ void* FTI_InitPosix(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, FTIT
 int FTI_WritePosixData(FTIT_dataset * data, void *fd)
 {
     WritePosixInfo_t *write_info = (WritePosixInfo_t*) fd;
+    FTIT_coalesce *stage = &(write_info->stage);
     char str[FTI_BUFS];
     int res;
 
+    // small variables are copied to the staging buffer, which is written
+    // when full, before a large variable, or on MD5/close
+    if ( stage->buf != NULL && !(data->isDevicePtr) && data->size <= stage->limit ) {
+        if ( stage->used + data->size > stage->size ) {
+            if ( FTI_PosixFlush(write_info) != FTI_SCES ) {
+                snprintf(str, FTI_BUFS, "Dataset #%d could not be written.", data->id);
+                FTI_Print(str, FTI_EROR);
+                FTI_PosixClose(write_info);
+                return FTI_NSCS;
+            }
+        }
+        memcpy(stage->buf + stage->used, data->ptr, data->size);
+        stage->used += data->size;
+        return FTI_SCES;
+    }
+    if ( FTI_PosixFlush(write_info) != FTI_SCES ) {
+        snprintf(str, FTI_BUFS, "Dataset #%d could not be written.", data->id);
+        FTI_Print(str, FTI_EROR);
+        FTI_PosixClose(write_info);
+        return FTI_NSCS;
+    }
+    stage->pos += data->size;
+
     if ( !(data->isDevicePtr) ){
         if (( res = FTI_Try(FTI_PosixWrite(data->ptr, data->size, write_info),"Storing Data to Checkpoint file")) != FTI_SCES){
             snprintf(str, FTI_BUFS, "Dataset #%d could not be written.", data->id);
@@ -299,5 +418,7 @@ int FTI_WritePosixData(FTIT_dataset * data, void *fd)
 void FTI_PosixMD5(unsigned char *dest, void *md5)
 {
     WritePosixInfo_t *write_info =(WritePosixInfo_t *) md5;
+    // a failure is reported by FTI_PosixClose
+    FTI_PosixFlush(write_info);
     MD5_Final(dest,&(write_info->integrity));
 }
@@ -14,6 +14,7 @@ size_t FTI_GetPosixFilePos(void *fileDesc);
 int FTI_PosixSeek(size_t pos, void *fileDesc);
 int FTI_PosixWrite(void *src, size_t size, void *fileDesc);
 int FTI_PosixClose(void *fileDesc);
+int FTI_PosixFlush(void *fileDesc);
 int FTI_PosixOpen(char *fn, void *fileDesc);
 
 #ifdef __cplusplus
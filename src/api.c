@@ -120,6 +120,7 @@ int FTI_Init(const char* configFile, MPI_Comm globalComm)
     FTI_Conf.verbosity = 1; //Temporary needed for output in FTI_LoadConf.
     FTI_Exec.initSCES = 0;
     FTI_Inje.timer = MPI_Wtime();
+    FTI_Exec.initTime = MPI_Wtime();
     FTI_COMM_WORLD = globalComm; // Temporary before building topology. Needed in FTI_LoadConf and FTI_Topology to communicate.
     FTI_Topo.splitRank = FTI_Topo.myRank; // Temporary before building topology. Needed in FTI_Print.
     int res = FTI_Try(FTI_LoadConf(&FTI_Conf, &FTI_Exec, &FTI_Topo, FTI_Ckpt, &FTI_Inje), "load configuration.");
@@ -130,6 +131,10 @@ int FTI_Init(const char* configFile, MPI_Comm globalComm)
     if (res == FTI_NSCS) {
         return FTI_NSCS;
     }
+    FTI_Exec.postComm = FTI_COMM_WORLD;
+    FTI_Try(FTI_TraceInit(&FTI_Conf, &FTI_Exec, &FTI_Topo), "start the checkpoint trace.");
+    FTI_Try(FTI_InitReclaim(&FTI_Conf), "start the reclaim threads.");
+    FTI_Try(FTI_SweepTrash(&FTI_Conf, &FTI_Topo), "delete the trash of previous executions.");
     FTI_Try(FTI_InitGroupsAndTypes(&FTI_Exec), "malloc arrays for groups and types.");
     FTI_Try(FTI_InitBasicTypes(), "create the basic data types.");
     if (FTI_Topo.myRank == 0) {
@@ -151,6 +156,7 @@ int FTI_Init(const char* configFile, MPI_Comm globalComm)
         strcpy(FTI_Conf.suffix,"fti");
     }
     
+    FTI_FreeDatasetAttr();
     FTI_KeyMap( &FTI_Data, sizeof(FTIT_dataset), FTI_Conf.maxVarId, true );
     
     FTI_Exec.initSCES = 1;
@@ -160,7 +166,9 @@ int FTI_Init(const char* configFile, MPI_Comm globalComm)
 
     if (FTI_Topo.amIaHead) { // If I am a FTI dedicated process
         if (FTI_Exec.reco) {
+            double tt = FTI_TraceStart();
             res = FTI_Try(FTI_RecoverFiles(&FTI_Conf, &FTI_Exec, &FTI_Topo, FTI_Ckpt), "recover the checkpoint files.");
+            FTI_TraceEvent(FTI_TRACE_RECOVERFILES, FTI_Exec.ckptLvel, tt, 0);
             if (res != FTI_SCES) {
                 FTI_Exec.reco = 0;
                 FTI_Exec.initSCES = 2; //Could not recover all ckpt files
@@ -177,6 +185,9 @@ int FTI_Init(const char* configFile, MPI_Comm globalComm)
         if ( FTI_Try(FTI_InitFunctionPointers(FTI_Conf.ioMode, &FTI_Exec),"Initializing IO pointers") != FTI_SCES){
             FTI_Print("Cannot define the function pointers\n", FTI_EROR);
         }
+        if (FTI_Conf.headThread) {
+            FTI_Try(FTI_InitHelper(&FTI_Conf, &FTI_Exec, &FTI_Topo, FTI_Ckpt), "start the post-processing helper thread.");
+        }
 
         // call in any case. treatment for diffCkpt disabled inside initializer.
         if( FTI_Conf.dcpFtiff ) {
@@ -186,7 +197,9 @@ int FTI_Init(const char* configFile, MPI_Comm globalComm)
             FTI_initMD5(FTI_Conf.dcpInfoPosix.BlockSize, 32*1024*1024, &FTI_Conf); 
         }
         if (FTI_Exec.reco) {
+            double tt = FTI_TraceStart();
             res = FTI_Try(FTI_RecoverFiles(&FTI_Conf, &FTI_Exec, &FTI_Topo, FTI_Ckpt), "recover the checkpoint files.");
+            FTI_TraceEvent(FTI_TRACE_RECOVERFILES, FTI_Exec.ckptLvel, tt, 0);
             if (FTI_Conf.ioMode == FTI_IO_FTIFF && res == FTI_SCES) {
                 res += FTI_Try( FTIFF_ReadDbFTIFF( &FTI_Conf, &FTI_Exec, FTI_Ckpt, FTI_Data ), "Read FTIFF meta information" );
             }
@@ -200,6 +213,13 @@ int FTI_Init(const char* configFile, MPI_Comm globalComm)
             }
             FTI_Exec.hasCkpt = (FTI_Exec.reco == 3) ? false : true;
             if(FTI_Exec.reco != 3) FTI_Try(FTI_LoadMetaDataset(&FTI_Conf, &FTI_Exec, &FTI_Topo, FTI_Ckpt, FTI_Data), "load dataset metadata");
+            // count the failure for the observed MTBF of the level
+            if (FTI_Conf.adaptiveIntv && FTI_Exec.reco != 3 && FTI_Exec.ckptLvel > 0 && FTI_Exec.ckptLvel < 5) {
+                FTI_Exec.failures[FTI_Exec.ckptLvel]++;
+                if (FTI_Topo.splitRank == 0) {
+                    FTI_Try(FTI_UpdateConf(&FTI_Conf, &FTI_Exec, FTI_Exec.reco), "update configuration file.");
+                }
+            }
         }
         FTI_Print("FTI has been initialized.", FTI_INFO);
         return FTI_SCES;
@@ -540,6 +560,41 @@ int FTI_GetStageStatus( int ID )
 
 }
 
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Returns progress of staging request in bytes.
+  @param      ID            ID of staging request.
+  @param      done          Bytes already staged [out].
+  @param      total         Size of the staged file [out].
+  @return     integer       Status of staging request on success, 
+  FTI_NSCS else.
+
+  Unlike 'FTI_GetStageStatus', this function does not free the stage
+  request ressources if the request is finished. The progress is 0 of 0
+  bytes as long as the request is pending.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_GetStageProgress( int ID, long* done, long* total )
+{
+
+    if ( !FTI_Conf.stagingEnabled ) {
+        FTI_Print( "'FTI_GetStageProgress' -> Staging disabled, no action performed.", FTI_WARN );
+        return FTI_NSCS;
+    }
+
+    if ( done == NULL || total == NULL ) {
+        FTI_Print( "'FTI_GetStageProgress' -> invalid argument (NULL).", FTI_WARN );
+        return FTI_NSCS;
+    }
+
+    if ( FTI_GetProgressField( &FTI_Exec, &FTI_Topo, ID, done, total, FTI_Topo.nodeRank ) != FTI_SCES ) {
+        return FTI_NSCS;
+    }
+
+    return FTI_GetStatusField( &FTI_Exec, &FTI_Topo, ID, FTI_SIF_VAL, FTI_Topo.nodeRank );
+
+}
+
 /*-------------------------------------------------------------------------*/
 /**
   @brief      Copies file asynchronously from 'lpath' to 'rpath'.
@@ -601,7 +656,79 @@ int FTI_SendFile( char* lpath, char *rpath )
 
     if ( FTI_Topo.nbHeads > 0 ) {
 
-        if ( FTI_AsyncStage( lpath, rpath, &FTI_Conf, &FTI_Exec, &FTI_Topo, ID ) != FTI_SCES ) {
+        if ( FTI_AsyncStage( lpath, rpath, FTI_SI_FILE, &FTI_Conf, &FTI_Exec, &FTI_Topo, ID ) != FTI_SCES ) {
+            FTI_Print("asynchronous staging failed!", FTI_WARN);
+            return FTI_NSCS;
+        }
+
+    }
+
+    return ID;
+
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Copies several files asynchronously into 'rdir'.
+  @param      lpattern        local directory or glob pattern.
+  @param      rdir            absolute path remote directory.
+  @return     integer         Request handle (ID) on success, FTI_NSCS else.
+
+  Stages all regular files of the directory 'lpattern', or the regular
+  files matching the glob pattern 'lpattern', with a single request.
+  Small files ('Advanced:stage_pack_file') are packed into tar archives
+  'Stage-Rank<r>-ID<id>-<n>.tar' of at most 'Advanced:stage_pack_size'
+  bytes, the larger files are copied to 'rdir' on their own. The files
+  are named by their path relative to the directory part of 'lpattern'.
+  The index 'Stage-Rank<r>-ID<id>.idx' lists for every file the name,
+  the remote file holding the data, the data offset in it and the size,
+  one file per line as '<len>:<name> <len>:<object> <offset> <size>'.
+
+  @par
+  The status of the request is set when all the files are staged and
+  is queried with 'FTI_GetStageStatus' and 'FTI_GetStageProgress' like
+  for 'FTI_SendFile'. As for 'FTI_SendFile', the local files are removed
+  by the synchronous staging (no head process) only.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_SendFiles( char* lpattern, char *rdir )
+{ 
+
+    if ( !FTI_Conf.stagingEnabled ) {
+        FTI_Print( "'FTI_SendFiles' -> Staging disabled, no action performed.", FTI_WARN );
+        return FTI_NSCS;
+    }
+
+    if ( lpattern == NULL ){
+        FTI_Print( "local pattern field is NULL!", FTI_WARN );
+        return FTI_NSCS;
+    }
+
+    if ( rdir == NULL ){
+        FTI_Print( "remote directory field is NULL!", FTI_WARN );
+        return FTI_NSCS;
+    }
+
+    int ID = FTI_GetRequestID( &FTI_Exec, &FTI_Topo );
+    if (ID < 0) {
+        FTI_Print("Too many stage requests!", FTI_WARN);
+        return FTI_NSCS;
+    }
+
+    FTI_InitStageRequestApp( &FTI_Exec, &FTI_Topo, ID );
+
+    if ( FTI_Topo.nbHeads == 0 ) {
+
+        if ( FTI_SyncStageFiles( lpattern, rdir, &FTI_Exec, &FTI_Topo, &FTI_Conf, ID ) != FTI_SCES ) {
+            FTI_Print("synchronous staging failed!", FTI_WARN);
+            return FTI_NSCS;
+        }
+
+    }
+
+    if ( FTI_Topo.nbHeads > 0 ) {
+
+        if ( FTI_AsyncStage( lpattern, rdir, FTI_SI_BATCH, &FTI_Conf, &FTI_Exec, &FTI_Topo, ID ) != FTI_SCES ) {
             FTI_Print("asynchronous staging failed!", FTI_WARN);
             return FTI_NSCS;
         }
@@ -627,6 +754,9 @@ int FTI_SendFile( char* lpath, char *rpath )
 /*-------------------------------------------------------------------------*/
 int FTI_InitGroup(FTIT_H5Group* h5group, char* name, FTIT_H5Group* parent)
 {
+#ifdef ENABLE_HDF5
+    FTI_WaitVPR();
+#endif
     if (parent == NULL) {
         //child of root
         parent = FTI_Exec.H5groups[0];
@@ -686,18 +816,19 @@ int FTI_setIDFromString( char *name )
     }
 
     for ( i = 0 ; i < FTI_Exec.nbVar; i++){
-        if (strcmp(name, data[i].idChar) == 0){
+        if (strcmp(name, data[i].attr->idChar) == 0){
             return data[i].id;
         }
     }
 
     // initialize blank dataset
-    FTIT_dataset dataAdd; FTI_InitDataset( &FTI_Exec, &dataAdd, i );
+    FTIT_dataset dataAdd; FTIT_datasetAttr attrAdd;
+    FTI_InitDataset( &FTI_Exec, &dataAdd, &attrAdd, i );
     
     // set id to i+1 and assign name
-    strncpy(dataAdd.idChar, name, FTI_BUFS);
+    strncpy(dataAdd.attr->idChar, name, FTI_BUFS);
     
-    FTI_Data->push_back( &dataAdd, i );
+    FTI_AppendDataset( FTI_Data, &dataAdd, i );
     FTI_Exec.nbVar++;
     
     return i;
@@ -728,7 +859,7 @@ int FTI_getIDFromString( char *name )
     }
 
     int i=0; for (; i < n; i++){
-        if (strcmp(name, data[i].idChar) == 0){
+        if (strcmp(name, data[i].attr->idChar) == 0){
             return data[i].id;
         }
 
@@ -779,6 +910,9 @@ int FTI_Protect(int id, void* ptr, long count, FTIT_type type)
         FTI_Print("FTI is not initialized.", FTI_WARN);
         return FTI_NSCS;
     }
+#ifdef ENABLE_HDF5
+    FTI_WaitVPR();
+#endif
 
     char str[5*FTI_BUFS]; //For console output
 
@@ -834,13 +968,13 @@ int FTI_Protect(int id, void* ptr, long count, FTIT_type type)
         data->type = FTI_Exec.FTI_Type[type.id];
         data->eleSize = type.size;
         data->size = type.size * count;
-        data->dimLength[0] = count;
+        data->attr->dimLength[0] = count;
         FTI_Exec.ckptSize = FTI_Exec.ckptSize + ((type.size * count) - prevSize);
-        if ( strlen(data->idChar) == 0 ){ 
+        if ( strlen(data->attr->idChar) == 0 ){ 
             sprintf(str, "Variable ID %d reseted. (Stored In %s).  Current ckpt. size per rank is %.2fMB.", id, memLocation, (float) FTI_Exec.ckptSize / (1024.0 * 1024.0));
         }
         else{
-            sprintf(str, "Variable Named %s with ID %d to protect (Stored in %s). Current ckpt. size per rank is %.2fMB.",data->idChar, id, memLocation, (float) FTI_Exec.ckptSize / (1024.0 * 1024.0));
+            sprintf(str, "Variable Named %s with ID %d to protect (Stored in %s). Current ckpt. size per rank is %.2fMB.",data->attr->idChar, id, memLocation, (float) FTI_Exec.ckptSize / (1024.0 * 1024.0));
         }
 
         FTI_Print(str, FTI_DBUG);
@@ -869,7 +1003,7 @@ int FTI_Protect(int id, void* ptr, long count, FTIT_type type)
 #endif
         }
         if( data->recovered ) {
-            if ( strlen(data->idChar) == 0 ){ 
+            if ( strlen(data->attr->idChar) == 0 ){ 
                 sprintf(str, "Variable ID %d to protect (Stored in %s). Current ckpt. size per rank is %.2fMB.", 
                         id, 
                         memLocation, 
@@ -877,7 +1011,7 @@ int FTI_Protect(int id, void* ptr, long count, FTIT_type type)
             }
             else{
                 sprintf(str, "Variable Named %s with ID %d to protect (Stored in %s). Current ckpt. size per rank is %.2fMB.",
-                        data->idChar, 
+                        data->attr->idChar, 
                         id, memLocation, 
                         (float) FTI_Exec.ckptSize / (1024.0 * 1024.0));
             }
@@ -889,7 +1023,10 @@ int FTI_Protect(int id, void* ptr, long count, FTIT_type type)
     }
     //Id could not be found in datasets
 
-    data = calloc( 1, sizeof(FTIT_dataset) );
+    FTIT_dataset dataNew = {0};
+    FTIT_datasetAttr attrNew = {0};
+    data = &dataNew;
+    data->attr = &attrNew;
 
     //Adding new variable to protect
     data->id = id;
@@ -924,9 +1061,9 @@ int FTI_Protect(int id, void* ptr, long count, FTIT_type type)
     data->eleSize = type.size;
     data->size = type.size * count;
     data->rank = 1;
-    data->dimLength[0] = data->count;
+    data->attr->dimLength[0] = data->count;
     data->h5group = FTI_Exec.H5groups[0];
-    sprintf(data->name, "Dataset_%d", id);
+    sprintf(data->attr->name, "Dataset_%d", id);
     FTI_Exec.ckptSize = FTI_Exec.ckptSize + (type.size * count);
 
     if ( FTI_Conf.dcpPosix ){
@@ -949,17 +1086,17 @@ int FTI_Protect(int id, void* ptr, long count, FTIT_type type)
     }
 
     // append dataset to protected variables
-    if( FTI_Data->push_back( data, id ) != FTI_SCES ) {
+    if( FTI_AppendDataset( FTI_Data, data, id ) != FTI_SCES ) {
         snprintf( str, FTI_BUFS, "failed to append variable with id = '%d' to protected variable map.", id );
         FTI_Print(str, FTI_EROR);
         return FTI_NSCS;
     }
 
-    if ( strlen(data->idChar) == 0 ){ 
+    if ( strlen(data->attr->idChar) == 0 ){ 
         sprintf(str, "Variable ID %d to protect (Stored in %s). Current ckpt. size per rank is %.2fMB.", id, memLocation, (float) FTI_Exec.ckptSize / (1024.0 * 1024.0));
     }
     else{
-        sprintf(str, "Variable Named %s with ID %d to protect (Stored in %s). Current ckpt. size per rank is %.2fMB.",data->idChar, id, memLocation, (float) FTI_Exec.ckptSize / (1024.0 * 1024.0));
+        sprintf(str, "Variable Named %s with ID %d to protect (Stored in %s). Current ckpt. size per rank is %.2fMB.",data->attr->idChar, id, memLocation, (float) FTI_Exec.ckptSize / (1024.0 * 1024.0));
     }
 
     FTI_Exec.nbVar = FTI_Exec.nbVar + 1;
@@ -990,6 +1127,8 @@ int FTI_Protect(int id, void* ptr, long count, FTIT_type type)
 int FTI_DefineGlobalDataset(int id, int rank, FTIT_hsize_t* dimLength, const char* name, FTIT_H5Group* h5group, FTIT_type type)
 {
 #ifdef ENABLE_HDF5
+    FTI_WaitVPR();
+
     FTIT_globalDataset* last = FTI_Exec.globalDatasets;
 
     if ( last ) {
@@ -1061,6 +1200,7 @@ int FTI_DefineGlobalDataset(int id, int rank, FTIT_hsize_t* dimLength, const cha
 int FTI_AddSubset( int id, int rank, FTIT_hsize_t* offset, FTIT_hsize_t* count, int did )
 {
 #ifdef ENABLE_HDF5
+    FTI_WaitVPR();
 
     FTIT_dataset* data;
     if( FTI_Data->get( &data, id ) != FTI_SCES ) {
@@ -1132,6 +1272,8 @@ int FTI_AddSubset( int id, int rank, FTIT_hsize_t* offset, FTIT_hsize_t* count,
 int FTI_UpdateGlobalDataset(int id, int rank, FTIT_hsize_t* dimLength )
 {
 #ifdef ENABLE_HDF5
+    FTI_WaitVPR();
+
     FTIT_globalDataset* dataset = FTI_Exec.globalDatasets;
 
     if ( !dataset ) {
@@ -1182,6 +1324,7 @@ int FTI_UpdateGlobalDataset(int id, int rank, FTIT_hsize_t* dimLength )
 int FTI_UpdateSubset( int id, int rank, FTIT_hsize_t* offset, FTIT_hsize_t* count, int did )
 {
 #ifdef ENABLE_HDF5
+    FTI_WaitVPR();
 
     FTIT_dataset* data;
     if( FTI_Data->get( &data, id ) != FTI_SCES ) {
@@ -1410,6 +1553,9 @@ int FTI_DefineDataset(int id, int rank, int* dimLength, char* name, FTIT_H5Group
         FTI_Print("FTI is not initialized.", FTI_WARN);
         return FTI_NSCS;
     }
+#ifdef ENABLE_HDF5
+    FTI_WaitVPR();
+#endif
 
     if (rank > 0 && dimLength == NULL) {
         FTI_Print("If rank > 0, the dimLength cannot be NULL.", FTI_WARN);
@@ -1449,7 +1595,7 @@ int FTI_DefineDataset(int id, int rank, int* dimLength, char* name, FTIT_H5Group
         }
         data->rank = rank;
         for (j = 0; j < rank; j++) {
-            data->dimLength[j] = dimLength[j];
+            data->attr->dimLength[j] = dimLength[j];
         }
     }
 
@@ -1458,8 +1604,8 @@ int FTI_DefineDataset(int id, int rank, int* dimLength, char* name, FTIT_H5Group
     }
 
     if (name != NULL) {
-        memset(data->name,'\0',FTI_BUFS);
-        strncpy(data->name, name, FTI_BUFS);
+        memset(data->attr->name,'\0',FTI_BUFS);
+        strncpy(data->attr->name, name, FTI_BUFS);
     }
 
     return FTI_SCES;
@@ -1646,6 +1792,9 @@ int FTI_BitFlip(int id)
   offline. Then, it updates the ckpt. information. It writes down the ckpt.
   data, creates the metadata and the post-processing work. This function
   is complementary with the FTI_Listen function in terms of communications.
+  With 'h5_single_file_async', a VPR checkpoint returns once the data is
+  copied: the file is renamed to its final name when all ranks wrote it,
+  a failure is reported by the next call waiting for the writer.
 
  **/
 /*-------------------------------------------------------------------------*/
@@ -1658,6 +1807,9 @@ int FTI_Checkpoint(int id, int level)
         FTI_Print("FTI is not initialized.", FTI_WARN);
         return FTI_NSCS;
     }
+#ifdef ENABLE_HDF5
+    FTI_WaitVPR();
+#endif
 
     if ((level < FTI_MIN_LEVEL_ID) || (level > FTI_MAX_LEVEL_ID)) {
         FTI_Print("Invalid level id! Aborting checkpoint creation...", FTI_WARN);
@@ -1693,6 +1845,7 @@ int FTI_Checkpoint(int id, int level)
     }
 
     double t0 = MPI_Wtime(); //Start time
+    double tt = FTI_TraceStart();
     if (FTI_Exec.wasLastOffline == 1) { // Block until previous checkpoint is done (Async. work)
         int lastLevel;
         MPI_Recv(&lastLevel, 1, MPI_INT, FTI_Topo.headRank, FTI_Conf.generalTag, FTI_Exec.globalComm, MPI_STATUS_IGNORE);
@@ -1706,8 +1859,12 @@ int FTI_Checkpoint(int id, int level)
     }
 
     t1 = MPI_Wtime(); //Time after waiting for head to done previous post-processing
+    FTI_TraceCkpt(FTI_Exec.ckptId, level);
+    FTI_TraceEvent(FTI_TRACE_WAIT, -1, tt, 0);
     FTI_Exec.ckptMeta.level = level; // assign to temporary metadata
+    double tw = FTI_TraceStart();
     int res = FTI_Try(FTI_WriteCkpt(&FTI_Conf, &FTI_Exec, &FTI_Topo, FTI_Ckpt, FTI_Data), "write the checkpoint.");
+    FTI_TraceEvent(FTI_TRACE_WRITECKPT, -1, tw, FTI_Exec.ckptSize);
     t2 = MPI_Wtime(); //Time after writing checkpoint
 
     // no postprocessing or meta data for h5 single file
@@ -1715,6 +1872,13 @@ int FTI_Checkpoint(int id, int level)
         char str[FTI_BUFS];
         sprintf( str, "Ckpt. ID %d (Variate Processor Recovery File) (%.2f MB/proc) taken in %.2f sec.",
                 FTI_Exec.ckptId, FTI_Exec.ckptSize / (1024.0 * 1024.0), t2 - t1 );
+#ifdef ENABLE_HDF5
+        // the file is only valid once the writer renamed it (FTI_WaitVPR)
+        if( FTI_PendingVPR() ) {
+            sprintf( str, "Ckpt. ID %d (Variate Processor Recovery File) (%.2f MB/proc) snapshot taken in %.2f sec., written in the background.",
+                    FTI_Exec.ckptId, FTI_Exec.ckptSize / (1024.0 * 1024.0), t2 - t1 );
+        }
+#endif
         FTI_Print(str, FTI_INFO);
         return FTI_SCES;
     }
@@ -1757,6 +1921,11 @@ int FTI_Checkpoint(int id, int level)
     sprintf(str, "Ckpt. ID %d (L%d) (%.2f MB/proc) taken in %.2f sec. (Wt:%.2fs, Wr:%.2fs, Ps:%.2fs)",
             FTI_Exec.ckptId, FTI_Exec.ckptMeta.level, FTI_Exec.ckptSize / (1024.0 * 1024.0), t3 - t0, t1 - t0, t2 - t1, t3 - t2);
     FTI_Print(str, FTI_INFO);
+    FTI_TraceEvent(FTI_TRACE_CKPT, -1, tt, FTI_Exec.ckptSize);
+
+    if (FTI_Conf.adaptiveIntv) {
+        FTI_AdaptCkptIntv(&FTI_Conf, &FTI_Exec, FTI_Ckpt, FTI_Exec.ckptMeta.level, t3 - t0);
+    }
 
     if ( (FTI_Conf.dcpFtiff || FTI_Conf.dcpPosix) && FTI_Ckpt[4].isDcp ) {
         FTI_PrintDcpStats( FTI_Conf, FTI_Exec, FTI_Topo );   
@@ -1807,6 +1976,9 @@ int FTI_InitICP(int id, int level, bool activate)
         FTI_Print("FTI is not initialized.", FTI_WARN);
         return FTI_NSCS;
     }
+#ifdef ENABLE_HDF5
+    FTI_WaitVPR();
+#endif
 
     // only step in if activate TRUE.
     if ( !activate ) {
@@ -1819,7 +1991,8 @@ int FTI_InitICP(int id, int level, bool activate)
     // reset iCP meta info (i.e. set counter to zero etc.)
     memset( &(FTI_Exec.iCPInfo), 0x0, sizeof(FTIT_iCPInfo) );
 
-    FTI_Exec.iCPInfo.isWritten = (bool*) calloc( FTI_Conf.maxVarId, sizeof(bool) );
+    FTI_Exec.iCPInfo.nbFlags = FTI_Exec.nbVar;
+    FTI_Exec.iCPInfo.isWritten = (bool*) calloc( FTI_Exec.nbVar + 1, sizeof(bool) );
 
     // init iCP status with failure
     FTI_Exec.iCPInfo.status = FTI_ICP_FAIL;
@@ -1864,6 +2037,7 @@ int FTI_InitICP(int id, int level, bool activate)
     }
 
     FTI_Exec.iCPInfo.t0 = MPI_Wtime(); //Start time
+    FTI_Exec.iCPInfo.tTrace = FTI_TraceStart();
     if (FTI_Exec.wasLastOffline == 1) { // Block until previous checkpoint is done (Async. work)
         int lastLevel;
         MPI_Recv(&lastLevel, 1, MPI_INT, FTI_Topo.headRank, FTI_Conf.generalTag, FTI_Exec.globalComm, MPI_STATUS_IGNORE);
@@ -1877,6 +2051,8 @@ int FTI_InitICP(int id, int level, bool activate)
     }
 
     FTI_Exec.iCPInfo.t1 = MPI_Wtime(); //Time after waiting for head to done previous post-processing
+    FTI_TraceCkpt(FTI_Exec.ckptId, level);
+    FTI_TraceEvent(FTI_TRACE_WAIT, -1, FTI_Exec.iCPInfo.tTrace, 0);
     FTI_Exec.ckptMeta.level = level; //For FTI_WriteCkpt
 
     // Name of the  CKPT file.
@@ -1919,7 +2095,9 @@ int FTI_InitICP(int id, int level, bool activate)
   With this function, the user may write the protected datasets in any
   order into the checkpoint file. However, before the call to
   FTI_FinalizeICP, all protected variables must have been written into
-  the file.
+  the file. If 'Advanced:icp_async_buffer' is set, the dataset may be
+  copied and written in the background, and the user may modify it as
+  soon as this function returns.
  **/
 /*-------------------------------------------------------------------------*/
 int FTI_AddVarICP( int varID ) 
@@ -1946,13 +2124,22 @@ int FTI_AddVarICP( int varID )
         return FTI_NSCS;
     }
 
-    // check if dataset was not already written.
-    int i=0; for(; i<FTI_Exec.iCPInfo.countVar; ++i) {
-        if(FTI_Exec.iCPInfo.isWritten[varID]) {
-            snprintf( str, FTI_BUFS, "Dataset with ID: %d was already successfully written!", varID );
-            FTI_Print(str, FTI_WARN);
-            return FTI_NSCS;
-        }
+    // check if dataset was not already written (flags are indexed by the
+    // location of the dataset in the keymap).
+    FTIT_dataset* first;
+    if( FTI_Data->data( &first, FTI_Exec.nbVar ) != FTI_SCES ) {
+        return FTI_NSCS;
+    }
+    long pos = data - first;
+    if( pos >= FTI_Exec.iCPInfo.nbFlags ) {
+        snprintf( str, FTI_BUFS, "FTI_AddVarICP: dataset ID: %d was protected after FTI_InitICP!", varID );
+        FTI_Print(str, FTI_WARN);
+        return FTI_NSCS;
+    }
+    if(FTI_Exec.iCPInfo.isWritten[pos]) {
+        snprintf( str, FTI_BUFS, "Dataset with ID: %d was already successfully written!", varID );
+        FTI_Print(str, FTI_WARN);
+        return FTI_NSCS;
     }
 
     int res;
@@ -1961,7 +2148,7 @@ int FTI_AddVarICP( int varID )
     res=FTI_Exec.writeVarICPFunc[funcID](varID, &FTI_Conf, &FTI_Exec, &FTI_Topo, FTI_Ckpt, FTI_Data,&ftiIO[funcID+offset]);
 
     if ( res == FTI_SCES ) {
-        FTI_Exec.iCPInfo.isWritten[varID] = true;
+        FTI_Exec.iCPInfo.isWritten[pos] = true;
         FTI_Exec.iCPInfo.countVar++;
     }
     else{
@@ -1979,6 +2166,7 @@ int FTI_AddVarICP( int varID )
   This function finalizes an incremental checkpoint. In contrast to
   InitICP, this function is collective on the communicator
   FTI_COMM_WORLD and blocking.
+  It first waits for the datasets queued by FTI_AddVarICP.
  **/
 /*-------------------------------------------------------------------------*/
 int FTI_FinalizeICP() 
@@ -1993,6 +2181,9 @@ int FTI_FinalizeICP()
         return FTI_SCES;
     }
 
+    // datasets queued for the iCP writer
+    FTI_WaitICP(&FTI_Exec, FTI_Data);
+
     int allRes[2];
     int locRes[2] = { (int)(FTI_Exec.iCPInfo.result==FTI_SCES), (int)(FTI_Exec.iCPInfo.countVar==FTI_Exec.nbVar) };
     //Check if all processes have written all the datasets failure free.
@@ -2024,7 +2215,9 @@ int FTI_FinalizeICP()
     }
 
     if( resCP == FTI_SCES ) {
+        double tm = FTI_TraceStart();
         resCP = FTI_Try(FTI_CreateMetadata(&FTI_Conf, &FTI_Exec, &FTI_Topo, FTI_Ckpt, FTI_Data), "create metadata.");
+        FTI_TraceEvent(FTI_TRACE_META, -1, tm, 0);
     }
 
     if ( resCP != FTI_SCES ) {
@@ -2084,11 +2277,16 @@ int FTI_FinalizeICP()
         sprintf(str, "Ckpt. ID %d (L%d) (%.2f MB/proc) taken in %.2f sec. (Wt:%.2fs, Wr:%.2fs, Ps:%.2fs)",
                 FTI_Exec.ckptId, FTI_Exec.ckptMeta.level, FTI_Exec.ckptSize / (1024.0 * 1024.0), t3 - FTI_Exec.iCPInfo.t0, FTI_Exec.iCPInfo.t1 - FTI_Exec.iCPInfo.t0, t2 - FTI_Exec.iCPInfo.t1, t3 - t2);
         FTI_Print(str, FTI_INFO);
+        FTI_TraceEvent(FTI_TRACE_CKPT, -1, FTI_Exec.iCPInfo.tTrace, FTI_Exec.ckptSize);
 
         if ( (FTI_Conf.dcpFtiff||FTI_Conf.dcpPosix) && FTI_Ckpt[4].isDcp ) {
             FTI_PrintDcpStats( FTI_Conf, FTI_Exec, FTI_Topo );
         }
 
+        if (FTI_Conf.adaptiveIntv) {
+            FTI_AdaptCkptIntv(&FTI_Conf, &FTI_Exec, FTI_Ckpt, FTI_Exec.ckptMeta.level, t3 - FTI_Exec.iCPInfo.t0);
+        }
+
         if (FTI_Exec.iCPInfo.isFirstCp && FTI_Topo.splitRank == 0) {
             //Setting recover flag to 1 (to recover from current ckpt level)
             FTI_Try(FTI_UpdateConf(&FTI_Conf, &FTI_Exec, 1), "update configuration file.");
@@ -2135,8 +2333,10 @@ int FTI_FinalizeICP()
 /*-------------------------------------------------------------------------*/
 int FTI_Recover()
 {
+    double tt = FTI_TraceStart();
     if ( FTI_Conf.ioMode == FTI_IO_FTIFF ) {
         int ret = FTI_Try(FTIFF_Recover( &FTI_Exec, FTI_Data, FTI_Ckpt ), "Recovering from Checkpoint");
+        FTI_TraceEvent(FTI_TRACE_RECOVER, -1, tt, FTI_Exec.ckptSize);
         return ret;
     }
 
@@ -2144,6 +2344,9 @@ int FTI_Recover()
         FTI_Print("FTI is not initialized.", FTI_WARN);
         return FTI_NREC;
     }
+#ifdef ENABLE_HDF5
+    FTI_WaitVPR();
+#endif
     if (FTI_Exec.initSCES == 2) {
         FTI_Print("No checkpoint files to make recovery.", FTI_WARN);
         return FTI_NREC;
@@ -2218,6 +2421,7 @@ int FTI_Recover()
 #ifdef ENABLE_HDF5 //If HDF5 is installed
     if (FTI_Conf.ioMode == FTI_IO_HDF5) {
         int ret = FTI_RecoverHDF5(&FTI_Conf, &FTI_Exec, FTI_Ckpt, FTI_Data);
+        FTI_TraceEvent(FTI_TRACE_RECOVER, -1, tt, FTI_Exec.ckptSize);
         return ret; 
     }
 #endif
@@ -2225,7 +2429,9 @@ int FTI_Recover()
     //Recovering from local for L4 case in FTI_Recover
     if (FTI_Exec.ckptLvel == 4) {
         if( FTI_Ckpt[4].recoIsDcp && FTI_Conf.dcpPosix ) {
-            return FTI_RecoverDcpPosix(&FTI_Conf, &FTI_Exec, FTI_Ckpt, FTI_Data);
+            int ret = FTI_RecoverDcpPosix(&FTI_Conf, &FTI_Exec, FTI_Ckpt, FTI_Data);
+            FTI_TraceEvent(FTI_TRACE_RECOVER, -1, tt, FTI_Exec.ckptSize);
+            return ret;
         } else {
             //Try from L1
             snprintf(fn, FTI_BUFS, "%s/Ckpt%d-Rank%d.%s", FTI_Ckpt[1].dir, FTI_Exec.ckptId, FTI_Topo.myRank, FTI_Conf.suffix);
@@ -2291,6 +2497,7 @@ int FTI_Recover()
     }      
 
     FTI_Exec.reco = 0;
+    FTI_TraceEvent(FTI_TRACE_RECOVER, -1, tt, FTI_Exec.ckptSize);
 
     return FTI_SCES;
 }
@@ -2342,7 +2549,13 @@ int FTI_Snapshot()
                     // counts the passed intervall times (if taken or not...)
                     FTI_Ckpt[i].ckptDcpCnt++;
                 }
-                if ( (FTI_Ckpt[i].ckptIntv) > 0 
+                if ( FTI_Conf.adaptiveIntv ) {
+                    // due minute restarted by FTI_AdaptCkptIntv
+                    if ( (FTI_Ckpt[i].ckptIntv > 0) && (FTI_Exec.minuteCnt >= FTI_Ckpt[i].ckptDue) ) {
+                        level = i;
+                    }
+                }
+                else if ( (FTI_Ckpt[i].ckptIntv) > 0 
                         && (FTI_Exec.minuteCnt/(FTI_Ckpt[i].ckptCnt*FTI_Ckpt[i].ckptIntv)) ) {
                     level = i;
                     // counts the passed intervall times (if taken or not...)
@@ -2380,13 +2593,26 @@ int FTI_Finalize()
         FTI_Print("FTI is not initialized.", FTI_WARN);
         return FTI_NSCS;
     }
+#ifdef ENABLE_HDF5
+    FTI_WaitVPR();
+#endif
 
     if (FTI_Topo.amIaHead) {
         if ( FTI_Conf.stagingEnabled ) {
             FTI_FinalizeStage( &FTI_Exec, &FTI_Topo, &FTI_Conf );
         }
+        if ( FTI_Conf.shmHandoff ) {
+            FTI_HandoffCleanup( &FTI_Exec );
+        }
+        // the application processes clean up after the deletions
+        FTI_FinalizeReclaim();
+        if ( FTI_Conf.reclaimThreads > 0 ) {
+            MPI_Barrier(FTI_Exec.globalComm);
+        }
+        FTI_TraceFinalize(&FTI_Conf, &FTI_Exec, &FTI_Topo);
         MPI_Barrier(FTI_Exec.globalComm);
         FTI_Data->clear();
+        FTI_FreeDatasetAttr();
         if ( !FTI_Conf.keepHeadsAlive ) { 
             MPI_Finalize();
             exit(0);
@@ -2397,6 +2623,11 @@ int FTI_Finalize()
 
     // Notice: The following code is only executed by the application procs
 
+    // complete the last iteration time reduction of FTI_UpdateIterTime
+    if (FTI_Exec.iterSyncReq != MPI_REQUEST_NULL) {
+        MPI_Wait(&FTI_Exec.iterSyncReq, MPI_STATUS_IGNORE);
+    }
+
     FTIT_dataset* data;
     if( FTI_Data->data( &data, FTI_Exec.nbVar ) != FTI_SCES ) {
         FTI_Print( "failed to finalize FTI", FTI_WARN );
@@ -2435,10 +2666,13 @@ int FTI_Finalize()
     }
 
     // Send notice to the head to stop listening
-    if (FTI_Topo.nbHeads == 1) {
+    if (FTI_Topo.nbHeads > 0) {
         int value = FTI_ENDW;
         MPI_Send(&value, 1, MPI_INT, FTI_Topo.headRank, FTI_Conf.finalTag, FTI_Exec.globalComm);
     }
+    if (FTI_Conf.headThread) {
+        FTI_FinalizeHelper();
+    }
 
     // for staging, we have to ensure, that the call to FTI_Clean 
     // comes after the heads have written all the staging files.
@@ -2447,6 +2681,12 @@ int FTI_Finalize()
         FTI_FinalizeStage( &FTI_Exec, &FTI_Topo, &FTI_Conf );
     }
 
+    // the final clean up needs the old checkpoints deleted, also by the heads
+    FTI_FinalizeReclaim();
+    if ( FTI_Conf.reclaimThreads > 0 && FTI_Topo.nbHeads > 0 ) {
+        MPI_Barrier(FTI_Exec.globalComm);
+    }
+
     // If we need to keep the last checkpoint and there was a checkpoint
     if ( FTI_Conf.saveLastCkpt && FTI_Exec.hasCkpt ) {
         //if ((FTI_Conf.saveLastCkpt || FTI_Conf.keepL4Ckpt) && FTI_Exec.ckptId > 0) {
@@ -2503,12 +2743,17 @@ int FTI_Finalize()
     if( FTI_Conf.ioMode == FTI_IO_FTIFF ) {
         FTIFF_FreeDbFTIFF(FTI_Exec.lastdb);
     }
+    if( FTI_Conf.ioMode == FTI_IO_MPI ) {
+        FTI_FreeMPIOView();
+    }
 #ifdef ENABLE_HDF5
     if( FTI_Conf.h5SingleFileEnable ) {
         FTI_FreeVPRMem( &FTI_Exec, FTI_Data ); 
     }
 #endif
     FTI_Data->clear();
+    FTI_FreeDatasetAttr();
+    FTI_TraceFinalize(&FTI_Conf, &FTI_Exec, &FTI_Topo);
     MPI_Barrier(FTI_Exec.globalComm);
     FTI_Print("FTI has been finalized.", FTI_INFO);
     return FTI_SCES;
@@ -2538,6 +2783,9 @@ int FTI_RecoverVar(int id)
         FTI_Print("FTI is not initialized.", FTI_WARN);
         return FTI_NSCS;
     }
+#ifdef ENABLE_HDF5
+    FTI_WaitVPR();
+#endif
 
     if(FTI_Exec.reco==0){
         /* This is not a restart: no actions performed */
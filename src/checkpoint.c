@@ -42,6 +42,7 @@
 
 #include "interface.h"
 #include <math.h>
+#include <time.h>
 
 /*-------------------------------------------------------------------------*/
 /**
@@ -53,6 +54,11 @@
   recomputes the checkpoint interval in iterations and corrects the next
   checkpointing iteration based on the observed mean iteration duration.
 
+  The global mean is reduced without blocking: the reduction started at
+  one synchronization point is completed, and applied, at the next one.
+  All ranks reach the synchronization points at the same iterations, so
+  they still take the same checkpoint decisions.
+
  **/
 /*-------------------------------------------------------------------------*/
 
@@ -68,10 +74,20 @@ int FTI_UpdateIterTime(FTIT_execution* FTI_Exec)
         FTI_Exec->lastIterTime = FTI_Exec->iterTime - last;
         FTI_Exec->totalIterTime = FTI_Exec->totalIterTime + FTI_Exec->lastIterTime;
         if (FTI_Exec->ckptIcnt % FTI_Exec->syncIter == 0) {
+            bool update = (FTI_Exec->iterSyncReq != MPI_REQUEST_NULL);
+            if (update) {
+                // started at the previous synchronization point
+                MPI_Wait(&FTI_Exec->iterSyncReq, MPI_STATUS_IGNORE);
+                MPI_Comm_size(FTI_COMM_WORLD, &nbProcs);
+                FTI_Exec->globMeanIter = FTI_Exec->iterSyncSum / nbProcs;
+            }
             FTI_Exec->meanIterTime = FTI_Exec->totalIterTime / FTI_Exec->ckptIcnt;
-            MPI_Allreduce(&FTI_Exec->meanIterTime, &FTI_Exec->globMeanIter, 1, MPI_DOUBLE, MPI_SUM, FTI_COMM_WORLD);
-            MPI_Comm_size(FTI_COMM_WORLD, &nbProcs);
-            FTI_Exec->globMeanIter = FTI_Exec->globMeanIter / nbProcs;
+            MPI_Iallreduce(&FTI_Exec->meanIterTime, &FTI_Exec->iterSyncSum, 1, MPI_DOUBLE, MPI_SUM,
+                    FTI_COMM_WORLD, &FTI_Exec->iterSyncReq);
+            if (!update) {
+                FTI_Exec->ckptIcnt++; // Increment checkpoint loop counter
+                return FTI_SCES;
+            }
             if (FTI_Exec->globMeanIter > 60) {
                 FTI_Exec->ckptIntv = 1;
             }
@@ -82,9 +98,12 @@ int FTI_UpdateIterTime(FTIT_execution* FTI_Exec)
             if (FTI_Exec->ckptLast == 0) {
                 res = res + 1;
             }
-            if (res >= FTI_Exec->ckptIcnt) {
-                FTI_Exec->ckptNext = res;
+            // the mean is one synchronization interval old, do not
+            // schedule the next check in the past
+            if (res <= FTI_Exec->ckptIcnt) {
+                res = FTI_Exec->ckptIcnt + 1;
             }
+            FTI_Exec->ckptNext = res;
             snprintf(str, FTI_BUFS, "Current iter : %d ckpt intv. : %d . Next ckpt. at iter. %d . Sync. intv. : %d",
                     FTI_Exec->ckptIcnt, FTI_Exec->ckptIntv, FTI_Exec->ckptNext, FTI_Exec->syncIter);
             FTI_Print(str, FTI_DBUG);
@@ -105,6 +124,96 @@ int FTI_UpdateIterTime(FTIT_execution* FTI_Exec)
     return FTI_SCES;
 }
 
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Checkpoint interval that minimizes the lost time (Daly).
+  @param      cost            Time to take one checkpoint (sec.).
+  @param      mtbf            Mean time between failures (sec.).
+  @return     double          Optimal checkpoint interval (sec.).
+
+  Higher order estimate of Daly, which reduces to Young's sqrt(2*C*M) for
+  a small checkpoint cost. If a checkpoint takes more than twice the MTBF,
+  checkpointing once per MTBF is the best one can do.
+
+ **/
+/*-------------------------------------------------------------------------*/
+double FTI_DalyInterval(double cost, double mtbf)
+{
+    if (cost >= 2 * mtbf) {
+        return mtbf;
+    }
+    double r = cost / (2 * mtbf);
+    return sqrt(2 * cost * mtbf) * (1 + sqrt(r) / 3 + r / 9) - cost;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Adapts the checkpoint intervals after a checkpoint.
+  @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Exec        Execution metadata.
+  @param      FTI_Ckpt        Checkpoint metadata.
+  @param      level           Level of the checkpoint just taken.
+  @param      cost            Time the checkpoint took on this rank (sec.).
+  @return     integer         FTI_SCES if successful.
+
+  The cost of a level is the time of the slowest rank (waiting for the
+  previous post-processing, writing and post-processing), averaged with
+  the previous checkpoints of the level. The MTBF of a level is the one
+  configured ('Basic:mtbf_lx'), or else the run time of the execution
+  over the number of failures recovered from that level so far. Levels
+  with a known cost and MTBF get the interval of FTI_DalyInterval, in
+  minutes; the others keep the configured one. A checkpoint also protects
+  against the failures of the lower levels, so it restarts their
+  intervals as well. All ranks compute the same intervals.
+
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_AdaptCkptIntv(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
+        FTIT_checkpoint* FTI_Ckpt, int level, double cost)
+{
+    char str[FTI_BUFS];
+    double maxCost;
+    int i;
+
+    MPI_Allreduce(&cost, &maxCost, 1, MPI_DOUBLE, MPI_MAX, FTI_COMM_WORLD);
+    if (FTI_Ckpt[level].ckptCost > 0) {
+        FTI_Ckpt[level].ckptCost = 0.5 * (FTI_Ckpt[level].ckptCost + maxCost);
+    } else {
+        FTI_Ckpt[level].ckptCost = maxCost;
+    }
+
+    double upTime = FTI_Exec->upTime + MPI_Wtime() - FTI_Exec->initTime;
+    for (i = 1; i < 5; i++) {
+        if (FTI_Ckpt[i].ckptIntv <= 0 || FTI_Ckpt[i].ckptCost <= 0) {
+            continue;
+        }
+        double mtbf = FTI_Ckpt[i].mtbf;
+        if (mtbf <= 0 && FTI_Exec->failures[i] > 0) {
+            mtbf = upTime / FTI_Exec->failures[i];
+        }
+        if (mtbf <= 0) {
+            continue;
+        }
+        int intv = (int)rint(FTI_DalyInterval(FTI_Ckpt[i].ckptCost, mtbf) / 60);
+        if (intv < 1) {
+            intv = 1;
+        }
+        if (intv != FTI_Ckpt[i].ckptIntv) {
+            snprintf(str, FTI_BUFS, "L%d checkpoint interval set to %d min. (cost: %.2f sec., MTBF: %.1f min.)",
+                    i, intv, FTI_Ckpt[i].ckptCost, mtbf / 60);
+            FTI_Print(str, FTI_INFO);
+            FTI_Ckpt[i].ckptIntv = intv;
+        }
+    }
+
+    for (i = 1; i <= level; i++) {
+        if (FTI_Ckpt[i].ckptIntv > 0) {
+            FTI_Ckpt[i].ckptDue = FTI_Exec->minuteCnt + FTI_Ckpt[i].ckptIntv;
+        }
+    }
+    return FTI_SCES;
+}
+
 /*-------------------------------------------------------------------------*/
 /**
   @brief      It writes the checkpoint data in the target file.
@@ -140,7 +249,11 @@ int FTI_WriteCkpt(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     //If checkpoint is inlin and level 4 save directly to PFS
     int res; //response from writing funcitons
     int offset = 2*(FTI_Conf->dcpPosix || FTI_Conf->dcpFtiff);
-    if (FTI_Ckpt[4].isInline && FTI_Exec->ckptMeta.level == 4) {
+    bool global = FTI_Ckpt[4].isInline && FTI_Exec->ckptMeta.level == 4;
+    // old checkpoints deleted in the background must leave room for this one
+    FTI_ReclaimReserve(global ? FTI_Conf->glbalDir : FTI_Conf->localDir,
+            (uint64_t)FTI_Exec->ckptSize * (global ? 1 : FTI_Topo->nbApprocs));
+    if (global) {
 
         if ( !((FTI_Conf->dcpFtiff || FTI_Conf->dcpPosix) && FTI_Ckpt[4].isDcp) && !FTI_Exec->h5SingleFile ) {
             MKDIR(FTI_Conf->gTmpDir, 0777);
@@ -181,7 +294,9 @@ int FTI_WriteCkpt(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         }
     }
 
+    double tm = FTI_TraceStart();
     res = FTI_Try(FTI_CreateMetadata(FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt, FTI_Data), "create metadata.");
+    FTI_TraceEvent(FTI_TRACE_META, -1, tm, 0);
 
     if ( (FTI_Conf->dcpFtiff || FTI_Conf->keepL4Ckpt) && (FTI_Topo->splitRank == 0) ) {
         FTI_WriteCkptMetaData( FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt );
@@ -213,6 +328,8 @@ int FTI_PostCkpt(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     char str[FTI_BUFS]; //For console output
 
     double t1 = MPI_Wtime(); //Start time
+    double tt = FTI_TraceStart();
+    FTI_TraceCkpt(FTI_Exec->ckptId, FTI_Exec->ckptMeta.level);
 
     int res; //Response from post-processing functions
     switch (FTI_Exec->ckptMeta.level) {
@@ -232,7 +349,7 @@ int FTI_PostCkpt(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
 
     //Check if all processes done post-processing correctly
     int allRes;
-    MPI_Allreduce(&res, &allRes, 1, MPI_INT, MPI_SUM, FTI_COMM_WORLD);
+    MPI_Allreduce(&res, &allRes, 1, MPI_INT, MPI_SUM, FTI_Exec->postComm);
     if (allRes != FTI_SCES) {
         FTI_Print("Error postprocessing checkpoint. Discarding current checkpoint...", FTI_WARN);
         FTI_Clean(FTI_Conf, FTI_Topo, FTI_Ckpt, 0); //Remove temporary files
@@ -242,7 +359,8 @@ int FTI_PostCkpt(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     double t2 = MPI_Wtime(); //Post-processing time
 
     FTI_Clean(FTI_Conf, FTI_Topo, FTI_Ckpt, FTI_Exec->ckptMeta.level); //delete previous files on this checkpoint level
-    int nodeFlag = (((!FTI_Topo->amIaHead) && ((FTI_Topo->nodeRank - FTI_Topo->nbHeads) == 0)) || (FTI_Topo->amIaHead)) ? 1 : 0;
+    double tr = FTI_TraceStart();
+    int nodeFlag = (((!FTI_Topo->amIaHead) && ((FTI_Topo->nodeRank - FTI_Topo->nbHeads) == 0)) || (FTI_Topo->amIaHead && FTI_Topo->headID == 0)) ? 1 : 0;
     nodeFlag = (!FTI_Ckpt[4].isDcp && (nodeFlag != 0));
     if (nodeFlag) { //True only for one process in the node.
         //Debug message needed to test nodeFlag (./tests/nodeFlag/nodeFlag.c)
@@ -265,9 +383,11 @@ int FTI_PostCkpt(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
             RENAME(FTI_Conf->mTmpDir, FTI_Ckpt[FTI_Exec->ckptMeta.level].metaDir);
         }
     }
-    MPI_Barrier(FTI_COMM_WORLD); //barrier needed to wait for process to rename directories (new temporary could be needed in next checkpoint)
+    MPI_Barrier(FTI_Exec->postComm); //barrier needed to wait for process to rename directories (new temporary could be needed in next checkpoint)
+    FTI_TraceEvent(FTI_TRACE_RENAME, -1, tr, 0);
 
     double t3 = MPI_Wtime(); //Renaming directories time
+    FTI_TraceEvent(FTI_TRACE_POST, -1, tt, 0);
 
     snprintf(str, FTI_BUFS, "Post-checkpoint took %.2f sec. (Pt:%.2fs, Cl:%.2fs)",
             t3 - t1, t2 - t1, t3 - t2);
@@ -279,6 +399,65 @@ int FTI_PostCkpt(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     return FTI_SCES;
 }
 
+/** @typedef    FTIT_headWork
+ *  @brief      Stage request queued on the head.
+ */
+typedef struct FTIT_headWork {
+    void*                   buf;        /**< serialized stage request       */
+    int                     source;     /**< application rank (node comm.)  */
+    double                  tEnqueue;   /**< time of arrival                */
+    struct FTIT_headWork*   next;       /**< next element in queue          */
+} FTIT_headWork;
+
+/** @typedef    FTIT_headStats
+ *  @brief      Activity statistics of the head progress engine.
+ */
+typedef struct FTIT_headStats {
+    double          tStart;             /**< time the head started listening */
+    double          tBusy;              /**< time spent handling requests   */
+    double          latSum;             /**< accumulated queue latency      */
+    double          latMax;             /**< maximum queue latency          */
+    long            nbCkpt;             /**< handled checkpoint requests    */
+    long            nbStage;            /**< handled stage requests         */
+} FTIT_headStats;
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Prints the statistics of the head progress engine.
+  @param      FTI_Topo        Topology metadata.
+  @param      stats           Head statistics.
+
+  Collective over the heads (FTI_COMM_WORLD of the heads).
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_PrintHeadStats(FTIT_topology* FTI_Topo, FTIT_headStats* stats)
+{
+    char str[FTI_BUFS];
+    double wall = MPI_Wtime() - stats->tStart;
+    double util = (wall > 0) ? 100.0 * stats->tBusy / wall : 0;
+    double latAvg = (stats->nbStage > 0) ? stats->latSum / stats->nbStage : 0;
+
+    snprintf(str, FTI_BUFS, "Head utilization: %.2f%% (Ckpt: %ld, Stage: %ld, queue latency avg: %.4fs, max: %.4fs)",
+            util, stats->nbCkpt, stats->nbStage, latAvg, stats->latMax);
+    FTI_Print(str, FTI_DBUG);
+
+    int nbHeads;
+    double utilSum, utilMax, latMax, latSum;
+    long nbStage;
+    MPI_Comm_size(FTI_COMM_WORLD, &nbHeads);
+    MPI_Reduce(&util, &utilSum, 1, MPI_DOUBLE, MPI_SUM, 0, FTI_COMM_WORLD);
+    MPI_Reduce(&util, &utilMax, 1, MPI_DOUBLE, MPI_MAX, 0, FTI_COMM_WORLD);
+    MPI_Reduce(&stats->latMax, &latMax, 1, MPI_DOUBLE, MPI_MAX, 0, FTI_COMM_WORLD);
+    MPI_Reduce(&stats->latSum, &latSum, 1, MPI_DOUBLE, MPI_SUM, 0, FTI_COMM_WORLD);
+    MPI_Reduce(&stats->nbStage, &nbStage, 1, MPI_LONG, MPI_SUM, 0, FTI_COMM_WORLD);
+    if (FTI_Topo->splitRank == 0) {
+        latAvg = (nbStage > 0) ? latSum / nbStage : 0;
+        snprintf(str, FTI_BUFS, "Head utilization avg: %.2f%%, max: %.2f%%. Stage queue latency avg: %.4fs, max: %.4fs.",
+                utilSum / nbHeads, utilMax, latAvg, latMax);
+        FTI_Print(str, FTI_INFO);
+    }
+}
+
 /*-------------------------------------------------------------------------*/
 /**
   @brief      It listens for checkpoint notifications.
@@ -291,56 +470,130 @@ int FTI_PostCkpt(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
   and takes the required actions after notification. This function is only
   executed by the head of the nodes and its complementary with the
   FTI_Checkpoint function in terms of communications.
+
+  Stage requests are received through a persistent request and queued,
+  checkpoint requests are served first unless the oldest stage request
+  waits for more than 'Advanced:stage_deadline' seconds. The file copies
+  of the stage requests are done by the stage workers, which pause at
+  the next transfer boundary while a checkpoint is post-processed. If there is no work, the head
+  sleeps with an exponential backoff (up to 'Advanced:head_backoff_max'
+  microseconds) instead of spinning on the probes.
  **/
 /*-------------------------------------------------------------------------*/
 int FTI_Listen(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         FTIT_topology* FTI_Topo, FTIT_checkpoint* FTI_Ckpt)
 {
 
-    MPI_Status ckpt_status;         int ckpt_flag = 0;
-    MPI_Status stage_status;        int stage_flag = 0;
-    MPI_Status finalize_status;     int finalize_flag = 0;
+    int ckpt_flag = 0;
+    int finalize_flag = 0;
+
+    FTIT_headWork *queueFirst = NULL, *queueLast = NULL;
+    FTIT_headStats stats;
+    memset(&stats, 0x0, sizeof(FTIT_headStats));
+    stats.tStart = MPI_Wtime();
+
+    long backoff = 0; // in microseconds
 
     FTI_Print("Head starts listening...", FTI_DBUG);
     while (1) { //heads can stop only by receiving FTI_ENDW
 
-        FTI_Print("Head waits for message...", FTI_DBUG);
+        bool progress = false;
+
+        // move all arrived stage requests into the queue
+        void *buf;
+        int source;
+        while ( FTI_Conf->stagingEnabled && FTI_TestStageRequest( &buf, &source ) ) {
+            FTIT_headWork *work = malloc( sizeof(FTIT_headWork) );
+            if ( work == NULL ) {
+                FTI_Print( "failed to allocate memory for stage request in 'FTI_Listen'", FTI_EROR );
+                free( buf );
+                continue;
+            }
+            work->buf = buf;
+            work->source = source;
+            work->tEnqueue = MPI_Wtime();
+            work->next = NULL;
+            if ( queueLast ) {
+                queueLast->next = work;
+            } else {
+                queueFirst = work;
+            }
+            queueLast = work;
+            progress = true;
+        }
+
+        // finish the copies completed by the stage workers
+        if ( FTI_Conf->stagingEnabled && FTI_ProgressStage( FTI_Exec, FTI_Topo ) > 0 ) {
+            progress = true;
+        }
+
+        // a stage request past its deadline is dispatched before the
+        // checkpoints, otherwise frequent checkpoints starve the staging
+        bool overdue = queueFirst && FTI_StageCanDispatch() && (FTI_Conf->stageDeadline > 0) &&
+            (MPI_Wtime() - queueFirst->tEnqueue > FTI_Conf->stageDeadline);
 
-        MPI_Iprobe( MPI_ANY_SOURCE, FTI_Conf->finalTag, FTI_Exec->globalComm, &finalize_flag, &finalize_status );
-        if ( FTI_Conf->stagingEnabled ) {
-            MPI_Iprobe( MPI_ANY_SOURCE, FTI_Conf->stageTag, FTI_Exec->nodeComm, &stage_flag, &stage_status );
+        ckpt_flag = 0;
+        if ( !overdue ) {
+            MPI_Iprobe( MPI_ANY_SOURCE, FTI_Conf->ckptTag, FTI_Exec->globalComm, &ckpt_flag, MPI_STATUS_IGNORE );
         }
-        MPI_Iprobe( MPI_ANY_SOURCE, FTI_Conf->ckptTag, FTI_Exec->globalComm, &ckpt_flag, &ckpt_status );
         if( ckpt_flag ) {
 
             // head will process the whole checkpoint
-            // (treated second due to priority)
+            // (treated first due to priority), the stage copies
+            // pause meanwhile
+            double t0 = MPI_Wtime();
+            double tt = FTI_TraceStart();
+            if ( FTI_Conf->stagingEnabled ) {
+                FTI_PreemptStage( true );
+            }
             FTI_HandleCkptRequest( FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt ); 
+            if ( FTI_Conf->stagingEnabled ) {
+                FTI_PreemptStage( false );
+            }
+            FTI_TraceEvent( FTI_TRACE_REQUEST, -1, tt, 0 );
+            stats.tBusy += MPI_Wtime() - t0;
+            stats.nbCkpt++;
             ckpt_flag = 0;
+            backoff = 0;
             continue;
 
         } 
 
-        if ( stage_flag ) {
+        if ( queueFirst && FTI_StageCanDispatch() ) {
 
-            // head will process each unstage request on its own
-            // [A MAYBE: we could interrupt the unstageing process if 
-            // we receive a checkpoint request.]
-            FTI_HandleStageRequest( FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt, stage_status.MPI_SOURCE );
-            stage_flag = 0;
+            // head hands each stage request to the stage workers
+            FTIT_headWork *work = queueFirst;
+            queueFirst = work->next;
+            if ( queueFirst == NULL ) {
+                queueLast = NULL;
+            }
+            double t0 = MPI_Wtime();
+            double lat = t0 - work->tEnqueue;
+            stats.latSum += lat;
+            stats.latMax = (lat > stats.latMax) ? lat : stats.latMax;
+            FTI_HandleStageRequest( FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt, work->source, work->buf );
+            stats.tBusy += MPI_Wtime() - t0;
+            stats.nbStage++;
+            free( work );
+            backoff = 0;
             continue;
 
         } 
 
-        // the 'continue' statement ensures that we first process all
+        // the 'continue' statements ensure that we first process all
         // checkpoint and staging request before we call finalize.
+        // The stage workers have to be done as well.
+        finalize_flag = 0;
+        if ( !queueFirst && !FTI_StageInFlight() ) {
+            MPI_Iprobe( MPI_ANY_SOURCE, FTI_Conf->finalTag, FTI_Exec->globalComm, &finalize_flag, MPI_STATUS_IGNORE );
+        }
         if ( finalize_flag ) {
 
             char str[FTI_BUFS];
             FTI_Print("Head waits for message...", FTI_DBUG);
 
             int val = 0, i;
-            for (i = 0; i < FTI_Topo->nbApprocs; i++) { // Iterate on the application processes in the node
+            for (i = 0; i < FTI_Topo->nbBody; i++) { // Iterate on the application processes of this head
                 int buf;
                 MPI_Recv(&buf, 1, MPI_INT, FTI_Topo->body[i], FTI_Conf->finalTag, FTI_Exec->globalComm, MPI_STATUS_IGNORE);
                 snprintf(str, FTI_BUFS, "The head received a %d message", buf);
@@ -348,12 +601,14 @@ int FTI_Listen(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
                 val += buf;
             }
 
-            val /= FTI_Topo->nbApprocs;
+            val /= FTI_Topo->nbBody;
 
             if ( val != FTI_ENDW) { // If we were asked to finalize
                 FTI_Print( "Inconsistency in Finalize request.", FTI_WARN );
             }
 
+            FTI_PrintHeadStats( FTI_Topo, &stats );
+
             FTI_Print("Head stopped listening.", FTI_DBUG);
             FTI_Finalize();
 
@@ -363,6 +618,18 @@ int FTI_Listen(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
 
         }
 
+        // nothing to do, back off
+        if ( !progress && FTI_Conf->headBackoffMax > 0 ) {
+            backoff = (backoff == 0) ? 1 : 2*backoff;
+            if ( backoff > FTI_Conf->headBackoffMax ) {
+                backoff = FTI_Conf->headBackoffMax;
+            }
+            struct timespec ts;
+            ts.tv_sec = backoff / 1000000;
+            ts.tv_nsec = (backoff % 1000000) * 1000;
+            nanosleep( &ts, NULL );
+        }
+
     }
 
     // will be reached only if keepHeadsAlive is TRUE
@@ -391,7 +658,7 @@ int FTI_HandleCkptRequest(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec
         flags[i] = 0;
     }
     FTI_Print("Head waits for message...", FTI_DBUG);
-    for (i = 0; i < FTI_Topo->nbApprocs; i++) { // Iterate on the application processes in the node
+    for (i = 0; i < FTI_Topo->nbBody; i++) { // Iterate on the application processes of this head
         int buf;
         MPI_Recv(&buf, 1, MPI_INT, FTI_Topo->body[i], FTI_Conf->ckptTag, FTI_Exec->globalComm, MPI_STATUS_IGNORE);
         int isDCP;
@@ -403,7 +670,7 @@ int FTI_HandleCkptRequest(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec
         flags[buf - FTI_BASE] = flags[buf - FTI_BASE] + 1;
     }
     for (i = 1; i < 7; i++) {
-        if (flags[i] == FTI_Topo->nbApprocs) { // Determining checkpoint level
+        if (flags[i] == FTI_Topo->nbBody) { // Determining checkpoint level
             FTI_Exec->ckptMeta.level = i;
         }
     }
@@ -420,6 +687,7 @@ int FTI_HandleCkptRequest(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec
     //Check if checkpoint was written correctly by all processes
     int res = (FTI_Exec->ckptMeta.level == 6) ? FTI_NSCS : FTI_SCES;
 
+    // aggregate over all the heads, each head only knows about its own processes
     int allRes;
     MPI_Allreduce(&res, &allRes, 1, MPI_INT, MPI_SUM, FTI_COMM_WORLD);
     if (allRes == FTI_SCES) { //If checkpoint was written correctly do post-processing
@@ -433,7 +701,7 @@ int FTI_HandleCkptRequest(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec
         FTI_Clean(FTI_Conf, FTI_Topo, FTI_Ckpt, 0); //Remove temporary files
         res = FTI_NSCS;
     }
-    for (i = 0; i < FTI_Topo->nbApprocs; i++) { // Send msg. to avoid checkpoint collision
+    for (i = 0; i < FTI_Topo->nbBody; i++) { // Send msg. to avoid checkpoint collision
         MPI_Send(&res, 1, MPI_INT, FTI_Topo->body[i], FTI_Conf->generalTag, FTI_Exec->globalComm);
     }
     return FTI_SCES;
@@ -460,7 +728,9 @@ int FTI_Write(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
 {
 
     int i;
+    double t = FTI_TraceStart();
     void *write_info = io->initCKPT(FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt, FTI_Data);
+    FTI_TraceEvent(FTI_TRACE_OPEN, -1, t, 0);
     if( !write_info ) {
         FTI_Print("unable to initialize checkpoint!", FTI_EROR);
         return FTI_NSCS;
@@ -471,14 +741,16 @@ int FTI_Write(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
 
     for (i = 0; i < FTI_Exec->nbVar; i++) {
         data[i].filePos = io->getPos(write_info);
+        t = FTI_TraceStart();
         int ret = io->WriteData(&data[i], write_info);
         if (ret != FTI_SCES)
             return ret;
+        FTI_TraceEvent(FTI_TRACE_WRITE, data[i].id, t, data[i].size);
     }
 
     io->finIntegrity(FTI_Exec->integrity, write_info);
-    io->finCKPT(write_info);
+    int res = io->finCKPT(write_info);
     free (write_info);
-    return FTI_SCES;
+    return res;
 
 }
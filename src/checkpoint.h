@@ -2,6 +2,9 @@
 #define __CHECKPOINT_H__
 
 int FTI_UpdateIterTime(FTIT_execution* FTI_Exec);
+double FTI_DalyInterval(double cost, double mtbf);
+int FTI_AdaptCkptIntv(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
+        FTIT_checkpoint* FTI_Ckpt, int level, double cost);
 int FTI_WriteCkpt(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         FTIT_topology* FTI_Topo, FTIT_checkpoint* FTI_Ckpt,
         FTIT_keymap* FTI_Data);
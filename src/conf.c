@@ -38,6 +38,8 @@
 
 #include "interface.h"
 #include <time.h>
+#include <limits.h>
+#include <sys/statvfs.h>
 
 /*-------------------------------------------------------------------------*/
 /**
@@ -74,6 +76,18 @@ int FTI_UpdateConf(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, int r
     iniparser_set(ini, "Restart:failure", str);
     // Set the exec. ID
     iniparser_set(ini, "Restart:exec_id", FTI_Exec->id);
+    // Failure history for the observed MTBF (see FTI_AdaptCkptIntv)
+    if (FTI_Conf->adaptiveIntv) {
+        int lvl;
+        char key[FTI_BUFS];
+        snprintf(str, FTI_BUFS, "%.0f", FTI_Exec->upTime + MPI_Wtime() - FTI_Exec->initTime);
+        iniparser_set(ini, "Restart:uptime", str);
+        for (lvl = 1; lvl < 5; lvl++) {
+            snprintf(key, FTI_BUFS, "Restart:failures_l%d", lvl);
+            snprintf(str, FTI_BUFS, "%d", FTI_Exec->failures[lvl]);
+            iniparser_set(ini, key, str);
+        }
+    }
 
     FILE* fd = fopen(FTI_Conf->cfgFile, "w");
     if (fd == NULL) {
@@ -101,6 +115,29 @@ int FTI_UpdateConf(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, int r
     return FTI_SCES;
 }
 
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Reads a size given in KB or MB in the conf. file.
+  @param      ini             Dictionary of the conf. file.
+  @param      key             Key of the size.
+  @param      notfound        Default value, in units.
+  @param      unit            Bytes per unit.
+  @return     integer         Size in bytes, -1 if it does not fit an int.
+
+  The value is range checked before it is scaled, so that a large value
+  is rejected by FTI_TestConfig instead of wrapping around.
+
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_GetSizeConf(dictionary* ini, const char* key, int notfound, int unit)
+{
+    long value = iniparser_getlint(ini, key, notfound);
+    if (value < 0 || value > INT_MAX / unit) {
+        return -1;
+    }
+    return (int)(value * unit);
+}
+
 /*-------------------------------------------------------------------------*/
 /**
   @brief      It reads the configuration given in the configuration file.
@@ -142,6 +179,8 @@ int FTI_ReadConf(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     snprintf(FTI_Conf->glbalDir, FTI_BUFS, "%s", par);
     par = iniparser_getstring(ini, "Basic:meta_dir", NULL);
     snprintf(FTI_Conf->metadDir, FTI_BUFS, "%s", par);
+    par = iniparser_getstring(ini, "Advanced:trace_dir", FTI_Conf->metadDir);
+    snprintf(FTI_Conf->traceDir, FTI_BUFS, "%s", par);
     FTI_Ckpt[1].ckptIntv = (int)iniparser_getint(ini, "Basic:ckpt_l1", -1);
     FTI_Ckpt[2].ckptIntv = (int)iniparser_getint(ini, "Basic:ckpt_l2", -1);
     FTI_Ckpt[3].ckptIntv = (int)iniparser_getint(ini, "Basic:ckpt_l3", -1);
@@ -157,10 +196,24 @@ int FTI_ReadConf(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     FTI_Ckpt[4].ckptCnt  = 1;
     FTI_Ckpt[4].ckptDcpCnt  = 1;
 
+    // adaptive intervals, MTBF of the failures each level recovers from
+    FTI_Conf->adaptiveIntv = (bool)iniparser_getboolean(ini, "Basic:ckpt_adaptive", 0);
+    FTI_Ckpt[1].mtbf = iniparser_getdouble(ini, "Basic:mtbf_l1", 0) * 60;
+    FTI_Ckpt[2].mtbf = iniparser_getdouble(ini, "Basic:mtbf_l2", 0) * 60;
+    FTI_Ckpt[3].mtbf = iniparser_getdouble(ini, "Basic:mtbf_l3", 0) * 60;
+    FTI_Ckpt[4].mtbf = iniparser_getdouble(ini, "Basic:mtbf_l4", 0) * 60;
+
     FTI_Conf->stagingEnabled = (bool)iniparser_getboolean(ini, "Basic:enable_staging", 0);
 
+    // node-local shared memory tier (checkpoints survive process but not node failures)
+    FTI_Conf->shmEnabled = (bool)iniparser_getboolean(ini, "Basic:enable_shm", 0);
+    par = iniparser_getstring(ini, "Advanced:shm_dir", "/dev/shm");
+    snprintf(FTI_Conf->shmDir, FTI_BUFS, "%s", par);
+    FTI_Conf->shmHandoff = (bool)iniparser_getboolean(ini, "Advanced:shm_handoff", 0);
+
     // Reading/setting configuration metadata
     FTI_Conf->keepHeadsAlive = (bool)iniparser_getboolean(ini, "Basic:keep_heads_alive", 0);
+    FTI_Conf->headThread = (bool)iniparser_getboolean(ini, "Basic:head_thread", 0);
     bool dcpEnabled = (bool)iniparser_getboolean(ini, "Basic:enable_dcp", 0);
     FTI_Conf->dcpMode = (int)iniparser_getint(ini, "Basic:dcp_mode", -1) + FTI_DCP_MODE_OFFSET;
     FTI_Conf->dcpBlockSize = (int)iniparser_getint(ini, "Basic:dcp_block_size", -1);
@@ -188,6 +241,35 @@ int FTI_ReadConf(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     FTI_Conf->stageTag = (int)iniparser_getint(ini, "Advanced:stage_tag", 406);
     FTI_Conf->finalTag = (int)iniparser_getint(ini, "Advanced:final_tag", 3107);
     FTI_Conf->generalTag = (int)iniparser_getint(ini, "Advanced:general_tag", 2612);
+    FTI_Conf->headBackoffMax = (int)iniparser_getint(ini, "Advanced:head_backoff_max", 1000);
+    FTI_Conf->headThreadCpu = (int)iniparser_getint(ini, "Advanced:head_thread_cpu", -1);
+    FTI_Conf->stageWorkers = (int)iniparser_getint(ini, "Advanced:stage_workers", 4);
+    FTI_Conf->reclaimThreads = (int)iniparser_getint(ini, "Advanced:reclaim_threads", 0);
+    FTI_Conf->reclaimMaxPending = (int)iniparser_getint(ini, "Advanced:reclaim_max_pending", 16);
+    FTI_Conf->icpAsyncBuffer = (int)iniparser_getint(ini, "Advanced:icp_async_buffer", 0);
+    FTI_Conf->stageDeadline = (int)iniparser_getint(ini, "Advanced:stage_deadline", 60);
+    FTI_Conf->stagePackFile = FTI_GetSizeConf(ini, "Advanced:stage_pack_file", 1024, 1024);
+    FTI_Conf->stagePackSize = FTI_GetSizeConf(ini, "Advanced:stage_pack_size", 64, 1024 * 1024);
+    FTI_Conf->groupStrategy = (int)iniparser_getint(ini, "Advanced:group_strategy", FTI_GROUP_LINEAR);
+    FTI_Conf->domainSize = (int)iniparser_getint(ini, "Advanced:domain_size", 1);
+    par = iniparser_getstring(ini, "Advanced:node_coords_file", "");
+    snprintf(FTI_Conf->nodeCoordsFile, FTI_BUFS, "%s", par);
+    FTI_Conf->h5ChunkSize = FTI_GetSizeConf(ini, "Advanced:h5_chunk_size", 0, 1024);
+    FTI_Conf->h5Checksum = (bool)iniparser_getboolean(ini, "Advanced:h5_checksum", 1);
+    FTI_Conf->h5Alignment = FTI_GetSizeConf(ini, "Advanced:h5_alignment", 0, 1024);
+    FTI_Conf->h5MetaBlockSize = FTI_GetSizeConf(ini, "Advanced:h5_meta_block_size", 0, 1024);
+    FTI_Conf->h5MdcSize = FTI_GetSizeConf(ini, "Advanced:h5_mdc_size", 0, 1024);
+    FTI_Conf->h5CbNodes = (int)iniparser_getint(ini, "Advanced:h5_cb_nodes", 0);
+    FTI_Conf->h5CbBufferSize = FTI_GetSizeConf(ini, "Advanced:h5_cb_buffer_size", 0, 1024);
+    FTI_Conf->mpioCbNodes = (int)iniparser_getint(ini, "Advanced:mpiio_cb_nodes", 0);
+    FTI_Conf->mpioCbBufferSize = FTI_GetSizeConf(ini, "Advanced:mpiio_cb_buffer_size", 0, 1024);
+    FTI_Conf->mpioStripeUnit = FTI_GetSizeConf(ini, "Advanced:mpiio_striping_unit", 4096, 1024);
+    FTI_Conf->mpioStripeFactor = (int)iniparser_getint(ini, "Advanced:mpiio_striping_factor", 0);
+    FTI_Conf->coalesceSize = FTI_GetSizeConf(ini, "Advanced:coalesce_size", 0, 1024);
+    FTI_Conf->coalesceBuffer = FTI_GetSizeConf(ini, "Advanced:coalesce_buffer", 4096, 1024);
+    FTI_Conf->traceEnabled = (bool)iniparser_getboolean(ini, "Advanced:trace", 0);
+    FTI_Conf->traceChrome = (bool)iniparser_getboolean(ini, "Advanced:trace_chrome", 0);
+    FTI_Conf->traceEvents = (int)iniparser_getint(ini, "Advanced:trace_events", 65536);
     FTI_Conf->test = (int)iniparser_getint(ini, "Advanced:local_test", -1);
     FTI_Conf->l3WordSize = FTI_WORD;
     FTI_Conf->ioMode = (int)iniparser_getint(ini, "Basic:ckpt_io", 0) + 1000;
@@ -211,11 +293,15 @@ int FTI_ReadConf(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         FTI_Conf->dcpFtiff = dcpEnabled;
     }
     FTI_Conf->cHostBufSize = (size_t)iniparser_getlint(ini, "Advanced:gpu_host_bufsize", FTI_DEFAULT_CHOSTBUF_SIZE_MB * ((size_t)1 << 20) );
-#ifdef LUSTRE
-    FTI_Conf->stripeUnit = (int)iniparser_getint(ini, "Advanced:lustre_stiping_unit", 4194304);
-    FTI_Conf->stripeFactor = (int)iniparser_getint(ini, "Advanced:lustre_stiping_factor", -1);
-    FTI_Conf->stripeOffset = (int)iniparser_getint(ini, "Advanced:lustre_stiping_offset", -1);
-#endif
+    // 'lustre_stiping_*' is the misspelled name read by older versions
+    FTI_Conf->stripeUnit = (int)iniparser_getint(ini, "Advanced:lustre_striping_unit",
+            iniparser_getint(ini, "Advanced:lustre_stiping_unit", 4194304));
+    FTI_Conf->stripeFactor = (int)iniparser_getint(ini, "Advanced:lustre_striping_factor",
+            iniparser_getint(ini, "Advanced:lustre_stiping_factor", -1));
+    FTI_Conf->stripeOffset = (int)iniparser_getint(ini, "Advanced:lustre_striping_offset",
+            iniparser_getint(ini, "Advanced:lustre_stiping_offset", -1));
+    FTI_Conf->stripeOstCount = (int)iniparser_getint(ini, "Advanced:lustre_ost_count", -1);
+    FTI_Conf->stripeTarget = (long)iniparser_getint(ini, "Advanced:lustre_stripe_target", 1024) * 1024 * 1024;
     char *h5SingleFileDir = iniparser_getstring(ini, "basic:h5_single_file_dir", NULL);
     if( h5SingleFileDir ) {
         if( strncmp( h5SingleFileDir, "", 1 ) != 0 ) {
@@ -239,6 +325,7 @@ int FTI_ReadConf(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     }
     FTI_Conf->h5SingleFileKeep = (bool)iniparser_getboolean(ini, "Basic:h5_single_file_keep", 0);
     FTI_Conf->h5SingleFileEnable = (bool)iniparser_getboolean(ini, "Basic:h5_single_file_enable", 0);
+    FTI_Conf->h5SingleFileAsync = (bool)iniparser_getboolean(ini, "Basic:h5_single_file_async", 0);
 
     // Reading/setting execution metadata
     FTI_Exec->nbVar = 0;
@@ -257,7 +344,19 @@ int FTI_ReadConf(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     FTI_Exec->lastIterTime = 0;
     FTI_Exec->totalIterTime = 0;
     FTI_Exec->meanIterTime = 0;
+    FTI_Exec->iterSyncReq = MPI_REQUEST_NULL;
     FTI_Exec->reco = (int)iniparser_getint(ini, "restart:failure", 0);
+    // failure history of this execution, restarted runs continue it
+    FTI_Exec->upTime = 0;
+    memset(FTI_Exec->failures, 0, sizeof(FTI_Exec->failures));
+    if ( FTI_Exec->reco == 1 || FTI_Exec->reco == 2 ) {
+        FTI_Exec->upTime = iniparser_getdouble(ini, "restart:uptime", 0);
+        int lvl;
+        for (lvl = 1; lvl < 5; lvl++) {
+            snprintf(str, FTI_BUFS, "restart:failures_l%d", lvl);
+            FTI_Exec->failures[lvl] = (int)iniparser_getint(ini, str, 0);
+        }
+    }
     if ( (FTI_Exec->reco == 0) || (FTI_Exec->reco == 3) ) {
         time_t tim = time(NULL);
         struct tm* n = localtime(&tim);
@@ -314,8 +413,12 @@ int FTI_TestConfig(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo,
         FTIT_checkpoint* FTI_Ckpt, FTIT_execution* FTI_Exec)
 {
     // Check requirements.
-    if (FTI_Topo->nbHeads != 0 && FTI_Topo->nbHeads != 1) {
-        FTI_Print("The number of heads needs to be set to 0 or 1.", FTI_WARN);
+    if (FTI_Topo->nbHeads < 0 || FTI_Topo->nbHeads >= FTI_Topo->nodeSize) {
+        FTI_Print("The number of heads needs to be positive and lower than the node size.", FTI_WARN);
+        return FTI_NSCS;
+    }
+    if (FTI_Topo->nbHeads > 1 && FTI_Topo->nbApprocs % FTI_Topo->nbHeads != 0) {
+        FTI_Print("The number of application processes per node is not a multiple of the number of heads.", FTI_WARN);
         return FTI_NSCS;
     }
     if (FTI_Topo->nbProc % FTI_Topo->nodeSize != 0) {
@@ -393,16 +496,43 @@ CHECK_DCP_SETTING_END:
         FTI_Print("Keep last ckpt. needs to be set to 0 or 1.", FTI_WARN);
         return FTI_NSCS;
     }
+    if (FTI_Conf->headThread) {
+        int provided;
+        MPI_Query_thread(&provided);
+        // the flush of those modes is collective over all the application ranks
+        bool collFlush = (FTI_Conf->ioMode == FTI_IO_MPI);
+#ifdef ENABLE_SIONLIB // --> If SIONlib is installed
+        collFlush = collFlush || (FTI_Conf->ioMode == FTI_IO_SIONLIB);
+#endif
+        if (FTI_Topo->nbHeads > 0) {
+            FTI_Print("'head_thread' cannot be combined with dedicated heads, helper thread disabled.", FTI_WARN);
+            FTI_Conf->headThread = false;
+        } else if (provided < MPI_THREAD_MULTIPLE) {
+            FTI_Print("'head_thread' requires MPI_THREAD_MULTIPLE (see MPI_Init_thread), helper thread disabled.", FTI_WARN);
+            FTI_Conf->headThread = false;
+        } else if (collFlush && !FTI_Ckpt[4].isInline) {
+            FTI_Print("L4 post-processing with MPI-I/O or SIONlib cannot run in a helper thread, L4 set inline.", FTI_WARN);
+            FTI_Ckpt[4].isInline = 1;
+        }
+    }
     int i;
     for (i = 1; i < 5; i++) {
         if (FTI_Ckpt[i].ckptIntv == 0) {
             FTI_Ckpt[i].ckptIntv = -1;
         }
+        if (FTI_Ckpt[i].mtbf < 0) {
+            char str[FTI_BUFS];
+            snprintf(str, FTI_BUFS, "MTBF ('Basic:mtbf_l%d') must be positive, set to 0 (observed).", i);
+            FTI_Print(str, FTI_WARN);
+            FTI_Ckpt[i].mtbf = 0;
+        }
+        FTI_Ckpt[i].ckptDue = (FTI_Ckpt[i].ckptIntv > 0) ? FTI_Ckpt[i].ckptIntv : 0;
+        FTI_Ckpt[i].ckptCost = 0;
         if (FTI_Ckpt[i].isInline != 0 && FTI_Ckpt[i].isInline != 1) {
             FTI_Ckpt[i].isInline = 1;
         }
-        if (FTI_Ckpt[i].isInline == 0 && FTI_Topo->nbHeads != 1) {
-            FTI_Print("If inline is set to 0 then head should be set to 1.", FTI_WARN);
+        if (FTI_Ckpt[i].isInline == 0 && FTI_Topo->nbHeads == 0 && !FTI_Conf->headThread) {
+            FTI_Print("If inline is set to 0 then head should be set to 1 or more, or head_thread to 1.", FTI_WARN);
             return FTI_NSCS;
         }
     }
@@ -425,6 +555,135 @@ CHECK_DCP_SETTING_END:
     if ( FTI_Conf->stagingEnabled && !FTI_Topo->nbHeads ) {
         FTI_Print( "Staging is enabled but no dedicated head process, staging will be performed inline!", FTI_WARN );
     }
+    if ( FTI_Conf->stageWorkers < 0 || FTI_Conf->stageWorkers > 64 ) {
+        FTI_Print("Number of stage workers ('Advanced:stage_workers') must be between 0 and 64, set to default (4).", FTI_WARN);
+        FTI_Conf->stageWorkers = 4;
+    }
+    if ( FTI_Conf->reclaimThreads < 0 || FTI_Conf->reclaimThreads > 64 ) {
+        FTI_Print("Number of reclaim threads ('Advanced:reclaim_threads') must be between 0 and 64, set to default (0).", FTI_WARN);
+        FTI_Conf->reclaimThreads = 0;
+    }
+    if ( FTI_Conf->reclaimMaxPending < 1 ) {
+        FTI_Print("Pending directories ('Advanced:reclaim_max_pending') must be positive, set to default (16).", FTI_WARN);
+        FTI_Conf->reclaimMaxPending = 16;
+    }
+    if ( FTI_Conf->icpAsyncBuffer < 0 || FTI_Conf->icpAsyncBuffer > 1048576 ) {
+        FTI_Print("Buffer of the iCP writer ('Advanced:icp_async_buffer') must be between 0 and 1048576 MB, set to default (0).", FTI_WARN);
+        FTI_Conf->icpAsyncBuffer = 0;
+    }
+    if ( FTI_Conf->stageDeadline < 0 ) {
+        FTI_Print("Stage deadline ('Advanced:stage_deadline') must be positive, set to default (60s).", FTI_WARN);
+        FTI_Conf->stageDeadline = 60;
+    }
+    if ( FTI_Conf->stagePackFile < 0 || FTI_Conf->stagePackFile > (1024 * 1024 * 64) ) {
+        FTI_Print("Max. size of packed files ('Advanced:stage_pack_file') must be between 0 and 64MB, set to default (1MB).", FTI_WARN);
+        FTI_Conf->stagePackFile = 1024 * 1024;
+    }
+    if ( FTI_Conf->stagePackSize < (1024 * 1024) || FTI_Conf->stagePackSize > (1024 * 1024 * 1024) ) {
+        FTI_Print("Size of stage archives ('Advanced:stage_pack_size') must be between 1MB and 1GB, set to default (64MB).", FTI_WARN);
+        FTI_Conf->stagePackSize = 64 * 1024 * 1024;
+    }
+    if ( FTI_Conf->h5ChunkSize < 0 || FTI_Conf->h5ChunkSize > (1024 * 1024 * 1024) ) {
+        FTI_Print("HDF5 chunk size ('Advanced:h5_chunk_size') must be between 0 and 1GB, set to default (0, one chunk per dataset).", FTI_WARN);
+        FTI_Conf->h5ChunkSize = 0;
+    }
+    if ( FTI_Conf->h5Alignment < 0 || FTI_Conf->h5Alignment > (1024 * 1024 * 1024) ) {
+        FTI_Print("HDF5 alignment ('Advanced:h5_alignment') must be between 0 and 1GB, set to default (0, unaligned).", FTI_WARN);
+        FTI_Conf->h5Alignment = 0;
+    }
+    if ( FTI_Conf->h5MetaBlockSize < 0 || FTI_Conf->h5MetaBlockSize > (1024 * 1024 * 64) ) {
+        FTI_Print("HDF5 metadata block size ('Advanced:h5_meta_block_size') must be between 0 and 64MB, set to default (0, HDF5 default).", FTI_WARN);
+        FTI_Conf->h5MetaBlockSize = 0;
+    }
+    if ( FTI_Conf->h5MdcSize < 0 || FTI_Conf->h5MdcSize > (1024 * 1024 * 1024) ) {
+        FTI_Print("HDF5 metadata cache size ('Advanced:h5_mdc_size') must be between 0 and 1GB, set to default (0, HDF5 default).", FTI_WARN);
+        FTI_Conf->h5MdcSize = 0;
+    }
+    if ( FTI_Conf->h5CbNodes < 0 ) {
+        FTI_Print("Number of collective buffering nodes ('Advanced:h5_cb_nodes') must be positive, set to default (0, MPI-IO default).", FTI_WARN);
+        FTI_Conf->h5CbNodes = 0;
+    }
+    if ( FTI_Conf->h5CbBufferSize < 0 || FTI_Conf->h5CbBufferSize > (1024 * 1024 * 1024) ) {
+        FTI_Print("Collective buffer size ('Advanced:h5_cb_buffer_size') must be between 0 and 1GB, set to default (0, MPI-IO default).", FTI_WARN);
+        FTI_Conf->h5CbBufferSize = 0;
+    }
+    if ( FTI_Conf->stripeUnit < 65536 || FTI_Conf->stripeUnit % 65536 != 0 ) {
+        FTI_Print("Striping unit ('Advanced:lustre_striping_unit') must be a multiple of 64KB, set to default (4194304).", FTI_WARN);
+        FTI_Conf->stripeUnit = 4194304;
+    }
+    if ( FTI_Conf->stripeTarget < 0 ) {
+        FTI_Print("Stripe target ('Advanced:lustre_stripe_target') must be positive, set to default (1024MB).", FTI_WARN);
+        FTI_Conf->stripeTarget = 1024L * 1024 * 1024;
+    }
+#ifndef LUSTRE
+    if ( FTI_Conf->stripeOstCount < 0 ) {
+        FTI_Conf->stripeOstCount = 0;
+    }
+#endif
+    if ( FTI_Conf->mpioCbNodes < 0 ) {
+        FTI_Print("Number of collective buffering nodes ('Advanced:mpiio_cb_nodes') must be positive, set to default (0, MPI-IO default).", FTI_WARN);
+        FTI_Conf->mpioCbNodes = 0;
+    }
+    if ( FTI_Conf->mpioCbBufferSize < 0 || FTI_Conf->mpioCbBufferSize > (1024 * 1024 * 1024) ) {
+        FTI_Print("Collective buffer size ('Advanced:mpiio_cb_buffer_size') must be between 0 and 1GB, set to default (0, MPI-IO default).", FTI_WARN);
+        FTI_Conf->mpioCbBufferSize = 0;
+    }
+    if ( FTI_Conf->mpioStripeUnit < 0 || FTI_Conf->mpioStripeUnit > (1024 * 1024 * 1024) ) {
+        FTI_Print("Striping unit ('Advanced:mpiio_striping_unit') must be between 0 and 1GB, set to default (4MB).", FTI_WARN);
+        FTI_Conf->mpioStripeUnit = 4 * 1024 * 1024;
+    }
+    if ( FTI_Conf->mpioStripeFactor < 0 ) {
+        FTI_Print("Striping factor ('Advanced:mpiio_striping_factor') must be positive, set to default (0, file system default).", FTI_WARN);
+        FTI_Conf->mpioStripeFactor = 0;
+    }
+    if ( FTI_Conf->coalesceSize < 0 || FTI_Conf->coalesceSize > (1024 * 1024 * 1024) ) {
+        FTI_Print("Coalescing size ('Advanced:coalesce_size') must be between 0 and 1GB, set to default (0, no coalescing).", FTI_WARN);
+        FTI_Conf->coalesceSize = 0;
+    }
+    if ( FTI_Conf->coalesceBuffer < FTI_Conf->coalesceSize || FTI_Conf->coalesceBuffer > (1024 * 1024 * 1024) ) {
+        FTI_Print("Coalescing buffer ('Advanced:coalesce_buffer') must be between 'Advanced:coalesce_size' and 1GB, set to 'Advanced:coalesce_size'.", FTI_WARN);
+        FTI_Conf->coalesceBuffer = FTI_Conf->coalesceSize;
+    }
+    if ( FTI_Conf->traceEvents < 1 || FTI_Conf->traceEvents > 16777216 ) {
+        FTI_Print("Trace events ('Advanced:trace_events') must be between 1 and 16777216, set to default (65536).", FTI_WARN);
+        FTI_Conf->traceEvents = 65536;
+    }
+    if ( FTI_Conf->h5SingleFileAsync ) {
+        int provided;
+        MPI_Query_thread(&provided);
+        if ( !FTI_Conf->h5SingleFileEnable || FTI_Conf->ioMode != FTI_IO_HDF5 ) {
+            FTI_Conf->h5SingleFileAsync = false;
+        } else if (provided < MPI_THREAD_MULTIPLE) {
+            FTI_Print("'h5_single_file_async' requires MPI_THREAD_MULTIPLE (see MPI_Init_thread), VPR files written synchronously.", FTI_WARN);
+            FTI_Conf->h5SingleFileAsync = false;
+        }
+#ifdef ENABLE_HDF5
+        hbool_t threadsafe = 0;
+        if ( FTI_Conf->h5SingleFileAsync && (H5is_library_threadsafe(&threadsafe) < 0 || !threadsafe) ) {
+            FTI_Print("'h5_single_file_async' requires a thread-safe HDF5 library, VPR files written synchronously.", FTI_WARN);
+            FTI_Conf->h5SingleFileAsync = false;
+        }
+#endif
+    }
+    if ( FTI_Conf->groupStrategy < FTI_GROUP_LINEAR || FTI_Conf->groupStrategy > FTI_GROUP_COORDS ) {
+        FTI_Print("Unknown group strategy ('Advanced:group_strategy'), set to default (0, consecutive nodes).", FTI_WARN);
+        FTI_Conf->groupStrategy = FTI_GROUP_LINEAR;
+    }
+    if ( FTI_Conf->groupStrategy == FTI_GROUP_COORDS && FTI_Conf->nodeCoordsFile[0] == '\0' ) {
+        FTI_Print("Group strategy 2 requires 'Advanced:node_coords_file', set to default (0, consecutive nodes).", FTI_WARN);
+        FTI_Conf->groupStrategy = FTI_GROUP_LINEAR;
+    }
+    if ( FTI_Conf->domainSize < 1 ) {
+        FTI_Print("Nodes per failure domain ('Advanced:domain_size') must be positive, set to default (1).", FTI_WARN);
+        FTI_Conf->domainSize = 1;
+    }
+    if ( FTI_Conf->shmHandoff && !FTI_Topo->nbHeads ) {
+        FTI_Print("Shared memory handoff ('Advanced:shm_handoff') requires a head, setting will be ignored.", FTI_WARN);
+        FTI_Conf->shmHandoff = false;
+    }
+    if ( FTI_Conf->shmEnabled ) {
+        FTI_TestShmDir(FTI_Conf, FTI_Topo, FTI_Exec);
+    }
     if (FTI_Topo->groupSize < 1) {
         FTI_Topo->groupSize = 1;
     }
@@ -474,6 +733,71 @@ CHECK_DCP_SETTING_END:
     return FTI_SCES;
 }
 
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      It selects the shared memory directory of the local checkpoints.
+  @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Topo        Topology metadata.
+  @param      FTI_Exec        Execution metadata.
+  @return     integer         FTI_SCES if the shared memory is used.
+
+  The local checkpoints are stored in '<shm_dir>/fti-<uid>' (the execution
+  ID is appended by FTI_CreateDirs), so that users sharing a node do not
+  share a directory. The process with the lowest rank of the node creates
+  it with mode 0700, whatever the umask, checks that it is a directory of
+  the user and broadcasts the result: all the processes of a node use the
+  same tier. Otherwise, 'Ckpt_dir' is used.
+
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_TestShmDir(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo,
+        FTIT_execution* FTI_Exec)
+{
+    char str[FTI_BUFS], dir[FTI_BUFS];
+    struct stat st;
+    MPI_Comm nodeComm;
+    int nodeRank, ok = 1;
+
+    if (!FTI_Conf->test) {
+        MPI_Comm_split_type(FTI_Exec->globalComm, MPI_COMM_TYPE_SHARED, FTI_Topo->myRank, MPI_INFO_NULL, &nodeComm);
+    }
+    else {
+        MPI_Comm_split(FTI_Exec->globalComm, FTI_Topo->myRank / FTI_Topo->nodeSize, FTI_Topo->myRank, &nodeComm);
+    }
+    MPI_Comm_rank(nodeComm, &nodeRank);
+
+    snprintf(dir, FTI_BUFS, "%s/fti-%u", FTI_Conf->shmDir, (unsigned int)getuid());
+    if (nodeRank == 0) {
+        if ((stat(FTI_Conf->shmDir, &st) != 0) || !S_ISDIR(st.st_mode)) {
+            ok = 0;
+        }
+        else if ((mkdir(dir, (mode_t) 0700) != 0) && (errno != EEXIST)) {
+            ok = 0;
+        }
+        // not a directory created by another user or a link to one
+        else if ((lstat(dir, &st) != 0) || !S_ISDIR(st.st_mode) || (st.st_uid != getuid())) {
+            ok = 0;
+        }
+        // the mode of mkdir is masked by the umask
+        else if (chmod(dir, (mode_t) 0700) != 0) {
+            ok = 0;
+        }
+        errno = 0;
+    }
+    MPI_Bcast(&ok, 1, MPI_INT, 0, nodeComm);
+    MPI_Comm_free(&nodeComm);
+
+    if (!ok) {
+        snprintf(str, FTI_BUFS, "Shared memory directory '%s' is not accessible, local checkpoints will be stored in '%s'.",
+                dir, FTI_Conf->localDir);
+        FTI_Print(str, FTI_WARN);
+        FTI_Conf->shmEnabled = false;
+        return FTI_NSCS;
+    }
+    snprintf(FTI_Conf->localDir, FTI_BUFS, "%s", dir);
+    return FTI_SCES;
+}
+
 /*-------------------------------------------------------------------------*/
 /**
   @brief      It tests that the directories given is correct.
@@ -496,6 +820,15 @@ int FTI_TestDirectories(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo)
     FTI_Print(str, FTI_DBUG);
     MKDIR(FTI_Conf->localDir,0777);
 
+    if ( FTI_Conf->shmEnabled ) {
+        struct statvfs sv;
+        if ( statvfs(FTI_Conf->localDir, &sv) == 0 ) {
+            snprintf(str, FTI_BUFS, "Local checkpoints are stored in shared memory (%s, %.2f MB available).",
+                    FTI_Conf->localDir, ((double)sv.f_bavail * sv.f_frsize) / (1024.0 * 1024.0));
+            FTI_Print(str, FTI_INFO);
+        }
+    }
+
     if (FTI_Topo->myRank == 0) {
         // Checking metadata directory
         snprintf(str, FTI_BUFS, "Checking the metadata directory (%s)...", FTI_Conf->metadDir);
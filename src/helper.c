@@ -0,0 +1,262 @@
+/**
+ *  Copyright (c) 2017 Leonardo A. Bautista-Gomez
+ *  All rights reserved
+ *
+ *  FTI - A multi-level checkpointing library for C/C++/Fortran applications
+ *
+ *  Revision 1.0 : Fault Tolerance Interface (FTI)
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *  @file   helper.c
+ *  @date   October, 2026
+ *  @brief  Post-processing in a helper thread of the application process.
+ *
+ *  If 'Basic:head_thread' is enabled, every application process starts a
+ *  helper thread that takes the role of the head for its own checkpoint.
+ *  The application process hands the non-inline post-processing (L1-L4)
+ *  to the thread and continues computing. The thread works on a copy of
+ *  the checkpoint metadata and of the few execution fields read by the
+ *  post-processing, and on duplicates of the communicators, so its
+ *  collectives never match the ones of the application. The result is sent back to the process itself with the
+ *  same message the heads send, thus the application side of the head
+ *  protocol is left unchanged.
+ */
+
+#define _GNU_SOURCE
+#include "interface.h"
+#include <pthread.h>
+#include <sched.h>
+
+/** @typedef    FTIT_helper
+ *  @brief      State of the post-processing helper thread.
+ */
+typedef struct FTIT_helper {
+    pthread_t               thread;     /**< helper thread                  */
+    pthread_mutex_t         mutex;      /**< protects the fields below      */
+    pthread_cond_t          cond;       /**< signals new work or stop       */
+    bool                    pending;    /**< TRUE if post-proc. requested   */
+    bool                    stop;       /**< TRUE if thread has to return   */
+    int                     status;     /**< status of the ckpt. write      */
+    FTIT_configuration*     FTI_Conf;   /**< configuration (read only)      */
+    FTIT_topology*          FTI_Topo;   /**< topology (read only)           */
+    FTIT_execution          exec;       /**< post-processing fields only    */
+    FTIT_checkpoint         ckpt[5];    /**< copy of the ckpt. metadata     */
+    MPI_Comm                worldComm;  /**< duplicate of FTI_COMM_WORLD    */
+    MPI_Comm                groupComm;  /**< duplicate of the group comm.   */
+} FTIT_helper;
+
+static FTIT_helper FTI_Help;
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Post-processes the checkpoint handed to the helper.
+  @param      h               Helper state.
+  @return     integer         Ckpt. level if successful, FTI_NSCS otherwise.
+
+  This is the thread counterpart of 'FTI_HandleCkptRequest'.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_HelperPostCkpt(FTIT_helper* h)
+{
+    int res = h->status;
+    int allRes;
+    MPI_Allreduce(&res, &allRes, 1, MPI_INT, MPI_SUM, h->worldComm);
+    if (allRes == FTI_SCES) {
+        res = FTI_Try(FTI_PostCkpt(h->FTI_Conf, &h->exec, h->FTI_Topo, h->ckpt), "postprocess the checkpoint.");
+        if (res == FTI_SCES) {
+            res = h->exec.ckptMeta.level;
+        }
+    } else {
+        FTI_Print("Checkpoint have not been witten correctly. Discarding current checkpoint...", FTI_WARN);
+        FTI_Clean(h->FTI_Conf, h->FTI_Topo, h->ckpt, 0);
+        res = FTI_NSCS;
+    }
+    return res;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Main loop of the helper thread.
+  @param      arg             Helper state.
+  @return     void*           NULL.
+ **/
+/*-------------------------------------------------------------------------*/
+static void* FTI_HelperMain(void* arg)
+{
+    FTIT_helper* h = (FTIT_helper*) arg;
+    pthread_mutex_lock(&h->mutex);
+    while (true) {
+        while (!h->pending && !h->stop) {
+            pthread_cond_wait(&h->cond, &h->mutex);
+        }
+        if (!h->pending) {
+            break;
+        }
+        h->pending = false;
+        pthread_mutex_unlock(&h->mutex);
+
+        int res = FTI_HelperPostCkpt(h);
+        // same message the head sends (received in FTI_Checkpoint/FTI_Finalize)
+        MPI_Send(&res, 1, MPI_INT, h->FTI_Topo->myRank, h->FTI_Conf->generalTag, h->exec.globalComm);
+
+        pthread_mutex_lock(&h->mutex);
+    }
+    pthread_mutex_unlock(&h->mutex);
+    return NULL;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Starts the post-processing helper thread.
+  @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Exec        Execution metadata.
+  @param      FTI_Topo        Topology metadata.
+  @param      FTI_Ckpt        Checkpoint metadata.
+  @return     integer         FTI_SCES if successful.
+
+  Collective over FTI_COMM_WORLD. If the thread cannot be started on any
+  of the processes, the helper is disabled everywhere and all the levels
+  fall back to inline post-processing.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_InitHelper(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
+        FTIT_topology* FTI_Topo, FTIT_checkpoint* FTI_Ckpt)
+{
+    char str[FTI_BUFS];
+    FTIT_helper* h = &FTI_Help;
+
+    memset(h, 0x0, sizeof(FTIT_helper));
+    h->FTI_Conf = FTI_Conf;
+    h->FTI_Topo = FTI_Topo;
+    MPI_Comm_dup(FTI_COMM_WORLD, &h->worldComm);
+    MPI_Comm_dup(FTI_Exec->groupComm, &h->groupComm);
+    snprintf(h->exec.id, FTI_BUFS, "%s", FTI_Exec->id);
+    h->exec.globalComm = FTI_Exec->globalComm;
+    h->exec.groupComm = h->groupComm;
+    h->exec.postComm = h->worldComm;
+    pthread_mutex_init(&h->mutex, NULL);
+    pthread_cond_init(&h->cond, NULL);
+
+    int res = FTI_SCES;
+    if (pthread_create(&h->thread, NULL, FTI_HelperMain, h) != 0) {
+        snprintf(str, FTI_BUFS, "Cannot start the post-processing helper thread (%s).", strerror(errno));
+        FTI_Print(str, FTI_EROR);
+        res = FTI_NSCS;
+    } else if (FTI_Conf->headThreadCpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(FTI_Conf->headThreadCpu + FTI_Topo->nodeRank, &cpus);
+        if (pthread_setaffinity_np(h->thread, sizeof(cpu_set_t), &cpus) != 0) {
+            snprintf(str, FTI_BUFS, "Cannot pin the helper thread to CPU %d.", FTI_Conf->headThreadCpu + FTI_Topo->nodeRank);
+            FTI_Print(str, FTI_WARN);
+        }
+    }
+
+    int allRes;
+    MPI_Allreduce(&res, &allRes, 1, MPI_INT, MPI_SUM, FTI_COMM_WORLD);
+    if (allRes != FTI_SCES) {
+        if (res == FTI_SCES) {
+            FTI_FinalizeHelper();
+        } else {
+            MPI_Comm_free(&h->worldComm);
+            MPI_Comm_free(&h->groupComm);
+            pthread_mutex_destroy(&h->mutex);
+            pthread_cond_destroy(&h->cond);
+        }
+        FTI_Print("Helper thread disabled, post-processing set inline for all levels.", FTI_WARN);
+        FTI_Conf->headThread = false;
+        int i;
+        for (i = 1; i < 5; i++) {
+            FTI_Ckpt[i].isInline = 1;
+        }
+        return FTI_SCES;
+    }
+
+    // the thread is the head of its own process
+    FTI_Topo->headRank = FTI_Topo->myRank;
+    FTI_Exec->activateHeads = FTI_ActivateHelper;
+    FTI_Print("Post-processing helper thread started.", FTI_DBUG);
+
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Hands the post-processing of the last ckpt. to the helper.
+  @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Exec        Execution metadata.
+  @param      FTI_Topo        Topology metadata.
+  @param      FTI_Ckpt        Checkpoint metadata.
+  @param      status          Status of the checkpoint write.
+  @return     integer         FTI_SCES if successful.
+
+  Replaces 'FTI_ActivateHeadsPosix' if the helper thread is enabled. The
+  metadata is copied, thus the application may continue right away. Only
+  plain fields are copied: the pointers of 'FTIT_execution' (queues, types,
+  groups, datasets) refer to structures the application keeps changing.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_ActivateHelper(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
+        FTIT_topology* FTI_Topo, FTIT_checkpoint* FTI_Ckpt, int status)
+{
+    FTIT_helper* h = &FTI_Help;
+
+    FTI_Exec->wasLastOffline = 1;
+    pthread_mutex_lock(&h->mutex);
+    h->exec.ckptId = FTI_Exec->ckptId;
+    h->exec.ckptMeta = FTI_Exec->ckptMeta;
+    memcpy(h->ckpt, FTI_Ckpt, 5 * sizeof(FTIT_checkpoint));
+    h->status = (status == FTI_SCES) ? FTI_SCES : FTI_NSCS;
+    h->pending = true;
+    pthread_cond_signal(&h->cond);
+    pthread_mutex_unlock(&h->mutex);
+
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Stops the post-processing helper thread.
+
+  Must be called after the result of the last post-processing has been
+  received.
+ **/
+/*-------------------------------------------------------------------------*/
+void FTI_FinalizeHelper(void)
+{
+    FTIT_helper* h = &FTI_Help;
+
+    pthread_mutex_lock(&h->mutex);
+    h->stop = true;
+    pthread_cond_signal(&h->cond);
+    pthread_mutex_unlock(&h->mutex);
+    pthread_join(h->thread, NULL);
+
+    MPI_Comm_free(&h->worldComm);
+    MPI_Comm_free(&h->groupComm);
+    pthread_mutex_destroy(&h->mutex);
+    pthread_cond_destroy(&h->cond);
+}
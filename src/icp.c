@@ -37,6 +37,239 @@
  */
 
 #include "interface.h"
+#include <pthread.h>
+
+/*
+ *  If 'Advanced:icp_async_buffer' is set, FTI_AddVarICP does not write
+ *  the dataset itself. It copies the dataset into a buffer and queues it
+ *  for the writer thread of the process, which appends the datasets to
+ *  the checkpoint file in the order they were added, while the
+ *  application continues computing. FTI_WaitICP, called at the beginning
+ *  of FTI_FinalizeICP, waits for the queued writes. At most
+ *  'icp_async_buffer' MB of copies are queued (FTI_AddVarICP blocks
+ *  beyond). Datasets that do not fit in the buffer or are in device
+ *  memory are written synchronously once the queue is empty.
+ *
+ *  Only the POSIX writer is used from the thread, it does not call MPI.
+ */
+
+/** @typedef    FTIT_icpJob
+ *  @brief      Dataset queued for the iCP writer.
+ */
+typedef struct FTIT_icpJob {
+    FTIT_dataset        data;   /**< copy of the dataset, ptr to the buffer */
+    struct FTIT_icpJob* next;   /**< next queued or written dataset         */
+} FTIT_icpJob;
+
+/** iCP writer of this process. */
+static struct {
+    pthread_t       thread;
+    bool            active;     /**< TRUE while the writer thread runs    */
+    bool            stop;
+    FTIT_IO*        io;
+    void*           fd;         /**< write info of the checkpoint file    */
+    FTIT_icpJob*    first;      /**< queued, first one is being written   */
+    FTIT_icpJob*    last;
+    FTIT_icpJob*    done;       /**< written, file position to be stored  */
+    size_t          used;       /**< bytes queued                         */
+    size_t          size;       /**< bytes queued at most                 */
+    int             result;     /**< FTI_NSCS after the first failure     */
+    int             failedId;   /**< dataset of the first failure         */
+    pthread_mutex_t lock;
+    pthread_cond_t  work;       /**< dataset queued or stop               */
+    pthread_cond_t  space;      /**< dataset written                      */
+} FTI_IcpWriter = { .active = false, .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work = PTHREAD_COND_INITIALIZER, .space = PTHREAD_COND_INITIALIZER };
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Main loop of the iCP writer thread.
+  @param      arg             Unused.
+  @return     void*           NULL.
+
+  Writes the queued datasets in order. After a failure, the remaining
+  datasets are dropped, since the writer closed the checkpoint file.
+ **/
+/*-------------------------------------------------------------------------*/
+static void* FTI_IcpWriterMain(void* arg)
+{
+    pthread_mutex_lock(&FTI_IcpWriter.lock);
+    while (true) {
+        while (FTI_IcpWriter.first == NULL && !FTI_IcpWriter.stop) {
+            pthread_cond_wait(&FTI_IcpWriter.work, &FTI_IcpWriter.lock);
+        }
+        FTIT_icpJob* job = FTI_IcpWriter.first;
+        if (job == NULL) {
+            break;
+        }
+        bool failed = (FTI_IcpWriter.result != FTI_SCES);
+        pthread_mutex_unlock(&FTI_IcpWriter.lock);
+
+        int res = FTI_NSCS;
+        if (!failed) {
+            double t = FTI_TraceStart();
+            job->data.filePos = FTI_IcpWriter.io->getPos(FTI_IcpWriter.fd);
+            res = FTI_IcpWriter.io->WriteData(&job->data, FTI_IcpWriter.fd);
+            FTI_TraceEvent(FTI_TRACE_WRITE, job->data.id, t, job->data.size);
+        }
+        free(job->data.ptr);
+        job->data.ptr = NULL;
+
+        pthread_mutex_lock(&FTI_IcpWriter.lock);
+        if (res != FTI_SCES && !failed) {
+            FTI_IcpWriter.result = FTI_NSCS;
+            FTI_IcpWriter.failedId = job->data.id;
+        }
+        FTI_IcpWriter.first = job->next;
+        if (FTI_IcpWriter.first == NULL) {
+            FTI_IcpWriter.last = NULL;
+        }
+        FTI_IcpWriter.used -= job->data.size;
+        job->next = FTI_IcpWriter.done;
+        FTI_IcpWriter.done = job;
+        pthread_cond_broadcast(&FTI_IcpWriter.space);
+    }
+    pthread_mutex_unlock(&FTI_IcpWriter.lock);
+    return NULL;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Starts the iCP writer for the current checkpoint file.
+  @param      FTI_Conf        Configuration metadata.
+  @param      io              IO function pointers
+  @param      fd              Write info of the checkpoint file.
+
+  Leaves the writes synchronous if the thread cannot be started.
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_StartIcpWriter(FTIT_configuration* FTI_Conf, FTIT_IO* io, void* fd)
+{
+    FTI_IcpWriter.io = io;
+    FTI_IcpWriter.fd = fd;
+    FTI_IcpWriter.first = NULL;
+    FTI_IcpWriter.last = NULL;
+    FTI_IcpWriter.done = NULL;
+    FTI_IcpWriter.used = 0;
+    FTI_IcpWriter.size = (size_t)FTI_Conf->icpAsyncBuffer * 1024 * 1024;
+    FTI_IcpWriter.result = FTI_SCES;
+    FTI_IcpWriter.failedId = -1;
+    FTI_IcpWriter.stop = false;
+
+    if (pthread_create(&FTI_IcpWriter.thread, NULL, FTI_IcpWriterMain, NULL) != 0) {
+        FTI_Print("Cannot start the iCP writer thread, datasets are written synchronously.", FTI_WARN);
+        return;
+    }
+    FTI_IcpWriter.active = true;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Queues a copy of a dataset for the iCP writer.
+  @param      data            Dataset to write.
+  @return     integer         FTI_SCES if queued, FTI_NSCS if the dataset
+                              has to be written synchronously.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_QueueIcpVar(FTIT_dataset* data)
+{
+    size_t size = data->size;
+    if (data->isDevicePtr || size > FTI_IcpWriter.size) {
+        return FTI_NSCS;
+    }
+
+    pthread_mutex_lock(&FTI_IcpWriter.lock);
+    while (FTI_IcpWriter.used + size > FTI_IcpWriter.size) {
+        pthread_cond_wait(&FTI_IcpWriter.space, &FTI_IcpWriter.lock);
+    }
+    FTI_IcpWriter.used += size;
+    pthread_mutex_unlock(&FTI_IcpWriter.lock);
+
+    FTIT_icpJob* job = malloc(sizeof(FTIT_icpJob));
+    void* buf = malloc((size > 0) ? size : 1);
+    if (job == NULL || buf == NULL) {
+        free(job);
+        free(buf);
+        pthread_mutex_lock(&FTI_IcpWriter.lock);
+        FTI_IcpWriter.used -= size;
+        pthread_mutex_unlock(&FTI_IcpWriter.lock);
+        return FTI_NSCS;
+    }
+    memcpy(buf, data->ptr, size);
+    memcpy(&job->data, data, sizeof(FTIT_dataset));
+    job->data.ptr = buf;
+    job->next = NULL;
+
+    pthread_mutex_lock(&FTI_IcpWriter.lock);
+    if (FTI_IcpWriter.last != NULL) {
+        FTI_IcpWriter.last->next = job;
+    } else {
+        FTI_IcpWriter.first = job;
+    }
+    FTI_IcpWriter.last = job;
+    pthread_cond_signal(&FTI_IcpWriter.work);
+    pthread_mutex_unlock(&FTI_IcpWriter.lock);
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Waits until the iCP writer has written all queued datasets.
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_DrainIcpWriter(void)
+{
+    pthread_mutex_lock(&FTI_IcpWriter.lock);
+    while (FTI_IcpWriter.first != NULL) {
+        pthread_cond_wait(&FTI_IcpWriter.space, &FTI_IcpWriter.lock);
+    }
+    pthread_mutex_unlock(&FTI_IcpWriter.lock);
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Waits for the datasets queued for the iCP writer.
+  @param      FTI_Exec        Execution metadata.
+  @param      FTI_Data        Dataset metadata.
+  @return     integer         FTI_SCES if all queued datasets were written.
+
+  Stops the writer thread, stores the file positions of the written
+  datasets in the keymap and sets the iCP result on failure. Does
+  nothing if the datasets were written synchronously.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_WaitICP(FTIT_execution* FTI_Exec, FTIT_keymap* FTI_Data)
+{
+    if (!FTI_IcpWriter.active) {
+        return FTI_SCES;
+    }
+
+    pthread_mutex_lock(&FTI_IcpWriter.lock);
+    FTI_IcpWriter.stop = true;
+    pthread_cond_signal(&FTI_IcpWriter.work);
+    pthread_mutex_unlock(&FTI_IcpWriter.lock);
+    pthread_join(FTI_IcpWriter.thread, NULL);
+    FTI_IcpWriter.active = false;
+
+    while (FTI_IcpWriter.done != NULL) {
+        FTIT_icpJob* job = FTI_IcpWriter.done;
+        FTIT_dataset* data;
+        if (FTI_Data->get(&data, job->data.id) == FTI_SCES && data != NULL) {
+            data->filePos = job->data.filePos;
+        }
+        FTI_IcpWriter.done = job->next;
+        free(job);
+    }
+
+    if (FTI_IcpWriter.result != FTI_SCES) {
+        char str[FTI_BUFS];
+        snprintf(str, FTI_BUFS, "iCP writer failed to write dataset #%d.", FTI_IcpWriter.failedId);
+        FTI_Print(str, FTI_WARN);
+        FTI_Exec->iCPInfo.result = FTI_NSCS;
+        return FTI_NSCS;
+    }
+    return FTI_SCES;
+}
 
 /*-------------------------------------------------------------------------*/
 /**
@@ -50,7 +283,8 @@
   @return     integer         FTI_SCES if successful.
 
   This function initializes all the necessary data structures and files
-  required to perform incremental checkpoint. 
+  required to perform incremental checkpoint. It starts the iCP writer
+  if 'Advanced:icp_async_buffer' is set.
  **/
 /*-------------------------------------------------------------------------*/
 int FTI_startICP(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
@@ -59,6 +293,10 @@ int FTI_startICP(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
 {
     void *ret = io->initCKPT(FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt, FTI_Data);
     FTI_Exec->iCPInfo.fd = ret;
+    // only the POSIX writer may run outside of the application thread
+    if ( FTI_Conf->icpAsyncBuffer > 0 && ret != NULL && io->WriteData == FTI_WritePosixData ) {
+        FTI_StartIcpWriter(FTI_Conf, io, ret);
+    }
     return FTI_SCES;
 }
 
@@ -75,7 +313,8 @@ int FTI_startICP(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
   @param      io              IO function pointers
   @return     integer         FTI_SCES if successful.
 
-  This functions writes the varid data on the checkpoint file
+  This functions writes the varid data on the checkpoint file, or
+  queues a copy of it if the iCP writer is running.
  **/
 /*-------------------------------------------------------------------------*/
 int FTI_WriteVar(int varID, FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
@@ -96,8 +335,19 @@ int FTI_WriteVar(int varID, FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Ex
         return FTI_NSCS;
     }
 
+    if ( FTI_IcpWriter.active ) {
+        if ( FTI_QueueIcpVar(data) == FTI_SCES ) {
+            FTI_Exec->iCPInfo.result = FTI_SCES;
+            return FTI_SCES;
+        }
+        // keep the order of the datasets in the file
+        FTI_DrainIcpWriter();
+    }
+
+    double t = FTI_TraceStart();
     data->filePos = io->getPos(write_info);
     res = io->WriteData(data,write_info);
+    FTI_TraceEvent(FTI_TRACE_WRITE, data->id, t, data->size);
     FTI_Exec->iCPInfo.result = res;
     return res;
 }
@@ -123,11 +373,11 @@ int FTI_FinishICP(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, FTIT_t
         return FTI_NSCS;
     }
     void *write_info = FTI_Exec->iCPInfo.fd;
-    io->finCKPT(write_info);
+    int res = io->finCKPT(write_info);
     io->finIntegrity(FTI_Exec->integrity, write_info);
     free(write_info);
     FTI_Exec->iCPInfo.fd = NULL;
-    return FTI_SCES;
+    return res;
 }
 
 
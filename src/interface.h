@@ -47,11 +47,15 @@ extern "C"
 #include "fortran/ftif.h"
 
 #include "util/ini.h"
-#include "util/dataset.h"
 #include "util/keymap.h"
+#include "util/dataset.h"
 #include "util/metaqueue.h"
 #include "util/macros.h"
 #include "util/utility.h"
+#include "util/handoff.h"
+#include "util/stripe.h"
+#include "util/trace.h"
+#include "util/reclaim.h"
 #include "util/failure-injection.h"
 
 #include "IO/posix.h"
@@ -69,6 +73,7 @@ extern "C"
 #include "conf.h"
 #include "checkpoint.h"
 #include "stage.h"
+#include "helper.h"
 #include "fti-io.h"
 #include "topo.h"
 #include "postckpt.h"
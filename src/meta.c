@@ -411,6 +411,7 @@ int FTI_LoadMetaDataset(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
 
     FTIT_iniparser ini; if( FTI_Iniparser( &ini, metaFileName, FTI_INI_OPEN ) != FTI_SCES ) return FTI_NSCS;
 
+    long nextPos = 0;
     int k; for (k = 0; k < FTI_Conf->maxVarId; k++) {
         snprintf(str, FTI_BUFS, "%d:Var%d_id", FTI_Topo->groupRank, k);
         int id = ini.getInt( &ini, str );
@@ -419,22 +420,26 @@ int FTI_LoadMetaDataset(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
             break;
         }
 
-        FTIT_dataset data; FTI_InitDataset( FTI_Exec, &data, id );
+        FTIT_dataset data; FTIT_datasetAttr attr;
+        FTI_InitDataset( FTI_Exec, &data, &attr, id );
 
         snprintf(str, FTI_BUFS, "%d:Var%d_size", FTI_Topo->groupRank, k);
         data.sizeStored = ini.getLong( &ini, str );
 
+        // a missing position means the variable follows the previous one
         snprintf(str, FTI_BUFS, "%d:Var%d_pos", FTI_Topo->groupRank, k);
-        data.filePos = ini.getLong( &ini, str );
+        long pos = ini.getLong( &ini, str );
+        data.filePos = (pos == -1) ? nextPos : pos;
+        nextPos = data.filePos + data.sizeStored;
 
         snprintf(str, FTI_BUFS, "%d:Var%d_name", FTI_Topo->groupRank, k);
-        strncpy(data.idChar, ini.getString( &ini, str ), FTI_BUFS);
+        strncpy(data.attr->idChar, ini.getString( &ini, str ), FTI_BUFS);
 
         FTI_Exec->ckptSize = FTI_Exec->ckptSize + data.size;
 
         data.recovered = true;
 
-        FTI_Data->push_back( &data, data.id ); 
+        FTI_AppendDataset( FTI_Data, &data, data.id ); 
 
     }
 
@@ -700,6 +705,7 @@ int FTI_WriteMetadata(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         snprintf(key, FTI_BUFS, "%d:Ckpt_checksum", i);
         ini.set(&ini, key, val);
         int j;
+        long nextPos = 0;
         for (j = 0; j < FTI_Exec->nbVar; j++) {
             //Save id of variable
             snprintf(key, FTI_BUFS, "%d:Var%d_id", i, j);
@@ -711,13 +717,20 @@ int FTI_WriteMetadata(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
             snprintf(val, FTI_BUFS, "%ld", allVarSizes[i * FTI_Exec->nbVar + j]);
             ini.set(&ini, key, val);
 
-            snprintf(key, FTI_BUFS, "%d:Var%d_pos", i, j);
-            snprintf(val, FTI_BUFS, "%ld", allVarPositions[i * FTI_Exec->nbVar + j]);
-            ini.set(&ini, key, val);
+            // position and name are omitted if the variable directly
+            // follows the previous one or has no name (see FTI_LoadMeta)
+            if (allVarPositions[i * FTI_Exec->nbVar + j] != nextPos) {
+                snprintf(key, FTI_BUFS, "%d:Var%d_pos", i, j);
+                snprintf(val, FTI_BUFS, "%ld", allVarPositions[i * FTI_Exec->nbVar + j]);
+                ini.set(&ini, key, val);
+            }
+            nextPos = allVarPositions[i * FTI_Exec->nbVar + j] + allVarSizes[i * FTI_Exec->nbVar + j];
 
-            snprintf(key, FTI_BUFS, "%d:Var%d_name", i,j);
-            snprintf(val, FTI_BUFS, "%s", &allCharIds[ (i*FTI_Exec->nbVar*FTI_BUFS) +j*FTI_BUFS]);
-            ini.set(&ini,key,val);
+            if (allCharIds[(i*FTI_Exec->nbVar*FTI_BUFS) + j*FTI_BUFS] != '\0') {
+                snprintf(key, FTI_BUFS, "%d:Var%d_name", i,j);
+                snprintf(val, FTI_BUFS, "%s", &allCharIds[ (i*FTI_Exec->nbVar*FTI_BUFS) +j*FTI_BUFS]);
+                ini.set(&ini,key,val);
+            }
         }
         if( FTI_Ckpt[FTI_Exec->ckptMeta.level].isDcp ) {
             int nbLayer = ((FTI_Exec->dcpInfoPosix.Counter-1) % FTI_Conf->dcpInfoPosix.StackSize) + 1;
@@ -879,7 +892,7 @@ int FTI_CreateMetadata(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     int* myVarIDs = talloc(int, FTI_Exec->nbVar);
     long* myVarSizes = talloc(long, FTI_Exec->nbVar);
     long* myVarPositions = talloc(long, FTI_Exec->nbVar);
-    char *ArrayOfStrings = ( char *) malloc (FTI_Exec->nbVar * sizeof(char*) *FTI_BUFS);
+    char *ArrayOfStrings = ( char *) malloc (FTI_Exec->nbVar * sizeof(char) * FTI_BUFS);
 
     FTIT_dataset* data;
     if( FTI_Data->data( &data, FTI_Exec->nbVar ) != FTI_SCES ) return FTI_NSCS;
@@ -888,7 +901,7 @@ int FTI_CreateMetadata(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         myVarIDs[i] = data[i].id;
         myVarSizes[i] =  data[i].size;
         myVarPositions[i] = data[i].filePos;
-        strncpy(&ArrayOfStrings[i*FTI_BUFS], data[i].idChar, FTI_BUFS);
+        strncpy(&ArrayOfStrings[i*FTI_BUFS], data[i].attr->idChar, FTI_BUFS);
     }
 
     //Gather variables IDs
@@ -88,7 +88,8 @@ int FTI_SendCkpt(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, FTIT_ch
     }
     FTI_Print(str, FTI_DBUG);
 
-    FILE* lfd = fopen(lfn, "rb");
+    FTIT_handoff ho;
+    FILE* lfd = FTI_HandoffOpen(FTI_Conf, FTI_Exec, lfn, FTI_Exec->ckptMeta.fs, &ho);
     if (lfd == NULL) {
         FTI_Print("FTI failed to open L2 Ckpt. file.", FTI_DBUG);
         return FTI_NSCS;
@@ -105,7 +106,7 @@ int FTI_SendCkpt(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, FTIT_ch
     }
 
     free(buffer);
-    fclose(lfd);
+    FTI_HandoffClose(lfd, &ho);
 
     return FTI_SCES;
 }
@@ -179,9 +180,9 @@ int FTI_Ptner(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
 {
     FTI_Print("Starting checkpoint post-processing L2", FTI_DBUG);
     int startProc, endProc;
-    if (FTI_Topo->amIaHead) { //post-processing for every process in the node
-        startProc = 1;
-        endProc = FTI_Topo->nodeSize;
+    if (FTI_Topo->amIaHead) { //post-processing for every process of this head
+        startProc = FTI_Topo->bodyOffset;
+        endProc = FTI_Topo->bodyOffset + FTI_Topo->nbBody;
     }
     else { //post-processing only for itself
         startProc = 0;
@@ -192,6 +193,7 @@ int FTI_Ptner(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     int destination = FTI_Topo->right; //send Ckpt file to this process
     int i;
     for (i = startProc; i < endProc; i++) {
+        double t = FTI_TraceStart();
         if (FTI_Topo->amIaHead) {
             int res = FTI_Try(FTI_LoadMetaPostprocessing(FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt, i), "load temporary metadata.");
             if (res != FTI_SCES) {
@@ -217,6 +219,7 @@ int FTI_Ptner(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
                 return FTI_NSCS;
             }
         }
+        FTI_TraceEvent(FTI_TRACE_PARTNER, i, t, FTI_Exec->ckptMeta.fs + FTI_Exec->ckptMeta.pfs);
     }
     return FTI_SCES;
 }
@@ -242,8 +245,8 @@ int FTI_RSenc(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     FTI_Print("Starting checkpoint post-processing L3", FTI_DBUG);
     int startProc, endProc;
     if (FTI_Topo->amIaHead) {
-        startProc = 1;
-        endProc = FTI_Topo->nodeSize;
+        startProc = FTI_Topo->bodyOffset;
+        endProc = FTI_Topo->bodyOffset + FTI_Topo->nbBody;
     }
     else {
         startProc = 0;
@@ -307,7 +310,8 @@ int FTI_RSenc(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
             close( lftmp_ );
         }
 
-        FILE* lfd = fopen(lfn, "rb");
+        FTIT_handoff ho;
+        FILE* lfd = FTI_HandoffOpen(FTI_Conf, FTI_Exec, lfn, maxFs, &ho);
         if (lfd == NULL) {
             FTI_Print("FTI failed to open L3 checkpoint file.", FTI_EROR);
             return FTI_NSCS;
@@ -317,7 +321,7 @@ int FTI_RSenc(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         if (efd == NULL) {
             FTI_Print("FTI failed to open encoded ckpt. file.", FTI_EROR);
 
-            fclose(lfd);
+            FTI_HandoffClose(lfd, &ho);
 
             return FTI_NSCS;
         }
@@ -351,6 +355,7 @@ int FTI_RSenc(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         // For each block
         long pos = 0;
         while (pos < ps) {
+            double t = FTI_TraceStart();
             if ((maxFs - pos) < bs) {
                 remBsize = maxFs - pos;
             }
@@ -412,6 +417,7 @@ int FTI_RSenc(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
             // Writting encoded checkpoints
             fwrite(coding, sizeof(char), remBsize, efd);
             MD5_Update (&mdContext, coding, remBsize);
+            FTI_TraceEvent(FTI_TRACE_RS, pos / bs, t, remBsize);
 
             // Next block
             pos = pos + bs;
@@ -485,7 +491,7 @@ int FTI_RSenc(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         free(matrix);
         free(coding);
         free(myData);
-        fclose(lfd);
+        FTI_HandoffClose(lfd, &ho);
         fclose(efd);
 
         long fs = FTI_Exec->ckptMeta.fs; //ckpt file size
@@ -522,13 +528,13 @@ int FTI_RSenc(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
 int FTI_Flush(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         FTIT_topology* FTI_Topo, FTIT_checkpoint* FTI_Ckpt, int level)
 {
-    if (!FTI_Topo->amIaHead && level == 0) {
+    if (!FTI_Topo->amIaHead && level == 0 && FTI_Ckpt[4].isInline) {
         return FTI_SCES; //inline L4 saves directly to PFS (nothing to flush)
     }
 
     /**
      *  FTI_Flush is either executed by application processes during
-     *  FTI_Finalize or by the heads during FTI_PostCkpt.
+     *  FTI_Finalize or by the heads (or helper threads) during FTI_PostCkpt.
      **/
 
     char str[FTI_BUFS];
@@ -554,11 +560,19 @@ int FTI_Flush(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
             FTI_FlushPosix(FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt, level);
             break;
         case FTI_IO_MPI:
-            FTI_FlushMPI(FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt, level);
+            {
+                double t = FTI_TraceStart();
+                FTI_FlushMPI(FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt, level);
+                FTI_TraceEvent(FTI_TRACE_FLUSH, -1, t, FTI_Exec->ckptMeta.fs);
+            }
             break;
 #ifdef ENABLE_SIONLIB // --> If SIONlib is installed
         case FTI_IO_SIONLIB:
-            FTI_FlushSionlib(FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt, level);
+            {
+                double t = FTI_TraceStart();
+                FTI_FlushSionlib(FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt, level);
+                FTI_TraceEvent(FTI_TRACE_FLUSH, -1, t, FTI_Exec->ckptMeta.fs);
+            }
             break;
 #endif
     }
@@ -620,9 +634,9 @@ int FTI_ArchiveL4Ckpt( FTIT_configuration* FTI_Conf, FTIT_execution *FTI_Exec, F
             RENAME(fn_from, fn_to);
         } else {
             int i;
-            for ( i=1; i<FTI_Topo->nodeSize; ++i ) {
+            for ( i=0; i<FTI_Topo->nbBody; ++i ) {
                 char lastL4CkptFile[FTI_BUFS];
-                snprintf(lastL4CkptFile, FTI_BUFS, "Ckpt%d-Rank%d.%s", FTI_Exec->ckptMeta.ckptIdL4, FTI_Topo->body[i-1], FTI_Conf->suffix);
+                snprintf(lastL4CkptFile, FTI_BUFS, "Ckpt%d-Rank%d.%s", FTI_Exec->ckptMeta.ckptIdL4, FTI_Topo->body[i], FTI_Conf->suffix);
                 snprintf(fn_from, FTI_BUFS, "%s/%s", FTI_Ckpt[4].dir, lastL4CkptFile ); 
                 snprintf(fn_to, FTI_BUFS, "%s/%s", FTI_Ckpt[4].archDir, lastL4CkptFile ); 
                 RENAME(fn_from, fn_to);
@@ -671,8 +685,8 @@ int FTI_FlushPosix(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     FTI_Print("Starting checkpoint post-processing L4 using Posix IO.", FTI_DBUG);
     int startProc, endProc, proc;
     if (FTI_Topo->amIaHead) {
-        startProc = 1;
-        endProc = FTI_Topo->nodeSize;
+        startProc = FTI_Topo->bodyOffset;
+        endProc = FTI_Topo->bodyOffset + FTI_Topo->nbBody;
     }
     else {
         startProc = 0;
@@ -680,6 +694,7 @@ int FTI_FlushPosix(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     }
 
     for (proc = startProc; proc < endProc; proc++) {
+        double t = FTI_TraceStart();
         if (FTI_Topo->amIaHead) {
             int res = FTI_Try(FTI_LoadMetaPostprocessing(FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt, proc), "load temporary metadata.");
             if (res != FTI_SCES) {
@@ -697,6 +712,13 @@ int FTI_FlushPosix(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         }
         snprintf(str, FTI_BUFS, "Global temporary file name for proc %d: %s", proc, gfn);
         FTI_Print(str, FTI_DBUG);
+        if ( !FTI_Ckpt[4].isDcp ) {
+            int fileIdx = FTI_StripeIndex(FTI_Topo, (FTI_Topo->amIaHead) ? proc : FTI_Topo->nodeRank);
+            if (FTI_CreateStriped(FTI_Conf, gfn, FTI_Exec->ckptMeta.fs, fileIdx) != FTI_SCES) {
+                snprintf(str, FTI_BUFS, "Unable to stripe %s, it is created with the default layout.", gfn);
+                FTI_Print(str, FTI_WARN);
+            }
+        }
         FILE* gfd = fopen(gfn, "wb");
 
         if (gfd == NULL) {
@@ -716,8 +738,15 @@ int FTI_FlushPosix(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         }
         snprintf(str, FTI_BUFS, "Local file name for proc %d: %s", proc, lfn);
         FTI_Print(str, FTI_DBUG);
-        // Open local file
-        FILE* lfd = fopen(lfn, "rb");
+        // Open local file (or its shared memory copy)
+        FTIT_handoff ho;
+        FILE* lfd;
+        if (level == 0 && !FTI_Ckpt[4].isDcp) {
+            lfd = FTI_HandoffOpen(FTI_Conf, FTI_Exec, lfn, FTI_Exec->ckptMeta.fs, &ho);
+        } else {
+            ho.ptr = NULL;
+            lfd = fopen(lfn, "rb");
+        }
         if (lfd == NULL) {
             FTI_Print("L4 cannot open the checkpoint file.", FTI_EROR);
             fclose(gfd);
@@ -742,8 +771,9 @@ int FTI_FlushPosix(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
             pos = pos + bytes;
         }
         free(readData);
-        fclose(lfd);
+        FTI_HandoffClose(lfd, &ho);
         fclose(gfd);
+        FTI_TraceEvent(FTI_TRACE_FLUSH, proc, t, fs);
     }
     return FTI_SCES;
 }
@@ -775,12 +805,12 @@ int FTI_FlushMPI(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     write_info.FTI_Conf = FTI_Conf;
     write_info.FTI_Topo= FTI_Topo;
     write_info.flag = 'w';
-    FTI_MPIOOpen(gfn,&write_info);
+    write_info.fileSize = 0;
 
     int proc, startProc, endProc;
     if (FTI_Topo->amIaHead) {
-        startProc = 1;
-        endProc = FTI_Topo->nodeSize;
+        startProc = FTI_Topo->bodyOffset;
+        endProc = FTI_Topo->bodyOffset + FTI_Topo->nbBody;
     }
     else {
         startProc = 0;
@@ -805,7 +835,7 @@ int FTI_FlushMPI(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
             snprintf(&localFileNames[proc * FTI_BUFS], FTI_BUFS, "%s/%s", FTI_Ckpt[level].dir, FTI_Exec->ckptMeta.ckptFile);
         }
         if (FTI_Topo->amIaHead) {
-            splitRanks[proc] = (FTI_Topo->nodeSize - 1) * FTI_Topo->nodeID + proc - 1; //determine process splitRank if head
+            splitRanks[proc] = FTI_Topo->nbApprocs * FTI_Topo->nodeID + proc - FTI_Topo->nbHeads; //determine process splitRank if head
         }
         else {
             splitRanks[proc] = FTI_Topo->splitRank;
@@ -813,9 +843,21 @@ int FTI_FlushMPI(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         localFileSizes[proc - startProc] = FTI_Exec->ckptMeta.fs; //[proc - startProc] to get index from 0
     }
 
-    MPI_Offset* allFileSizes = talloc(MPI_Offset, FTI_Topo->nbApprocs * FTI_Topo->nbNodes);
-    MPI_Allgather(localFileSizes, nbProc, MPI_OFFSET, allFileSizes, nbProc, MPI_OFFSET, FTI_COMM_WORLD);
-    free(localFileSizes);
+    // the files of this process start after those of the lower ranks
+    MPI_Offset localSize = 0, offset = 0;
+    for (proc = 0; proc < nbProc; proc++) {
+        localSize += localFileSizes[proc];
+    }
+    MPI_Exscan(&localSize, &offset, 1, MPI_OFFSET, MPI_SUM, FTI_COMM_WORLD);
+    int commRank;
+    MPI_Comm_rank(FTI_COMM_WORLD, &commRank);
+    if (commRank == 0) {
+        offset = 0;
+    }
+    if (FTI_StripeOsts(FTI_Conf) > 0) {
+        MPI_Allreduce(&localSize, &write_info.fileSize, 1, MPI_OFFSET, MPI_SUM, FTI_COMM_WORLD);
+    }
+    FTI_MPIOOpen(gfn,&write_info);
 
 
     for (proc = startProc; proc < endProc; proc++) {
@@ -825,17 +867,14 @@ int FTI_FlushMPI(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
                 return FTI_NSCS;
             }
         }
-        int i;
-        write_info.offset = 0;
-        for (i = 0; i < splitRanks[proc]; i++) {
-            write_info.offset += allFileSizes[i];
-        }
+        write_info.offset = offset;
+        offset += localFileSizes[proc - startProc];
 
         FILE* lfd = fopen(&localFileNames[FTI_BUFS * proc], "rb");
         if (lfd == NULL) {
             FTI_Print("L4 cannot open the checkpoint file.", FTI_EROR);
             free(localFileNames);
-            free(allFileSizes);
+            free(localFileSizes);
             free(splitRanks);
             return FTI_NSCS;
         }
@@ -854,7 +893,7 @@ int FTI_FlushMPI(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
             size_t bytes;
             //#warning I also need to close pfh file but this marcro is not yet ready
             //                MPI_File_close(&pfh);
-            FREAD(FTI_NSCS, bytes,readData, sizeof(char), bSize, lfd,"pppp",localFileNames,allFileSizes,splitRanks,readData);
+            FREAD(FTI_NSCS, bytes,readData, sizeof(char), bSize, lfd,"pppp",localFileNames,localFileSizes,splitRanks,readData);
 
             FTI_MPIOWrite(readData, bytes,&write_info);
             pos = pos + bytes;
@@ -863,7 +902,7 @@ int FTI_FlushMPI(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         fclose(lfd);
     }
     free(localFileNames);
-    free(allFileSizes);
+    free(localFileSizes);
     free(splitRanks);
     FTI_MPIOClose(&write_info);
     return FTI_SCES;
@@ -890,8 +929,8 @@ int FTI_FlushSionlib(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     int proc, startProc, endProc;
     char fn[FTI_BUFS],str[FTI_BUFS];
     if (FTI_Topo->amIaHead) {
-        startProc = 1;
-        endProc = FTI_Topo->nodeSize;
+        startProc = FTI_Topo->bodyOffset;
+        endProc = FTI_Topo->bodyOffset + FTI_Topo->nbBody;
     }
     else {
         startProc = 0;
@@ -917,7 +956,7 @@ int FTI_FlushSionlib(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
             snprintf(&localFileNames[(proc-startProc) * FTI_BUFS], FTI_BUFS, "%s/%s", FTI_Ckpt[level].dir, FTI_Exec->ckptMeta.ckptFile);
         }
         if (FTI_Topo->amIaHead) {
-            splitRanks[proc-startProc] = (FTI_Topo->nodeSize - 1) * FTI_Topo->nodeID + proc - 1; //determine process splitRank if head
+            splitRanks[proc-startProc] = FTI_Topo->nbApprocs * FTI_Topo->nodeID + proc - FTI_Topo->nbHeads; //determine process splitRank if head
         }
         else {
             splitRanks[proc-startProc] = FTI_Topo->splitRank;
@@ -1061,10 +1061,7 @@ int FTI_RecoverL4Mpi(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     // enable collective buffer optimization
     MPI_Info info;
     MPI_Info_create(&info);
-    MPI_Info_set(info, "romio_cb_read", "enable");
-
-    // set stripping unit to 4MB
-    MPI_Info_set(info, "stripping_unit", "4194304");
+    FTI_MPIOSetHints(FTI_Conf, info, 'r');
 
     char gfn[FTI_BUFS], lfn[FTI_BUFS], gfp[FTI_BUFS];
     snprintf(FTI_Exec->ckptMeta.ckptFile, FTI_BUFS, "Ckpt%d-Rank%d.fti", FTI_Exec->ckptId, FTI_Topo->myRank);
@@ -1075,6 +1072,7 @@ int FTI_RecoverL4Mpi(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     // open parallel file
     MPI_File pfh;
     int buf = MPI_File_open(FTI_COMM_WORLD, gfp, MPI_MODE_RDWR, info, &pfh);
+    MPI_Info_free(&info);
     // check if successful
     if (buf != 0) {
         errno = 0;
@@ -1089,17 +1087,12 @@ int FTI_RecoverL4Mpi(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         return FTI_NSCS;
     }
 
-    // collect chunksizes of other ranks
-    MPI_Offset* chunkSizes = talloc(MPI_Offset, FTI_Topo->nbApprocs*FTI_Topo->nbNodes);
-    MPI_Allgather(&FTI_Exec->ckptMeta.fs, 1, MPI_OFFSET, chunkSizes, 1, MPI_OFFSET, FTI_COMM_WORLD);
-
-    MPI_Offset offset = 0;
-    // set file offset
-    int i;
-    for (i = 0; i < FTI_Topo->splitRank; i++) {
-        offset += chunkSizes[i];
+    // file offset is the sum of the chunk sizes of the lower ranks
+    MPI_Offset chunkSize = FTI_Exec->ckptMeta.fs, offset = 0;
+    MPI_Exscan(&chunkSize, &offset, 1, MPI_OFFSET, MPI_SUM, FTI_COMM_WORLD);
+    if (FTI_Topo->splitRank == 0) {
+        offset = 0;
     }
-    free(chunkSizes);
 
     MKDIR(FTI_Conf->lTmpDir,0777);
     FILE *lfd = fopen(lfn, "wb");
@@ -322,8 +322,8 @@ int FTI_RecoverFiles(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
                 if ( FTI_Conf->keepL4Ckpt ) {
                     ckptId = FTI_LoadL4CkptMetaData( FTI_Conf, FTI_Exec, FTI_Topo, FTI_Ckpt );
                     int hasL4Ckpt = ( ckptId >= 0 ) ? 1 : 0;
-                    if ( (FTI_Topo->nbHeads > 0 ) && (FTI_Topo->nodeRank == 1) ) {
-                        // send level and ckpt ID to head process in node
+                    if ( (FTI_Topo->nbHeads > 0 ) && (FTI_Topo->nodeRank == FTI_Topo->bodyOffset) ) {
+                        // send level and ckpt ID to the head serving this process
                         int sendBuf[2] = { hasL4Ckpt, ckptId };
                         MPI_Send( sendBuf, 2, MPI_INT, FTI_Topo->headRank, FTI_Conf->generalTag, FTI_Exec->globalComm ); 
                     }
@@ -367,7 +367,7 @@ int FTI_RecoverFiles(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
             return FTI_NSCS;
         }
         if ( FTI_Conf->keepL4Ckpt && !(FTI_Exec->reco == 3) ) {
-            // receive level and ckpt ID from first application process in node
+            // receive level and ckpt ID from first application process of this head
             int recvBuf[2];
             MPI_Recv( recvBuf, 2, MPI_INT, FTI_Topo->body[0], FTI_Conf->generalTag, FTI_Exec->globalComm, MPI_STATUS_IGNORE ); 
             if ( recvBuf[0] == 4 ) {
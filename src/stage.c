@@ -39,8 +39,14 @@
  *  @brief  helper functions for the FTI staging feature.
  */
 
+#define _GNU_SOURCE
 #include "interface.h"
 #include <libgen.h>
+#include <glob.h>
+#include <pthread.h>
+#ifdef __linux__
+#   include <sys/sendfile.h>
+#endif
 
 /**
  * @todo
@@ -63,55 +69,1001 @@
  * instructions are performed on a copy of the status field. The final
  * value of the copy is then assigned to the  original status field
  * variable in memory.
+ * @par
+ * The same holds for the 64-bit fields of the progress window, which
+ * are only written by one thread of the head at a time.
  *
  */
 
-/** MPI derived datatype to send staging info   */
-static MPI_Datatype buf_t;
+/** MPI derived datatype to send staging info   */
+static MPI_Datatype buf_t;
+
+/** 
+ * @brief Look-up table for the stage info request array elements. 
+ *
+ * The elements of the array, 'idxRequest', keep informations about 'ID'
+ * at 'idxRequest[ID]'.  These are a flag if for 'ID' exists an
+ * allocated request element and if, the index of the ID corresponding
+ * element fo 'FTI_Exec->stageInfo->request'. The two fields may be
+ * requested by 'FTI_GetRequestFiled' and may be set by
+ * 'FTI_SetRequestField'. The most significant 19 bits hold the indices
+ * and the 20th bit holds a flag that indicates if the ID has a
+ * corresponding request structure allocated. the bits 21 to 32 are
+ * free. Only the application ranks allocate memory for this field. The
+ * head processes use a linear search to locate the 'ID' corresponding
+ * request element.
+ **/
+static uint32_t *idxRequest;
+
+/** 
+ * @brief holds status of the user requested staging action. 
+ *
+ * this variable is a contiguous memory region partitioned into
+ * 'FTI_SI_MAX_NUM' 8 bit fields. The elements of the region are
+ * assigned to the corresponding 'ID' at 'status[ID]'. The first
+ * significant bit of the status field keeps a flag that indicates
+ * whether the 'ID' is available and the next 3 bits encode 5 statuses;
+ * 'not initialized', 'pending', 'active', 'failed' or 'success'. Only
+ * the application ranks allocate memory for this field (the heads never
+ * request staging). However, the field is exposed to all the ranks on
+ * the common node using a shared memory MPI window. Since the staging
+ * is supposed to operate asynchronously, this allows the dedicated
+ * process to set the proper status 'remotely'.     
+ **/
+static uint8_t *status;
+
+/** 
+ * @brief shared memory window to query the status field address. 
+ **/
+static MPI_Win stageWin;
+
+/** 
+ * @brief pointer to FTI_Conf->stagingEnabled (set in 'FTI_InitStage'). 
+ **/
+static bool *enableStagingPtr;
+
+/** 
+ * @brief receive buffer of the persistent stage request receive (head). 
+ **/
+static void *stageRecvBuf;
+
+/** 
+ * @brief persistent receive request for stage requests (head). 
+ **/
+static MPI_Request stageRecvReq = MPI_REQUEST_NULL;
+
+/** 
+ * @brief progress of the user requested staging action in bytes. 
+ *
+ * Same layout as 'status' (one element per 'ID'), exposed through the
+ * shared memory window 'progWin'. The head sets the file size when the
+ * request becomes active and the stage workers update the amount of
+ * staged bytes after each transfer. The fields are only valid if the
+ * request is active, failed or succeeded (not zeroed at allocation).
+ **/
+static FTIT_StageProgress *progress;
+
+/** 
+ * @brief shared memory window of the progress field. 
+ **/
+static MPI_Win progWin;
+
+/** @typedef    FTIT_StageFile
+ *  @brief      Small file packed into an archive object (head).
+ */
+typedef struct FTIT_StageFile {
+    char lpath[FTI_BUFS];           /**< local file path                */
+    char name[FTI_BUFS];            /**< path relative to the request   */
+    off_t size;                     /**< file size                      */
+    off_t offset;                   /**< offset of header in archive    */
+} FTIT_StageFile;
+
+/** @typedef    FTIT_StageBatch
+ *  @brief      Stage request of several files (see 'FTI_SendFiles').
+ */
+typedef struct FTIT_StageBatch {
+    int nbJobs;                     /**< unfinished jobs of request     */
+    int res;                        /**< result of the finished jobs    */
+    uint64_t done;                  /**< bytes staged by all the jobs   */
+} FTIT_StageBatch;
+
+/** @typedef    FTIT_StageJob
+ *  @brief      File copy of a stage request (head).
+ *
+ *  Either a single file ('files' is NULL) or an archive object holding
+ *  several small files of a batch. The files of batch jobs are opened
+ *  by the worker ('fdLocal' and 'fdGlobal' are -1).
+ */
+typedef struct FTIT_StageJob {
+    char lpath[FTI_BUFS];           /**< local file path                */
+    char rpath[FTI_BUFS];           /**< remote file path               */
+    int fdLocal;                    /**< local file descriptor          */
+    int fdGlobal;                   /**< remote file descriptor         */
+    off_t size;                     /**< file size                      */
+    size_t bs;                      /**< transfer size                  */
+    FTIT_StageFile *files;          /**< files packed in the archive    */
+    int nbFiles;                    /**< number of packed files         */
+    FTIT_StageBatch *batch;         /**< batch of the job (or NULL)     */
+    FTIT_StageProgress *prog;       /**< progress field of the request  */
+    int ID;                         /**< ID of request                  */
+    int source;                     /**< application rank of request    */
+    double tStart;                  /**< time the copy was dispatched   */
+    int res;                        /**< result of the copy             */
+    char errstr[FTI_BUFS];          /**< error message of the copy      */
+    struct FTIT_StageJob *next;     /**< next element in list           */
+} FTIT_StageJob;
+
+/** @typedef    FTIT_StagePool
+ *  @brief      Worker threads performing the file copies (head).
+ *
+ *  The workers never call MPI or FTI_Print, the status of the finished
+ *  copies is set by the head in 'FTI_ProgressStage'. While the head
+ *  post-processes a checkpoint, the copies pause at the next transfer
+ *  boundary, unless they were dispatched more than 'deadline' seconds
+ *  ago.
+ */
+typedef struct FTIT_StagePool {
+    pthread_t *thread;              /**< worker threads                 */
+    int nbWorkers;                  /**< number of worker threads       */
+    pthread_mutex_t mutex;          /**< protects the job lists         */
+    pthread_cond_t cond;            /**< signals new jobs or stop       */
+    FTIT_StageJob *todoFirst;       /**< jobs waiting for a worker      */
+    FTIT_StageJob *todoLast;        /**< last job waiting for a worker  */
+    FTIT_StageJob *done;            /**< finished jobs                  */
+    int inFlight;                   /**< dispatched, not yet finished   */
+    bool stop;                      /**< TRUE if workers have to return */
+    bool preempt;                   /**< TRUE while a ckpt is processed */
+    pthread_cond_t resume;          /**< signals the end of preemption  */
+    int deadline;                   /**< seconds a copy may be preempted*/
+} FTIT_StagePool;
+
+/** 
+ * @brief stage workers of the head. 
+ **/
+static FTIT_StagePool pool;
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Returns the time of the monotonic clock in seconds.
+  @return     time in seconds.
+ **/
+/*-------------------------------------------------------------------------*/
+static double FTI_StageNow( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Pauses a copy while the head post-processes a checkpoint.
+  @param      job             running file copy.
+
+  Called by the stage workers between two transfers. The copy resumes
+  at the same position when the preemption ends or when the copy passes
+  its deadline ('Advanced:stage_deadline'), so checkpoints cannot
+  starve the staging.
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_StageYield( FTIT_StageJob *job )
+{
+
+    if ( pool.nbWorkers == 0 ) {
+        return;
+    }
+
+    // 'preempt' is set by the head, it is only read under the lock
+    double tEnd = job->tStart + pool.deadline;
+    struct timespec ts;
+    ts.tv_sec = (time_t) tEnd;
+    ts.tv_nsec = (long) ((tEnd - ts.tv_sec) * 1e9);
+
+    pthread_mutex_lock( &pool.mutex );
+    while ( pool.preempt && (FTI_StageNow() < tEnd) ) {
+        pthread_cond_timedwait( &pool.resume, &pool.mutex, &ts );
+    }
+    pthread_mutex_unlock( &pool.mutex );
+
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Adds staged bytes to the progress field of the request.
+  @param      job             running file copy.
+  @param      bytes           number of bytes staged.
+
+  The jobs of a batch may run concurrently and share the field.
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_StageAddProgress( FTIT_StageJob *job, off_t bytes )
+{
+
+    if ( job->prog == NULL ) {
+        return;
+    }
+
+    if ( job->batch == NULL ) {
+        job->prog->done += bytes;
+        return;
+    }
+
+    if ( pool.nbWorkers > 0 ) {
+        pthread_mutex_lock( &pool.mutex );
+    }
+    job->batch->done += bytes;
+    job->prog->done = job->batch->done;
+    if ( pool.nbWorkers > 0 ) {
+        pthread_mutex_unlock( &pool.mutex );
+    }
+
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Copies data from a local file to a file on the PFS.
+  @param      job             running file copy.
+  @param      fd_in           local file descriptor.
+  @param      fd_out          remote file descriptor.
+  @param      lpath           local file path (for error messages).
+  @param      size            number of bytes to copy (from offset 0).
+  @param      off_out         offset in the remote file.
+  @return     'FTI_SCES' on success, 'FTI_NSCS' else.
+
+  The copy is done in the kernel with 'copy_file_range', or 'sendfile'
+  if the file systems do not support the former, and with 'pread' and
+  'pwrite' as last resort. The transfers are of at most 'transferSize'
+  bytes and the progress field is updated after each of them. Between
+  two transfers, the copy may be preempted by a checkpoint.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_StageCopyData( FTIT_StageJob *job, int fd_in, int fd_out, char *lpath, off_t size, off_t off_out )
+{
+
+    int mode = 0; // 0: copy_file_range, 1: sendfile, 2: pread/pwrite
+    char *buf = NULL;
+    off_t pos = 0;
+    ssize_t bytes;
+    int res = FTI_SCES;
+    while( pos < size ) {
+        FTI_StageYield( job );
+        size_t count = ( (size - pos) < job->bs ) ? size - pos : job->bs;
+        if ( mode == 0 ) {
+#ifdef HAVE_COPY_FILE_RANGE
+            loff_t off_in = pos, off_dst = off_out + pos;
+            bytes = copy_file_range( fd_in, &off_in, fd_out, &off_dst, count, 0 );
+#else
+            bytes = -1;
+            errno = ENOSYS;
+#endif
+            if ( (bytes == -1) && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP) ) {
+                mode = 1;
+                continue;
+            }
+        } else if ( mode == 1 ) {
+#ifdef __linux__
+            off_t off_in = pos;
+            bytes = -1;
+            if ( lseek( fd_out, off_out + pos, SEEK_SET ) != -1 ) {
+                bytes = sendfile( fd_out, fd_in, &off_in, count );
+            }
+#else
+            bytes = -1;
+            errno = ENOSYS;
+#endif
+            if ( (bytes == -1) && (errno == ENOSYS || errno == EINVAL) ) {
+                mode = 2;
+                continue;
+            }
+        } else {
+            if ( buf == NULL ) {
+                buf = (char*) malloc( job->bs );
+                if ( buf == NULL ) {
+                    snprintf( job->errstr, FTI_BUFS, "failed to allocate memory for 'buf' in 'FTI_StageCopyData'" );
+                    res = FTI_NSCS;
+                    break;
+                }
+            }
+            // for the case we have written less then we have read, the
+            // next read starts at 'pos'
+            bytes = pread( fd_in, buf, count, pos );
+            if ( bytes > 0 ) {
+                bytes = pwrite( fd_out, buf, bytes, off_out + pos );
+            }
+        }
+        if ( bytes == -1 ) {
+            snprintf( job->errstr, FTI_BUFS, "unable to copy '%s' to '%s' (%s).", lpath, job->rpath, strerror(errno) );
+            errno = 0;
+            res = FTI_NSCS;
+            break;
+        }
+        if ( bytes == 0 ) {
+            snprintf( job->errstr, FTI_BUFS, "unexpected end of file '%s', staging failed.", lpath );
+            res = FTI_NSCS;
+            break;
+        }
+        pos += bytes;
+        FTI_StageAddProgress( job, bytes );
+    }
+
+    free( buf );
+
+    return res;
+
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Copies the local file of a stage request to the PFS.
+  @param      job             file copy to perform.
+  @return     'FTI_SCES' on success, 'FTI_NSCS' else.
+
+  Opens the files if not done yet and closes them.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_StageCopyFile( FTIT_StageJob *job )
+{
+
+    if ( job->fdLocal == -1 ) {
+        job->fdLocal = open( job->lpath, O_RDONLY );
+        if ( job->fdLocal == -1 ) {
+            snprintf( job->errstr, FTI_BUFS, "Could not open the local file '%s' for staging.", job->lpath );
+            if ( job->fdGlobal != -1 ) {
+                close( job->fdGlobal );
+            }
+            return FTI_NSCS;
+        }
+    }
+    if ( job->fdGlobal == -1 ) {
+        job->fdGlobal = open( job->rpath, O_WRONLY|O_CREAT, (mode_t) 0600 );
+        if ( job->fdGlobal == -1 ) {
+            snprintf( job->errstr, FTI_BUFS, "Could not open the destination file '%s' for staging.", job->rpath );
+            close( job->fdLocal );
+            return FTI_NSCS;
+        }
+    }
+
+    // the local file is read once, sequentially
+    posix_fadvise( job->fdLocal, 0, job->size, POSIX_FADV_SEQUENTIAL );
+
+    int res = FTI_StageCopyData( job, job->fdLocal, job->fdGlobal, job->lpath, job->size, 0 );
+
+    // we do not need the local data in the page cache anymore
+    posix_fadvise( job->fdLocal, 0, job->size, POSIX_FADV_DONTNEED );
+    close( job->fdLocal );
+    if ( res == FTI_SCES ) {
+        // remote file might have existed and been larger
+        if ( ftruncate( job->fdGlobal, job->size ) == -1 ) {
+            snprintf( job->errstr, FTI_BUFS, "unable to truncate '%s'.", job->rpath );
+            res = FTI_NSCS;
+        }
+        fsync( job->fdGlobal );
+    }
+    close( job->fdGlobal );
+
+    return res;
+
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Packs the small files of a batch into an archive object.
+  @param      job             archive to write.
+  @return     'FTI_SCES' on success, 'FTI_NSCS' else.
+
+  The archive is a POSIX tar (ustar) archive and can be extracted with
+  any tar implementation. The offsets of the file headers are planned by
+  the head, the padding and the end-of-archive blocks are written by
+  truncating the archive to its final size.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_StagePackFiles( FTIT_StageJob *job )
+{
+
+    int fd_out = open( job->rpath, O_WRONLY|O_CREAT|O_TRUNC, (mode_t) 0600 );
+    if ( fd_out == -1 ) {
+        snprintf( job->errstr, FTI_BUFS, "Could not open the archive '%s' for staging.", job->rpath );
+        return FTI_NSCS;
+    }
+
+    int res = FTI_SCES;
+    int i;
+    for ( i=0; (i<job->nbFiles) && (res == FTI_SCES); ++i ) {
+        FTIT_StageFile *file = &job->files[i];
+        int fd_in = open( file->lpath, O_RDONLY );
+        if ( fd_in == -1 ) {
+            snprintf( job->errstr, FTI_BUFS, "Could not open the local file '%s' for staging.", file->lpath );
+            res = FTI_NSCS;
+            break;
+        }
+        struct stat st;
+        if ( fstat( fd_in, &st ) == -1 ) {
+            snprintf( job->errstr, FTI_BUFS, "Could not stat the local file '%s' for staging.", file->lpath );
+            close( fd_in );
+            res = FTI_NSCS;
+            break;
+        }
+
+        // ustar header
+        char hdr[FTI_SI_TAR_BLOCK];
+        memset( hdr, 0x0, FTI_SI_TAR_BLOCK );
+        strncpy( hdr, file->name, 100 );
+        snprintf( hdr + 100, 8, "%07o", 0600 );
+        snprintf( hdr + 108, 8, "%07o", 0 );
+        snprintf( hdr + 116, 8, "%07o", 0 );
+        snprintf( hdr + 124, 12, "%011llo", (unsigned long long) file->size );
+        snprintf( hdr + 136, 12, "%011llo", (unsigned long long) st.st_mtime );
+        memset( hdr + 148, ' ', 8 );
+        hdr[156] = '0';
+        memcpy( hdr + 257, "ustar", 6 );
+        memcpy( hdr + 263, "00", 2 );
+        unsigned int chksum = 0;
+        int j;
+        for ( j=0; j<FTI_SI_TAR_BLOCK; ++j ) {
+            chksum += (unsigned char) hdr[j];
+        }
+        snprintf( hdr + 148, 8, "%06o", chksum );
+        hdr[155] = ' ';
+
+        if ( pwrite( fd_out, hdr, FTI_SI_TAR_BLOCK, file->offset ) != FTI_SI_TAR_BLOCK ) {
+            snprintf( job->errstr, FTI_BUFS, "unable to write to '%s'.", job->rpath );
+            res = FTI_NSCS;
+        } else {
+            posix_fadvise( fd_in, 0, file->size, POSIX_FADV_SEQUENTIAL );
+            res = FTI_StageCopyData( job, fd_in, fd_out, file->lpath, file->size, file->offset + FTI_SI_TAR_BLOCK );
+            posix_fadvise( fd_in, 0, file->size, POSIX_FADV_DONTNEED );
+        }
+        close( fd_in );
+    }
+
+    if ( res == FTI_SCES ) {
+        // zero padding and end-of-archive blocks
+        if ( ftruncate( fd_out, job->size ) == -1 ) {
+            snprintf( job->errstr, FTI_BUFS, "unable to truncate '%s'.", job->rpath );
+            res = FTI_NSCS;
+        }
+        fsync( fd_out );
+    }
+    close( fd_out );
+
+    return res;
+
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Performs a file copy of a stage request.
+  @param      job             file copy to perform.
+  @return     'FTI_SCES' on success, 'FTI_NSCS' else.
+
+  Does not call MPI, thus may be executed by the stage workers.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_StageRunJob( FTIT_StageJob *job )
+{
+    double tt = FTI_TraceStart();
+    int res = ( job->files == NULL ) ? FTI_StageCopyFile( job ) : FTI_StagePackFiles( job );
+    FTI_TraceEvent( FTI_TRACE_STAGE, job->ID, tt, job->size );
+    return res;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Main loop of the stage workers.
+  @param      arg             unused.
+  @return     void*           NULL.
+ **/
+/*-------------------------------------------------------------------------*/
+static void* FTI_StageWorker( void *arg )
+{
+
+    pthread_mutex_lock( &pool.mutex );
+    while ( true ) {
+        while ( (pool.todoFirst == NULL) && !pool.stop ) {
+            pthread_cond_wait( &pool.cond, &pool.mutex );
+        }
+        if ( pool.todoFirst == NULL ) {
+            break;
+        }
+        FTIT_StageJob *job = pool.todoFirst;
+        pool.todoFirst = job->next;
+        if ( pool.todoFirst == NULL ) {
+            pool.todoLast = NULL;
+        }
+        pthread_mutex_unlock( &pool.mutex );
+
+        job->res = FTI_StageRunJob( job );
+
+        pthread_mutex_lock( &pool.mutex );
+        job->next = pool.done;
+        pool.done = job;
+    }
+    pthread_mutex_unlock( &pool.mutex );
+
+    return NULL;
+
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Starts the stage workers of the head.
+  @param      nbWorkers       number of worker threads.
+  @param      deadline        seconds a copy may be preempted.
+
+  If no thread can be started, the head performs the copies itself.
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_InitStagePool( int nbWorkers, int deadline )
+{
+
+    memset( &pool, 0x0, sizeof(FTIT_StagePool) );
+    pool.deadline = deadline;
+    if ( nbWorkers <= 0 ) {
+        return;
+    }
+
+    pool.thread = malloc( nbWorkers * sizeof(pthread_t) );
+    if ( pool.thread == NULL ) {
+        FTI_Print( "failed to allocate memory for the stage workers, staging is done by the head.", FTI_WARN );
+        return;
+    }
+    pthread_mutex_init( &pool.mutex, NULL );
+    pthread_cond_init( &pool.cond, NULL );
+    pthread_condattr_t attr;
+    pthread_condattr_init( &attr );
+    pthread_condattr_setclock( &attr, CLOCK_MONOTONIC );
+    pthread_cond_init( &pool.resume, &attr );
+    pthread_condattr_destroy( &attr );
+
+    int i;
+    for ( i=0; i<nbWorkers; ++i ) {
+        if ( pthread_create( &pool.thread[i], NULL, FTI_StageWorker, NULL ) != 0 ) {
+            break;
+        }
+        pool.nbWorkers++;
+    }
+    if ( pool.nbWorkers < nbWorkers ) {
+        char str[FTI_BUFS];
+        snprintf( str, FTI_BUFS, "Could only start %d of %d stage workers.", pool.nbWorkers, nbWorkers );
+        FTI_Print( str, FTI_WARN );
+    }
+    if ( pool.nbWorkers == 0 ) {
+        free( pool.thread );
+        pool.thread = NULL;
+        pthread_mutex_destroy( &pool.mutex );
+        pthread_cond_destroy( &pool.cond );
+        pthread_cond_destroy( &pool.resume );
+    }
+
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Stops the stage workers of the head.
+
+  All the dispatched copies have to be finished ('FTI_StageInFlight').
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_FinalizeStagePool( void )
+{
+
+    if ( pool.nbWorkers == 0 ) {
+        return;
+    }
+
+    pthread_mutex_lock( &pool.mutex );
+    pool.stop = true;
+    pool.preempt = false;
+    pthread_cond_broadcast( &pool.cond );
+    pthread_cond_broadcast( &pool.resume );
+    pthread_mutex_unlock( &pool.mutex );
+
+    int i;
+    for ( i=0; i<pool.nbWorkers; ++i ) {
+        pthread_join( pool.thread[i], NULL );
+    }
+
+    free( pool.thread );
+    pthread_mutex_destroy( &pool.mutex );
+    pthread_cond_destroy( &pool.cond );
+    pthread_cond_destroy( &pool.resume );
+    pool.nbWorkers = 0;
+
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Returns the progress field of a stage request.
+  @param      integer         'ID' of staging request
+  @param      integer         'source', application rank of stage request.
+  @return     pointer to the field in the shared memory window.
+ **/
+/*-------------------------------------------------------------------------*/
+static FTIT_StageProgress* FTI_GetProgressPtr( int ID, int source )
+{
+
+    int disp;
+    MPI_Aint size;
+    FTIT_StageProgress *prog;
+    MPI_Win_shared_query( progWin, source, &size, &disp, &prog ); 
+
+    return &prog[ID];
+
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Sets the status of a finished copy and frees the request.
+
+  The request of a batch is finished with the last of its jobs.
+  @param      FTI_Exec        Execution metadata.
+  @param      FTI_Topo        Topology metadata.
+  @param      job             finished file copy (freed by this function).
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_FinishStageJob( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo, FTIT_StageJob *job )
+{
+
+    int res = job->res;
+    if ( res != FTI_SCES ) {
+        FTI_Print( job->errstr, FTI_EROR );
+    }
+
+    // the request of a batch is finished with its last job
+    FTIT_StageBatch *batch = job->batch;
+    if ( batch != NULL ) {
+        if ( res != FTI_SCES ) {
+            batch->res = FTI_NSCS;
+        }
+        res = batch->res;
+        if ( --batch->nbJobs > 0 ) {
+            free( job->files );
+            free( job );
+            return;
+        }
+        free( batch );
+    }
+
+    if ( res == FTI_SCES ) {
+        FTI_SetStatusField( FTI_Exec, FTI_Topo, job->ID, FTI_SI_SCES, FTI_SIF_VAL, job->source );
+    } else {
+        FTI_SetStatusField( FTI_Exec, FTI_Topo, job->ID, FTI_SI_FAIL, FTI_SIF_VAL, job->source );
+    }
+    FTI_FreeStageRequest( FTI_Exec, FTI_Topo, job->ID, job->source );
+    free( job->files );
+    free( job );
+
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Returns the length of the directory prefix of a glob pattern.
+  @param      pattern         glob pattern.
+  @return     size_t          length of the prefix, with its last '/'.
+
+  The prefix is the part of 'pattern' up to the last '/' before the
+  first wildcard. 'glob' keeps it unchanged in the matched paths, the
+  rest of a path is the name of the file relative to the request.
+ **/
+/*-------------------------------------------------------------------------*/
+static size_t FTI_StageBaseLength( const char *pattern )
+{
+    size_t wild = strcspn( pattern, "*?[\\" );
+    size_t len = 0;
+    size_t i;
+    for ( i=0; i<wild; ++i ) {
+        if ( pattern[i] == '/' ) {
+            len = i + 1;
+        }
+    }
+    return len;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Creates the directories of a relative file path in 'rdir'.
+  @param      rdir            remote directory.
+  @param      name            file path relative to 'rdir'.
+  @return     'FTI_SCES' on success, 'FTI_NSCS' else.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_StageMakeDirs( const char *rdir, const char *name )
+{
+    char path[FTI_BUFS];
+    const char *sep;
+    for ( sep = strchr( name, '/' ); sep; sep = strchr( sep + 1, '/' ) ) {
+        snprintf( path, FTI_BUFS, "%s/%.*s", rdir, (int)( sep - name ), name );
+        if ( mkdir( path, (mode_t) 0700 ) != 0 && errno != EEXIST ) {
+            char errstr[FTI_BUFS];
+            snprintf( errstr, FTI_BUFS, "Could not create the remote directory '%s'.", path );
+            FTI_Print( errstr, FTI_EROR );
+            errno = 0;
+            return FTI_NSCS;
+        }
+    }
+    errno = 0;
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Creates the file copies of a batch stage request.
+  @param      lpattern        local directory or glob pattern.
+  @param      rdir            remote directory.
+  @param      FTI_Conf        Configuration metadata.
+  @param      rank            global rank of the requesting process.
+  @param      ID              'ID' of staging request.
+  @param      source          application rank of stage request.
+  @param      first           list of the file copies [out].
+  @return     'FTI_SCES' on success, 'FTI_NSCS' else.
+
+  The regular files matching 'lpattern' (all files of the directory if
+  'lpattern' is a directory) of at most 'Advanced:stage_pack_file'
+  bytes are packed into archive objects 'Stage-Rank<r>-ID<id>-<n>.tar'
+  of at most 'Advanced:stage_pack_size' bytes, the larger files are
+  copied on their own into 'rdir'. The index 'Stage-Rank<r>-ID<id>.idx'
+  lists for every file the object and offset holding its data. Thus,
+  the PFS sees a few large files instead of a metadata operation per
+  file. The list is empty if no file matches.
+
+  The files are named by their path relative to the directory part of
+  the pattern, e.g. 'a/f' and 'b/f' for the files '<dir>/a/f' and
+  '<dir>/b/f' of the pattern '<dir>/?/f', in the archives as well as in
+  'rdir'. Every line of the index reads
+  '<len>:<name> <len>:<object> <offset> <size>', the lengths in bytes
+  delimit names holding blanks or newlines.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_StagePlanBatch( char *lpattern, char *rdir, FTIT_configuration *FTI_Conf, 
+        int rank, int ID, int source, FTIT_StageJob **first )
+{
+
+    char errstr[FTI_BUFS];
+    char pattern[FTI_BUFS];
+    struct stat st;
+
+    *first = NULL;
+
+    if ( stat( rdir, &st ) != 0 || !S_ISDIR(st.st_mode) ) {
+        snprintf( errstr, FTI_BUFS, "'%s' is not a directory, abort staging.", rdir );
+        FTI_Print( errstr, FTI_EROR );
+        return FTI_NSCS;
+    }
+
+    if ( stat( lpattern, &st ) == 0 && S_ISDIR(st.st_mode) ) {
+        snprintf( pattern, FTI_BUFS, "%s/*", lpattern );
+    } else {
+        strncpy( pattern, lpattern, FTI_BUFS-1 );
+        pattern[FTI_BUFS-1] = '\0';
+    }
+    size_t baseLen = FTI_StageBaseLength( pattern );
+
+    glob_t gl;
+    int res = glob( pattern, 0, NULL, &gl );
+    size_t nbPaths = ( res == 0 ) ? gl.gl_pathc : 0;
+    if ( res != 0 && res != GLOB_NOMATCH ) {
+        snprintf( errstr, FTI_BUFS, "Could not expand '%s' for staging.", pattern );
+        FTI_Print( errstr, FTI_EROR );
+        return FTI_NSCS;
+    }
+
+    char ipath[FTI_BUFS];
+    snprintf( ipath, FTI_BUFS, "%s/Stage-Rank%d-ID%d.idx", rdir, rank, ID );
+    FILE *index = fopen( ipath, "w" );
+    if ( index == NULL ) {
+        snprintf( errstr, FTI_BUFS, "Could not open the stage index '%s'.", ipath );
+        FTI_Print( errstr, FTI_EROR );
+        globfree( &gl );
+        return FTI_NSCS;
+    }
+
+    FTIT_StageBatch *batch = calloc( 1, sizeof(FTIT_StageBatch) );
+    if ( batch == NULL ) {
+        FTI_Print( "failed to allocate memory for 'batch' in 'FTI_StagePlanBatch'", FTI_EROR );
+        fclose( index );
+        globfree( &gl );
+        return FTI_NSCS;
+    }
+    batch->res = FTI_SCES;
+
+    FTIT_StageJob *last = NULL;
+    FTIT_StageJob *archive = NULL;  // archive object being filled
+    int nbArchives = 0;
+    uint64_t total = 0;
+    res = FTI_SCES;
+
+    size_t i;
+    for ( i=0; (res == FTI_SCES) && (i<nbPaths); ++i ) {
+        char *lpath = gl.gl_pathv[i];
+        if ( stat( lpath, &st ) != 0 || !S_ISREG(st.st_mode) ) {
+            continue;
+        }
+        char *name = lpath + baseLen;
+        // the files must stay in 'rdir'
+        if ( strcmp( name, ".." ) == 0 || strncmp( name, "../", 3 ) == 0 || strstr( name, "/../" ) ) {
+            snprintf( errstr, FTI_BUFS, "'%s' is not below the directory of '%s', abort staging.", lpath, lpattern );
+            FTI_Print( errstr, FTI_EROR );
+            res = FTI_NSCS;
+            break;
+        }
+
+        // ustar headers hold names of up to 100 characters
+        bool pack = ( st.st_size <= FTI_Conf->stagePackFile ) && ( strlen( name ) < 100 );
+        off_t padded = ( st.st_size + FTI_SI_TAR_BLOCK - 1 ) / FTI_SI_TAR_BLOCK * FTI_SI_TAR_BLOCK;
+
+        // close the archive object if the file does not fit
+        if ( pack && archive && archive->nbFiles > 0 && 
+                (archive->size + FTI_SI_TAR_BLOCK + padded + 2*FTI_SI_TAR_BLOCK > FTI_Conf->stagePackSize) ) {
+            archive->size += 2*FTI_SI_TAR_BLOCK;
+            archive = NULL;
+        }
+
+        FTIT_StageJob *job = ( pack ) ? archive : NULL;
+        if ( job == NULL ) {
+            job = calloc( 1, sizeof(FTIT_StageJob) );
+            if ( job == NULL ) {
+                FTI_Print( "failed to allocate memory for 'job' in 'FTI_StagePlanBatch'", FTI_EROR );
+                res = FTI_NSCS;
+                break;
+            }
+            job->fdLocal = -1;
+            job->fdGlobal = -1;
+            job->bs = FTI_Conf->transferSize;
+            job->batch = batch;
+            job->ID = ID;
+            job->source = source;
+            job->tStart = FTI_StageNow();
+            if ( pack ) {
+                snprintf( job->lpath, FTI_BUFS, "%s", lpattern );
+                snprintf( job->rpath, FTI_BUFS, "%s/Stage-Rank%d-ID%d-%d.tar", rdir, rank, ID, nbArchives++ );
+                archive = job;
+            } else {
+                snprintf( job->lpath, FTI_BUFS, "%s", lpath );
+                snprintf( job->rpath, FTI_BUFS, "%s/%s", rdir, name );
+                job->size = st.st_size;
+                res = FTI_StageMakeDirs( rdir, name );
+            }
+            if ( last ) {
+                last->next = job;
+            } else {
+                *first = job;
+            }
+            last = job;
+            batch->nbJobs++;
+        }
+
+        if ( pack ) {
+            FTIT_StageFile *files = realloc( job->files, (job->nbFiles+1) * sizeof(FTIT_StageFile) );
+            if ( files == NULL ) {
+                FTI_Print( "failed to allocate memory for 'files' in 'FTI_StagePlanBatch'", FTI_EROR );
+                res = FTI_NSCS;
+                break;
+            }
+            job->files = files;
+            FTIT_StageFile *file = &job->files[job->nbFiles++];
+            snprintf( file->lpath, FTI_BUFS, "%s", lpath );
+            snprintf( file->name, FTI_BUFS, "%s", name );
+            file->size = st.st_size;
+            file->offset = job->size;
+            job->size += FTI_SI_TAR_BLOCK + padded;
+            char *object = strrchr( job->rpath, '/' ) + 1;
+            fprintf( index, "%zu:%s %zu:%s %lld %lld\n", strlen( name ), name, strlen( object ), object,
+                    (long long) file->offset + FTI_SI_TAR_BLOCK, (long long) file->size );
+        } else {
+            fprintf( index, "%zu:%s %zu:%s 0 %lld\n", strlen( name ), name, strlen( name ), name,
+                    (long long) st.st_size );
+        }
+        total += st.st_size;
+    }
+    if ( archive ) {
+        archive->size += 2*FTI_SI_TAR_BLOCK;
+    }
+
+    globfree( &gl );
+
+    if ( fclose( index ) != 0 && res == FTI_SCES ) {
+        snprintf( errstr, FTI_BUFS, "Could not write the stage index '%s'.", ipath );
+        FTI_Print( errstr, FTI_EROR );
+        res = FTI_NSCS;
+    }
+
+    if ( res != FTI_SCES || *first == NULL ) {
+        while ( *first ) {
+            FTIT_StageJob *next = (*first)->next;
+            free( (*first)->files );
+            free( *first );
+            *first = next;
+        }
+        free( batch );
+        return res;
+    }
+
+    FTIT_StageProgress *prog = FTI_GetProgressPtr( ID, source );
+    prog->size = total;
+    prog->done = 0;
+    FTIT_StageJob *job;
+    for ( job = *first; job; job = job->next ) {
+        job->prog = prog;
+    }
+
+    return FTI_SCES;
+
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Stages the files of a batch stage request (head).
+  @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Exec        Execution metadata.
+  @param      FTI_Topo        Topology metadata.
+  @param      lpattern        local directory or glob pattern.
+  @param      rdir            remote directory.
+  @param      ID              'ID' of staging request.
+  @param      source          application rank of stage request.
+  @param      rank            global rank of the requesting process.
+  @return     'FTI_SCES' on success, 'FTI_NSCS' else.
+
+  The archive objects and file copies are staged concurrently by the
+  stage workers, the request is finished with the last of them.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_HandleStageBatch( FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, 
+        FTIT_topology* FTI_Topo, char *lpattern, char *rdir, int ID, int source, int rank )
+{
+
+    if ( FTI_InitStageRequestHead( lpattern, rdir, FTI_Exec, FTI_Topo, source, ID ) != FTI_SCES ) {
+        FTI_Print( "failed to initialize stage request meta info!", FTI_WARN );
+        FTI_SetStatusField( FTI_Exec, FTI_Topo, ID, FTI_SI_FAIL, FTI_SIF_VAL, source );
+        return FTI_NSCS;
+    }
 
-/** 
- * @brief Look-up table for the stage info request array elements. 
- *
- * The elements of the array, 'idxRequest', keep informations about 'ID'
- * at 'idxRequest[ID]'.  These are a flag if for 'ID' exists an
- * allocated request element and if, the index of the ID corresponding
- * element fo 'FTI_Exec->stageInfo->request'. The two fields may be
- * requested by 'FTI_GetRequestFiled' and may be set by
- * 'FTI_SetRequestField'. The most significant 19 bits hold the indices
- * and the 20th bit holds a flag that indicates if the ID has a
- * corresponding request structure allocated. the bits 21 to 32 are
- * free. Only the application ranks allocate memory for this field. The
- * head processes use a linear search to locate the 'ID' corresponding
- * request element.
- **/
-static uint32_t *idxRequest;
+    FTIT_StageJob *job;
+    if ( FTI_StagePlanBatch( lpattern, rdir, FTI_Conf, rank, ID, source, &job ) != FTI_SCES ) {
+        FTI_FreeStageRequest( FTI_Exec, FTI_Topo, ID, source );
+        FTI_SetStatusField( FTI_Exec, FTI_Topo, ID, FTI_SI_FAIL, FTI_SIF_VAL, source );
+        return FTI_NSCS;
+    }
 
-/** 
- * @brief holds status of the user requested staging action. 
- *
- * this variable is a contiguous memory region partitioned into
- * 'FTI_SI_MAX_NUM' 8 bit fields. The elements of the region are
- * assigned to the corresponding 'ID' at 'status[ID]'. The first
- * significant bit of the status field keeps a flag that indicates
- * whether the 'ID' is available and the next 3 bits encode 5 statuses;
- * 'not initialized', 'pending', 'active', 'failed' or 'success'. Only
- * the application ranks allocate memory for this field (the heads never
- * request staging). However, the field is exposed to all the ranks on
- * the common node using a shared memory MPI window. Since the staging
- * is supposed to operate asynchronously, this allows the dedicated
- * process to set the proper status 'remotely'.     
- **/
-static uint8_t *status;
+    if ( job == NULL ) {
+        FTI_FreeStageRequest( FTI_Exec, FTI_Topo, ID, source );
+        FTI_SetStatusField( FTI_Exec, FTI_Topo, ID, FTI_SI_SCES, FTI_SIF_VAL, source );
+        return FTI_SCES;
+    }
 
-/** 
- * @brief shared memory window to query the status field address. 
- **/
-static MPI_Win stageWin;
+    // without workers, the head copies the files itself
+    if ( pool.nbWorkers == 0 ) {
+        int res = job->batch->res;
+        while ( job ) {
+            FTIT_StageJob *next = job->next;
+            job->res = FTI_StageRunJob( job );
+            res = ( job->res == FTI_SCES ) ? res : FTI_NSCS;
+            FTI_FinishStageJob( FTI_Exec, FTI_Topo, job );
+            job = next;
+        }
+        return res;
+    }
 
-/** 
- * @brief pointer to FTI_Conf->stagingEnabled (set in 'FTI_InitStage'). 
- **/
-static bool *enableStagingPtr;
+    int nbJobs = 0;
+    FTIT_StageJob *last;
+    for ( last = job; last->next; last = last->next ) {
+        nbJobs++;
+    }
+    nbJobs++;
+
+    pthread_mutex_lock( &pool.mutex );
+    if ( pool.todoLast ) {
+        pool.todoLast->next = job;
+    } else {
+        pool.todoFirst = job;
+    }
+    pool.todoLast = last;
+    pthread_cond_broadcast( &pool.cond );
+    pthread_mutex_unlock( &pool.mutex );
+    pool.inFlight += nbJobs;
+
+    return FTI_SCES;
+
+}
 
 /*-------------------------------------------------------------------------*/
 /**
@@ -132,7 +1084,7 @@ int FTI_InitStage( FTIT_execution *FTI_Exec, FTIT_configuration *FTI_Conf, FTIT_
         return FTI_NSCS;
     }
 
-    MPI_Type_contiguous( 2*FTI_BUFS + sizeof(int), MPI_BYTE, &buf_t );
+    MPI_Type_contiguous( FTI_SI_BUF_SIZE, MPI_BYTE, &buf_t );
     MPI_Type_commit( &buf_t );
 
     // memory window size
@@ -167,9 +1119,9 @@ int FTI_InitStage( FTIT_execution *FTI_Exec, FTIT_configuration *FTI_Conf, FTIT_
     }
 
     // create node communicator
-    // NOTE: head is assigned rank 0. This is important in order 
+    // NOTE: heads are assigned the lowest ranks. This is important in order 
     // to access the stageInfo array at the  head rank in the 
-    // implemented way (array[app_rank-1], app_ranks = 1 -> nodeSize-1)
+    // implemented way (array[app_rank-nbHeads], app_ranks = nbHeads -> nodeSize-1)
     int key = (FTI_Topo->amIaHead) ? 0 : 1;
     if ( FTI_Conf->test ) {
         int color = FTI_Topo->nodeID;
@@ -196,7 +1148,8 @@ int FTI_InitStage( FTIT_execution *FTI_Exec, FTIT_configuration *FTI_Conf, FTIT_
     MPI_Comm_rank( FTI_Exec->nodeComm, &FTI_Topo->nodeRank );
 
     // store head rank in node communicator
-    // NOTE: must(!!) be the lowest rank number
+    // NOTE: must(!!) be the lowest rank number. With several heads per
+    // node, the stage requests are all served by the first head.
     FTI_Topo->headRankNode = 0;
 
     // create shared memory window
@@ -206,6 +1159,10 @@ int FTI_InitStage( FTIT_execution *FTI_Exec, FTIT_configuration *FTI_Conf, FTIT_
     MPI_Info_set(win_info, "alloc_shared_noncontig", "true");
     MPI_Info_set(win_info, "no_locks", "true");
     MPI_Win_allocate_shared( win_size, disp, win_info, FTI_Exec->nodeComm, &status, &stageWin );
+
+    // create shared memory window for the progress of the requests
+    size_t prog_size = FTI_SI_MAX_NUM * sizeof(FTIT_StageProgress) * !(FTI_Topo->amIaHead);
+    MPI_Win_allocate_shared( prog_size, sizeof(FTIT_StageProgress), win_info, FTI_Exec->nodeComm, &progress, &progWin );
     MPI_Info_free(&win_info);
 
     // init shared memory window segments to 0x0
@@ -222,6 +1179,7 @@ int FTI_InitStage( FTIT_execution *FTI_Exec, FTIT_configuration *FTI_Conf, FTIT_
         if (errno != EEXIST) {
             FTI_DISABLE_STAGING;
             MPI_Win_free( &stageWin );
+            MPI_Win_free( &progWin );
             MPI_Comm_free( &FTI_Exec->nodeComm );
             free( FTI_Exec->stageInfo );
             free( idxRequest );
@@ -229,6 +1187,23 @@ int FTI_InitStage( FTIT_execution *FTI_Exec, FTIT_configuration *FTI_Conf, FTIT_
         }
     }
 
+    // the head receives the stage requests through a persistent request
+    if ( FTI_SI_ENABLED && FTI_Topo->amIaHead && FTI_Topo->nodeRank == FTI_Topo->headRankNode ) {
+        stageRecvBuf = malloc( FTI_SI_BUF_SIZE );
+        if ( stageRecvBuf == NULL ) {
+            FTI_DISABLE_STAGING;
+            MPI_Win_free( &stageWin );
+            MPI_Win_free( &progWin );
+            MPI_Comm_free( &FTI_Exec->nodeComm );
+            free( FTI_Exec->stageInfo );
+            FTI_Print( "failed to allocate memory for 'stageRecvBuf'", FTI_EROR );
+            return FTI_NSCS;
+        }
+        MPI_Recv_init( stageRecvBuf, 1, buf_t, MPI_ANY_SOURCE, FTI_Conf->stageTag, FTI_Exec->nodeComm, &stageRecvReq );
+        MPI_Start( &stageRecvReq );
+        FTI_InitStagePool( FTI_Conf->stageWorkers, FTI_Conf->stageDeadline );
+    }
+
     return FTI_SCES;
 
 }
@@ -273,11 +1248,14 @@ void FTI_FinalizeStage( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo, FTIT_
 
     }
 
+    // the head has waited for all the copies in 'FTI_Listen'
+    FTI_FinalizeStagePool();
+
     // ensure that before removing local files, all is on the PFS.
     MPI_Barrier( FTI_Exec->nodeComm );
 
     // remove staging directory and all the staging files.
-    FTI_RmDir(FTI_Conf->stageDir, FTI_Topo->amIaHead);
+    FTI_RmDir(FTI_Conf->stageDir, FTI_Topo->amIaHead && FTI_Topo->nodeRank == FTI_Topo->headRankNode);
 
     // ensure that before removing local directory, all staging files
     // are removed.
@@ -292,6 +1270,16 @@ void FTI_FinalizeStage( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo, FTIT_
     // free window 
     // NOTE: this also releases the ressources for the status field array
     MPI_Win_free( &stageWin );
+    MPI_Win_free( &progWin );
+
+    // cancel the pending persistent receive
+    if ( stageRecvReq != MPI_REQUEST_NULL ) {
+        MPI_Cancel( &stageRecvReq );
+        MPI_Wait( &stageRecvReq, MPI_STATUS_IGNORE );
+        MPI_Request_free( &stageRecvReq );
+        free( stageRecvBuf );
+        stageRecvBuf = NULL;
+    }
 
     // free mpi type
     MPI_Type_free( &buf_t );
@@ -384,12 +1372,12 @@ int FTI_InitStageRequestHead( char* lpath, char *rpath, FTIT_execution *FTI_Exec
         return FTI_NSCS;
     }
 
-    void *ptr = realloc( FTI_Exec->stageInfo[source-1].request, sizeof(FTIT_StageHeadInfo) * (FTI_Exec->stageInfo[source-1].nbRequest+1) );
+    void *ptr = realloc( FTI_Exec->stageInfo[source-FTI_Topo->nbHeads].request, sizeof(FTIT_StageHeadInfo) * (FTI_Exec->stageInfo[source-FTI_Topo->nbHeads].nbRequest+1) );
     if( ptr == NULL ) {
         FTI_Print( "failed to allocate memory", FTI_EROR );
         return FTI_NSCS;
     }
-    FTIT_StageInfo *si = &(FTI_Exec->stageInfo[source-1]); 
+    FTIT_StageInfo *si = &(FTI_Exec->stageInfo[source-FTI_Topo->nbHeads]); 
     si->request = ptr;
     int idx = si->nbRequest++;
 
@@ -399,6 +1387,10 @@ int FTI_InitStageRequestHead( char* lpath, char *rpath, FTIT_execution *FTI_Exec
     FTI_SI_HPTR(si->request)[idx].size = 0;
     FTI_SI_HPTR(si->request)[idx].ID = ID;
 
+    FTIT_StageProgress *prog = FTI_GetProgressPtr( ID, source );
+    prog->size = 0;
+    prog->done = 0;
+
     FTI_SetStatusField( FTI_Exec, FTI_Topo, ID, FTI_SI_ACTV, FTI_SIF_VAL, source );
 
     return FTI_SCES;
@@ -490,12 +1482,12 @@ int FTI_FreeStageRequest( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo, int
 
     } else {
 
-        int nbRequest = FTI_Exec->stageInfo[source-1].nbRequest;
-        FTIT_StageHeadInfo *ptr = FTI_SI_HPTR(FTI_Exec->stageInfo[source-1].request);
+        int nbRequest = FTI_Exec->stageInfo[source-FTI_Topo->nbHeads].nbRequest;
+        FTIT_StageHeadInfo *ptr = FTI_SI_HPTR(FTI_Exec->stageInfo[source-FTI_Topo->nbHeads].request);
         int idx;
         // locate idx, heads do not have a look-up table
         for( idx=0; idx<nbRequest; ++idx ) {
-            if(ptr->ID == ID) {
+            if(ptr[idx].ID == ID) {
                 break;
             }
         }
@@ -513,8 +1505,8 @@ int FTI_FreeStageRequest( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo, int
                 FTI_Print( "failed to allocate memory for 'ptr' in 'FTI_FreeStageRequest'", FTI_EROR );
                 return FTI_NSCS;
             }
-            --FTI_Exec->stageInfo[source-1].nbRequest;
-            FTI_Exec->stageInfo[source-1].request = (FTI_Exec->stageInfo[source-1].nbRequest == 0) ? NULL : (void*)ptr;
+            --FTI_Exec->stageInfo[source-FTI_Topo->nbHeads].nbRequest;
+            FTI_Exec->stageInfo[source-FTI_Topo->nbHeads].request = (FTI_Exec->stageInfo[source-FTI_Topo->nbHeads].nbRequest == 0) ? NULL : (void*)ptr;
         } 
 
         // if not last element, we need to truncate array and move elements (before truncation)
@@ -538,8 +1530,8 @@ int FTI_FreeStageRequest( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo, int
                 return FTI_NSCS;
             }
             free( dest_cpy);
-            FTI_Exec->stageInfo[source-1].request = ptr;
-            --FTI_Exec->stageInfo[source-1].nbRequest;
+            FTI_Exec->stageInfo[source-FTI_Topo->nbHeads].request = ptr;
+            --FTI_Exec->stageInfo[source-FTI_Topo->nbHeads].nbRequest;
         }
 
     }
@@ -595,6 +1587,9 @@ int FTI_SyncStage( char* lpath, char *rpath, FTIT_execution *FTI_Exec,
     int source = FTI_Topo->nodeRank;
 
     // for consistency
+    FTIT_StageProgress *prog = FTI_GetProgressPtr( ID, source );
+    prog->size = 0;
+    prog->done = 0;
     FTI_SetStatusField( FTI_Exec, FTI_Topo, ID, FTI_SI_ACTV, FTI_SIF_VAL, source );
 
     // set buffer size for the file data transfer
@@ -674,54 +1669,26 @@ int FTI_SyncStage( char* lpath, char *rpath, FTIT_execution *FTI_Exec,
         close( fd_local );
         return FTI_NSCS;
     }
-    // allocate buffer
-    char *buf = (char*) malloc( bs );
-
     // move file to destination
-    off_t pos = 0;
-    ssize_t read_bytes, write_bytes;
-    size_t buf_bytes;
-    while( pos < eof ) {
-        buf_bytes = ( (eof - pos) < bs ) ? eof - pos : bs;
-        // for the case we have written less then we have read
-        if( lseek( fd_local, pos, SEEK_SET ) == -1 ) {
-            snprintf( errstr, FTI_BUFS, "unable to seek in '%s'.", lpath );
-            FTI_Print( errstr, FTI_EROR );
-            errno = 0;
-            free( buf );
-            close( fd_local );
-            close( fd_global );
-            return FTI_NSCS;
-        }
-        if( (read_bytes = read( fd_local, buf, buf_bytes )) == -1 ) {
-            FTI_SetStatusField( FTI_Exec, FTI_Topo, ID, FTI_SI_FAIL, FTI_SIF_VAL, source );
-            snprintf( errstr, FTI_BUFS, "unable to read from '%s'.", lpath );
-            FTI_Print( errstr, FTI_EROR );
-            errno = 0;
-            free( buf );
-            close( fd_local );
-            close( fd_global );
-            return FTI_NSCS;
-        }
-        if( (write_bytes = write( fd_global, buf, read_bytes )) == -1 ) {  
-            FTI_SetStatusField( FTI_Exec, FTI_Topo, ID, FTI_SI_FAIL, FTI_SIF_VAL, source );
-            snprintf( errstr, FTI_BUFS, "unable to write to '%s'.", rpath );
-            FTI_Print( errstr, FTI_EROR );
-            errno = 0;
-            free( buf );
-            close( fd_local );
-            close( fd_global );
-            return FTI_NSCS;
-        }
-        pos += write_bytes;
+    FTIT_StageJob job;
+    strncpy( job.lpath, lpath, FTI_BUFS );
+    strncpy( job.rpath, rpath, FTI_BUFS );
+    job.fdLocal = fd_local;
+    job.fdGlobal = fd_global;
+    job.size = eof;
+    job.bs = bs;
+    job.files = NULL;
+    job.nbFiles = 0;
+    job.batch = NULL;
+    job.tStart = 0;
+    job.prog = prog;
+    job.prog->size = eof;
+    if ( FTI_StageCopyFile( &job ) != FTI_SCES ) {
+        FTI_SetStatusField( FTI_Exec, FTI_Topo, ID, FTI_SI_FAIL, FTI_SIF_VAL, source );
+        FTI_Print( job.errstr, FTI_EROR );
+        return FTI_NSCS;
     }
 
-    // deallocate buffer and close file descriptors
-    free( buf );
-    close( fd_local );
-    fsync( fd_global );
-    close( fd_global );
-
     if( remove( lpath ) == -1 ) {
         snprintf( errstr, FTI_BUFS, "Could not remove local file '%s'.", lpath );
         FTI_Print( errstr, FTI_WARN );
@@ -735,14 +1702,98 @@ int FTI_SyncStage( char* lpath, char *rpath, FTIT_execution *FTI_Exec,
 
 }
 
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Removes the local files of a finished file copy.
+  @param      job             staged file or archive object.
+  @return     'FTI_SCES' on success, 'FTI_NSCS' else.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_StageRemoveLocal( FTIT_StageJob *job )
+{
+    char errstr[FTI_BUFS];
+    int res = FTI_SCES;
+    int i;
+    for ( i=0; i<((job->files) ? job->nbFiles : 1); ++i ) {
+        char *lpath = ( job->files ) ? job->files[i].lpath : job->lpath;
+        if( remove( lpath ) == -1 ) {
+            snprintf( errstr, FTI_BUFS, "Could not remove local file '%s'.", lpath );
+            FTI_Print( errstr, FTI_WARN );
+            errno = 0;
+            res = FTI_NSCS;
+        }
+    }
+    return res;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      This function synchronously stages several files to the PFS.
+  @param      string          'lpattern', local directory or glob pattern
+  @param      string          'rdir', absolute path of remote directory
+  @param      FTI_Exec        Execution metadata.
+  @param      FTI_Topo        Topology metadata.
+  @param      FTI_Conf        Configuration metadata.
+  @param      integer         'ID' of staging request
+  @return     'FTI_SCES' on success, 'FTI_NSCS' else.  
+
+  This function should be called only if the staging feature is enabled
+  without the head process being enabled. Like in 'FTI_SyncStage', the
+  local files are removed once they are staged.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_SyncStageFiles( char* lpattern, char *rdir, FTIT_execution *FTI_Exec, 
+        FTIT_topology *FTI_Topo, FTIT_configuration *FTI_Conf, uint32_t ID ) 
+{
+
+    if ( !FTI_SI_ENABLED ) {
+        FTI_Print( "Staging disabled, invalid call to 'FTI_SyncStageFiles'", FTI_WARN );
+        return FTI_NSCS;
+    }
+
+    int source = FTI_Topo->nodeRank;
+
+    // for consistency
+    FTIT_StageProgress *prog = FTI_GetProgressPtr( ID, source );
+    prog->size = 0;
+    prog->done = 0;
+    FTI_SetStatusField( FTI_Exec, FTI_Topo, ID, FTI_SI_ACTV, FTI_SIF_VAL, source );
+
+    FTIT_StageJob *job;
+    int res = FTI_StagePlanBatch( lpattern, rdir, FTI_Conf, FTI_Topo->myRank, ID, source, &job );
+    if ( job ) {
+        free( job->batch );
+    }
+    while ( job ) {
+        FTIT_StageJob *next = job->next;
+        job->batch = NULL;
+        if ( res == FTI_SCES && FTI_StageRunJob( job ) != FTI_SCES ) {
+            FTI_Print( job->errstr, FTI_EROR );
+            res = FTI_NSCS;
+        }
+        if ( res == FTI_SCES && FTI_StageRemoveLocal( job ) != FTI_SCES ) {
+            res = FTI_NSCS;
+        }
+        free( job->files );
+        free( job );
+        job = next;
+    }
+
+    FTI_SetStatusField( FTI_Exec, FTI_Topo, ID, (res == FTI_SCES) ? FTI_SI_SCES : FTI_SI_FAIL, FTI_SIF_VAL, source );
+
+    return res;
+
+}
+
 /*-------------------------------------------------------------------------*/
 /**            
   @brief      This function triggers the asynchronous stage.
   @param      string          'lpath', absolute path of local file
   @param      string          'rpath', absolute path of remote file
+  @param      integer         'type', FTI_SI_FILE or FTI_SI_BATCH
+  @param      FTI_Conf        Configuration metadata.
   @param      FTI_Exec        Execution metadata.
   @param      FTI_Topo        Topology metadata.
-  @param      FTI_Conf        Configuration metadata.
   @param      integer         'ID' of staging request
   @return     'FTI_SCES' on success, 'FTI_NSCS' else.
 
@@ -751,7 +1802,7 @@ int FTI_SyncStage( char* lpath, char *rpath, FTIT_execution *FTI_Exec,
   asynchronous staging of the local file to the PFS. 
  **/
 /*-------------------------------------------------------------------------*/
-int FTI_AsyncStage( char *lpath, char *rpath, FTIT_configuration *FTI_Conf, 
+int FTI_AsyncStage( char *lpath, char *rpath, int type, FTIT_configuration *FTI_Conf, 
         FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo, int ID ) {
 
     if ( !FTI_SI_ENABLED ) {
@@ -761,7 +1812,7 @@ int FTI_AsyncStage( char *lpath, char *rpath, FTIT_configuration *FTI_Conf,
 
     int idx = FTI_GetRequestField( ID, FTI_SIF_IDX );
     // serialize request before sending to the head
-    void *buf_ser = malloc ( 2*FTI_BUFS + sizeof(int) );
+    void *buf_ser = malloc ( FTI_SI_BUF_SIZE );
     if ( buf_ser == NULL ) {
         FTI_Print("failed to allocate memory for 'buf_ser' in FTI_AsyncStage'", FTI_EROR );
         return FTI_NSCS;
@@ -773,6 +1824,10 @@ int FTI_AsyncStage( char *lpath, char *rpath, FTIT_configuration *FTI_Conf,
     pos += FTI_BUFS;
     memcpy( buf_ser + pos, &ID, sizeof(int) );   
     pos += sizeof(int);
+    memcpy( buf_ser + pos, &type, sizeof(int) );   
+    pos += sizeof(int);
+    memcpy( buf_ser + pos, &FTI_Topo->myRank, sizeof(int) );   
+    pos += sizeof(int);
 
     // send request to head
     MPI_Request *mpiReq = &(FTI_SI_APTR(FTI_Exec->stageInfo->request)[idx].mpiReq);
@@ -784,38 +1839,79 @@ int FTI_AsyncStage( char *lpath, char *rpath, FTIT_configuration *FTI_Conf,
     return FTI_SCES;
 }
 
+/*-------------------------------------------------------------------------*/
+/**            
+  @brief      Tests for an incoming stage request (head rank).
+  @param      buf_ser         serialized request [out].
+  @param      source          application rank of stage request [out].
+  @return     1 if a request was received, 0 else.
+
+  This function tests the persistent receive for stage requests. If a
+  request arrived, a copy of the serialized request is returned in
+  'buf_ser' (to be passed to 'FTI_HandleStageRequest') and the receive
+  is restarted.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_TestStageRequest( void **buf_ser, int *source )
+{
+
+    if ( !FTI_SI_ENABLED || stageRecvReq == MPI_REQUEST_NULL ) {
+        return 0;
+    }
+
+    int flag;
+    MPI_Status status;
+    MPI_Test( &stageRecvReq, &flag, &status );
+    if ( !flag ) {
+        return 0;
+    }
+
+    size_t buf_ser_size = FTI_SI_BUF_SIZE;
+    *buf_ser = malloc( buf_ser_size );
+    if ( *buf_ser == NULL ) {
+        FTI_Print( "failed to allocate memory for 'buf_ser' in FTI_TestStageRequest", FTI_EROR );
+        MPI_Start( &stageRecvReq );
+        return 0;
+    }
+    memcpy( *buf_ser, stageRecvBuf, buf_ser_size );
+    *source = status.MPI_SOURCE;
+
+    MPI_Start( &stageRecvReq );
+
+    return 1;
+
+}
+
 /*-------------------------------------------------------------------------*/
 /**            
   @brief      This function asynchronously stages the local file to the PFS.
-  @param      string          'lpath', absolute path of local file.
-  @param      string          'rpath', absolute path of remote file.
+  @param      FTI_Conf        Configuration metadata.
   @param      FTI_Exec        Execution metadata.
   @param      FTI_Topo        Topology metadata.
-  @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Ckpt        Checkpoint metadata.
   @param      integer         'source', application rank of stage request.
+  @param      buf_ser         serialized request (freed by this function).
   @return     'FTI_SCES' on success, 'FTI_NSCS' else.  
+
+  This function checks the request and opens the files. The copy itself
+  is queued for the stage workers ('Advanced:stage_workers') and
+  finished in 'FTI_ProgressStage', thus several requests are staged
+  concurrently. Batch requests ('FTI_SendFiles') are split into several
+  copies in 'FTI_HandleStageBatch'.
  **/
 /*-------------------------------------------------------------------------*/
 int FTI_HandleStageRequest(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
-        FTIT_topology* FTI_Topo, FTIT_checkpoint* FTI_Ckpt, int source)
+        FTIT_topology* FTI_Topo, FTIT_checkpoint* FTI_Ckpt, int source, void *buf_ser)
 {      
 
     if ( !FTI_SI_ENABLED ) {
         FTI_Print( "Staging disabled, invalid call to 'FTI_HandleStageRequest'", FTI_WARN );
+        free( buf_ser );
         return FTI_NSCS;
     }
 
     char errstr[FTI_BUFS];
 
-    size_t buf_ser_size = 2*FTI_BUFS + sizeof(int);
-    void *buf_ser = malloc ( buf_ser_size );
-    if ( buf_ser == NULL ) {
-        FTI_Print( "failed to allocate memory for 'buf_ser' in FTI_HandleStageRequest", FTI_EROR );
-        return FTI_NSCS; 
-    }
-
-    MPI_Recv( buf_ser, 1, buf_t, source, FTI_Conf->stageTag, FTI_Exec->nodeComm, MPI_STATUS_IGNORE );
-
     // set local file path
     char lpath[FTI_BUFS];
     char rpath[FTI_BUFS];
@@ -825,9 +1921,15 @@ int FTI_HandleStageRequest(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exe
     lpath[FTI_BUFS-1] = '\0';
     rpath[FTI_BUFS-1] = '\0';
     int ID = *(int*)(buf_ser+2*FTI_BUFS);
+    int type = *(int*)(buf_ser+2*FTI_BUFS+sizeof(int));
+    int rank = *(int*)(buf_ser+2*FTI_BUFS+2*sizeof(int));
 
     free( buf_ser );
 
+    if ( type == FTI_SI_BATCH ) {
+        return FTI_HandleStageBatch( FTI_Conf, FTI_Exec, FTI_Topo, lpath, rpath, ID, source, rank );
+    }
+
     // init Head staging meta data
     if ( FTI_InitStageRequestHead( lpath, rpath, FTI_Exec, FTI_Topo, source, ID ) != FTI_SCES ) {
         FTI_Print( "failed to initialize stage request meta info!", FTI_WARN );
@@ -921,70 +2023,177 @@ int FTI_HandleStageRequest(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exe
         close( fd_local );
         return FTI_NSCS;
     }
-    // allocate buffer
-    char *buf = (char*) malloc( bs );
-    if ( buf == NULL ) {
+    // hand the copy to the stage workers
+    FTIT_StageJob *job = malloc( sizeof(FTIT_StageJob) );
+    if ( job == NULL ) {
         close ( fd_local );
         close ( fd_global );
         FTI_FreeStageRequest( FTI_Exec, FTI_Topo, ID, source );
         FTI_SetStatusField( FTI_Exec, FTI_Topo, ID, FTI_SI_FAIL, FTI_SIF_VAL, source );
-        FTI_Print( "failed to allocate memory for 'buf' in 'FTI_HandleStageRequest'", FTI_EROR );
+        FTI_Print( "failed to allocate memory for 'job' in 'FTI_HandleStageRequest'", FTI_EROR );
         return FTI_NSCS;
     }
+    strncpy( job->lpath, lpath, FTI_BUFS );
+    strncpy( job->rpath, rpath, FTI_BUFS );
+    job->fdLocal = fd_local;
+    job->fdGlobal = fd_global;
+    job->size = eof;
+    job->bs = bs;
+    job->files = NULL;
+    job->nbFiles = 0;
+    job->batch = NULL;
+    job->prog = FTI_GetProgressPtr( ID, source );
+    job->prog->size = eof;
+    job->ID = ID;
+    job->source = source;
+    job->tStart = FTI_StageNow();
+    job->next = NULL;
+
+    // without workers, the head copies the file itself
+    if ( pool.nbWorkers == 0 ) {
+        job->res = FTI_StageCopyFile( job );
+        int res = job->res;
+        FTI_FinishStageJob( FTI_Exec, FTI_Topo, job );
+        return res;
+    }
 
-    // move file to destination
-    off_t pos = 0;
-    ssize_t read_bytes, write_bytes;
-    size_t buf_bytes;
-    while( pos < eof ) {
-        buf_bytes = ( (eof - pos) < bs ) ? eof - pos : bs;
-        // for the case we have written less then we have read
-        if( lseek( fd_local, pos, SEEK_SET ) == -1 ) {
-            FTI_FreeStageRequest( FTI_Exec, FTI_Topo, ID, source );
-            FTI_SetStatusField( FTI_Exec, FTI_Topo, ID, FTI_SI_FAIL, FTI_SIF_VAL, source );
-            snprintf( errstr, FTI_BUFS, "unable to seek in '%s'.", lpath );
-            FTI_Print( errstr, FTI_EROR );
-            errno = 0;
-            free( buf );
-            close( fd_local );
-            close( fd_global );
-            return FTI_NSCS;
-        }
-        if( (read_bytes = read( fd_local, buf, buf_bytes )) == -1 ) {
-            FTI_FreeStageRequest( FTI_Exec, FTI_Topo, ID, source );
-            FTI_SetStatusField( FTI_Exec, FTI_Topo, ID, FTI_SI_FAIL, FTI_SIF_VAL, source );
-            snprintf( errstr, FTI_BUFS, "unable to read from '%s'.", lpath );
-            FTI_Print( errstr, FTI_EROR );
-            errno = 0;
-            free( buf );
-            close( fd_local );
-            close( fd_global );
-            return FTI_NSCS;
-        }
-        if( (write_bytes = write( fd_global, buf, read_bytes )) == -1 ) {  
-            FTI_FreeStageRequest( FTI_Exec, FTI_Topo, ID, source );
-            FTI_SetStatusField( FTI_Exec, FTI_Topo, ID, FTI_SI_FAIL, FTI_SIF_VAL, source );
-            snprintf( errstr, FTI_BUFS, "unable to write to '%s'.", rpath );
-            FTI_Print( errstr, FTI_EROR );
-            errno = 0;
-            free( buf );
-            close( fd_local );
-            close( fd_global );
-            return FTI_NSCS;
-        }
-        pos += write_bytes;
+    pthread_mutex_lock( &pool.mutex );
+    if ( pool.todoLast ) {
+        pool.todoLast->next = job;
+    } else {
+        pool.todoFirst = job;
     }
+    pool.todoLast = job;
+    pthread_cond_signal( &pool.cond );
+    pthread_mutex_unlock( &pool.mutex );
+    pool.inFlight++;
 
-    // deallocate buffer and close file descriptors
-    free( buf );
-    close( fd_local );
-    fsync( fd_global );
-    close( fd_global );
+    return FTI_SCES;
+}
 
-    FTI_SetStatusField( FTI_Exec, FTI_Topo, ID, FTI_SI_SCES, FTI_SIF_VAL, source );
-    FTI_FreeStageRequest( FTI_Exec, FTI_Topo, ID, source );
+/*-------------------------------------------------------------------------*/
+/**            
+  @brief      Finishes the copies completed by the stage workers (head).
+  @param      FTI_Exec        Execution metadata.
+  @param      FTI_Topo        Topology metadata.
+  @return     number of finished stage requests.
+
+  Sets the status of the finished requests and frees the request meta
+  info.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_ProgressStage( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo )
+{
+
+    if ( pool.nbWorkers == 0 ) {
+        return 0;
+    }
+
+    pthread_mutex_lock( &pool.mutex );
+    FTIT_StageJob *job = pool.done;
+    pool.done = NULL;
+    pthread_mutex_unlock( &pool.mutex );
+
+    int count = 0;
+    while ( job ) {
+        FTIT_StageJob *next = job->next;
+        FTI_FinishStageJob( FTI_Exec, FTI_Topo, job );
+        pool.inFlight--;
+        count++;
+        job = next;
+    }
+
+    return count;
+
+}
+
+/*-------------------------------------------------------------------------*/
+/**            
+  @brief      Returns the number of unfinished copies (head).
+  @return     number of dispatched stage requests not yet finished.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_StageInFlight( void )
+{
+    return pool.inFlight;
+}
+
+/*-------------------------------------------------------------------------*/
+/**            
+  @brief      Tells if the head may dispatch the next stage request.
+  @return     TRUE if a stage worker is (or soon will be) available.
+
+  At most two copies per worker are queued, the remaining requests stay
+  in the queue of the head (and keep their files closed).
+ **/
+/*-------------------------------------------------------------------------*/
+bool FTI_StageCanDispatch( void )
+{
+    return ( pool.nbWorkers == 0 ) || ( pool.inFlight < 2*pool.nbWorkers );
+}
+
+/*-------------------------------------------------------------------------*/
+/**            
+  @brief      Pauses or resumes the copies of the stage workers (head).
+  @param      preempt         TRUE to pause, FALSE to resume.
+
+  The head pauses the copies while post-processing a checkpoint, thus
+  the checkpoint gets the bandwidth of the node. The copies pause at
+  the next transfer boundary ('Advanced:transfer_size') and resume where
+  they stopped. Copies older than 'Advanced:stage_deadline' seconds are
+  not paused.
+ **/
+/*-------------------------------------------------------------------------*/
+void FTI_PreemptStage( bool preempt )
+{
+
+    if ( pool.nbWorkers == 0 || pool.deadline == 0 ) {
+        return;
+    }
+
+    pthread_mutex_lock( &pool.mutex );
+    pool.preempt = preempt;
+    if ( !preempt ) {
+        pthread_cond_broadcast( &pool.resume );
+    }
+    pthread_mutex_unlock( &pool.mutex );
+
+}
+
+/*-------------------------------------------------------------------------*/
+/**            
+  @brief      Returns the progress of a stage request in bytes.
+  @param      FTI_Exec          Execution metadata.
+  @param      FTI_Topo          Topology metadata.
+  @param      integer           'ID' of staging request
+  @param      done              staged bytes [out].
+  @param      total             size of the file [out].
+  @param      integer           'source', application rank of stage request. 
+  @return     'FTI_SCES' on success, 'FTI_NSCS' else.
+
+  The progress is 0 of 0 bytes as long as the request is pending.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_GetProgressField( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo, int ID, long *done, long *total, int source )
+{
+
+    if ( !FTI_SI_ENABLED ) {
+        FTI_Print( "Staging disabled, invalid call to 'FTI_GetProgressField'", FTI_WARN );
+        return FTI_NSCS;
+    }
+
+    *done = 0;
+    *total = 0;
+
+    int val = FTI_GetStatusField( FTI_Exec, FTI_Topo, ID, FTI_SIF_VAL, source );
+    if ( (val == FTI_SI_ACTV) || (val == FTI_SI_SCES) || (val == FTI_SI_FAIL) ) {
+        FTIT_StageProgress *prog = FTI_GetProgressPtr( ID, source );
+        *total = (long) prog->size;
+        *done = (long) prog->done;
+    }
 
     return FTI_SCES;
+
 }
 
 /*-------------------------------------------------------------------------*/
@@ -63,6 +63,16 @@
 #define FTI_DISABLE_STAGING do{*enableStagingPtr = false;} while(0)
 #define FTI_SI_ENABLED (*(bool*)enableStagingPtr)
 
+// type of stage request
+#define FTI_SI_FILE 0x0
+#define FTI_SI_BATCH 0x1
+
+/** size of a serialized stage request (lpath, rpath, ID, type, rank) **/
+#define FTI_SI_BUF_SIZE (2*FTI_BUFS + 3*sizeof(int))
+
+/** block size of the archives of a batch (POSIX tar) **/
+#define FTI_SI_TAR_BLOCK 512
+
 /** @typedef    FTIT_StatusField
  *  @brief      valid fields of 'status'.
  * 
@@ -96,6 +106,14 @@ typedef struct FTIT_StageHeadInfo {
     int ID;                         /**< ID of request                  */
 } FTIT_StageHeadInfo;
 
+/** @typedef    FTIT_StageProgress
+ *  @brief      Progress of a stage request (shared memory window).
+ */
+typedef struct FTIT_StageProgress {
+    uint64_t size;                  /**< file size in bytes             */
+    uint64_t done;                  /**< bytes already staged           */
+} FTIT_StageProgress;
+
 /** @typedef    FTIT_StageAppInfo
  *  @brief      Application rank staging meta info.
  */
@@ -109,18 +127,26 @@ typedef struct FTIT_StageAppInfo {
 int FTI_GetRequestID( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo ); 
 int FTI_InitStage( FTIT_execution *FTI_Exec, FTIT_configuration *FTI_Conf, FTIT_topology *FTI_Topo );
 int FTI_InitStageRequestApp( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo, uint32_t ID );
-int FTI_AsyncStage( char *lpath, char *rpath, FTIT_configuration *FTI_Conf, 
+int FTI_AsyncStage( char *lpath, char *rpath, int type, FTIT_configuration *FTI_Conf, 
         FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo, int ID );
 int FTI_InitStageRequestHead( char* lpath, char *rpath, FTIT_execution *FTI_Exec, 
         FTIT_topology *FTI_Topo, int source, uint32_t ID );
 int FTI_SyncStage( char* lpath, char *rpath, FTIT_execution *FTI_Exec, 
         FTIT_topology *FTI_Topo, FTIT_configuration *FTI_Conf, uint32_t ID ); 
+int FTI_SyncStageFiles( char* lpattern, char *rdir, FTIT_execution *FTI_Exec, 
+        FTIT_topology *FTI_Topo, FTIT_configuration *FTI_Conf, uint32_t ID );
+int FTI_TestStageRequest( void **buf_ser, int *source );
 int FTI_HandleStageRequest(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
-        FTIT_topology* FTI_Topo, FTIT_checkpoint* FTI_Ckpt, int source);
+        FTIT_topology* FTI_Topo, FTIT_checkpoint* FTI_Ckpt, int source, void *buf_ser);
 int FTI_GetStatusField( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo, int ID, FTIT_StatusField val, int source ); 
 int FTI_SetStatusField( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo, int ID, uint8_t entry, FTIT_StatusField val, int source );
 int FTI_GetRequestField( int ID, FTIT_RequestField val ); 
 int FTI_SetRequestField( int ID, uint32_t entry, FTIT_RequestField val );
+int FTI_GetProgressField( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo, int ID, long *done, long *total, int source );
+int FTI_ProgressStage( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo );
+int FTI_StageInFlight( void );
+bool FTI_StageCanDispatch( void );
+void FTI_PreemptStage( bool preempt );
 int FTI_FreeStageRequest( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo, int ID, int source ); 
 void FTI_PrintStageStatus( FTIT_execution *FTI_Exec, FTIT_topology *FTI_Topo, int ID, int source ); 
 int FTI_GetRequestIdx( int ID );
@@ -37,6 +37,86 @@
  */
 
 #include "interface.h"
+#include <ctype.h>
+#include <limits.h>
+
+/** Magic number of the binary topology file **/
+#define FTI_TOPO_MAGIC "FTITOPO1"
+
+/** @typedef    FTIT_nameEntry
+ *  @brief      Entry of a hash table of names.
+ */
+typedef struct FTIT_nameEntry {
+    const char*     key;                    /**< name (not terminated)      */
+    int             len;                    /**< length of the name         */
+    int             val;                    /**< value, -1 if entry is free */
+} FTIT_nameEntry;
+
+/** @typedef    FTIT_nameTable
+ *  @brief      Hash table of names (open addressing, linear probing).
+ */
+typedef struct FTIT_nameTable {
+    FTIT_nameEntry* entry;                  /**< entries                    */
+    unsigned long   mask;                   /**< number of entries - 1      */
+} FTIT_nameTable;
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Initializes a hash table of names.
+  @param      table           The table to initialize.
+  @param      count           Number of names to store.
+
+  The table has at least twice as many entries as names.
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_InitNameTable(FTIT_nameTable* table, int count)
+{
+    unsigned long size = 16;
+    while (size < 2 * (unsigned long)count) {
+        size *= 2;
+    }
+    table->entry = talloc(FTIT_nameEntry, size);
+    table->mask = size - 1;
+    unsigned long i;
+    for (i = 0; i < size; i++) {
+        table->entry[i].val = -1;
+    }
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Looks up a name and adds it if not found.
+  @param      table           The hash table.
+  @param      key             The name (not necessarily terminated).
+  @param      len             The length of the name.
+  @param      val             The value to store if the name is new
+  (-1 to only look up the name).
+  @return     integer         The value of the name, 'val' if new.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_NameTableFind(FTIT_nameTable* table, const char* key, int len, int val)
+{
+    // FNV-1a
+    unsigned long h = 14695981039346656037UL;
+    int i;
+    for (i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)key[i]) * 1099511628211UL;
+    }
+    unsigned long pos = h & table->mask;
+    while (table->entry[pos].val != -1) {
+        FTIT_nameEntry* e = &table->entry[pos];
+        if (e->len == len && memcmp(e->key, key, len) == 0) {
+            return e->val;
+        }
+        pos = (pos + 1) & table->mask;
+    }
+    if (val != -1) {
+        table->entry[pos].key = key;
+        table->entry[pos].len = len;
+        table->entry[pos].val = val;
+    }
+    return val;
+}
 
 /*-------------------------------------------------------------------------*/
 /**
@@ -49,63 +129,105 @@
   This function writes the topology of the system (List of nodes and their
   ID) in a topology file that will be read during recovery to detect which
   nodes (and therefore checkpoit files) are missing in the new topology.
+  The file is binary: the magic number, the number of nodes and, for
+  each node ID, the length of the node name followed by the name.
 
  **/
 /*-------------------------------------------------------------------------*/
 int FTI_SaveTopo(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo, char* nameList)
 {
-    char str[FTI_BUFS];
-    snprintf(str, FTI_BUFS, "Trying to load configuration file (%s) to create topology.", FTI_Conf->cfgFile);
-    FTI_Print(str, FTI_DBUG);
-
-    dictionary* ini = iniparser_load(FTI_Conf->cfgFile);
-    if (ini == NULL) {
-        FTI_Print("Iniparser cannot parse the configuration file.", FTI_WARN);
-        return FTI_NSCS;
-    }
-
-    // Set topology section
-    iniparser_set(ini, "topology", NULL);
-
-    // Write list of nodes
-    int i;
-    for (i = 0; i < FTI_Topo->nbNodes; i++) {
-        char mfn[FTI_BUFS];
-        strncpy(mfn, nameList + (i * FTI_BUFS), FTI_BUFS - 1);
-        snprintf(str, FTI_BUFS, "topology:%d", i);
-        iniparser_set(ini, str, mfn);
-    }
-
-    // Unset sections of the configuration file
-    iniparser_unset(ini, "basic");
-    iniparser_unset(ini, "restart");
-    iniparser_unset(ini, "advanced");
-
-    char mfn[FTI_BUFS];
+    char mfn[FTI_BUFS], str[FTI_BUFS];
     snprintf(mfn, FTI_BUFS, "%s/Topology.fti", FTI_Conf->metadDir);
     snprintf(str, FTI_BUFS, "Creating topology file (%s)...", mfn);
     FTI_Print(str, FTI_DBUG);
 
-    FILE* fd = fopen(mfn, "w");
+    FILE* fd = fopen(mfn, "wb");
     if (fd == NULL) {
         FTI_Print("Topology file could NOT be opened", FTI_WARN);
+        return FTI_NSCS;
+    }
 
-        iniparser_freedict(ini);
+    int32_t nbNodes = FTI_Topo->nbNodes;
+    bool ok = (fwrite(FTI_TOPO_MAGIC, 8, 1, fd) == 1) && (fwrite(&nbNodes, sizeof(int32_t), 1, fd) == 1);
+    int i;
+    for (i = 0; ok && i < FTI_Topo->nbNodes; i++) {
+        char* name = nameList + (i * FTI_BUFS);
+        uint16_t len = strnlen(name, FTI_BUFS - 1);
+        ok = (fwrite(&len, sizeof(uint16_t), 1, fd) == 1) && (fwrite(name, 1, len, fd) == len);
+    }
 
+    if (!ok) {
+        FTI_Print("Topology file could NOT be written.", FTI_WARN);
+        fclose(fd);
         return FTI_NSCS;
     }
 
-    // Write new topology
-    iniparser_dump_ini(ini, fd);
-
     if (fclose(fd) != 0) {
         FTI_Print("Topology file could NOT be closed.", FTI_WARN);
+        return FTI_NSCS;
+    }
 
-        iniparser_freedict(ini);
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      It reads the node names of the topology file.
+  @param      mfn             Path of the topology file.
+  @param      nbNodes         Number of node names to read.
+  @param      oldList         The list of the old node names to fill.
+  @return     integer         FTI_SCES if successful.
+
+  Topology files written in the former iniparser format are read as
+  well. Missing names are left empty.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_LoadTopo(char* mfn, int nbNodes, char* oldList)
+{
+    memset(oldList, 0, nbNodes * FTI_BUFS);
 
+    FILE* fd = fopen(mfn, "rb");
+    if (fd == NULL) {
+        FTI_Print("The topology file is NOT accessible.", FTI_WARN);
         return FTI_NSCS;
     }
 
+    char magic[8];
+    int32_t nbOld;
+    if (fread(magic, 8, 1, fd) == 1 && memcmp(magic, FTI_TOPO_MAGIC, 8) == 0) {
+        if (fread(&nbOld, sizeof(int32_t), 1, fd) != 1) {
+            nbOld = 0;
+        }
+        int i;
+        for (i = 0; i < nbOld && i < nbNodes; i++) {
+            uint16_t len;
+            if (fread(&len, sizeof(uint16_t), 1, fd) != 1 || len >= FTI_BUFS ||
+                    fread(oldList + (i * FTI_BUFS), 1, len, fd) != len) {
+                FTI_Print("Topology file is corrupted.", FTI_WARN);
+                fclose(fd);
+                return FTI_NSCS;
+            }
+        }
+        fclose(fd);
+        return FTI_SCES;
+    }
+    fclose(fd);
+
+    // iniparser format
+    dictionary* ini = iniparser_load(mfn);
+    if (ini == NULL) {
+        FTI_Print("Iniparser could NOT parse the topology file.", FTI_WARN);
+        return FTI_NSCS;
+    }
+    int i;
+    for (i = 0; i < nbNodes; i++) {
+        char str[FTI_BUFS];
+        snprintf(str, FTI_BUFS, "Topology:%d", i);
+        char* tmp = iniparser_getstring(ini, str, NULL);
+        if (tmp != NULL) {
+            strncpy(oldList + (i * FTI_BUFS), tmp, FTI_BUFS - 1);
+        }
+    }
     iniparser_freedict(ini);
 
     return FTI_SCES;
@@ -115,97 +237,92 @@ int FTI_SaveTopo(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo, char* na
 /**
   @brief      It reorders the nodes following the previous topology.
   @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Exec        Execution metadata.
   @param      FTI_Topo        Topology metadata.
   @param      nodeList        The list of the nodes.
   @param      nameList        The list of the node names.
   @return     integer         FTI_SCES if successful.
 
-  This function writes the topology of the system (List of nodes and their
-  ID) in a topology file that will be read during recovery to detect which
-  nodes (and therefore checkpoit files) are missing in the new topology.
+  This function reads the topology file of the previous execution and
+  gives each node its previous ID. New nodes take the IDs of the missing
+  nodes (and therefore recover their checkpoint files from the partners).
+  Rank 0 reads the file and matches the names through a hash table, the
+  new order is broadcast.
 
  **/
 /*-------------------------------------------------------------------------*/
-int FTI_ReorderNodes(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo,
-        int* nodeList, char* nameList)
+int FTI_ReorderNodes(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
+        FTIT_topology* FTI_Topo, int* nodeList, char* nameList)
 {
-    int* nl = talloc(int, FTI_Topo->nbProc);
-    int* old = talloc(int, FTI_Topo->nbNodes);
     int* new = talloc(int, FTI_Topo->nbNodes);
-    int i;
-    for (i = 0; i < FTI_Topo->nbNodes; i++) {
-        old[i] = -1;
-        new[i] = -1;
-    }
-
-    char mfn[FTI_BUFS], str[FTI_BUFS];
-    snprintf(mfn, FTI_BUFS, "%s/Topology.fti", FTI_Conf->metadDir);
-    snprintf(str, FTI_BUFS, "Loading FTI topology file (%s) to reorder nodes...", mfn);
-    FTI_Print(str, FTI_DBUG);
+    int res = FTI_SCES;
+    int i, j;
+
+    if (FTI_Topo->myRank == 0) {
+        char mfn[FTI_BUFS], str[FTI_BUFS];
+        snprintf(mfn, FTI_BUFS, "%s/Topology.fti", FTI_Conf->metadDir);
+        snprintf(str, FTI_BUFS, "Loading FTI topology file (%s) to reorder nodes...", mfn);
+        FTI_Print(str, FTI_DBUG);
+
+        char* oldList = talloc(char, FTI_Topo->nbNodes * FTI_BUFS);
+        int* old = talloc(int, FTI_Topo->nbNodes);
+        res = FTI_LoadTopo(mfn, FTI_Topo->nbNodes, oldList);
+
+        if (res == FTI_SCES) {
+            FTIT_nameTable table;
+            FTI_InitNameTable(&table, FTI_Topo->nbNodes);
+            for (j = 0; j < FTI_Topo->nbNodes; j++) {
+                char* name = nameList + (j * FTI_BUFS);
+                FTI_NameTableFind(&table, name, strnlen(name, FTI_BUFS), j);
+                old[j] = -1;
+            }
 
-    // Checking that the topology file exist
-    if (access(mfn, F_OK) != 0) {
-        FTI_Print("The topology file is NOT accessible.", FTI_WARN);
+            // Get the old order of nodes
+            for (i = 0; i < FTI_Topo->nbNodes; i++) {
+                char* name = oldList + (i * FTI_BUFS);
+                j = (name[0] != '\0') ? FTI_NameTableFind(&table, name, strnlen(name, FTI_BUFS), -1) : -1;
+                // set matching IDs, a node can match only once
+                if (j != -1 && old[j] == -1) {
+                    old[j] = i;
+                    new[i] = j;
+                }
+                else {
+                    new[i] = -1;
+                }
+            }
+            free(table.entry);
+
+            j = 0;
+            // Introducing missing nodes
+            for (i = 0; i < FTI_Topo->nbNodes; i++) {
+                // For each new node..
+                if (new[i] == -1) {
+                    // ..search for an old node not present in the new list..
+                    while (old[j] != -1) {
+                        j++;
+                    }
+                    // .. and set matching IDs
+                    old[j] = i;
+                    new[i] = j;
+                    j++;
+                }
+            }
+        }
 
-        free(nl);
         free(old);
-        free(new);
-
-        return FTI_NSCS;
+        free(oldList);
     }
 
-    dictionary* ini;
-    ini = iniparser_load(mfn);
-    if (ini == NULL) {
-        FTI_Print("Iniparser could NOT parse the topology file.", FTI_WARN);
-
-        free(nl);
-        free(old);
+    MPI_Bcast(&res, 1, MPI_INT, 0, FTI_Exec->globalComm);
+    if (res != FTI_SCES) {
         free(new);
-
         return FTI_NSCS;
     }
+    MPI_Bcast(new, FTI_Topo->nbNodes, MPI_INT, 0, FTI_Exec->globalComm);
 
-    // Get the old order of nodes
-    for (i = 0; i < FTI_Topo->nbNodes; i++) {
-        snprintf(str, FTI_BUFS, "Topology:%d", i);
-        char* tmp = iniparser_getstring(ini, str, NULL);
-        snprintf(str, FTI_BUFS, "%s", tmp);
-
-        // Search for same node in current nameList
-        int j;
-        for (j = 0; j < FTI_Topo->nbNodes; j++) {
-            // If found...
-            if (strncmp(str, nameList + (j * FTI_BUFS), FTI_BUFS) == 0) {
-                old[j] = i;
-                new[i] = j;
-                break;
-            } // ...set matching IDs and break out of the searching loop
-        }
-    }
-
-    iniparser_freedict(ini);
-
-    int j = 0;
-    // Introducing missing nodes
-    for (i = 0; i < FTI_Topo->nbNodes; i++) {
-        // For each new node..
-        if (new[i] == -1) {
-            // ..search for an old node not present in the new list..
-            while (old[j] != -1) {
-                j++;
-            }
-            // .. and set matching IDs
-            old[j] = i;
-            new[i] = j;
-            j++;
-        }
-    }
-    // Copying nodeList in nl
-    for (i = 0; i < FTI_Topo->nbProc; i++) {
-        nl[i] = nodeList[i];
-    }
     // Creating the new nodeList with the old order
+    int* nl = talloc(int, FTI_Topo->nbProc);
+    memcpy(nl, nodeList, FTI_Topo->nbProc * sizeof(int));
     for (i = 0; i < FTI_Topo->nbNodes; i++) {
         for (j = 0; j < FTI_Topo->nodeSize; j++) {
             nodeList[(i * FTI_Topo->nodeSize) + j] = nl[(new[i] * FTI_Topo->nodeSize) + j];
@@ -214,7 +331,6 @@ int FTI_ReorderNodes(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo,
 
     // Free memory
     free(nl);
-    free(old);
     free(new);
 
     return FTI_SCES;
@@ -234,66 +350,89 @@ int FTI_ReorderNodes(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo,
   located and distributes the information globally to create an uniform
   mapping structure between processes and nodes.
 
+  The processes of a node are found with 'MPI_Comm_split_type' (or
+  split by rank in local tests). The nodes are numbered in the order of
+  their lowest rank, thus only one integer per process and one host name
+  per node are gathered.
+
  **/
 /*-------------------------------------------------------------------------*/
 int FTI_BuildNodeList(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         FTIT_topology* FTI_Topo, int* nodeList, char* nameList)
 {
-    char* lhn = talloc(char, FTI_BUFS* FTI_Topo->nbProc);
-    memset(lhn + (FTI_Topo->myRank * FTI_BUFS), 0, FTI_BUFS); // To get local hostname
+    MPI_Comm localComm;
     if (!FTI_Conf->test) {
-        gethostname(lhn + (FTI_Topo->myRank * FTI_BUFS), FTI_BUFS); // NOT local test
+        MPI_Comm_split_type(FTI_Exec->globalComm, MPI_COMM_TYPE_SHARED, FTI_Topo->myRank, MPI_INFO_NULL, &localComm);
     }
     else {
-        snprintf(lhn + (FTI_Topo->myRank * FTI_BUFS), FTI_BUFS, "node%d", FTI_Topo->myRank / FTI_Topo->nodeSize); // Local
+        MPI_Comm_split(FTI_Exec->globalComm, FTI_Topo->myRank / FTI_Topo->nodeSize, FTI_Topo->myRank, &localComm); // Local
     }
-    char hname[FTI_BUFS];
-    strncpy(hname, lhn + (FTI_Topo->myRank * FTI_BUFS), FTI_BUFS - 1); // Distributing host names
-    MPI_Allgather(hname, FTI_BUFS, MPI_CHAR, lhn, FTI_BUFS, MPI_CHAR, FTI_Exec->globalComm);
-
-    int nbNodes = 0;
-    int i;
-    for (i = 0; i < FTI_Topo->nbProc; i++) { // Creating the node list: For each process
-        int found = 0;
-        int pos = 0;
-        strncpy(hname, lhn + (i * FTI_BUFS), FTI_BUFS - 1); // Get node name of process i
-        while ((pos < nbNodes) && (found == 0)) { // Search the node name in the current list of node names
-            if (strncmp(&(nameList[pos * FTI_BUFS]), hname, FTI_BUFS) == 0) { // If we find it break out
-                found = 1;
-            }
-            else { // Else move to the next name in the list
-                pos++;
-            }
-        }
-        if (found) { // If we found the node name in the current list...
-            int p = pos * FTI_Topo->nodeSize;
-            while (p < pos * FTI_Topo->nodeSize + FTI_Topo->nodeSize) { // ... we look for empty spot in this node
-                if (nodeList[p] == -1) {
-                    nodeList[p] = i;
-                    break;
-                }
-                else {
-                    p++;
-                }
-            }
+    int localRank;
+    MPI_Comm_rank(localComm, &localRank);
+
+    // the process with the lowest rank of a node numbers the node
+    int leader = (localRank == 0) ? 1 : 0;
+    int nodeID = 0;
+    MPI_Exscan(&leader, &nodeID, 1, MPI_INT, MPI_SUM, FTI_Exec->globalComm);
+    if (FTI_Topo->myRank == 0) {
+        nodeID = 0;
+    }
+    MPI_Bcast(&nodeID, 1, MPI_INT, 0, localComm);
+    MPI_Comm_free(&localComm);
+
+    int* nodeOf = talloc(int, FTI_Topo->nbProc);
+    MPI_Allgather(&nodeID, 1, MPI_INT, nodeOf, 1, MPI_INT, FTI_Exec->globalComm);
+
+    int* count = talloc(int, FTI_Topo->nbNodes);
+    memset(count, 0, FTI_Topo->nbNodes * sizeof(int));
+    int i, bad = -1;
+    for (i = 0; i < FTI_Topo->nbProc && bad == -1; i++) { // Creating the node list: For each process
+        int node = nodeOf[i];
+        if (node >= FTI_Topo->nbNodes || count[node] == FTI_Topo->nodeSize) {
+            bad = node;
         }
-        else { // ... else, we add the new node to the end of the current list of nodes
-            strncpy(&(nameList[pos * FTI_BUFS]), hname, FTI_BUFS - 1);
-            nodeList[pos * FTI_Topo->nodeSize] = i;
-            nbNodes++;
+        else {
+            nodeList[(node * FTI_Topo->nodeSize) + count[node]] = i;
+            count[node]++;
         }
     }
-    for (i = 0; i < FTI_Topo->nbProc; i++) { // Checking that all nodes have nodeSize processes
-        if (nodeList[i] == -1) {
-            char str[FTI_BUFS];
-            snprintf(str, FTI_BUFS, "Node %d has no %d processes", i / FTI_Topo->nodeSize, FTI_Topo->nodeSize);
-            FTI_Print(str, FTI_WARN);
-            free(lhn);
-            return FTI_NSCS;
+    for (i = 0; i < FTI_Topo->nbNodes && bad == -1; i++) { // Checking that all nodes have nodeSize processes
+        if (count[i] != FTI_Topo->nodeSize) {
+            bad = i;
         }
     }
+    free(count);
+    if (bad != -1) {
+        char str[FTI_BUFS];
+        snprintf(str, FTI_BUFS, "Node %d has no %d processes", bad, FTI_Topo->nodeSize);
+        FTI_Print(str, FTI_WARN);
+        free(nodeOf);
+        return FTI_NSCS;
+    }
+
+    // the first process of each node contributes the host name
+    char hname[FTI_BUFS];
+    memset(hname, 0, FTI_BUFS);
+    if (!FTI_Conf->test) {
+        gethostname(hname, FTI_BUFS - 1); // NOT local test
+    }
+    else {
+        snprintf(hname, FTI_BUFS, "node%d", FTI_Topo->myRank / FTI_Topo->nodeSize); // Local
+    }
+    int* counts = nodeOf; // reused, indexed by rank
+    int* displs = talloc(int, FTI_Topo->nbProc);
+    for (i = 0; i < FTI_Topo->nbProc; i++) {
+        counts[i] = 0;
+        displs[i] = 0;
+    }
+    for (i = 0; i < FTI_Topo->nbNodes; i++) {
+        counts[nodeList[i * FTI_Topo->nodeSize]] = FTI_BUFS;
+        displs[nodeList[i * FTI_Topo->nodeSize]] = i * FTI_BUFS;
+    }
+    MPI_Allgatherv(hname, counts[FTI_Topo->myRank], MPI_CHAR, nameList, counts, displs, MPI_CHAR, FTI_Exec->globalComm);
 
-    free(lhn);
+    free(displs);
+    free(nodeOf);
 
     return FTI_SCES;
 }
@@ -322,22 +461,29 @@ int FTI_CreateComms(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     MPI_Group newGroup, origGroup;
     MPI_Comm_group(FTI_Exec->globalComm, &origGroup);
     if (FTI_Topo->amIaHead) {
-        MPI_Group_incl(origGroup, FTI_Topo->nbNodes * FTI_Topo->nbHeads, distProcList, &newGroup);
+        int* headProcList = talloc(int, FTI_Topo->nbNodes * FTI_Topo->nbHeads);
+        int i, j;
+        for (i = 0; i < FTI_Topo->nbNodes; i++) { // Node-major order, matches the order of the app. procs
+            for (j = 0; j < FTI_Topo->nbHeads; j++) {
+                headProcList[(i * FTI_Topo->nbHeads) + j] = nodeList[(i * FTI_Topo->nodeSize) + j];
+            }
+        }
+        MPI_Group_incl(origGroup, FTI_Topo->nbNodes * FTI_Topo->nbHeads, headProcList, &newGroup);
         MPI_Comm_create(FTI_Exec->globalComm, newGroup, &FTI_COMM_WORLD);
-        int i;
-        for (i = FTI_Topo->nbHeads; i < FTI_Topo->nodeSize; i++) {
+        free(headProcList);
+        for (i = FTI_Topo->bodyOffset; i < FTI_Topo->bodyOffset + FTI_Topo->nbBody; i++) {
             int src = nodeList[(FTI_Topo->nodeID * FTI_Topo->nodeSize) + i];
             int buf;
             MPI_Recv(&buf, 1, MPI_INT, src, FTI_Conf->generalTag, FTI_Exec->globalComm, MPI_STATUS_IGNORE);
             if (buf == src) {
-                FTI_Topo->body[i - FTI_Topo->nbHeads] = src;
+                FTI_Topo->body[i - FTI_Topo->bodyOffset] = src;
             }
         }
     }
     else {
         MPI_Group_incl(origGroup, FTI_Topo->nbProc - (FTI_Topo->nbNodes * FTI_Topo->nbHeads), userProcList, &newGroup);
         MPI_Comm_create(FTI_Exec->globalComm, newGroup, &FTI_COMM_WORLD);
-        if (FTI_Topo->nbHeads == 1) {
+        if (FTI_Topo->nbHeads > 0) {
             MPI_Send(&(FTI_Topo->myRank), 1, MPI_INT, FTI_Topo->headRank, FTI_Conf->generalTag, FTI_Exec->globalComm);
         }
     }
@@ -359,6 +505,346 @@ int FTI_CreateComms(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     return FTI_SCES;
 }
 
+/** @typedef    FTIT_nodeDomain
+ *  @brief      Nodes of a failure domain not yet placed in a group.
+ */
+typedef struct FTIT_nodeDomain {
+    FTIT_nodeLoc*   nodes;                  /**< nodes sorted by coordinates*/
+    int             count;                  /**< number of nodes            */
+    int             next;                   /**< first node not yet placed  */
+} FTIT_nodeDomain;
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Compares two node locations by coordinates.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_CmpNodeCoord(const void* a, const void* b)
+{
+    const FTIT_nodeLoc* x = a;
+    const FTIT_nodeLoc* y = b;
+    int i;
+    for (i = 0; i < FTI_TOPO_LEVELS; i++) {
+        if (x->coord[i] != y->coord[i]) {
+            return (x->coord[i] < y->coord[i]) ? -1 : 1;
+        }
+    }
+    return x->node - y->node;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Compares two node locations by domain, then coordinates.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_CmpNodeDomain(const void* a, const void* b)
+{
+    const FTIT_nodeLoc* x = a;
+    const FTIT_nodeLoc* y = b;
+    if (x->domain != y->domain) {
+        return (x->domain < y->domain) ? -1 : 1;
+    }
+    return FTI_CmpNodeCoord(a, b);
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Compares two failure domains by their first free node.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_CmpDomain(const void* a, const void* b)
+{
+    const FTIT_nodeDomain* x = a;
+    const FTIT_nodeDomain* y = b;
+    return FTI_CmpNodeCoord(&x->nodes[x->next], &y->nodes[y->next]);
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Returns the network distance of two nodes.
+  @param      a               Location of the first node.
+  @param      b               Location of the second node.
+  @return     integer         0 if the nodes share all coordinates, else
+  the number of levels below (and including) the first differing one.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_NodeDistance(FTIT_nodeLoc* a, FTIT_nodeLoc* b)
+{
+    int i;
+    for (i = 0; i < FTI_TOPO_LEVELS; i++) {
+        if (a->coord[i] != b->coord[i]) {
+            return FTI_TOPO_LEVELS - i;
+        }
+    }
+    return 0;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Locates the nodes from their host names.
+  @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Topo        Topology metadata.
+  @param      nameList        The list of the node names.
+  @param      loc             The node locations to fill.
+
+  Host names are split into a prefix and a trailing number (e.g.
+  'nid00042'). Nodes with the same prefix and the same number divided by
+  'Advanced:domain_size' (e.g. the nodes of a chassis) form a failure
+  domain. The coordinates are the prefix, the domain and the number, thus
+  nodes with close numbers are close in the network.
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_LocateNodesByName(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo,
+        char* nameList, FTIT_nodeLoc* loc)
+{
+    FTIT_nameTable prefixes;
+    FTI_InitNameTable(&prefixes, FTI_Topo->nbNodes);
+    int i;
+    for (i = 0; i < FTI_Topo->nbNodes; i++) {
+        char* name = nameList + (i * FTI_BUFS);
+        int len = strnlen(name, FTI_BUFS);
+        int end = len;
+        while (end > 0 && isdigit((unsigned char)name[end - 1])) {
+            end--;
+        }
+        long number = (end < len) ? atol(name + end) : i;
+
+        // nodes with the same prefix get the same prefix index
+        int prefix = FTI_NameTableFind(&prefixes, name, end, i);
+
+        loc[i].node = i;
+        loc[i].coord[0] = prefix;
+        loc[i].coord[1] = number / FTI_Conf->domainSize;
+        loc[i].coord[2] = number;
+        loc[i].coord[3] = 0;
+        loc[i].domain = ((long)prefix << 32) | (number / FTI_Conf->domainSize);
+    }
+    free(prefixes.entry);
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Locates the nodes from a node coordinate file.
+  @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Topo        Topology metadata.
+  @param      nameList        The list of the node names.
+  @param      loc             The node locations to fill.
+  @return     integer         FTI_SCES if successful.
+
+  Each line of 'Advanced:node_coords_file' holds a host name, its failure
+  domain (e.g. the power domain) and up to four coordinates, coarse
+  first (e.g. dragonfly group, chassis, blade, node). Nodes missing in
+  the file get their own domain and are placed last.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_LocateNodesByFile(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo,
+        char* nameList, FTIT_nodeLoc* loc)
+{
+    char str[FTI_BUFS];
+    FILE* fd = fopen(FTI_Conf->nodeCoordsFile, "r");
+    if (fd == NULL) {
+        snprintf(str, FTI_BUFS, "Node coordinate file (%s) could NOT be opened.", FTI_Conf->nodeCoordsFile);
+        FTI_Print(str, FTI_WARN);
+        return FTI_NSCS;
+    }
+
+    int i, found = 0;
+    for (i = 0; i < FTI_Topo->nbNodes; i++) {
+        loc[i].node = i;
+        loc[i].domain = -1 - i;
+        int j;
+        for (j = 0; j < FTI_TOPO_LEVELS; j++) {
+            loc[i].coord[j] = LONG_MAX;
+        }
+    }
+
+    char line[FTI_BUFS];
+    while (fgets(line, FTI_BUFS, fd) != NULL) {
+        char name[FTI_BUFS];
+        long domain, c[FTI_TOPO_LEVELS] = { 0 };
+        int n = sscanf(line, "%s %ld %ld %ld %ld %ld", name, &domain, &c[0], &c[1], &c[2], &c[3]);
+        if (n < 2 || name[0] == '#') {
+            continue;
+        }
+        for (i = 0; i < FTI_Topo->nbNodes; i++) {
+            if (strncmp(name, nameList + (i * FTI_BUFS), FTI_BUFS) == 0) {
+                loc[i].domain = domain;
+                memcpy(loc[i].coord, c, sizeof(c));
+                found++;
+                break;
+            }
+        }
+    }
+    fclose(fd);
+
+    if (found < FTI_Topo->nbNodes) {
+        snprintf(str, FTI_BUFS, "%d nodes are missing in the node coordinate file (%s).",
+                FTI_Topo->nbNodes - found, FTI_Conf->nodeCoordsFile);
+        FTI_Print(str, FTI_WARN);
+    }
+
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Orders the nodes such that groups span failure domains.
+  @param      FTI_Topo        Topology metadata.
+  @param      loc             The node locations (sorted on return).
+  @param      order           The new order of the nodes [out].
+  @return     integer         Number of groups with nodes of the same
+  failure domain.
+
+  The groups are built one after the other. A group starts with the
+  failure domain having the most unplaced nodes (so no domain is left
+  over at the end) and takes the remaining members from the closest
+  other domains. Within a group, the nodes are ordered by coordinates,
+  so the partner ring ('left', 'right') follows the network.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_PlaceGroups(FTIT_topology* FTI_Topo, FTIT_nodeLoc* loc, int* order)
+{
+    int nbNodes = FTI_Topo->nbNodes, gs = FTI_Topo->groupSize;
+    qsort(loc, nbNodes, sizeof(FTIT_nodeLoc), FTI_CmpNodeDomain);
+
+    FTIT_nodeDomain* dom = talloc(FTIT_nodeDomain, nbNodes);
+    int nbDom = 0, i;
+    for (i = 0; i < nbNodes; i++) {
+        if (i == 0 || loc[i].domain != loc[i - 1].domain) {
+            dom[nbDom].nodes = &loc[i];
+            dom[nbDom].count = 0;
+            dom[nbDom].next = 0;
+            nbDom++;
+        }
+        dom[nbDom - 1].count++;
+    }
+    qsort(dom, nbDom, sizeof(FTIT_nodeDomain), FTI_CmpDomain);
+
+    int* used = talloc(int, nbDom);
+    FTIT_nodeLoc* group = talloc(FTIT_nodeLoc, gs);
+    int shared = 0, pos = 0, g;
+    for (g = 0; g < nbNodes / gs; g++) {
+        int first = -1, d;
+        for (d = 0; d < nbDom; d++) {
+            used[d] = 0;
+            int left = dom[d].count - dom[d].next;
+            if (left > 0 && (first == -1 || left > dom[first].count - dom[first].next)) {
+                first = d;
+            }
+        }
+        group[0] = dom[first].nodes[dom[first].next++];
+        used[first] = 1;
+
+        int k, mixed = 0;
+        for (k = 1; k < gs; k++) {
+            int best = -1, bestDist = 0, bestLeft = 0;
+            int pass;
+            // first look for an unused domain, then accept a used one
+            for (pass = 0; pass < 2 && best == -1; pass++) {
+                for (d = 0; d < nbDom; d++) {
+                    int left = dom[d].count - dom[d].next;
+                    if (left == 0 || (pass == 0 && used[d])) {
+                        continue;
+                    }
+                    int dist = FTI_NodeDistance(&group[0], &dom[d].nodes[dom[d].next]);
+                    if (best == -1 || dist < bestDist || (dist == bestDist && left > bestLeft)) {
+                        best = d;
+                        bestDist = dist;
+                        bestLeft = left;
+                    }
+                }
+                mixed |= (pass == 1 && best != -1);
+            }
+            group[k] = dom[best].nodes[dom[best].next++];
+            used[best] = 1;
+        }
+        shared += mixed;
+
+        qsort(group, gs, sizeof(FTIT_nodeLoc), FTI_CmpNodeCoord);
+        for (k = 0; k < gs; k++) {
+            order[pos++] = group[k].node;
+        }
+    }
+
+    free(group);
+    free(used);
+    free(dom);
+
+    return shared;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Reorders the nodes following the group strategy.
+  @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Exec        Execution metadata.
+  @param      FTI_Topo        Topology metadata.
+  @param      nodeList        The list of the nodes.
+  @param      nameList        The list of the node names.
+  @return     integer         FTI_SCES if successful.
+
+  The L2 and L3 groups are formed by consecutive node IDs. With the
+  strategies 'Advanced:group_strategy' = 1 (host names) or 2 (node
+  coordinate file), the nodes are reordered such that the nodes of a
+  group belong to different failure domains and are close in the
+  network. The order is decided by rank 0 and is saved in the topology
+  file, thus 'FTI_ReorderNodes' restores it on restart.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_GroupNodes(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
+        FTIT_topology* FTI_Topo, int* nodeList, char* nameList)
+{
+    if (FTI_Conf->groupStrategy == FTI_GROUP_LINEAR || FTI_Topo->groupSize < 2) {
+        return FTI_SCES;
+    }
+
+    int* order = talloc(int, FTI_Topo->nbNodes);
+    int res = FTI_SCES;
+    if (FTI_Topo->myRank == 0) {
+        FTIT_nodeLoc* loc = talloc(FTIT_nodeLoc, FTI_Topo->nbNodes);
+        if (FTI_Conf->groupStrategy == FTI_GROUP_COORDS) {
+            res = FTI_LocateNodesByFile(FTI_Conf, FTI_Topo, nameList, loc);
+        }
+        else {
+            FTI_LocateNodesByName(FTI_Conf, FTI_Topo, nameList, loc);
+        }
+        if (res == FTI_SCES) {
+            int shared = FTI_PlaceGroups(FTI_Topo, loc, order);
+            if (shared > 0) {
+                char str[FTI_BUFS];
+                snprintf(str, FTI_BUFS, "%d of %d groups have several nodes in the same failure domain.",
+                        shared, FTI_Topo->nbNodes / FTI_Topo->groupSize);
+                FTI_Print(str, FTI_WARN);
+            }
+        }
+        free(loc);
+    }
+    MPI_Bcast(&res, 1, MPI_INT, 0, FTI_Exec->globalComm);
+    if (res != FTI_SCES) {
+        free(order);
+        return FTI_NSCS;
+    }
+    MPI_Bcast(order, FTI_Topo->nbNodes, MPI_INT, 0, FTI_Exec->globalComm);
+
+    int* nl = talloc(int, FTI_Topo->nbProc);
+    char* names = talloc(char, FTI_Topo->nbNodes * FTI_BUFS);
+    memcpy(nl, nodeList, FTI_Topo->nbProc * sizeof(int));
+    memcpy(names, nameList, FTI_Topo->nbNodes * FTI_BUFS);
+    int i, j;
+    for (i = 0; i < FTI_Topo->nbNodes; i++) {
+        for (j = 0; j < FTI_Topo->nodeSize; j++) {
+            nodeList[(i * FTI_Topo->nodeSize) + j] = nl[(order[i] * FTI_Topo->nodeSize) + j];
+        }
+        memcpy(nameList + (i * FTI_BUFS), names + (order[i] * FTI_BUFS), FTI_BUFS);
+    }
+
+    free(names);
+    free(nl);
+    free(order);
+
+    return FTI_SCES;
+}
+
 /*-------------------------------------------------------------------------*/
 /**
   @brief      It builds and saves the topology of the current execution.
@@ -392,8 +878,20 @@ int FTI_Topology(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         return FTI_NSCS;
     }
 
+    // a new execution places the nodes following the group strategy,
+    // a restart keeps the order of the topology file
+    if ( (FTI_Exec->reco == 0) || (FTI_Exec->reco == 3) ) {
+        res = FTI_Try(FTI_GroupNodes(FTI_Conf, FTI_Exec, FTI_Topo, nodeList, nameList), "group nodes.");
+        if (res == FTI_NSCS) {
+            free(nameList);
+            free(nodeList);
+
+            return FTI_NSCS;
+        }
+    }
+
     if ( (FTI_Exec->reco == 1) || (FTI_Exec->reco==2) ) {
-        res = FTI_Try(FTI_ReorderNodes(FTI_Conf, FTI_Topo, nodeList, nameList), "reorder nodes.");
+        res = FTI_Try(FTI_ReorderNodes(FTI_Conf, FTI_Exec, FTI_Topo, nodeList, nameList), "reorder nodes.");
         if (res == FTI_NSCS) {
             free(nameList);
             free(nodeList);
@@ -422,7 +920,7 @@ int FTI_Topology(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         if (FTI_Topo->myRank == nodeList[i]) {
             mypos = i;
         }
-        if ((i % FTI_Topo->nodeSize != 0) || (FTI_Topo->nbHeads == 0)) {
+        if (i % FTI_Topo->nodeSize >= FTI_Topo->nbHeads) {
             userProcList[c] = nodeList[i];
             c++;
         }
@@ -437,14 +935,28 @@ int FTI_Topology(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
     }
 
     FTI_Topo->nodeRank = mypos % FTI_Topo->nodeSize;
-    if (FTI_Topo->nodeRank == 0 && FTI_Topo->nbHeads == 1) {
+    if (FTI_Topo->nodeRank < FTI_Topo->nbHeads) {
         FTI_Topo->amIaHead = 1;
     }
     else {
         FTI_Topo->amIaHead = 0;
     }
     FTI_Topo->nodeID = mypos / FTI_Topo->nodeSize;
-    FTI_Topo->headRank = nodeList[(mypos / FTI_Topo->nodeSize) * FTI_Topo->nodeSize];
+
+    // The application processes of the node are split in contiguous blocks,
+    // one block per head. Each head post-processes only its own block.
+    if (FTI_Topo->nbHeads > 0) {
+        FTI_Topo->nbBody = FTI_Topo->nbApprocs / FTI_Topo->nbHeads;
+        FTI_Topo->headID = (FTI_Topo->amIaHead) ? FTI_Topo->nodeRank :
+            (FTI_Topo->nodeRank - FTI_Topo->nbHeads) / FTI_Topo->nbBody;
+        FTI_Topo->bodyOffset = FTI_Topo->nbHeads + (FTI_Topo->headID * FTI_Topo->nbBody);
+    }
+    else {
+        FTI_Topo->nbBody = 0;
+        FTI_Topo->headID = 0;
+        FTI_Topo->bodyOffset = 0;
+    }
+    FTI_Topo->headRank = nodeList[(FTI_Topo->nodeID * FTI_Topo->nodeSize) + FTI_Topo->headID];
     FTI_Topo->sectorID = FTI_Topo->nodeID / FTI_Topo->groupSize;
     int posInNode = mypos % FTI_Topo->nodeSize;
     FTI_Topo->groupID = posInNode;
@@ -1,10 +1,32 @@
 #ifndef __TOPO_H__
 #define __TOPO_H__
+
+// strategies to form the L2/L3 groups ('Advanced:group_strategy')
+#define FTI_GROUP_LINEAR 0
+#define FTI_GROUP_HOSTNAME 1
+#define FTI_GROUP_COORDS 2
+
+/** Levels of node coordinates used for the network distance **/
+#define FTI_TOPO_LEVELS 4
+
+/** @typedef    FTIT_nodeLoc
+ *  @brief      Location of a node in the network.
+ */
+typedef struct FTIT_nodeLoc {
+    int             node;                   /**< node index in 'nameList'   */
+    long            domain;                 /**< failure domain of the node */
+    long            coord[FTI_TOPO_LEVELS]; /**< coordinates, coarse first  */
+} FTIT_nodeLoc;
+
 int FTI_SaveTopo(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo, char *nameList);
-int FTI_ReorderNodes(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo,
+int FTI_LoadTopo(char* mfn, int nbNodes, char* oldList);
+int FTI_ReorderNodes(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, FTIT_topology* FTI_Topo,
         int *nodeList, char *nameList);
 int FTI_BuildNodeList(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         FTIT_topology* FTI_Topo, int *nodeList, char *nameList);
+int FTI_PlaceGroups(FTIT_topology* FTI_Topo, FTIT_nodeLoc* loc, int* order);
+int FTI_GroupNodes(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
+        FTIT_topology* FTI_Topo, int *nodeList, char *nameList);
 int FTI_CreateComms(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         FTIT_topology* FTI_Topo, int *userProcList,
         int *distProcList, int* nodeList);
@@ -39,16 +39,80 @@
 
 #include "../interface.h"
 
-int FTI_InitDataset( FTIT_execution* FTI_Exec, FTIT_dataset* data , int id )
+/** Entries of the first slab of the side table, each slab doubles */
+#define FTI_ATTR_SLAB_MIN 32
+
+/** Maximum number of slabs of the side table */
+#define FTI_ATTR_NB_SLABS 32
+
+/*-------------------------------------------------------------------------*/
+/**
+    @var static FTIT_datasetAttr* attrSlabs[FTI_ATTR_NB_SLABS]
+    Side table of the names and dimensions of the protected datasets. The
+    slabs are never moved, so the 'attr' pointers of the datasets stay
+    valid until 'FTI_FreeDatasetAttr'.
+**/
+/*-------------------------------------------------------------------------*/
+static FTIT_datasetAttr* attrSlabs[FTI_ATTR_NB_SLABS];
+static long attrUsed = 0;
+
+int FTI_InitDataset( FTIT_execution* FTI_Exec, FTIT_dataset* data, FTIT_datasetAttr* attr, int id )
 {
     FTIT_dataset dataNew = {0};
-    dataNew.rank = 1;
-    dataNew.h5group = FTI_Exec->H5groups[0];
-    sprintf(dataNew.name, "Dataset_%d", id);
+    memset(attr, 0, sizeof(FTIT_datasetAttr));
     dataNew.rank = 1;
     dataNew.h5group = FTI_Exec->H5groups[0];
     dataNew.id = id;
-    sprintf(dataNew.name, "Dataset_%d", id);
+    dataNew.attr = attr;
+    sprintf(attr->name, "Dataset_%d", id);
     memcpy(data, &dataNew, sizeof(FTIT_dataset));
     return FTI_SCES;
 }
+
+int FTI_AppendDataset( FTIT_keymap* FTI_Data, FTIT_dataset* data, int id )
+{
+    // slab 'k' holds the entries [MIN*(2^k-1), MIN*(2^(k+1)-1))
+    long first = 0, size = FTI_ATTR_SLAB_MIN;
+    int k = 0;
+    while( (k < FTI_ATTR_NB_SLABS) && (attrUsed >= first + size) ) {
+        first += size;
+        size *= 2;
+        k++;
+    }
+    if( k == FTI_ATTR_NB_SLABS ) {
+        FTI_Print("too many datasets for the side table of the dataset attributes", FTI_EROR);
+        return FTI_NSCS;
+    }
+    if( attrSlabs[k] == NULL ) {
+        attrSlabs[k] = talloc( FTIT_datasetAttr, size );
+        if( attrSlabs[k] == NULL ) {
+            FTI_Print("failed to allocate the side table of the dataset attributes", FTI_EROR);
+            return FTI_NSCS;
+        }
+    }
+
+    FTIT_datasetAttr* attr = attrSlabs[k] + (attrUsed - first);
+    if( data->attr ) {
+        memcpy(attr, data->attr, sizeof(FTIT_datasetAttr));
+    } else {
+        memset(attr, 0, sizeof(FTIT_datasetAttr));
+    }
+    FTIT_datasetAttr* local = data->attr;
+    data->attr = attr;
+    int res = FTI_Data->push_back( data, id );
+    data->attr = local;
+    if( res == FTI_SCES ) {
+        attrUsed++;
+    }
+    return res;
+}
+
+void FTI_FreeDatasetAttr()
+{
+    int k;
+    for( k=0; k<FTI_ATTR_NB_SLABS; k++ ) {
+        free( attrSlabs[k] );
+        attrSlabs[k] = NULL;
+    }
+    attrUsed = 0;
+}
@@ -52,6 +52,9 @@
   metadata.
   @param        data[out]       <b> FTIT_dataset* </b>      Pointer to dataset
   to be initialized.
+  @param        attr[out]       <b> FTIT_datasetAttr* </b>  Names and dimensions
+  of the dataset, 'data->attr' points to it until the dataset is appended with
+  \ref FTI_AppendDataset.
   @param        id[in]          <b> int </b>                id of dataset to
   be initialized.
   
@@ -59,6 +62,39 @@
  
 
 --------------------------------------------------------------------------**/
-int FTI_InitDataset( FTIT_execution* FTI_Exec, FTIT_dataset* data , int id );
+int FTI_InitDataset( FTIT_execution* FTI_Exec, FTIT_dataset* data, FTIT_datasetAttr* attr, int id );
+
+/**--------------------------------------------------------------------------
+  
+  
+  @brief        Appends a dataset to the protected variables.
+
+  The names and dimensions 'data->attr' points to (if any) are copied to the
+  side table of the dataset attributes, and the dataset is pushed back to the
+  keymap with 'attr' pointing to the copy. The entries of the side table are
+  never moved, thus the pointer stays valid until \ref FTI_FreeDatasetAttr.
+  'data' itself is not modified.
+
+  @param        FTI_Data[in]    <b> FTIT_keymap* </b>       Protected variables.
+  @param        data[in]        <b> FTIT_dataset* </b>      Dataset to append.
+  @param        id[in]          <b> int </b>                id of the dataset.
+  
+  @return                       \ref FTI_SCES if successful  
+                                \ref FTI_NSCS on failure
+ 
+
+--------------------------------------------------------------------------**/
+int FTI_AppendDataset( FTIT_keymap* FTI_Data, FTIT_dataset* data, int id );
+
+/**--------------------------------------------------------------------------
+  
+  
+  @brief        Frees the side table of the dataset attributes.
+
+  Called together with the 'clear' of the keymap of the protected variables.
+ 
+
+--------------------------------------------------------------------------**/
+void FTI_FreeDatasetAttr( void );
 
 #endif
@@ -0,0 +1,269 @@
+/**
+ *  Copyright (c) 2017 Leonardo A. Bautista-Gomez
+ *  All rights reserved
+ *
+ *  FTI - A multi-level checkpointing library for C/C++/Fortran applications
+ *
+ *  Revision 1.0 : Fault Tolerance Interface (FTI)
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *  @file   handoff.c
+ *  @date   October, 2026
+ *  @brief  Shared memory handoff of checkpoint data from application
+ *          ranks to the heads.
+ *
+ *  If 'Advanced:shm_handoff' is enabled, the application ranks mirror
+ *  the local checkpoint file into a POSIX shared memory segment while
+ *  writing it. The heads map that segment during post-processing (L2,
+ *  L3 and L4) instead of re-reading the local file. The segment is
+ *  removed by the head as soon as the post-processing for the rank is
+ *  done. If no segment exists, the heads fall back to the local file.
+ *
+ *  The handoff only saves the head the reading of the local file, the
+ *  application ranks still write it in full. The local file is what L1,
+ *  L2 and L3 recover from, and what the head reads if the segment is
+ *  missing, thus it cannot be skipped.
+ */
+
+#include "../interface.h"
+#include <sys/mman.h>
+#include <dirent.h>
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Builds the name of the shared memory segment for a ckpt. file.
+  @param      FTI_Exec        Execution metadata.
+  @param      ckptFile        Name of the checkpoint file.
+  @param      name            Segment name [out].
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_HandoffName(FTIT_execution* FTI_Exec, char* ckptFile, char* name)
+{
+    snprintf(name, FTI_BUFS, "/fti-%s-%s", FTI_Exec->id, ckptFile);
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Creates the shared memory segment for the current checkpoint.
+  @param      FTI_Exec        Execution metadata.
+  @param      ho              Handoff descriptor [out].
+  @param      size            Size of the checkpoint file.
+  @return     integer         FTI_SCES if successful.
+
+  The segment is created for 'FTI_Exec->ckptMeta.ckptFile' and mapped
+  for writing. The content is supplied by 'FTI_PosixWrite'.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_HandoffCreate(FTIT_execution* FTI_Exec, FTIT_handoff* ho, size_t size)
+{
+    char str[FTI_BUFS];
+
+    ho->ptr = NULL;
+    ho->size = 0;
+    ho->pos = 0;
+    FTI_HandoffName(FTI_Exec, FTI_Exec->ckptMeta.ckptFile, ho->name);
+
+    if (size == 0) {
+        return FTI_NSCS;
+    }
+
+    int fd = shm_open(ho->name, O_CREAT | O_TRUNC | O_RDWR, (mode_t) 0600);
+    if (fd == -1) {
+        snprintf(str, FTI_BUFS, "unable to create shared memory segment '%s' [%s].", ho->name, strerror(errno));
+        FTI_Print(str, FTI_WARN);
+        errno = 0;
+        return FTI_NSCS;
+    }
+    if (ftruncate(fd, size) == -1) {
+        snprintf(str, FTI_BUFS, "unable to resize shared memory segment '%s' [%s].", ho->name, strerror(errno));
+        FTI_Print(str, FTI_WARN);
+        errno = 0;
+        close(fd);
+        shm_unlink(ho->name);
+        return FTI_NSCS;
+    }
+    void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        snprintf(str, FTI_BUFS, "unable to map shared memory segment '%s' [%s].", ho->name, strerror(errno));
+        FTI_Print(str, FTI_WARN);
+        errno = 0;
+        shm_unlink(ho->name);
+        return FTI_NSCS;
+    }
+
+    ho->ptr = ptr;
+    ho->size = size;
+
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Unmaps the segment on the application side.
+  @param      ho              Handoff descriptor.
+
+  The segment itself persists until the head removes it. If the mirrored
+  content is incomplete, the segment is removed right away and the head
+  will read the local file instead.
+ **/
+/*-------------------------------------------------------------------------*/
+void FTI_HandoffDetach(FTIT_handoff* ho)
+{
+    if (ho->ptr == NULL) {
+        return;
+    }
+    munmap(ho->ptr, ho->size);
+    if (ho->pos != ho->size) {
+        shm_unlink(ho->name);
+    }
+    ho->ptr = NULL;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Removes the segment of the current checkpoint.
+  @param      FTI_Exec        Execution metadata.
+
+  Called by the application ranks if the checkpoint is rejected, since
+  the heads will not post-process (and thus not remove) it.
+ **/
+/*-------------------------------------------------------------------------*/
+void FTI_HandoffUnlink(FTIT_execution* FTI_Exec)
+{
+    char name[FTI_BUFS];
+    FTI_HandoffName(FTI_Exec, FTI_Exec->ckptMeta.ckptFile, name);
+    shm_unlink(name);
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Opens the checkpoint data of a rank for post-processing.
+  @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Exec        Execution metadata.
+  @param      lfn             Path of the local checkpoint file.
+  @param      size            Number of bytes to expose (zero padded).
+  @param      ho              Handoff descriptor [out].
+  @return     FILE*           Stream to read from, NULL on failure.
+
+  If the handoff is enabled and a segment exists for
+  'FTI_Exec->ckptMeta.ckptFile', the returned stream reads from the
+  shared memory. Otherwise the local file 'lfn' is opened. The stream
+  must be closed with 'FTI_HandoffClose'.
+ **/
+/*-------------------------------------------------------------------------*/
+FILE* FTI_HandoffOpen(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
+        char* lfn, long size, FTIT_handoff* ho)
+{
+    ho->ptr = NULL;
+    ho->size = 0;
+    ho->pos = 0;
+
+    if (FTI_Conf->shmHandoff && size > 0) {
+        FTI_HandoffName(FTI_Exec, FTI_Exec->ckptMeta.ckptFile, ho->name);
+        int fd = shm_open(ho->name, O_RDWR, (mode_t) 0600);
+        if (fd != -1) {
+            struct stat st;
+            if ((fstat(fd, &st) == 0) && (st.st_size <= size)) {
+                // pad with zeros (L3 encodes 'maxFs' bytes)
+                if ((st.st_size == size) || (ftruncate(fd, size) == 0)) {
+                    void* ptr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+                    if (ptr != MAP_FAILED) {
+                        FILE* mfd = fmemopen(ptr, size, "r");
+                        if (mfd != NULL) {
+                            close(fd);
+                            ho->ptr = ptr;
+                            ho->size = size;
+                            char str[FTI_BUFS];
+                            snprintf(str, FTI_BUFS, "Reading ckpt. data from shared memory (%s).", ho->name);
+                            FTI_Print(str, FTI_DBUG);
+                            return mfd;
+                        }
+                        munmap(ptr, size);
+                    }
+                }
+            }
+            close(fd);
+            shm_unlink(ho->name);
+        }
+        errno = 0;
+    }
+
+    return fopen(lfn, "rb");
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Closes a stream opened with 'FTI_HandoffOpen'.
+  @param      fd              Stream to close.
+  @param      ho              Handoff descriptor.
+
+  If the stream was backed by shared memory, the segment is unmapped and
+  removed.
+ **/
+/*-------------------------------------------------------------------------*/
+void FTI_HandoffClose(FILE* fd, FTIT_handoff* ho)
+{
+    fclose(fd);
+    if (ho->ptr != NULL) {
+        munmap(ho->ptr, ho->size);
+        shm_unlink(ho->name);
+        ho->ptr = NULL;
+    }
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Removes stale segments of the current execution.
+  @param      FTI_Exec        Execution metadata.
+
+  Segments of checkpoints that were not post-processed (e.g. after a
+  failure) are left behind. This function removes all segments with the
+  prefix of the current execution ID. Linux exposes the POSIX shared
+  memory objects in '/dev/shm'.
+ **/
+/*-------------------------------------------------------------------------*/
+void FTI_HandoffCleanup(FTIT_execution* FTI_Exec)
+{
+    char prefix[FTI_BUFS];
+    snprintf(prefix, FTI_BUFS, "fti-%s-", FTI_Exec->id);
+    size_t len = strlen(prefix);
+
+    DIR* dp = opendir("/dev/shm");
+    if (dp == NULL) {
+        errno = 0;
+        return;
+    }
+    struct dirent* ep;
+    while ((ep = readdir(dp)) != NULL) {
+        if (strncmp(ep->d_name, prefix, len) == 0) {
+            char name[FTI_BUFS];
+            snprintf(name, FTI_BUFS, "/%s", ep->d_name);
+            shm_unlink(name);
+        }
+    }
+    closedir(dp);
+}
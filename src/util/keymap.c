@@ -38,6 +38,7 @@
  */
 
 #include "../interface.h"
+#include <sys/mman.h>
 
 /*-------------------------------------------------------------------------*/
 /** 
@@ -47,6 +48,178 @@
 /*-------------------------------------------------------------------------*/
 static FTIT_keymap self;
 
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Hashes a key for the open addressing lookup table.
+  @param      key             The key.
+  @return     unsigned        The hash of the key.
+ **/
+/*-------------------------------------------------------------------------*/
+static inline uint32_t FTI_KeyMapHash( int key )
+{
+    uint32_t h = (uint32_t) key;
+    h ^= h >> 16; h *= 0x45d9f3b;
+    h ^= h >> 16; h *= 0x45d9f3b;
+    h ^= h >> 16;
+    return h;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Returns the slot of a key in the lookup table.
+  @param      slots           The lookup table.
+  @param      nslots          Size of the table (power of two).
+  @param      key             The key.
+  @return     long            Slot holding the key or the empty slot
+                              where it would be inserted.
+ **/
+/*-------------------------------------------------------------------------*/
+static long FTI_KeyMapSlot( FTIT_keyslot* slots, long nslots, int key )
+{
+    long i = FTI_KeyMapHash( key ) & (nslots - 1);
+    while( slots[i].key != -1 && slots[i].key != key ) {
+        i = (i + 1) & (nslots - 1);
+    }
+    return i;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Resizes the lookup table.
+  @param      nslots          New size of the table (power of two).
+  @return     integer         FTI_SCES if successful.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_KeyMapRehash( long nslots )
+{
+    FTIT_keyslot* slots = talloc( FTIT_keyslot, nslots );
+    if( !slots ) {
+        FTI_Print("Failed to extent keymap lookup table", FTI_EROR);
+        return FTI_NSCS;
+    }
+    long i=0; for(; i<nslots; i++) {
+        slots[i].key = -1;
+        slots[i].pos = -1;
+    }
+    for(i=0; i<self._nslots; i++) {
+        if( self._slots[i].key != -1 ) {
+            slots[FTI_KeyMapSlot( slots, nslots, self._slots[i].key )] = self._slots[i];
+        }
+    }
+    free( self._slots );
+    self._slots = slots;
+    self._nslots = nslots;
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Rounds a size up to whole pages.
+  @param      bytes           Size in bytes.
+  @return     size_t          Size in bytes of the pages holding 'bytes'.
+ **/
+/*-------------------------------------------------------------------------*/
+static size_t FTI_KeyMapPages( size_t bytes )
+{
+    size_t page = sysconf( _SC_PAGESIZE );
+    return ( (bytes + page - 1) / page ) * page;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Makes the start of a reserved range accessible.
+  @param      base            Start of the reserved range.
+  @param      bytes           Number of bytes needed.
+  @param      limit           Size of the reserved range.
+  @return     integer         FTI_SCES if successful.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_KeyMapCommit( void* base, size_t bytes, size_t limit )
+{
+    bytes = FTI_KeyMapPages( bytes );
+    if( bytes > limit ) {
+        bytes = limit;
+    }
+    return ( mprotect( base, bytes, PROT_READ | PROT_WRITE ) == 0 ) ? FTI_SCES : FTI_NSCS;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Extends the reserved range of the elements.
+  @param      max_size        New number of elements reserved.
+  @return     integer         FTI_SCES if successful.
+
+  The range is extended in place if the address space behind it is free.
+  Else, the elements are moved to a new range, like with realloc.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_KeyMapReserve( long max_size )
+{
+    size_t old = FTI_KeyMapPages( self._max_size * self._type_size );
+    size_t bytes = FTI_KeyMapPages( max_size * self._type_size );
+
+    void* end = (char*)self._data + old;
+    void* ext = mmap( end, bytes - old, PROT_NONE, 
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+    if( ext == end ) {
+        self._max_size = max_size;
+        return FTI_SCES;
+    }
+    if( ext != MAP_FAILED ) {
+        munmap( ext, bytes - old );
+    }
+
+    void* data = mmap( NULL, bytes, PROT_NONE, 
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+    if( data == MAP_FAILED ) {
+        return FTI_NSCS;
+    }
+    if( FTI_KeyMapCommit( data, self._size * self._type_size, bytes ) != FTI_SCES ) {
+        munmap( data, bytes );
+        return FTI_NSCS;
+    }
+    memcpy( data, self._data, self._used * self._type_size );
+    munmap( self._data, old );
+    self._data = data;
+    self._max_size = max_size;
+    FTI_Print("keymap elements moved to a larger address range", FTI_DBUG);
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Makes room for more elements.
+  @param      new_size        New capacity in number of elements.
+  @return     integer         FTI_SCES if successful.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_KeyMapGrow( long new_size )
+{
+    if( !self._mapped ) {
+        void* alloc = realloc( self._data, new_size * self._type_size );
+        if( !alloc ) {
+            return FTI_NSCS;
+        }
+        self._data = alloc;
+        return FTI_SCES;
+    }
+
+    // the reservation doubles, up to the maximum key
+    if( new_size > self._max_size ) {
+        long max_size = ( 2 * self._max_size > new_size ) ? 2 * self._max_size : new_size;
+        if( max_size > (long)self._max_key + 1 ) {
+            max_size = (long)self._max_key + 1;
+        }
+        if( FTI_KeyMapReserve( max_size ) != FTI_SCES ) {
+            return FTI_NSCS;
+        }
+    }
+
+    // commit more of the reserved range, the elements stay in place
+    return FTI_KeyMapCommit( self._data, new_size * self._type_size, 
+            FTI_KeyMapPages( self._max_size * self._type_size ) );
+}
+
 int FTI_KeyMap( FTIT_keymap** instance, long type_size, long max_key, bool reset )
 {
 
@@ -64,10 +237,27 @@ int FTI_KeyMap( FTIT_keymap** instance, long type_size, long max_key, bool reset
 
     self._type_size = type_size;
     self._max_key = max_key;
-    self._key = talloc( int, max_key+1 );
 
-    int i=0; for(; i<max_key+1; i++)
-        self._key[i] = -1;
+    // reserve address space for the elements, memory is only committed
+    // when elements are added, so elements do not move until the
+    // reservation is exhausted.
+    self._max_size = ( max_key < (long)FTI_MIN_RESERVE ) ? max_key + 1 : (long)FTI_MIN_RESERVE;
+    self._data = mmap( NULL, FTI_KeyMapPages( self._max_size * type_size ), PROT_NONE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+    self._mapped = ( self._data != MAP_FAILED );
+    if( !self._mapped ) {
+        self._data = NULL;
+        self._max_size = 0;
+        FTI_Print("Failed to reserve keymap memory, elements are allocated with malloc", FTI_DBUG);
+    }
+
+    if( FTI_KeyMapRehash( FTI_MIN_REALLOC * 2 ) != FTI_SCES ) {
+        if( self._mapped ) {
+            munmap( self._data, FTI_KeyMapPages( self._max_size * type_size ) );
+        }
+        self._data = NULL;
+        return FTI_NSCS;
+    }
 
     self.push_back = FTI_KeyMapPushBack;
     self.data = FTI_KeyMapData;
@@ -105,7 +295,7 @@ int FTI_KeyMapPushBack( void* new_item, int key )
         return FTI_NSCS;
     }
 
-    if( self._key[key] != -1 ) {
+    if( self._slots[FTI_KeyMapSlot( self._slots, self._nslots, key )].key != -1 ) {
         snprintf( str, FTI_BUFS, "Requested key='%d' is already in use", key );
         FTI_Print( str, FTI_EROR);
         return FTI_NSCS;
@@ -129,20 +319,29 @@ int FTI_KeyMapPushBack( void* new_item, int key )
 
         }
 
-        void* alloc = realloc( self._data, new_size * self._type_size );
-        
-        if(!alloc) {
+        if( new_size > (long)self._max_key + 1 ) {
+            new_size = (long)self._max_key + 1;
+        }
+
+        if( FTI_KeyMapGrow( new_size ) != FTI_SCES ) {
             FTI_Print("Failed to extent keymap size", FTI_EROR);
             return FTI_NSCS;
         }
-
-        self._data = alloc;
     
     }
 
+    // keep the load factor of the lookup table below 1/2
+    if( 2 * new_used > self._nslots ) {
+        if( FTI_KeyMapRehash( 2 * self._nslots ) != FTI_SCES ) {
+            return FTI_NSCS;
+        }
+    }
+
     memcpy(self._data + self._used*self._type_size, new_item, self._type_size);
     
-    self._key[key] = self._used;
+    long slot = FTI_KeyMapSlot( self._slots, self._nslots, key );
+    self._slots[slot].key = key;
+    self._slots[slot].pos = self._used;
     self._used = new_used;
     self._size = new_size;
 
@@ -187,7 +386,7 @@ int FTI_KeyMapGet( FTIT_dataset** data, int key )
         return FTI_NSCS;
     }
 
-    long check_pos = self._key[key];
+    long check_pos = self._slots[FTI_KeyMapSlot( self._slots, self._nslots, key )].pos;
 
     if( check_pos > (self._used - 1) ) {
         FTI_Print("data location out of bounds", FTI_EROR );
@@ -214,8 +413,12 @@ int FTI_KeyMapClear()
         return FTI_NSCS;
     }
 
-    free(self._data);
-    free(self._key);
+    if( self._mapped ) {
+        munmap(self._data, FTI_KeyMapPages( self._max_size * self._type_size ));
+    } else {
+        free(self._data);
+    }
+    free(self._slots);
     
     FTIT_keymap reset = {0};
     
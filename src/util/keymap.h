@@ -49,6 +49,15 @@ extern "C" {
     /** Maximum size for dynamic reallocation (in number of elements) ~ 10 Mb for FTIT_dataset */
     const static size_t FTI_MAX_REALLOC = 10*1024;  
 
+    /** Number of elements of the address space reserved at creation */
+    const static size_t FTI_MIN_RESERVE = 64*1024;
+
+    /** Slot of the open addressing lookup table (key = -1 if empty) */
+    typedef struct FTIT_keyslot {
+        int     key;            /**< Key of the element                        */
+        int     pos;            /**< Location of the element in keymap         */
+    } FTIT_keyslot;
+
     /**--------------------------------------------------------------------------
       
       
@@ -72,9 +81,12 @@ extern "C" {
         long    _type_size;     /**< Size of keymap elements                   */
         long    _size;          /**< Capacity of keymap                        */
         long    _used;          /**< Number of elements in keymap              */
+        long    _max_size;      /**< Number of elements reserved               */
+        bool    _mapped;        /**< False if elements are allocated by malloc */
         int     _max_key;       /**< Maximum value for key                     */       
         void*   _data;          /**< Pointer to first element in keymap        */
-        int*    _key;           /**< Lookup table for key -> location in keymap*/
+        FTIT_keyslot* _slots;   /**< Lookup table for key -> location in keymap*/
+        long    _nslots;        /**< Size of lookup table (power of two)       */
         int     (*push_back)    ( void*, int );
         int     (*data)         ( FTIT_dataset**, int );
         int     (*get)          ( FTIT_dataset**, int );
@@ -93,6 +105,15 @@ extern "C" {
       after the successful call, <code>*instance</code> points to the static
       variable \ref self. The call to the function if the keymap was already 
       initialized is erroneous and is protected by assert. 
+
+      Keys are looked up in an open addressing hash table, so memory scales
+      with the number of elements and not with the maximum key. The elements
+      are stored in a range of address space reserved for min(max_key+1, 
+      \ref FTI_MIN_RESERVE) elements; pages are only committed as elements are
+      added, so pointers returned by get and data stay valid. The reservation
+      doubles when it is exhausted, in place if possible, else the elements
+      are moved as with realloc. If no address space can be reserved, the
+      elements are allocated with malloc and realloc.
       
       @param        instance[out]     <b> FTIT_keymap** </b>  Pointer to be set to
       the static instance of the key value container.
@@ -113,9 +134,9 @@ extern "C" {
     
       This function inserts a new element to the keymap. The allocation happens
       dynamically and is inspired by the C++ vector push_back method. each time
-      the addition of an element leads to the necessity of a reallocation, the 
-      new allocation size will be set to twice the current size. However, the 
-      maximum reallocation size can be controlled by the variable \ref FTI_MAX_REALLOC. 
+      the addition of an element exceeds the committed memory, the committed
+      size will be set to twice the current size. However, the maximum
+      extension can be controlled by the variable \ref FTI_MAX_REALLOC. 
       The first allocation size (first insertion) is controled by variable 
       \ref FTI_MIN_REALLOC. The new item will be copied so that we are not in danger 
       for inconsistent pointer values when the passed pointer goes out of scope.
@@ -0,0 +1,486 @@
+/**
+ *  Copyright (c) 2017 Leonardo A. Bautista-Gomez
+ *  All rights reserved
+ *
+ *  FTI - A multi-level checkpointing library for C/C++/Fortran applications
+ *
+ *  Revision 1.0 : Fault Tolerance Interface (FTI)
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *  @file   reclaim.c
+ *  @date   October, 2026
+ *  @brief  Deferred deletion of old checkpoint directories.
+ *
+ *  With 'Advanced:reclaim_threads' > 0, FTI_RmDir does not unlink the
+ *  files of an old checkpoint directory itself: FTI_TrashDir renames the
+ *  directory next to itself (<dir>.trash-<pid>-<n>, same file system, a
+ *  single metadata operation) and queues it. The reclaim threads of the
+ *  process share the readdir stream of the oldest queued directory, so
+ *  that the unlinks of a directory run in parallel, and remove the
+ *  directory once it is empty.
+ *
+ *  Reclamation must stay ahead of the checkpoints: FTI_TrashDir blocks
+ *  while 'Advanced:reclaim_max_pending' directories are queued, and
+ *  FTI_ReclaimReserve lets a checkpoint wait until the reclaim threads
+ *  have freed enough space for it on its file system. FTI_FinalizeReclaim
+ *  drains the queue before the final clean up of FTI_Finalize.
+ *
+ *  The reclaim threads do not call MPI or FTI_Print.
+ */
+
+#include "../interface.h"
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+
+/** @typedef    FTIT_trashDir
+ *  @brief      Directory queued for deletion.
+ */
+typedef struct FTIT_trashDir {
+    char                    path[FTI_BUFS]; /**< trash name of the directory */
+    DIR*                    dp;             /**< shared readdir stream       */
+    bool                    eof;            /**< all files handed out        */
+    int                     active;         /**< files being removed         */
+    double                  start;          /**< trace start of the deletion */
+    struct FTIT_trashDir*   next;           /**< next queued directory       */
+} FTIT_trashDir;
+
+/** Reclaimer of this process. */
+static struct {
+    pthread_t*      thread;
+    int             nbThreads;  /**< 0 if the deletion is synchronous */
+    int             maxPending; /**< directories queued at most       */
+    int             pending;    /**< directories queued               */
+    FTIT_trashDir*  first;
+    bool            stop;
+    unsigned int    seq;        /**< trash names of this process      */
+    uint64_t        nbDirs;
+    uint64_t        nbFiles;
+    uint64_t        nbErrors;
+    double          tWait;      /**< time callers waited for the queue */
+    pthread_mutex_t lock;
+    pthread_cond_t  work;       /**< directory queued or stop         */
+    pthread_cond_t  done;       /**< directory removed                */
+} FTI_Reclaim = { .nbThreads = 0, .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work = PTHREAD_COND_INITIALIZER, .done = PTHREAD_COND_INITIALIZER };
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Returns the time of the monotonic clock in seconds.
+  @return     double          time in seconds.
+ **/
+/*-------------------------------------------------------------------------*/
+static double FTI_ReclaimNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Removes an emptied directory and dequeues it.
+  @param      dir             Directory whose files are all removed.
+
+  Called with the reclaimer locked.
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_ReclaimDone(FTIT_trashDir* dir)
+{
+    if (dir->dp != NULL) {
+        closedir(dir->dp);
+    }
+    if (rmdir(dir->path) == -1 && errno != ENOENT) {
+        FTI_Reclaim.nbErrors++;
+    }
+    FTIT_trashDir** prev = &FTI_Reclaim.first;
+    while (*prev != dir) {
+        prev = &(*prev)->next;
+    }
+    *prev = dir->next;
+    FTI_Reclaim.pending--;
+    FTI_Reclaim.nbDirs++;
+    FTI_TraceEvent(FTI_TRACE_RECLAIM, -1, dir->start, 0);
+    free(dir);
+    pthread_cond_broadcast(&FTI_Reclaim.done);
+    // idle threads recheck whether to stop
+    pthread_cond_broadcast(&FTI_Reclaim.work);
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Main loop of the reclaim threads.
+  @param      arg             unused.
+  @return     void*           NULL.
+
+  Each thread takes the next file of the oldest directory that still has
+  files to hand out and removes it without holding the lock.
+ **/
+/*-------------------------------------------------------------------------*/
+static void* FTI_ReclaimWorker(void* arg)
+{
+    char fn[FTI_BUFS];
+
+    pthread_mutex_lock(&FTI_Reclaim.lock);
+    while (true) {
+        FTIT_trashDir* dir = FTI_Reclaim.first;
+        while (dir != NULL && dir->eof) {
+            dir = dir->next;
+        }
+        if (dir == NULL) {
+            if (FTI_Reclaim.stop && FTI_Reclaim.first == NULL) {
+                break;
+            }
+            pthread_cond_wait(&FTI_Reclaim.work, &FTI_Reclaim.lock);
+            continue;
+        }
+        if (dir->dp == NULL) {
+            dir->start = FTI_TraceStart();
+            dir->dp = opendir(dir->path);
+            if (dir->dp == NULL) {
+                FTI_Reclaim.nbErrors += (errno != ENOENT);
+                dir->eof = true;
+                if (dir->active == 0) {
+                    FTI_ReclaimDone(dir);
+                }
+                continue;
+            }
+        }
+        struct dirent* ep = readdir(dir->dp);
+        if (ep == NULL) {
+            dir->eof = true;
+            if (dir->active == 0) {
+                FTI_ReclaimDone(dir);
+            }
+            continue;
+        }
+        if (strcmp(ep->d_name, ".") == 0 || strcmp(ep->d_name, "..") == 0) {
+            continue;
+        }
+        snprintf(fn, FTI_BUFS, "%s/%s", dir->path, ep->d_name);
+        dir->active++;
+        pthread_mutex_unlock(&FTI_Reclaim.lock);
+
+        int res = remove(fn);
+        int err = errno;
+
+        pthread_mutex_lock(&FTI_Reclaim.lock);
+        if (res == -1 && err != ENOENT) {
+            FTI_Reclaim.nbErrors++;
+        } else {
+            FTI_Reclaim.nbFiles++;
+        }
+        dir->active--;
+        if (dir->eof && dir->active == 0) {
+            FTI_ReclaimDone(dir);
+        }
+    }
+    pthread_mutex_unlock(&FTI_Reclaim.lock);
+
+    return NULL;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Starts the reclaim threads of this process.
+  @param      FTI_Conf        Configuration metadata.
+  @return     integer         FTI_SCES if successful.
+
+  Without reclaim threads FTI_RmDir deletes synchronously.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_InitReclaim(FTIT_configuration* FTI_Conf)
+{
+    char str[FTI_BUFS];
+    int i;
+
+    if (FTI_Conf->reclaimThreads <= 0) {
+        return FTI_SCES;
+    }
+    FTI_Reclaim.thread = (pthread_t*) malloc(sizeof(pthread_t) * FTI_Conf->reclaimThreads);
+    if (FTI_Reclaim.thread == NULL) {
+        FTI_Print("Failed to allocate the reclaim threads, old checkpoints are deleted synchronously.", FTI_WARN);
+        return FTI_NSCS;
+    }
+    FTI_Reclaim.maxPending = FTI_Conf->reclaimMaxPending;
+    FTI_Reclaim.stop = false;
+    for (i = 0; i < FTI_Conf->reclaimThreads; i++) {
+        if (pthread_create(&FTI_Reclaim.thread[i], NULL, FTI_ReclaimWorker, NULL) != 0) {
+            break;
+        }
+        FTI_Reclaim.nbThreads++;
+    }
+    if (FTI_Reclaim.nbThreads < FTI_Conf->reclaimThreads) {
+        snprintf(str, FTI_BUFS, "Could only start %d of %d reclaim threads.",
+                FTI_Reclaim.nbThreads, FTI_Conf->reclaimThreads);
+        FTI_Print(str, FTI_WARN);
+    }
+    if (FTI_Reclaim.nbThreads == 0) {
+        free(FTI_Reclaim.thread);
+        FTI_Reclaim.thread = NULL;
+        return FTI_NSCS;
+    }
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Appends a trash directory to the queue of the reclaim threads.
+  @param      dir             Directory to delete, renamed already.
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_ReclaimQueue(FTIT_trashDir* dir)
+{
+    pthread_mutex_lock(&FTI_Reclaim.lock);
+    FTIT_trashDir** last = &FTI_Reclaim.first;
+    while (*last != NULL) {
+        last = &(*last)->next;
+    }
+    *last = dir;
+    FTI_Reclaim.pending++;
+    pthread_cond_broadcast(&FTI_Reclaim.work);
+    pthread_mutex_unlock(&FTI_Reclaim.lock);
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Hands a directory over to the reclaim threads.
+  @param      path            Directory to delete.
+  @return     integer         FTI_SCES if the directory is gone from path.
+
+  The directory is renamed to its trash name at once and deleted later.
+  Blocks while the queue is full. Returns FTI_NSCS without reclaim
+  threads or if the rename fails, the caller then deletes it itself.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_TrashDir(char path[FTI_BUFS])
+{
+    if (FTI_Reclaim.nbThreads == 0) {
+        return FTI_NSCS;
+    }
+    FTIT_trashDir* dir = (FTIT_trashDir*) calloc(1, sizeof(FTIT_trashDir));
+    if (dir == NULL) {
+        return FTI_NSCS;
+    }
+
+    pthread_mutex_lock(&FTI_Reclaim.lock);
+    if (FTI_Reclaim.pending >= FTI_Reclaim.maxPending) {
+        double t0 = FTI_ReclaimNow();
+        while (FTI_Reclaim.pending >= FTI_Reclaim.maxPending) {
+            pthread_cond_wait(&FTI_Reclaim.done, &FTI_Reclaim.lock);
+        }
+        FTI_Reclaim.tWait += FTI_ReclaimNow() - t0;
+    }
+    int len = snprintf(dir->path, FTI_BUFS, "%s.trash-%d-%u", path, (int)getpid(), FTI_Reclaim.seq++);
+    pthread_mutex_unlock(&FTI_Reclaim.lock);
+
+    if (len >= FTI_BUFS || rename(path, dir->path) == -1) {
+        int err = (len >= FTI_BUFS) ? ENAMETOOLONG : errno;
+        free(dir);
+        errno = 0;
+        return (err == ENOENT) ? FTI_SCES : FTI_NSCS;
+    }
+
+    FTI_ReclaimQueue(dir);
+
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Tells whether a name is one of a trash directory.
+  @param      name            Name of the directory entry.
+  @return     bool            True if 'name' is '<name>.trash-<pid>-<n>'.
+
+  Only the names built by FTI_TrashDir match, other entries holding
+  '.trash-' are left alone.
+ **/
+/*-------------------------------------------------------------------------*/
+static bool FTI_IsTrashName(const char* name)
+{
+    const char* digits = "0123456789";
+    const char* suffix = NULL;
+    const char* p = name;
+
+    while ((p = strstr(p, ".trash-")) != NULL) {
+        suffix = p++;
+    }
+    if (suffix == NULL || suffix == name) {
+        return false;
+    }
+    p = suffix + strlen(".trash-");
+    size_t len = strspn(p, digits);
+    if (len == 0 || p[len] != '-') {
+        return false;
+    }
+    p += len + 1;
+    len = strspn(p, digits);
+    return (len > 0 && p[len] == '\0');
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Deletes the trash directories left in a directory.
+  @param      path            Directory holding checkpoint directories.
+  @return     integer         FTI_SCES if successful.
+
+  A process that stops before its reclaim threads are done leaves its
+  trash directories next to the checkpoint directories. They are queued
+  for the reclaim threads, or deleted at once without them.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_SweepTrashDir(char* path)
+{
+    char fn[FTI_BUFS];
+    struct stat st;
+
+    DIR* dp = opendir(path);
+    if (dp == NULL) {
+        errno = 0;
+        return FTI_SCES;
+    }
+    struct dirent* ep;
+    while ((ep = readdir(dp)) != NULL) {
+        if (!FTI_IsTrashName(ep->d_name)) {
+            continue;
+        }
+        if (snprintf(fn, FTI_BUFS, "%s/%s", path, ep->d_name) >= FTI_BUFS ||
+                stat(fn, &st) == -1 || !S_ISDIR(st.st_mode)) {
+            continue;
+        }
+        FTIT_trashDir* dir = NULL;
+        if (FTI_Reclaim.nbThreads > 0) {
+            dir = (FTIT_trashDir*) calloc(1, sizeof(FTIT_trashDir));
+        }
+        if (dir != NULL) {
+            strncpy(dir->path, fn, FTI_BUFS);
+            FTI_ReclaimQueue(dir);
+        } else {
+            FTI_RmDir(fn, 1);
+        }
+    }
+    closedir(dp);
+    errno = 0;
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Deletes the trash directories of previous executions.
+  @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Topo        Topology metadata.
+  @return     integer         FTI_SCES if successful.
+
+  Called by FTI_Init, after a crash the trash would otherwise stay on
+  disk, and by the final clean up, which removes the parent directories.
+  One process per node sweeps the local directory and one process the
+  global and meta data directories, as in FTI_Clean.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_SweepTrash(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo)
+{
+    bool nodeFlag = ((!FTI_Topo->amIaHead) && ((FTI_Topo->nodeRank - FTI_Topo->nbHeads) == 0)) ||
+        (FTI_Topo->amIaHead && FTI_Topo->headID == 0);
+
+    if (nodeFlag) {
+        FTI_SweepTrashDir(FTI_Conf->localDir);
+    }
+    if (FTI_Topo->splitRank == 0) {
+        FTI_SweepTrashDir(FTI_Conf->glbalDir);
+        FTI_SweepTrashDir(FTI_Conf->metadDir);
+    }
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Waits until a file system has room for a checkpoint.
+  @param      dir             Directory on the file system.
+  @param      bytes           Bytes the checkpoint needs.
+  @return     integer         FTI_SCES if successful.
+
+  Returns at once if the space is available or nothing is queued for
+  deletion; otherwise waits for the reclaim threads to remove queued
+  directories until it is.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_ReclaimReserve(char* dir, uint64_t bytes)
+{
+    if (FTI_Reclaim.nbThreads == 0) {
+        return FTI_SCES;
+    }
+    struct statvfs st;
+    double t0 = FTI_ReclaimNow();
+    pthread_mutex_lock(&FTI_Reclaim.lock);
+    while (FTI_Reclaim.first != NULL && statvfs(dir, &st) == 0 &&
+            (uint64_t)st.f_bavail * st.f_frsize < bytes) {
+        pthread_cond_wait(&FTI_Reclaim.done, &FTI_Reclaim.lock);
+    }
+    FTI_Reclaim.tWait += FTI_ReclaimNow() - t0;
+    pthread_mutex_unlock(&FTI_Reclaim.lock);
+    errno = 0;
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Deletes the queued directories and stops the reclaim threads.
+  @return     integer         FTI_SCES if all the files could be removed.
+
+  FTI_RmDir deletes synchronously afterwards.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_FinalizeReclaim(void)
+{
+    char str[FTI_BUFS];
+    int i;
+
+    if (FTI_Reclaim.nbThreads == 0) {
+        return FTI_SCES;
+    }
+    pthread_mutex_lock(&FTI_Reclaim.lock);
+    FTI_Reclaim.stop = true;
+    pthread_cond_broadcast(&FTI_Reclaim.work);
+    pthread_mutex_unlock(&FTI_Reclaim.lock);
+    for (i = 0; i < FTI_Reclaim.nbThreads; i++) {
+        pthread_join(FTI_Reclaim.thread[i], NULL);
+    }
+    free(FTI_Reclaim.thread);
+    FTI_Reclaim.thread = NULL;
+    FTI_Reclaim.nbThreads = 0;
+
+    snprintf(str, FTI_BUFS, "Reclaimed %lu directories (%lu files) in the background, waited %.2f sec. for it.",
+            (unsigned long)FTI_Reclaim.nbDirs, (unsigned long)FTI_Reclaim.nbFiles, FTI_Reclaim.tWait);
+    FTI_Print(str, FTI_DBUG);
+    if (FTI_Reclaim.nbErrors > 0) {
+        snprintf(str, FTI_BUFS, "Could not remove %lu files or directories of old checkpoints.",
+                (unsigned long)FTI_Reclaim.nbErrors);
+        FTI_Print(str, FTI_WARN);
+        return FTI_NSCS;
+    }
+    return FTI_SCES;
+}
@@ -0,0 +1,179 @@
+/**
+ *  Copyright (c) 2017 Leonardo A. Bautista-Gomez
+ *  All rights reserved
+ *
+ *  FTI - A multi-level checkpointing library for C/C++/Fortran applications
+ *
+ *  Revision 1.0 : Fault Tolerance Interface (FTI)
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *  @file   stripe.c
+ *  @date   October, 2026
+ *  @brief  Striping layout of the L4 checkpoint files.
+ *
+ *  Each L4 file (one per rank, or one shared file for MPI-IO) is
+ *  created with a stripe count that grows with its size and a first
+ *  OST chosen from the index of the file. Files are numbered so that
+ *  consecutive files belong to different nodes; with the same stripe
+ *  count c, file i starts on OST i*c, so the files of the job cover
+ *  all OSTs round-robin instead of piling up on the default ones.
+ *
+ *  Without Lustre, 'Advanced:lustre_ost_count' describes a simulated
+ *  file system: the layout is planned and logged the same way, but the
+ *  files are created with the default layout.
+ */
+
+#include "../interface.h"
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Returns the number of OSTs used to plan the layouts.
+  @param      FTI_Conf        Configuration metadata.
+  @return     integer         Number of OSTs, 0 if striping is disabled.
+
+  With Lustre, the number of OSTs of the file system holding the global
+  directory is queried once. 'Advanced:lustre_ost_count', if set, takes
+  precedence and is the only source of the simulated model otherwise.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_StripeOsts(FTIT_configuration* FTI_Conf)
+{
+#ifdef LUSTRE
+    if (FTI_Conf->stripeOstCount < 0) {
+        int count = 0;
+        if (llapi_get_obd_count(FTI_Conf->glbalDir, &count, 0) != 0 || count < 1) {
+            FTI_Print("[Lustre] Cannot get the number of OSTs, using the default layout.", FTI_DBUG);
+            count = 0;
+        }
+        FTI_Conf->stripeOstCount = count;
+    }
+#endif
+    return (FTI_Conf->stripeOstCount > 0) ? FTI_Conf->stripeOstCount : 0;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Returns the index of the L4 file of a process.
+  @param      FTI_Topo        Topology metadata.
+  @param      proc            Node position of the process.
+  @return     integer         Index of the file among all rank files.
+
+  Processes with the same position on different nodes get consecutive
+  indexes, so neighbouring files are written from different nodes.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_StripeIndex(FTIT_topology* FTI_Topo, int proc)
+{
+    return (proc - FTI_Topo->nbHeads) * FTI_Topo->nbNodes + FTI_Topo->nodeID;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Plans the striping layout of an L4 file.
+  @param      FTI_Conf        Configuration metadata.
+  @param      nbOsts          Number of OSTs of the file system.
+  @param      fileSize        Expected size of the file.
+  @param      fileIdx         Index of the file (see FTI_StripeIndex).
+  @param      layout          Planned layout [out].
+  @return     integer         FTI_SCES if a layout was planned.
+
+  The stripe count is one OST per 'Advanced:lustre_stripe_target' MB of
+  file, bounded by the number of OSTs, unless the striping factor is
+  set. The first OST is (fileIdx * count + striping offset) modulo the
+  number of OSTs. The function has no side effects.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_PlanStripe(FTIT_configuration* FTI_Conf, int nbOsts, size_t fileSize,
+        int fileIdx, FTIT_stripe* layout)
+{
+    if (nbOsts < 1 || fileIdx < 0) {
+        return FTI_NSCS;
+    }
+
+    long count;
+    if (FTI_Conf->stripeFactor > 0) {
+        count = FTI_Conf->stripeFactor;
+    }
+    else if (FTI_Conf->stripeTarget > 0) {
+        count = (long)((fileSize + FTI_Conf->stripeTarget - 1) / FTI_Conf->stripeTarget);
+    }
+    else {
+        count = nbOsts;
+    }
+    if (count < 1) {
+        count = 1;
+    }
+    if (count > nbOsts) {
+        count = nbOsts;
+    }
+
+    long first = (FTI_Conf->stripeOffset > 0) ? FTI_Conf->stripeOffset : 0;
+    layout->unit = FTI_Conf->stripeUnit;
+    layout->count = (int)count;
+    layout->offset = (int)(((long)fileIdx * count + first) % nbOsts);
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Creates an L4 file with the planned striping layout.
+  @param      FTI_Conf        Configuration metadata.
+  @param      fn              Path of the file.
+  @param      fileSize        Expected size of the file.
+  @param      fileIdx         Index of the file (see FTI_StripeIndex).
+  @return     integer         FTI_NSCS if the layout could not be set.
+
+  The file must not exist yet. If no layout is planned (no OSTs), in the
+  simulated model, or on failure, the file is not created and the caller
+  creates it with the default layout.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_CreateStriped(FTIT_configuration* FTI_Conf, char* fn, size_t fileSize,
+        int fileIdx)
+{
+    char str[FTI_BUFS];
+    FTIT_stripe layout;
+
+    if (FTI_PlanStripe(FTI_Conf, FTI_StripeOsts(FTI_Conf), fileSize, fileIdx, &layout) != FTI_SCES) {
+        return FTI_SCES;
+    }
+    snprintf(str, FTI_BUFS, "L4 layout of %s: %lu bytes, stripe unit %d, count %d, first OST %d.",
+            fn, (unsigned long)fileSize, layout.unit, layout.count, layout.offset);
+    FTI_Print(str, FTI_DBUG);
+
+#ifdef LUSTRE
+    int res = llapi_file_create(fn, layout.unit, layout.offset, layout.count, 0);
+    if (res) {
+        char error_msg[FTI_BUFS];
+        error_msg[0] = 0;
+        strerror_r(-res, error_msg, FTI_BUFS);
+        snprintf(str, FTI_BUFS, "[Lustre] %s.", error_msg);
+        FTI_Print(str, FTI_WARN);
+        return FTI_NSCS;
+    }
+#endif
+    return FTI_SCES;
+}
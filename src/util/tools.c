@@ -343,12 +343,16 @@ int FTI_InitBasicTypes()
 
   This function erases a directory and all its files. It focusses on the
   checkpoint directories created by FTI so it does NOT handle recursive
-  erasing if the given directory includes other directories.
+  erasing if the given directory includes other directories. With reclaim
+  threads, the directory is only moved to the trash (see reclaim.c).
 
  **/
 /*-------------------------------------------------------------------------*/
 int FTI_RmDir(char path[FTI_BUFS], int flag)
 {
+    if (flag && FTI_TrashDir(path) == FTI_SCES) {
+        return FTI_SCES;
+    }
     if (flag) {
         char str[FTI_BUFS];
         sprintf(str, "Removing directory %s and its files.", path);
@@ -414,7 +418,7 @@ int FTI_Clean(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo,
     int nodeFlag; //only one process in the node has set it to 1
     int globalFlag = !FTI_Topo->splitRank; //only one process in the FTI_COMM_WORLD has set it to 1
 
-    nodeFlag = (((!FTI_Topo->amIaHead) && ((FTI_Topo->nodeRank - FTI_Topo->nbHeads) == 0)) || (FTI_Topo->amIaHead)) ? 1 : 0;
+    nodeFlag = (((!FTI_Topo->amIaHead) && ((FTI_Topo->nodeRank - FTI_Topo->nbHeads) == 0)) || (FTI_Topo->amIaHead && FTI_Topo->headID == 0)) ? 1 : 0;
 
     bool notDcpFtiff = !(FTI_Ckpt[4].isDcp && FTI_Conf->dcpFtiff); 
     bool notDcp = !FTI_Ckpt[4].isDcp;   
@@ -455,6 +459,7 @@ int FTI_Clean(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo,
 
     // If it is the very last cleaning and we DO NOT keep the last checkpoint
     if (level == 5) {
+        FTI_SweepTrash(FTI_Conf, FTI_Topo);
         rmdir(FTI_Conf->lTmpDir);
         rmdir(FTI_Conf->localDir);
         rmdir(FTI_Conf->glbalDir);
@@ -476,6 +481,7 @@ int FTI_Clean(FTIT_configuration* FTI_Conf, FTIT_topology* FTI_Topo,
 
     // If it is the very last cleaning and we DO keep the last checkpoint
     if (level == 6) {
+        FTI_SweepTrash(FTI_Conf, FTI_Topo);
         rmdir(FTI_Conf->lTmpDir);
         rmdir(FTI_Conf->localDir);
     }
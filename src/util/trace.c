@@ -0,0 +1,558 @@
+/**
+ *  Copyright (c) 2017 Leonardo A. Bautista-Gomez
+ *  All rights reserved
+ *
+ *  FTI - A multi-level checkpointing library for C/C++/Fortran applications
+ *
+ *  Revision 1.0 : Fault Tolerance Interface (FTI)
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *  @file   trace.c
+ *  @date   October, 2026
+ *  @brief  Per phase timing of the checkpoints.
+ *
+ *  With 'Advanced:trace = 1', every process records the phases of its
+ *  checkpoints and post-processing (see FTI_TRACE_* in trace.h) in a
+ *  ring of 'Advanced:trace_events' events. Recording takes a lock and
+ *  two reads of the monotonic clock, so that helper and stage threads
+ *  can record as well; no I/O or communication happens before
+ *  FTI_Finalize. The clocks of the processes start together after a
+ *  barrier in FTI_Init.
+ *
+ *  At FTI_Finalize, each process writes its ring (oldest event first)
+ *  to 'trace_dir/<exec. ID>-Rank<rank>.trace', a FTIT_traceHeader
+ *  followed by the FTIT_traceEvent records in host byte order. The time
+ *  spent in each phase is summed aside from the ring and summarized over
+ *  all processes (min/avg/max and the slowest process). With
+ *  'Advanced:trace_chrome = 1', the global rank 0 also collects all the
+ *  rings into 'trace_dir/<exec. ID>.json', a timeline in the Chrome
+ *  trace event format (chrome://tracing, ui.perfetto.dev) with one
+ *  process per rank and one track per thread.
+ */
+
+#include "../interface.h"
+#include <float.h>
+#include <pthread.h>
+
+/** A process is reported as straggler of a phase if it spends this
+    factor of the average time in it. */
+#define FTI_TRACE_STRAGGLER 1.25
+
+/** Threads told apart in the events, the others share the last ID. */
+#define FTI_TRACE_THREADS   64
+
+/** Trace of this process. */
+static struct {
+    bool                enabled;
+    FTIT_traceEvent*    ring;
+    uint64_t            size;       /**< capacity of the ring (events)   */
+    uint64_t            count;      /**< events recorded so far          */
+    double              origin;     /**< clock at FTI_TraceInit          */
+    pthread_t           thread[FTI_TRACE_THREADS];
+    int                 ckptId[FTI_TRACE_THREADS];  /**< ckpt. per thread, -1: [0] */
+    int                 level[FTI_TRACE_THREADS];   /**< its level                 */
+    int                 nbThreads;  /**< threads seen, [0] is FTI_Init's */
+    double              time[FTI_TRACE_NBPHASES];
+    uint64_t            bytes[FTI_TRACE_NBPHASES];
+    uint64_t            calls[FTI_TRACE_NBPHASES];
+    pthread_mutex_t     lock;
+} FTI_Trace = { .enabled = false, .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static const char* FTI_TracePhases[FTI_TRACE_NBPHASES] = {
+    "checkpoint", "wait", "open", "write", "hash", "fsync", "metadata",
+    "post-process", "partner", "rs-encode", "flush", "rename",
+    "write-ckpt", "head-request", "stage", "recover-files", "recover", "reclaim"
+};
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Returns the time of the monotonic clock in seconds.
+  @return     double          time in seconds.
+ **/
+/*-------------------------------------------------------------------------*/
+static double FTI_TraceNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Returns the ID of the calling thread in the trace.
+  @return     integer         0 for the thread of FTI_Init.
+
+  Called with the trace locked.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_TraceThread(void)
+{
+    pthread_t self = pthread_self();
+    int i;
+    for (i = 0; i < FTI_Trace.nbThreads; i++) {
+        if (pthread_equal(FTI_Trace.thread[i], self)) {
+            return i;
+        }
+    }
+    if (FTI_Trace.nbThreads == FTI_TRACE_THREADS) {
+        return FTI_TRACE_THREADS - 1;
+    }
+    FTI_Trace.thread[FTI_Trace.nbThreads] = self;
+    return FTI_Trace.nbThreads++;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Starts the trace of this process.
+  @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Exec        Execution metadata.
+  @param      FTI_Topo        Topology metadata.
+  @return     integer         FTI_SCES if successful.
+
+  Collective over the global communicator if tracing is enabled: the
+  origin of the time stamps is taken after a barrier, so that the traces
+  of the processes line up.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_TraceInit(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
+        FTIT_topology* FTI_Topo)
+{
+    if (!FTI_Conf->traceEnabled) {
+        return FTI_SCES;
+    }
+    int res = FTI_SCES;
+    FTI_Trace.size = FTI_Conf->traceEvents;
+    FTI_Trace.ring = (FTIT_traceEvent*) malloc(sizeof(FTIT_traceEvent) * FTI_Trace.size);
+    if (FTI_Trace.ring == NULL) {
+        FTI_Print("Unable to allocate the trace buffer, this process is not traced.", FTI_WARN);
+        res = FTI_NSCS;
+    }
+    FTI_Trace.count = 0;
+    int i;
+    for (i = 0; i < FTI_TRACE_THREADS; i++) {
+        FTI_Trace.ckptId[i] = (i == 0) ? 0 : -1;
+        FTI_Trace.level[i] = 0;
+    }
+    FTI_Trace.thread[0] = pthread_self();
+    FTI_Trace.nbThreads = 1;
+    memset(FTI_Trace.time, 0, sizeof(FTI_Trace.time));
+    memset(FTI_Trace.bytes, 0, sizeof(FTI_Trace.bytes));
+    memset(FTI_Trace.calls, 0, sizeof(FTI_Trace.calls));
+    MPI_Barrier(FTI_Exec->globalComm);
+    FTI_Trace.origin = FTI_TraceNow();
+    FTI_Trace.enabled = (FTI_Trace.ring != NULL);
+    return res;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Sets the checkpoint the next events belong to.
+  @param      ckptId          Checkpoint ID.
+  @param      level           Checkpoint level.
+
+  Per thread: the helper thread post-processes a checkpoint while the
+  application already takes the next one. The threads that never set a
+  checkpoint (stage workers) report the one of the thread of FTI_Init.
+ **/
+/*-------------------------------------------------------------------------*/
+void FTI_TraceCkpt(int ckptId, int level)
+{
+    if (!FTI_Trace.enabled) {
+        return;
+    }
+    pthread_mutex_lock(&FTI_Trace.lock);
+    if (!FTI_Trace.enabled) {
+        pthread_mutex_unlock(&FTI_Trace.lock);
+        return;
+    }
+    int t = FTI_TraceThread();
+    FTI_Trace.ckptId[t] = ckptId;
+    FTI_Trace.level[t] = level;
+    pthread_mutex_unlock(&FTI_Trace.lock);
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Returns the start time of a phase.
+  @return     double          Monotonic clock, 0 if tracing is disabled.
+
+  The trace does not use MPI_Wtime, the stage workers must not call MPI.
+ **/
+/*-------------------------------------------------------------------------*/
+double FTI_TraceStart(void)
+{
+    return (FTI_Trace.enabled) ? FTI_TraceNow() : 0;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Records a phase that ends now.
+  @param      phase           FTI_TRACE_* phase.
+  @param      id              Dataset, process or block, -1 if none.
+  @param      start           Start of the phase (FTI_TraceStart).
+  @param      bytes           Bytes moved by the phase.
+
+  The oldest event is overwritten once the ring is full.
+ **/
+/*-------------------------------------------------------------------------*/
+void FTI_TraceEvent(int phase, int id, double start, uint64_t bytes)
+{
+    if (!FTI_Trace.enabled || phase < 0 || phase >= FTI_TRACE_NBPHASES) {
+        return;
+    }
+    double duration = FTI_TraceNow() - start;
+    pthread_mutex_lock(&FTI_Trace.lock);
+    // FTI_TraceFinalize may have written and freed the ring meanwhile
+    if (!FTI_Trace.enabled) {
+        pthread_mutex_unlock(&FTI_Trace.lock);
+        return;
+    }
+    FTIT_traceEvent* ev = &FTI_Trace.ring[FTI_Trace.count % FTI_Trace.size];
+    int t = FTI_TraceThread();
+    int c = (FTI_Trace.ckptId[t] >= 0) ? t : 0;
+    ev->start = start - FTI_Trace.origin;
+    ev->duration = duration;
+    ev->bytes = bytes;
+    ev->ckptId = FTI_Trace.ckptId[c];
+    ev->id = id;
+    ev->phase = phase;
+    ev->level = FTI_Trace.level[c];
+    ev->thread = t;
+    FTI_Trace.count++;
+    FTI_Trace.time[phase] += duration;
+    FTI_Trace.bytes[phase] += bytes;
+    FTI_Trace.calls[phase]++;
+    pthread_mutex_unlock(&FTI_Trace.lock);
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Returns the name of a phase.
+  @param      phase           FTI_TRACE_* phase.
+  @return     const char*     Name of the phase, "unknown" if invalid.
+ **/
+/*-------------------------------------------------------------------------*/
+const char* FTI_TracePhaseName(int phase)
+{
+    if (phase < 0 || phase >= FTI_TRACE_NBPHASES) {
+        return "unknown";
+    }
+    return FTI_TracePhases[phase];
+}
+
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Reverses a range of the ring.
+  @param      first           First event of the range.
+  @param      last            Event after the range.
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_TraceReverse(uint64_t first, uint64_t last)
+{
+    while (first + 1 < last) {
+        FTIT_traceEvent tmp = FTI_Trace.ring[first];
+        FTI_Trace.ring[first++] = FTI_Trace.ring[--last];
+        FTI_Trace.ring[last] = tmp;
+    }
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Puts the events of the ring in order, oldest first.
+  @return     uint64_t        Number of events in the ring.
+
+  Once the ring has wrapped, the oldest event is the next one to be
+  overwritten; the ring is rotated in place to bring it to the front.
+ **/
+/*-------------------------------------------------------------------------*/
+static uint64_t FTI_TraceOrder(void)
+{
+    if (FTI_Trace.count <= FTI_Trace.size) {
+        return FTI_Trace.count;
+    }
+    uint64_t first = FTI_Trace.count % FTI_Trace.size;
+    FTI_TraceReverse(0, first);
+    FTI_TraceReverse(first, FTI_Trace.size);
+    FTI_TraceReverse(0, FTI_Trace.size);
+    return FTI_Trace.size;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Writes the ring of this process to its trace file.
+  @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Exec        Execution metadata.
+  @param      FTI_Topo        Topology metadata.
+  @param      nbEvents        Number of events, in order (FTI_TraceOrder).
+  @param      nbDropped       Number of overwritten events.
+  @return     integer         FTI_SCES if successful.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_TraceDump(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
+        FTIT_topology* FTI_Topo, uint64_t nbEvents, uint64_t nbDropped)
+{
+    char fn[FTI_BUFS], str[FTI_BUFS];
+
+    if (mkdir(FTI_Conf->traceDir, 0777) == -1 && errno != EEXIST) {
+        snprintf(str, FTI_BUFS, "Unable to create the trace directory '%s'.", FTI_Conf->traceDir);
+        FTI_Print(str, FTI_EROR);
+        errno = 0;
+        return FTI_NSCS;
+    }
+    errno = 0;
+    snprintf(fn, FTI_BUFS, "%s/%s-Rank%d.trace", FTI_Conf->traceDir, FTI_Exec->id, FTI_Topo->myRank);
+
+    FTIT_traceHeader header;
+    memset(&header, 0, sizeof(FTIT_traceHeader));
+    memcpy(header.magic, FTI_TRACE_MAGIC, sizeof(header.magic));
+    header.version = FTI_TRACE_VERSION;
+    header.rank = FTI_Topo->myRank;
+    header.isHead = FTI_Topo->amIaHead;
+    header.nbPhases = FTI_TRACE_NBPHASES;
+    header.nbEvents = nbEvents;
+    header.nbDropped = nbDropped;
+    header.origin = FTI_Trace.origin;
+
+    FILE* fd = fopen(fn, "wb");
+    if (fd == NULL) {
+        snprintf(str, FTI_BUFS, "Unable to create the trace file '%s'.", fn);
+        FTI_Print(str, FTI_EROR);
+        return FTI_NSCS;
+    }
+    size_t written = fwrite(&header, sizeof(FTIT_traceHeader), 1, fd);
+    written += fwrite(FTI_Trace.ring, sizeof(FTIT_traceEvent), nbEvents, fd);
+    if (fclose(fd) != 0 || written != nbEvents + 1) {
+        snprintf(str, FTI_BUFS, "Unable to write the trace file '%s'.", fn);
+        FTI_Print(str, FTI_EROR);
+        return FTI_NSCS;
+    }
+    snprintf(str, FTI_BUFS, "Trace written to '%s' (%lu events, %lu dropped).", fn,
+            (unsigned long)nbEvents, (unsigned long)nbDropped);
+    FTI_Print(str, FTI_DBUG);
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Prints the time per phase over all processes.
+  @param      FTI_Exec        Execution metadata.
+  @param      FTI_Topo        Topology metadata.
+
+  Collective over the global communicator. The time of a process in a
+  phase is the sum over all its events of that phase; processes without
+  such events (e.g. heads for the writes) are left out of min and avg.
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_TraceSummary(FTIT_execution* FTI_Exec, FTIT_topology* FTI_Topo)
+{
+    enum { TIME, CALLS, BYTES, PROCS, NBSUMS };
+    double sums[NBSUMS][FTI_TRACE_NBPHASES], sumsAll[NBSUMS][FTI_TRACE_NBPHASES];
+    double minTime[FTI_TRACE_NBPHASES], minTimeAll[FTI_TRACE_NBPHASES];
+    struct { double time; int rank; } maxTime[FTI_TRACE_NBPHASES], maxTimeAll[FTI_TRACE_NBPHASES];
+    char str[FTI_BUFS];
+    int i;
+
+    for (i = 0; i < FTI_TRACE_NBPHASES; i++) {
+        sums[TIME][i] = FTI_Trace.time[i];
+        sums[CALLS][i] = FTI_Trace.calls[i];
+        sums[BYTES][i] = FTI_Trace.bytes[i];
+        sums[PROCS][i] = (FTI_Trace.calls[i] > 0);
+        minTime[i] = (FTI_Trace.calls[i] > 0) ? FTI_Trace.time[i] : DBL_MAX;
+        maxTime[i].time = FTI_Trace.time[i];
+        maxTime[i].rank = FTI_Topo->myRank;
+    }
+    double dropped = FTI_Trace.count - ((FTI_Trace.count < FTI_Trace.size) ? FTI_Trace.count : FTI_Trace.size);
+    double droppedAll;
+    MPI_Allreduce(sums, sumsAll, NBSUMS * FTI_TRACE_NBPHASES, MPI_DOUBLE, MPI_SUM, FTI_Exec->globalComm);
+    MPI_Allreduce(minTime, minTimeAll, FTI_TRACE_NBPHASES, MPI_DOUBLE, MPI_MIN, FTI_Exec->globalComm);
+    MPI_Allreduce(maxTime, maxTimeAll, FTI_TRACE_NBPHASES, MPI_DOUBLE_INT, MPI_MAXLOC, FTI_Exec->globalComm);
+    MPI_Allreduce(&dropped, &droppedAll, 1, MPI_DOUBLE, MPI_SUM, FTI_Exec->globalComm);
+
+    if (FTI_Topo->amIaHead) {
+        return;
+    }
+    snprintf(str, FTI_BUFS, "Checkpoint trace of %d processes (time per process, %.0f events dropped):",
+            FTI_Topo->nbProc, droppedAll);
+    FTI_Print(str, FTI_INFO);
+    for (i = 0; i < FTI_TRACE_NBPHASES; i++) {
+        if (sumsAll[CALLS][i] == 0) {
+            continue;
+        }
+        double avg = sumsAll[TIME][i] / sumsAll[PROCS][i];
+        bool straggler = sumsAll[PROCS][i] > 1 && maxTimeAll[i].time > FTI_TRACE_STRAGGLER * avg;
+        snprintf(str, FTI_BUFS, "  %-12s %8.0f calls %10.2f MB  min %.3fs  avg %.3fs  max %.3fs (rank %d%s)",
+                FTI_TracePhases[i], sumsAll[CALLS][i], sumsAll[BYTES][i] / (1024.0 * 1024.0),
+                minTimeAll[i], avg, maxTimeAll[i].time, maxTimeAll[i].rank,
+                straggler ? ", straggler" : "");
+        FTI_Print(str, FTI_INFO);
+    }
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Writes the events of a rank in the Chrome trace format.
+  @param      fd              JSON file.
+  @param      rank            Rank in the global communicator.
+  @param      isHead          TRUE if the rank is a head.
+  @param      events          Events, oldest first.
+  @param      nbEvents        Number of events.
+
+  Each rank is a process of the timeline, each of its threads a track.
+  Time stamps and durations are in microseconds.
+ **/
+/*-------------------------------------------------------------------------*/
+static void FTI_TraceJson(FILE* fd, int rank, int isHead,
+        FTIT_traceEvent* events, uint64_t nbEvents)
+{
+    uint64_t i;
+    fprintf(fd, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s %d\"}},\n"
+            "{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"sort_index\":%d}}",
+            (rank > 0) ? ",\n" : "", rank, isHead ? "head" : "rank", rank, rank, rank);
+    for (i = 0; i < nbEvents; i++) {
+        FTIT_traceEvent* ev = &events[i];
+        fprintf(fd, ",\n{\"name\":\"%s\",\"cat\":\"L%d\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,"
+                "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"ckpt\":%d,\"id\":%d,\"bytes\":%lu}}",
+                FTI_TracePhaseName(ev->phase), ev->level, rank, ev->thread,
+                ev->start * 1e6, ev->duration * 1e6, ev->ckptId, ev->id, (unsigned long)ev->bytes);
+    }
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Writes the timeline of all the ranks.
+  @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Exec        Execution metadata.
+  @param      FTI_Topo        Topology metadata.
+  @param      nbEvents        Number of events, in order (FTI_TraceOrder).
+  @return     integer         FTI_SCES if successful.
+
+  Collective over the global communicator. The rank 0 receives the
+  events of one rank after the other and writes them to
+  'trace_dir/<exec. ID>.json', so it needs memory for a single ring.
+ **/
+/*-------------------------------------------------------------------------*/
+static int FTI_TraceChrome(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
+        FTIT_topology* FTI_Topo, uint64_t nbEvents)
+{
+    char fn[FTI_BUFS], str[FTI_BUFS];
+    FTIT_traceEvent* buf = NULL;
+    FILE* fd = NULL;
+    MPI_Comm comm;
+    int rank, nbProcs, r, ok = 1;
+
+    MPI_Comm_dup(FTI_Exec->globalComm, &comm);
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &nbProcs);
+
+    if (rank == 0) {
+        snprintf(fn, FTI_BUFS, "%s/%s.json", FTI_Conf->traceDir, FTI_Exec->id);
+        buf = (FTIT_traceEvent*) malloc(sizeof(FTIT_traceEvent) * FTI_Conf->traceEvents);
+        fd = (buf != NULL) ? fopen(fn, "w") : NULL;
+        if (fd == NULL) {
+            snprintf(str, FTI_BUFS, "Unable to create the timeline '%s'.", fn);
+            FTI_Print(str, FTI_EROR);
+            ok = 0;
+        }
+    }
+    MPI_Bcast(&ok, 1, MPI_INT, 0, comm);
+    if (!ok) {
+        free(buf);
+        MPI_Comm_free(&comm);
+        return FTI_NSCS;
+    }
+
+    int info[2] = { (int)nbEvents, FTI_Topo->amIaHead };
+    if (rank != 0) {
+        MPI_Send(info, 2, MPI_INT, 0, 0, comm);
+        if (nbEvents > 0) {
+            MPI_Send(FTI_Trace.ring, nbEvents * sizeof(FTIT_traceEvent), MPI_BYTE, 0, 0, comm);
+        }
+        MPI_Comm_free(&comm);
+        return FTI_SCES;
+    }
+
+    fprintf(fd, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    FTI_TraceJson(fd, 0, FTI_Topo->amIaHead, FTI_Trace.ring, nbEvents);
+    for (r = 1; r < nbProcs; r++) {
+        MPI_Recv(info, 2, MPI_INT, r, 0, comm, MPI_STATUS_IGNORE);
+        if (info[0] > 0) {
+            MPI_Recv(buf, info[0] * sizeof(FTIT_traceEvent), MPI_BYTE, r, 0, comm, MPI_STATUS_IGNORE);
+        }
+        FTI_TraceJson(fd, r, info[1], buf, info[0]);
+    }
+    fprintf(fd, "\n]}\n");
+    free(buf);
+    MPI_Comm_free(&comm);
+
+    if (fclose(fd) != 0) {
+        snprintf(str, FTI_BUFS, "Unable to write the timeline '%s'.", fn);
+        FTI_Print(str, FTI_EROR);
+        return FTI_NSCS;
+    }
+    snprintf(str, FTI_BUFS, "Checkpoint timeline written to '%s'.", fn);
+    FTI_Print(str, FTI_DBUG);
+    return FTI_SCES;
+}
+
+/*-------------------------------------------------------------------------*/
+/**
+  @brief      Writes the trace file and prints the summary.
+  @param      FTI_Conf        Configuration metadata.
+  @param      FTI_Exec        Execution metadata.
+  @param      FTI_Topo        Topology metadata.
+  @return     integer         FTI_SCES if successful.
+
+  Collective over the global communicator if tracing is enabled, called
+  by the application processes and the heads in FTI_Finalize.
+ **/
+/*-------------------------------------------------------------------------*/
+int FTI_TraceFinalize(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
+        FTIT_topology* FTI_Topo)
+{
+    if (!FTI_Conf->traceEnabled) {
+        return FTI_SCES;
+    }
+    int res = FTI_SCES;
+    uint64_t nbEvents = 0, nbDropped = 0;
+    pthread_mutex_lock(&FTI_Trace.lock);
+    if (FTI_Trace.enabled) {
+        nbDropped = (FTI_Trace.count > FTI_Trace.size) ? FTI_Trace.count - FTI_Trace.size : 0;
+        nbEvents = FTI_TraceOrder();
+        res = FTI_TraceDump(FTI_Conf, FTI_Exec, FTI_Topo, nbEvents, nbDropped);
+    }
+    FTI_Trace.enabled = false;
+    pthread_mutex_unlock(&FTI_Trace.lock);
+    FTI_TraceSummary(FTI_Exec, FTI_Topo);
+    if (FTI_Conf->traceChrome) {
+        if (FTI_TraceChrome(FTI_Conf, FTI_Exec, FTI_Topo, nbEvents) != FTI_SCES) {
+            res = FTI_NSCS;
+        }
+    }
+    free(FTI_Trace.ring);
+    FTI_Trace.ring = NULL;
+    return res;
+}
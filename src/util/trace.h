@@ -0,0 +1,106 @@
+/**
+ *  Copyright (c) 2017 Leonardo A. Bautista-Gomez
+ *  All rights reserved
+ *
+ *  FTI - A multi-level checkpointing library for C/C++/Fortran applications
+ *
+ *  Revision 1.0 : Fault Tolerance Interface (FTI)
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation
+ *  and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *  @file   trace.h
+ *  @date   October, 2026
+ *  @brief  Per phase timing of the checkpoints.
+ */
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <stdint.h>
+
+#define FTI_TRACE_MAGIC     "FTITRACE"
+#define FTI_TRACE_VERSION   1
+
+/** Phases of a checkpoint recorded in the trace.                          */
+enum {
+    FTI_TRACE_CKPT = 0,     /**< whole FTI_Checkpoint                       */
+    FTI_TRACE_WAIT,         /**< wait for the previous post-processing      */
+    FTI_TRACE_OPEN,         /**< open the checkpoint file                   */
+    FTI_TRACE_WRITE,        /**< write one dataset (id: dataset)            */
+    FTI_TRACE_HASH,         /**< checksum of the written data               */
+    FTI_TRACE_FSYNC,        /**< sync the checkpoint file                   */
+    FTI_TRACE_META,         /**< gather and write the metadata              */
+    FTI_TRACE_POST,         /**< whole FTI_PostCkpt                         */
+    FTI_TRACE_PARTNER,      /**< L2 exchange of one file (id: process)      */
+    FTI_TRACE_RS,           /**< L3 encoding of one block (id: block)       */
+    FTI_TRACE_FLUSH,        /**< L4 flush of one file (id: process)         */
+    FTI_TRACE_RENAME,       /**< rename the temporary directories           */
+    FTI_TRACE_WRITECKPT,    /**< whole FTI_WriteCkpt                        */
+    FTI_TRACE_REQUEST,      /**< head handling a checkpoint request         */
+    FTI_TRACE_STAGE,        /**< stage worker copying a file (id: request)  */
+    FTI_TRACE_RECOVERFILES, /**< whole FTI_RecoverFiles                     */
+    FTI_TRACE_RECOVER,      /**< whole FTI_Recover                          */
+    FTI_TRACE_RECLAIM,      /**< background deletion of one old directory   */
+    FTI_TRACE_NBPHASES
+};
+
+/** @typedef    FTIT_traceEvent
+ *  @brief      One timed phase, as stored in the trace file.
+ */
+typedef struct FTIT_traceEvent {
+    double          start;      /**< start, seconds after the origin        */
+    double          duration;   /**< duration in seconds                    */
+    uint64_t        bytes;      /**< bytes moved by the phase               */
+    int32_t         ckptId;     /**< checkpoint ID                          */
+    int32_t         id;         /**< dataset, process or block, -1 if none  */
+    uint16_t        phase;      /**< FTI_TRACE_*                            */
+    uint16_t        level;      /**< checkpoint level                       */
+    uint32_t        thread;     /**< 0: thread of FTI_Init, else others     */
+} FTIT_traceEvent;
+
+/** @typedef    FTIT_traceHeader
+ *  @brief      Header of a trace file, followed by nbEvents events.
+ */
+typedef struct FTIT_traceHeader {
+    char            magic[8];   /**< FTI_TRACE_MAGIC                        */
+    uint32_t        version;    /**< FTI_TRACE_VERSION                      */
+    int32_t         rank;       /**< rank in the global communicator        */
+    int32_t         isHead;     /**< 1 if written by a head                 */
+    int32_t         nbPhases;   /**< FTI_TRACE_NBPHASES                     */
+    uint64_t        nbEvents;   /**< events in the file, oldest first       */
+    uint64_t        nbDropped;  /**< older events overwritten in the ring   */
+    double          origin;     /**< monotonic clock at the origin          */
+} FTIT_traceHeader;
+
+int FTI_TraceInit(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
+        FTIT_topology* FTI_Topo);
+void FTI_TraceCkpt(int ckptId, int level);
+double FTI_TraceStart(void);
+void FTI_TraceEvent(int phase, int id, double start, uint64_t bytes);
+const char* FTI_TracePhaseName(int phase);
+int FTI_TraceFinalize(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
+        FTIT_topology* FTI_Topo);
+
+#endif // __TRACE_H__
@@ -52,13 +52,45 @@ typedef struct{
     MPI_File pfh;                   // File descriptor
     char flag;                      // Flags used to open the file
     MD5_CTX integrity;              // integrity of the file
+    bool queue;                     // TRUE to write CPU data on close
+    bool failed;                    // TRUE if a dataset could not be written
+    int nbSeg;                      // Number of queued segments
+    int maxSeg;                     // Capacity of the segment arrays
+    MPI_Aint *segAddr;              // Memory address of the segments
+    MPI_Aint *segDisp;              // Offset of the segments in the rank's part
+    int *segLen;                    // Size of the segments
+    MPI_Offset fileSize;            // Expected size of the whole file
 } WriteMPIInfo_t;
 
+typedef struct{
+    void *ptr;                      // mapping of the shared memory segment
+    size_t size;                    // size of the mapping
+    size_t pos;                     // bytes written to the mapping
+    char name[FTI_BUFS];            // name of the shared memory segment
+}FTIT_handoff;
+
+typedef struct{
+    int unit;                       // stripe size in bytes
+    int count;                      // number of OSTs of the file
+    int offset;                     // index of the first OST
+}FTIT_stripe;
+
+typedef struct{
+    char *buf;                      // small variables gathered for one write
+    size_t size;                    // capacity of the buffer
+    size_t limit;                   // largest variable gathered in the buffer
+    size_t used;                    // bytes gathered, not yet written
+    size_t pos;                     // file position of the first gathered byte
+    bool failed;                    // TRUE if writing the buffer failed
+}FTIT_coalesce;
+
 typedef struct{
     FILE *f;                        // Posix file descriptor
     size_t offset;                  // offset in the file
     char flag;                      // flags to open the file
     MD5_CTX integrity;              // integrity of the file
+    FTIT_handoff handoff;           // shared memory copy for the heads
+    FTIT_coalesce stage;            // coalescing of small variables
 }WritePosixInfo_t;
 
 #ifdef ENABLE_IME_NATIVE
@@ -85,6 +117,8 @@ typedef struct{
     size_t offset;                  // offset in the file
     char flag;                      // flags to open the file
     MD5_CTX integrity;              // integrity of the file
+    FTIT_handoff handoff;           // shared memory copy for the heads
+    FTIT_coalesce stage;            // unused, keeps the WritePosixInfo_t layout
     FTIT_configuration *FTI_Conf;   // FTI Configuration
     FTIT_checkpoint *FTI_Ckpt;      // FTI Checkpoint options
     FTIT_execution *FTI_Exec;       // FTI execution options
@@ -99,6 +133,7 @@ typedef struct{
     FTIT_topology *FTI_Topo;         // FTI Data
     FTIT_configuration *FTI_Conf;         // FTI Data
     hid_t file_id;                  // File Id
+    bool tmpFile;                   // VPR file written in the background
 }WriteHDF5Info_t;
 
 int FTI_HDF5Open(char *fn, void *fileDesc);
@@ -109,6 +144,9 @@ int FTI_WriteHDF5(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec,
         FTIT_topology* FTI_Topo, FTIT_checkpoint* FTI_Ckpt,
         FTIT_keymap* FTI_Data);
 size_t FTI_GetHDF5FilePos(void *);
+int FTI_WriteGlobalDatasets(WriteHDF5Info_t* fd, void** ptr, MPI_Comm comm);
+int FTI_StartVPRWriter(FTIT_execution* FTI_Exec, WriteHDF5Info_t* fd);
+int FTI_RemoveLastVPR(WriteHDF5Info_t* fd, int ckptId);
 #endif
 
 #ifdef ENABLE_SIONLIB
@@ -129,6 +167,7 @@ size_t FTI_GetSionFilePos(void *fileDesc);
 #endif
 
 // Wrappers around MPIO
+int FTI_MPIOSetHints(FTIT_configuration* FTI_Conf, MPI_Info info, char flag);
 int FTI_MPIOOpen(char *fn, void *fileDesc);
 int FTI_MPIOClose(void *fileDesc);
 int FTI_MPIOWrite(void *src, size_t size, void *fileDesc);
@@ -137,6 +176,7 @@ size_t FTI_GetMPIOFilePos(void *fileDesc);
 
 void *FTI_InitMPIO(FTIT_configuration* FTI_Conf, FTIT_execution* FTI_Exec, FTIT_topology* FTI_Topo, FTIT_checkpoint *FTI_Ckpt, FTIT_keymap *FTI_Data);
 int FTI_WriteMPIOData(FTIT_dataset * data, void *write_info);
+void FTI_FreeMPIOView(void);
 
 //Wrappers around dcp POSIX
 
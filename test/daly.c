@@ -0,0 +1,69 @@
+/**
+ *  @file   daly.c
+ *  @date   October, 2026
+ *  @brief  FTI testing program.
+ *
+ *  Program tests the checkpoint interval FTI_DalyInterval computes for
+ *  'Basic:ckpt_adaptive': Young's sqrt(2*C*M) for a small checkpoint cost,
+ *  the MTBF when a checkpoint takes more than twice the MTBF, and an
+ *  interval growing with the cost and the MTBF.
+ *
+ *  Usage: ./daly
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "interface.h"
+
+static int failures = 0;
+
+void check(int cond, const char* what, double cost, double mtbf)
+{
+	if (!cond) {
+		printf("FAILED: %s (cost %g, MTBF %g)\n", what, cost, mtbf);
+		failures++;
+	}
+}
+
+int main(void)
+{
+	double costs[] = {0.01, 0.1, 1, 10, 60, 600, 3600};
+	double mtbfs[] = {60, 600, 3600, 86400, 864000};
+	int nbCosts = sizeof(costs) / sizeof(double);
+	int nbMtbfs = sizeof(mtbfs) / sizeof(double);
+	int i, j;
+
+	for (j = 0; j < nbMtbfs; j++) {
+		double last = 0;
+		for (i = 0; i < nbCosts; i++) {
+			double cost = costs[i], mtbf = mtbfs[j];
+			double intv = FTI_DalyInterval(cost, mtbf);
+			double young = sqrt(2 * cost * mtbf);
+			check(intv > 0 && isfinite(intv), "positive interval", cost, mtbf);
+			if (cost >= 2 * mtbf) {
+				check(intv == mtbf, "one checkpoint per MTBF", cost, mtbf);
+			} else {
+				check(intv >= last, "interval grows with the cost", cost, mtbf);
+				check(intv <= mtbf + cost, "interval bounded by the MTBF", cost, mtbf);
+			}
+			if (cost / mtbf <= 1e-4) {
+				check(fabs(intv - young) <= 0.01 * young, "Young's interval for a small cost",
+						cost, mtbf);
+			}
+			if (j > 0 && cost < 2 * mtbfs[j - 1]) {
+				check(intv >= FTI_DalyInterval(cost, mtbfs[j - 1]), "interval grows with the MTBF",
+						cost, mtbf);
+			}
+			last = intv;
+		}
+	}
+
+	if (failures > 0) {
+		printf("Daly test FAILED: %d checks failed.\n", failures);
+	} else {
+		printf("Daly test succeed.\n");
+	}
+	return (failures > 0);
+}
@@ -0,0 +1,141 @@
+/**
+ *  @file   groups.c
+ *  @date   October, 2026
+ *  @brief  FTI testing program.
+ *
+ *  Program tests the placement of the nodes in the L2/L3 groups
+ *  (FTI_PlaceGroups, 'Advanced:group_strategy'): the order is a
+ *  permutation of the nodes, the nodes of a group are in different
+ *  failure domains when the domains allow it, the groups sharing a domain
+ *  are counted when they do not, the nodes of a group are ordered by
+ *  coordinates and the members are taken from the closest domains.
+ *
+ *  Usage: ./groups
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "interface.h"
+
+#define MAX_NODES 64
+
+static int failures = 0;
+
+void check(int cond, const char* what, const char* layout)
+{
+	if (!cond) {
+		printf("FAILED: %s (%s)\n", what, layout);
+		failures++;
+	}
+}
+
+/* Places 'nbNodes' nodes with the given domains and first coordinates in
+ * groups of 'gs' nodes, checks the order and returns the shared groups. */
+int place(const char* layout, int nbNodes, int gs, long* domain, long* coord0, int* order)
+{
+	FTIT_topology topo;
+	FTIT_nodeLoc loc[MAX_NODES];
+	int seen[MAX_NODES] = {0};
+	int i, k;
+
+	memset(&topo, 0, sizeof(topo));
+	topo.nbNodes = nbNodes;
+	topo.groupSize = gs;
+	for (i = 0; i < nbNodes; i++) {
+		loc[i].node = i;
+		loc[i].domain = domain[i];
+		loc[i].coord[0] = coord0[i];
+		loc[i].coord[1] = domain[i];
+		loc[i].coord[2] = i;
+		loc[i].coord[3] = 0;
+	}
+	int shared = FTI_PlaceGroups(&topo, loc, order);
+
+	for (i = 0; i < nbNodes; i++) {
+		check(order[i] >= 0 && order[i] < nbNodes && !seen[order[i]], "order is a permutation", layout);
+		if (order[i] >= 0 && order[i] < nbNodes) {
+			seen[order[i]] = 1;
+		}
+	}
+	for (i = 0; i < nbNodes; i += gs) {
+		for (k = 1; k < gs; k++) {
+			int a = order[i + k - 1], b = order[i + k];
+			check(coord0[a] < coord0[b] || (coord0[a] == coord0[b] &&
+						(domain[a] < domain[b] || (domain[a] == domain[b] && a < b))),
+					"group ordered by coordinates", layout);
+		}
+	}
+	return shared;
+}
+
+/* Returns the number of groups with several nodes of the same domain. */
+int countShared(int nbNodes, int gs, long* domain, int* order)
+{
+	int i, j, k, shared = 0;
+	for (i = 0; i < nbNodes; i += gs) {
+		int same = 0;
+		for (j = 0; j < gs; j++) {
+			for (k = j + 1; k < gs; k++) {
+				same |= (domain[order[i + j]] == domain[order[i + k]]);
+			}
+		}
+		shared += same;
+	}
+	return shared;
+}
+
+int main(void)
+{
+	long domain[MAX_NODES], coord0[MAX_NODES];
+	int order[MAX_NODES];
+	int i;
+
+	// 16 nodes in 4 domains of 4 nodes (e.g. chassis), groups of 4
+	for (i = 0; i < 16; i++) {
+		domain[i] = i / 4;
+		coord0[i] = 0;
+	}
+	int shared = place("4 domains of 4", 16, 4, domain, coord0, order);
+	check(shared == 0, "no group shares a domain", "4 domains of 4");
+	check(countShared(16, 4, domain, order) == 0, "groups span the domains", "4 domains of 4");
+
+	// 8 nodes in domains of 5 and 3 nodes, groups of 4: each group has
+	// two nodes of a domain
+	for (i = 0; i < 8; i++) {
+		domain[i] = (i < 5) ? 0 : 1;
+		coord0[i] = 0;
+	}
+	shared = place("domains of 5 and 3", 8, 4, domain, coord0, order);
+	check(shared == 2, "shared groups counted", "domains of 5 and 3");
+	check(countShared(8, 4, domain, order) == shared, "shared groups match the order", "domains of 5 and 3");
+
+	// 8 nodes in 4 domains of 2 nodes on two network branches, groups of
+	// 2: the partner is in the other domain of the same branch
+	for (i = 0; i < 8; i++) {
+		domain[i] = i / 2;
+		coord0[i] = i / 4;
+	}
+	shared = place("2 branches of 2 domains", 8, 2, domain, coord0, order);
+	check(shared == 0, "no group shares a domain", "2 branches of 2 domains");
+	for (i = 0; i < 8; i += 2) {
+		check(coord0[order[i]] == coord0[order[i + 1]], "partner on the same branch",
+				"2 branches of 2 domains");
+	}
+
+	// a single domain, all groups share it
+	for (i = 0; i < 12; i++) {
+		domain[i] = 7;
+		coord0[i] = 0;
+	}
+	shared = place("1 domain", 12, 4, domain, coord0, order);
+	check(shared == 3, "all groups share the domain", "1 domain");
+
+	if (failures > 0) {
+		printf("Groups test FAILED: %d checks failed.\n", failures);
+	} else {
+		printf("Groups test succeed.\n");
+	}
+	return (failures > 0);
+}
@@ -0,0 +1,120 @@
+/**
+ *  @file   heads.c
+ *  @date   October, 2026
+ *  @brief  FTI testing program.
+ *
+ *  Program tests several heads per node ('Basic:head > 1'). Each head
+ *  post-processes the checkpoints of its block of application ranks of
+ *  the node. The first run (crash = 1) takes three checkpoints of the
+ *  given level, waits for the result of the last post-processing from
+ *  the head of its block, stops the head and quits without FTI_Finalize.
+ *  The second run (crash = 0) recovers and checks the data of the last
+ *  checkpoint.
+ *
+ *  Usage: ./heads config.fti <level> <crash>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "interface.h"
+
+#define N (256 * 1024)
+
+int main(int argc, char** argv)
+{
+	int rank, grank, j, failures = 0;
+
+	if (argc < 4) {
+		printf("Usage: %s config.fti <level> <crash>\n", argv[0]);
+		return 1;
+	}
+	int level = atoi(argv[2]);
+	int crash = atoi(argv[3]);
+
+	MPI_Init(&argc, &argv);
+	MPI_Comm_rank(MPI_COMM_WORLD, &grank);
+
+	dictionary* ini = iniparser_load(argv[1]);
+	int nbHeads = iniparser_getint(ini, "Basic:head", 0);
+	int nodeSize = iniparser_getint(ini, "Basic:node_size", 1);
+	int generalTag = iniparser_getint(ini, "Advanced:general_tag", 2612);
+	int finalTag = iniparser_getint(ini, "Advanced:final_tag", 3107);
+	char key[32];
+	snprintf(key, 32, "Basic:inline_l%d", level);
+	int isInline = (level == 1) || iniparser_getint(ini, key, 1);
+	iniparser_freedict(ini);
+
+	// the application ranks of a node are split in contiguous blocks,
+	// one per head, the heads are the first ranks of the node
+	int nodeRank = grank % nodeSize;
+	int nbBody = (nodeSize - nbHeads) / nbHeads;
+	int headRank = grank - nodeRank + (nodeRank - nbHeads) / nbBody;
+
+	FTI_Init(argv[1], MPI_COMM_WORLD);
+	MPI_Comm_rank(FTI_COMM_WORLD, &rank);
+
+	double* data = (double*) malloc(N * sizeof(double));
+	int id = 0;
+	FTI_Protect(0, data, N, FTI_DBLE);
+	FTI_Protect(1, &id, 1, FTI_INTG);
+
+	if (crash) {
+		for (id = 1; id <= 3; id++) {
+			for (j = 0; j < N; j++) {
+				data[j] = rank * N + j + id;
+			}
+			if (FTI_Checkpoint(id, level) != FTI_DONE) {
+				printf("FAILED: checkpoint %d (rank %d)\n", id, rank);
+				failures++;
+			}
+		}
+		if (!isInline) {
+			int res;
+			MPI_Recv(&res, 1, MPI_INT, headRank, generalTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+			if (res == FTI_NSCS) {
+				printf("FAILED: post-processing of checkpoint 3 (rank %d)\n", rank);
+				failures++;
+			}
+		}
+		// stops the head of the block, as FTI_Finalize does
+		int value = FTI_ENDW;
+		MPI_Send(&value, 1, MPI_INT, headRank, finalTag, MPI_COMM_WORLD);
+		MPI_Barrier(MPI_COMM_WORLD);
+		free(data);
+		MPI_Finalize();
+		return (failures > 0);
+	}
+
+	if (FTI_Status() == 0) {
+		printf("FAILED: no checkpoint to recover (rank %d)\n", rank);
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	if (FTI_Recover() != FTI_SCES) {
+		printf("FAILED: recovery (rank %d)\n", rank);
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	if (id != 3) {
+		printf("FAILED: recovered checkpoint %d instead of 3 (rank %d)\n", id, rank);
+		failures++;
+	}
+	for (j = 0; j < N && failures == 0; j++) {
+		if (data[j] != rank * N + j + 3) {
+			printf("FAILED: data[%d] = %lf (rank %d)\n", j, data[j], rank);
+			failures++;
+		}
+	}
+	int allFailures;
+	MPI_Allreduce(&failures, &allFailures, 1, MPI_INT, MPI_SUM, FTI_COMM_WORLD);
+	if (rank == 0) {
+		if (allFailures > 0) {
+			printf("Heads test FAILED: %d processes failed.\n", allFailures);
+		} else {
+			printf("Heads test succeed.\n");
+		}
+	}
+	free(data);
+	FTI_Finalize();
+	MPI_Finalize();
+	return (allFailures > 0);
+}
@@ -0,0 +1,113 @@
+/**
+ *  @file   helper.c
+ *  @date   October, 2026
+ *  @brief  FTI testing program.
+ *
+ *  Program tests the post-processing helper thread ('Basic:head_thread = 1'
+ *  without heads). The first run (crash = 1) takes three checkpoints of the
+ *  given level back to back, thus the helper post-processes a checkpoint
+ *  while the application writes the next one. It then waits for the result
+ *  the helper sends to its own process (the application side of the head
+ *  protocol) and stops without FTI_Finalize. The second run (crash = 0)
+ *  recovers and checks the data of the last checkpoint.
+ *
+ *  Usage: ./helper config.fti <level> <crash>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "interface.h"
+
+#define N (256 * 1024)
+
+int main(int argc, char** argv)
+{
+	int rank, provided, j, failures = 0;
+
+	if (argc < 4) {
+		printf("Usage: %s config.fti <level> <crash>\n", argv[0]);
+		return 1;
+	}
+	int level = atoi(argv[2]);
+	int crash = atoi(argv[3]);
+
+	// the helper thread needs MPI_THREAD_MULTIPLE
+	MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+	if (provided < MPI_THREAD_MULTIPLE) {
+		printf("MPI_THREAD_MULTIPLE is not supported.\n");
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+
+	dictionary* ini = iniparser_load(argv[1]);
+	int generalTag = iniparser_getint(ini, "Advanced:general_tag", 2612);
+	char key[32];
+	snprintf(key, 32, "Basic:inline_l%d", level);
+	int isInline = (level == 1) || iniparser_getint(ini, key, 1);
+	iniparser_freedict(ini);
+
+	FTI_Init(argv[1], MPI_COMM_WORLD);
+	MPI_Comm_rank(FTI_COMM_WORLD, &rank);
+
+	double* data = (double*) malloc(N * sizeof(double));
+	int id = 0;
+	FTI_Protect(0, data, N, FTI_DBLE);
+	FTI_Protect(1, &id, 1, FTI_INTG);
+
+	if (crash) {
+		for (id = 1; id <= 3; id++) {
+			for (j = 0; j < N; j++) {
+				data[j] = rank * N + j + id;
+			}
+			if (FTI_Checkpoint(id, level) != FTI_DONE) {
+				printf("FAILED: checkpoint %d (rank %d)\n", id, rank);
+				failures++;
+			}
+		}
+		// the helper sends the result of the last post-processing to this
+		// process, MPI must not stop before
+		if (!isInline) {
+			int res;
+			MPI_Recv(&res, 1, MPI_INT, rank, generalTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+			if (res == FTI_NSCS) {
+				printf("FAILED: post-processing of checkpoint 3 (rank %d)\n", rank);
+				failures++;
+			}
+		}
+		free(data);
+		MPI_Finalize();
+		return (failures > 0);
+	}
+
+	if (FTI_Status() == 0) {
+		printf("FAILED: no checkpoint to recover (rank %d)\n", rank);
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	if (FTI_Recover() != FTI_SCES) {
+		printf("FAILED: recovery (rank %d)\n", rank);
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	if (id != 3) {
+		printf("FAILED: recovered checkpoint %d instead of 3 (rank %d)\n", id, rank);
+		failures++;
+	}
+	for (j = 0; j < N && failures == 0; j++) {
+		if (data[j] != rank * N + j + 3) {
+			printf("FAILED: data[%d] = %lf (rank %d)\n", j, data[j], rank);
+			failures++;
+		}
+	}
+	int allFailures;
+	MPI_Allreduce(&failures, &allFailures, 1, MPI_INT, MPI_SUM, FTI_COMM_WORLD);
+	if (rank == 0) {
+		if (allFailures > 0) {
+			printf("Helper test FAILED: %d processes failed.\n", allFailures);
+		} else {
+			printf("Helper test succeed.\n");
+		}
+	}
+	free(data);
+	FTI_Finalize();
+	MPI_Finalize();
+	return (allFailures > 0);
+}
@@ -32,6 +32,12 @@
  *      FTI_Recover
  *    FTI_Finalize
  *
+ * The environment variable ENABLE_ICP selects the checkpoint: OFF for
+ * FTI_Checkpoint, ON for the incremental checkpoint and ASYNC for the
+ * incremental checkpoint where each dataset is changed right after
+ * FTI_AddVarICP (with 'Advanced:icp_async_buffer', the iCP writer saves
+ * the dataset as it was added).
+ *
  */
 
 #include "mpi.h"
@@ -155,6 +161,9 @@ int main(int argc, char* argv[]) {
     else if( !strcmp(env, "OFF") ) {
       enable_icp = 0;
     }
+    else if( !strcmp(env, "ASYNC") ) {
+      enable_icp = 2;
+    }
     else {
       exit(WRONG_ENVIRONMENT);
     }
@@ -234,6 +243,27 @@ int main(int argc, char* argv[]) {
       FTI_AddVarICP( 1 );
       FTI_FinalizeICP();
     } 
+    else if ( enable_icp == 2 ) {
+      // the datasets are overwritten while they may still be queued
+      size_t i, asize_keep = asize;
+      FTI_InitICP( 1, level, 1 );
+      FTI_AddVarICP( 2 );
+      asize = 0;
+      FTI_AddVarICP( 0 );
+      for (i = 0; i < asize_keep; i++) {
+        A[i] = -1.0;
+      }
+      FTI_AddVarICP( 1 );
+      for (i = 0; i < asize_keep; i++) {
+        B[i] = -1.0;
+      }
+      FTI_FinalizeICP();
+      asize = asize_keep;
+      for (i = 0; i < asize; i++) {
+        A[i] = 1.0;
+      }
+      read_data(B, &asize_chk, FTI_APP_RANK, asize);
+    } 
     else if ( enable_icp == 0 ) {
         FTI_Checkpoint(1,level);
     }
@@ -0,0 +1,310 @@
+/**
+ *  @file   batch.c
+ *  @date   October, 2026
+ *  @brief  FTI testing program.
+ *
+ *  Program tests the staging of several files with one request
+ *  ('FTI_SendFiles'), once for a directory and once for a glob pattern
+ *  matching files of the same name in two directories. The names hold
+ *  blanks. Every rank checks that the index lists exactly the requested
+ *  files by their relative path, that the data at the offsets of the
+ *  index is the data of the files, that the '.tar' objects extract with
+ *  tar to the same files and, without heads, that the local files are
+ *  removed.
+ *
+ *  Usage: ./batch <1 if the local files are removed, 0 else>
+ */
+
+#include "fti.h"
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#define EXIT_FAIL(MSG) \
+    do { \
+        printf("%s:%d [ERROR] (rank %d) -> %s\n", __FILE__, __LINE__, rank, MSG); \
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE); \
+    } while(0)
+
+#define NUM_SMALL 40            // packed files per request
+#define SMALL_SIZE 100000       // bytes at most, 2MB in total ('stage_pack_size = 1')
+#define LARGE_SIZE 3000000      // bytes, larger than 'stage_pack_file'
+#define F_BUFF 512
+#define REMOTE_DIR "./rdir"
+
+int rank;
+int worldRank;   // rank in the names of the stage index and objects
+
+/* Content of byte 'i' of the file 'j'. */
+unsigned char pattern( int j, long i )
+{
+    return (unsigned char)( (j * 33 + i) % 251 );
+}
+
+long fileSize( int j )
+{
+    return ( j == NUM_SMALL ) ? LARGE_SIZE : (long) j * SMALL_SIZE / NUM_SMALL + 1;
+}
+
+/*
+ * File 'j' is 'sub-<j%3>/file <j/3>.<ext>', the files of 'sub-1' and
+ * 'sub-2' have the same names. 'relName' is its name in the index of
+ * request 'k' (0: the directory 'sub-0', 1: the '.dat' files of 'sub-1'
+ * and 'sub-2').
+ */
+void relName( int j, int k, char *name )
+{
+    int s = j % 3, y = j / 3;
+    const char *ext = ( y % 2 ) ? "dat" : "txt";
+    if ( k == 0 ) {
+        snprintf( name, F_BUFF, "file %d.%s", y, ext );
+    } else {
+        snprintf( name, F_BUFF, "sub-%d/file %d.%s", s, y, ext );
+    }
+}
+
+bool isRequested( int j, int k )
+{
+    return ( k == 0 ) ? ( j % 3 == 0 ) : ( j % 3 != 0 && (j / 3) % 2 );
+}
+
+void localPath( const char *sdir, int j, char *fn )
+{
+    char name[F_BUFF];
+    relName( j, 1, name );
+    snprintf( fn, F_BUFF, "%s/%s", sdir, name );
+}
+
+void createFile( const char *fn, int j )
+{
+    FILE *fstream = fopen( fn, "wb" );
+    if ( fstream == NULL ) {
+        EXIT_FAIL( "unable to create a local file." );
+    }
+    long i;
+    for( i=0; i<fileSize( j ); ++i ) {
+        fputc( pattern( j, i ), fstream );
+    }
+    fclose( fstream );
+}
+
+/* Compares 'size' bytes at 'offset' of 'fn' with the data of the file 'j'. */
+bool checkData( const char *fn, long offset, int j, long size )
+{
+    FILE *fstream = fopen( fn, "rb" );
+    if ( fstream == NULL || fseek( fstream, offset, SEEK_SET ) != 0 ) {
+        if ( fstream ) fclose( fstream );
+        return false;
+    }
+    long i;
+    bool ok = true;
+    for( i=0; ok && i<size; ++i ) {
+        int c = fgetc( fstream );
+        ok = ( c != EOF ) && ( (unsigned char) c == pattern( j, i ) );
+    }
+    fclose( fstream );
+    return ok;
+}
+
+/* Reads a '<len>:<name>' field of the index. */
+bool readName( FILE *index, char *name )
+{
+    size_t len;
+    if ( fscanf( index, " %zu:", &len ) != 1 || len >= F_BUFF ) {
+        return false;
+    }
+    if ( fread( name, 1, len, index ) != len ) {
+        return false;
+    }
+    name[len] = '\0';
+    return true;
+}
+
+/*
+ * Checks the index of request 'k' in 'rdir': the staged files are the
+ * requested files, and their data is found at the offsets of the index
+ * and in the extracted tar objects.
+ */
+void checkBatch( const char *rdir, int ID, int k )
+{
+    char fn[F_BUFF], msg[2*F_BUFF], cmd[4*F_BUFF], expect[F_BUFF];
+    char name[F_BUFF], object[F_BUFF];
+    long long offset, size;
+    bool found[NUM_SMALL+1] = { false };
+    int j;
+
+    snprintf( fn, F_BUFF, "%s/Stage-Rank%d-ID%d.idx", rdir, worldRank, ID );
+    FILE *index = fopen( fn, "r" );
+    if ( index == NULL ) {
+        snprintf( msg, F_BUFF, "missing stage index '%s'.", fn );
+        EXIT_FAIL( msg );
+    }
+
+    while( readName( index, name ) ) {
+        if ( !readName( index, object ) || fscanf( index, "%lld %lld", &offset, &size ) != 2 ) {
+            snprintf( msg, 2*F_BUFF, "invalid entry of '%s' in '%s'.", name, fn );
+            EXIT_FAIL( msg );
+        }
+        for( j=0; j<=NUM_SMALL; ++j ) {
+            relName( j, k, expect );
+            if ( isRequested( j, k ) && strcmp( name, expect ) == 0 ) {
+                break;
+            }
+        }
+        if ( j > NUM_SMALL || found[j] ) {
+            snprintf( msg, 2*F_BUFF, "unexpected file '%s' in '%s'.", name, fn );
+            EXIT_FAIL( msg );
+        }
+        found[j] = true;
+        if ( size != fileSize( j ) ) {
+            snprintf( msg, 2*F_BUFF, "wrong size of '%s' in '%s'.", name, fn );
+            EXIT_FAIL( msg );
+        }
+        bool packed = ( strstr( object, ".tar" ) != NULL );
+        if ( packed == ( j == NUM_SMALL ) || ( !packed && strcmp( object, name ) != 0 ) ) {
+            snprintf( msg, 2*F_BUFF, "'%s' is %s.", name, packed ? "packed" : "not packed" );
+            EXIT_FAIL( msg );
+        }
+
+        // data at the offset of the index
+        snprintf( fn, F_BUFF, "%s/%s", rdir, object );
+        if ( !checkData( fn, offset, j, size ) ) {
+            snprintf( msg, 2*F_BUFF, "wrong data of '%s' at offset %lld of '%s'.", name, offset, fn );
+            EXIT_FAIL( msg );
+        }
+
+        // data extracted with tar
+        if ( packed ) {
+            snprintf( cmd, 4*F_BUFF, "mkdir -p %s/x-%s && tar -xf %s -C %s/x-%s '%s'",
+                    rdir, object, fn, rdir, object, name );
+            if ( system( cmd ) != 0 ) {
+                snprintf( msg, 2*F_BUFF, "could not extract '%s' from '%s'.", name, fn );
+                EXIT_FAIL( msg );
+            }
+            snprintf( fn, F_BUFF, "%s/x-%s/%s", rdir, object, name );
+            struct stat st;
+            if ( stat( fn, &st ) != 0 || st.st_size != size || !checkData( fn, 0, j, size ) ) {
+                snprintf( msg, 2*F_BUFF, "wrong data of '%s' extracted from '%s'.", name, object );
+                EXIT_FAIL( msg );
+            }
+        }
+    }
+    fclose( index );
+
+    for( j=0; j<=NUM_SMALL; ++j ) {
+        if ( isRequested( j, k ) && !found[j] ) {
+            relName( j, k, name );
+            snprintf( msg, 2*F_BUFF, "'%s' missing in the index of request %d.", name, ID );
+            EXIT_FAIL( msg );
+        }
+    }
+}
+
+void makeDir( const char *dir )
+{
+    errno = 0;
+    if ( mkdir( dir, (mode_t) 0700 ) != 0 && errno != EEXIST ) {
+        char msg[F_BUFF];
+        snprintf( msg, F_BUFF, "unable to create directory ('%s').", dir );
+        EXIT_FAIL( msg );
+    }
+}
+
+int waitRequest( int ID )
+{
+    int status;
+    while( (status = FTI_GetStageStatus( ID )) == FTI_SI_PEND || status == FTI_SI_ACTV ) {
+        usleep( 100000 );
+    }
+    return status;
+}
+
+int main( int argc, char **argv ) {
+
+    char ldir[F_BUFF], sdir[F_BUFF], lpat[2][F_BUFF], rdir[2][F_BUFF], fn[F_BUFF];
+    int ID[2], j, k;
+
+    MPI_Init( &argc, &argv );
+    FTI_Init( "config.fti", MPI_COMM_WORLD );
+    MPI_Comm_rank( FTI_COMM_WORLD, &rank );
+    MPI_Comm_rank( MPI_COMM_WORLD, &worldRank );
+
+    bool removed = ( argc > 1 ) && atoi( argv[1] );
+
+    if ( FTI_GetStageDir( ldir, F_BUFF ) != FTI_SCES ) {
+        EXIT_FAIL( "Failed to get the local directory." );
+    }
+
+    // local directories 'sub-0', 'sub-1' and 'sub-2'
+    snprintf( sdir, F_BUFF, "%s/batch-%d", ldir, rank );
+    makeDir( sdir );
+    for( k=0; k<3; ++k ) {
+        snprintf( fn, F_BUFF, "%s/sub-%d", sdir, k );
+        makeDir( fn );
+    }
+    for( j=0; j<=NUM_SMALL; ++j ) {
+        localPath( sdir, j, fn );
+        createFile( fn, j );
+    }
+
+    makeDir( REMOTE_DIR );
+    for( k=0; k<2; ++k ) {
+        snprintf( rdir[k], F_BUFF, "%s/batch-%s-%d", REMOTE_DIR, ( k == 0 ) ? "dir" : "glob", rank );
+        makeDir( rdir[k] );
+    }
+
+    // the directory 'sub-0', then the '.dat' files of 'sub-1' and 'sub-2'
+    snprintf( lpat[0], F_BUFF, "%s/sub-0", sdir );
+    snprintf( lpat[1], F_BUFF, "%s/sub-[12]/*.dat", sdir );
+    for( k=0; k<2; ++k ) {
+        if ( (ID[k] = FTI_SendFiles( lpat[k], rdir[k] )) == FTI_NSCS ) {
+            EXIT_FAIL( "Failed to stage the files." );
+        }
+    }
+    for( k=0; k<2; ++k ) {
+        if ( waitRequest( ID[k] ) != FTI_SI_SCES ) {
+            EXIT_FAIL( "Stage request returned status failure." );
+        }
+        checkBatch( rdir[k], ID[k], k );
+    }
+
+    // the synchronous staging removes the staged files
+    for( j=0; j<=NUM_SMALL; ++j ) {
+        struct stat st;
+        localPath( sdir, j, fn );
+        bool exists = ( stat( fn, &st ) == 0 );
+        if ( exists == ( removed && (isRequested( j, 0 ) || isRequested( j, 1 )) ) ) {
+            char msg[2*F_BUFF];
+            snprintf( msg, 2*F_BUFF, "local file '%s' %s.", fn, exists ? "not removed" : "removed" );
+            EXIT_FAIL( msg );
+        }
+    }
+
+    // the stage directory is removed in 'FTI_Finalize' without subdirectories
+    for( j=0; j<=NUM_SMALL; ++j ) {
+        localPath( sdir, j, fn );
+        remove( fn );
+    }
+    for( k=0; k<3; ++k ) {
+        snprintf( fn, F_BUFF, "%s/sub-%d", sdir, k );
+        rmdir( fn );
+    }
+    rmdir( sdir );
+
+    MPI_Barrier( FTI_COMM_WORLD );
+    if ( rank == 0 ) {
+        printf( "[ batch staging of a directory and a glob pattern succeed ]\n" );
+    }
+
+    FTI_Finalize();
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+
+}
@@ -0,0 +1,155 @@
+/**
+ *  @file   deadline.c
+ *  @date   October, 2026
+ *  @brief  FTI testing program.
+ *
+ *  Program tests the staging while the head post-processes checkpoints
+ *  ('Advanced:stage_deadline'). Every rank stages one large file and
+ *  checkpoints without pause until the request is finished. The copies
+ *  are paused by the checkpoints and resumed at the same position, the
+ *  deadline bounds how long they are paused. Every rank checks that the
+ *  request finishes in time, that the progress never decreases and that
+ *  the staged file is the local file.
+ *
+ *  Usage: ./deadline <max seconds>
+ */
+
+#include "fti.h"
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#define EXIT_FAIL(MSG) \
+    do { \
+        printf("%s:%d [ERROR] (rank %d) -> %s\n", __FILE__, __LINE__, rank, MSG); \
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE); \
+    } while(0)
+
+#define FILE_SIZE (64L*1024*1024)   // bytes, 64 transfers of 'transfer_size = 1'
+#define CKPT_SIZE (512*1024)        // doubles protected per rank
+#define F_BUFF 512
+#define REMOTE_DIR "./rdir"
+
+int rank;
+
+/* Content of byte 'i' of the staged file of rank 'r'. */
+unsigned char pattern( int r, long i )
+{
+    return (unsigned char)( (r * 7 + i) % 251 );
+}
+
+int main( int argc, char **argv ) {
+
+    char lfile[F_BUFF], rfile[F_BUFF], ldir[F_BUFF], msg[F_BUFF];
+    long i, done, total, last = 0;
+    int ID, status, nbCkpt = 0;
+
+    MPI_Init( &argc, &argv );
+    FTI_Init( "config.fti", MPI_COMM_WORLD );
+    MPI_Comm_rank( FTI_COMM_WORLD, &rank );
+
+    double tMax = ( argc > 1 ) ? atof( argv[1] ) : 120.0;
+
+    double *data = (double*) malloc( CKPT_SIZE * sizeof(double) );
+    if ( data == NULL ) {
+        EXIT_FAIL( "unable to allocate the protected data." );
+    }
+    FTI_Protect( 0, data, CKPT_SIZE, FTI_DBLE );
+
+    if ( FTI_GetStageDir( ldir, F_BUFF ) != FTI_SCES ) {
+        EXIT_FAIL( "Failed to get the local directory." );
+    }
+    errno = 0;
+    if ( mkdir( REMOTE_DIR, (mode_t) 0700 ) != 0 && errno != EEXIST ) {
+        EXIT_FAIL( "unable to create the remote directory." );
+    }
+
+    snprintf( lfile, F_BUFF, "%s/deadline-%d.fti", ldir, rank );
+    snprintf( rfile, F_BUFF, "%s/deadline-%d.fti", REMOTE_DIR, rank );
+    FILE *fstream = fopen( lfile, "wb" );
+    if ( fstream == NULL ) {
+        EXIT_FAIL( "unable to create the local file." );
+    }
+    for( i=0; i<FILE_SIZE; ++i ) {
+        fputc( pattern( rank, i ), fstream );
+    }
+    fclose( fstream );
+
+    MPI_Barrier( FTI_COMM_WORLD );
+    double t0 = MPI_Wtime(), t1;
+    if ( (ID = FTI_SendFile( lfile, rfile )) == FTI_NSCS ) {
+        EXIT_FAIL( "Failed to stage the file." );
+    }
+
+    // checkpoints without pause, each of them preempts the copies. The
+    // checkpoints are collective, all ranks stop after the last request.
+    status = FTI_SI_PEND;
+    while( 1 ) {
+        if ( status == FTI_SI_PEND || status == FTI_SI_ACTV ) {
+            status = FTI_GetStageStatus( ID );
+            t1 = MPI_Wtime();
+        }
+        int pending = ( status == FTI_SI_PEND || status == FTI_SI_ACTV ), anyPending;
+        MPI_Allreduce( &pending, &anyPending, 1, MPI_INT, MPI_LOR, FTI_COMM_WORLD );
+        if ( !anyPending ) {
+            break;
+        }
+        if ( t1 - t0 > tMax ) {
+            snprintf( msg, F_BUFF, "staging not finished after %.0lf seconds.", tMax );
+            EXIT_FAIL( msg );
+        }
+        for( i=0; i<CKPT_SIZE; ++i ) {
+            data[i] = rank + nbCkpt + i;
+        }
+        if ( FTI_Checkpoint( ++nbCkpt, 2 ) != FTI_DONE ) {
+            EXIT_FAIL( "Checkpoint failed during the staging." );
+        }
+        if ( pending && FTI_GetStageProgress( ID, &done, &total ) == FTI_SI_ACTV ) {
+            if ( done < last || done > FILE_SIZE ) {
+                snprintf( msg, F_BUFF, "progress went from %ld to %ld bytes.", last, done );
+                EXIT_FAIL( msg );
+            }
+            last = done;
+        }
+    }
+    if ( status != FTI_SI_SCES ) {
+        EXIT_FAIL( "Stage request returned status failure." );
+    }
+
+    // the copy resumed where it was paused
+    fstream = fopen( rfile, "rb" );
+    if ( fstream == NULL ) {
+        EXIT_FAIL( "staged file is missing." );
+    }
+    for( i=0; i<FILE_SIZE; ++i ) {
+        int c = fgetc( fstream );
+        if ( c == EOF || (unsigned char) c != pattern( rank, i ) ) {
+            snprintf( msg, F_BUFF, "wrong data at offset %ld of '%s'.", i, rfile );
+            EXIT_FAIL( msg );
+        }
+    }
+    if ( fgetc( fstream ) != EOF ) {
+        EXIT_FAIL( "staged file is too large." );
+    }
+    fclose( fstream );
+
+    double tStage = t1 - t0, tStageMax;
+    MPI_Reduce( &tStage, &tStageMax, 1, MPI_DOUBLE, MPI_MAX, 0, FTI_COMM_WORLD );
+    if ( rank == 0 ) {
+        printf( "[ staging during checkpoints succeed (%.2lf seconds, %d checkpoints on rank 0) ]\n",
+                tStageMax, nbCkpt );
+    }
+
+    free( data );
+    FTI_Finalize();
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+
+}
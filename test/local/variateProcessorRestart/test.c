@@ -5,11 +5,12 @@
 #include <math.h>
 #include <string.h>
 #include <stdbool.h>
+#include <unistd.h>
 
 #include "../../../deps/iniparser/iniparser.h"
 #include "../../../deps/iniparser/dictionary.h"
 
-bool ICP, RECOVERVAR;
+bool ICP, RECOVERVAR, ASYNC;
 
 int checkpoint( int, int, int*, int );
 int recover( int*, int );
@@ -78,19 +79,26 @@ int main( int argc, char** argv ) {
 //
 
     if( argc < 3 ) {
-        printf("insufficiant parameters (needs 2: icp recovervar)\n");
+        printf("insufficiant parameters (needs 2: icp recovervar [async])\n");
         return -1;
     }
 
     ICP = atoi(argv[1]);
     RECOVERVAR = atoi(argv[2]);
+    // 'h5_single_file_async = 1' writes the VPR files in a thread
+    ASYNC = (argc > 3) ? atoi(argv[3]) : 0;
     int rank, grank; 
     int size; 
     int size_bac; 
     int i,j;
     int *ids;
 
-    MPI_Init(NULL,NULL);
+    if( ASYNC ) {
+        int provided;
+        MPI_Init_thread(NULL, NULL, MPI_THREAD_MULTIPLE, &provided);
+    } else {
+        MPI_Init(NULL,NULL);
+    }
     
     // determine global rank
     MPI_Comm_rank(MPI_COMM_WORLD, &grank);
@@ -304,6 +312,24 @@ int main( int argc, char** argv ) {
         checkpoint( 11, 4, ids, ldim0*2 );
         checkpoint( 12, FTI_L4_H5_SINGLE, ids, ldim0*2 );
         
+        // the last file gets its name once the writer is joined (here by
+        // FTI_Protect), until then only '.tmp' files exist
+        if( ASYNC ) {
+            FTI_Protect( 0, data[0], ldim1, FTI_INTG );
+            if( rank == 0 ) {
+                char vprDir[256], vprFile[512];
+                const char* dir = iniparser_getstring(ini, "Basic:h5_single_file_dir", "");
+                snprintf( vprDir, 256, "%s", (strcmp(dir, "") != 0) ? dir : iniparser_getstring(ini, "Basic:glbl_dir", "") );
+                snprintf( vprFile, 512, "%s/VPR-h5-ID%08d.h5", vprDir, 12 );
+                bool written = ( access( vprFile, F_OK ) == 0 );
+                strcat( vprFile, ".tmp" );
+                if( !written || access( vprFile, F_OK ) == 0 ) {
+                    printf("[FAILURE-%d] VPR file of ckpt. 12 not renamed after the background write!\n", rank);
+                    MPI_Abort(MPI_COMM_WORLD, -1);
+                }
+            }
+        }
+
         // simulate crash
         if( nbHeads > 0 ) { 
             int value = FTI_ENDW;
@@ -0,0 +1,178 @@
+/**
+ *  @file   reclaim.c
+ *  @date   October, 2026
+ *  @brief  FTI testing program.
+ *
+ *  Program tests the sweep of the trash directories by FTI_Init
+ *  ('Advanced:reclaim_threads'). The first run (crash = 1) takes L1 and
+ *  L4 checkpoints, thus the previous checkpoint directories are moved to
+ *  the trash of the reclaim threads. Rank 0 then leaves trash directories
+ *  of a dead process, '<name>.trash-<pid>-<n>', and directories which
+ *  only look alike in the local and global directories, and the run
+ *  stops without FTI_Finalize. The second run (crash = 0) checks after
+ *  FTI_Init that the trash directories are deleted, that the other
+ *  directories are still there and that the last checkpoint recovers.
+ *
+ *  Usage: ./reclaim config.fti <crash>
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "interface.h"
+
+#define N (64 * 1024)
+#define TIMEOUT 30
+
+static const char* trash[] = {"l1.trash-4194305-0", "l4.trash-4194305-12"};
+static const char* decoys[] = {"notes.trash-old", "l4.trash-1-2a", ".trash-1-2", "l1.trash-3-"};
+
+static int failures = 0;
+
+void check(int cond, const char* what, const char* fn)
+{
+	if (!cond) {
+		printf("FAILED: %s (%s)\n", what, fn);
+		failures++;
+	}
+}
+
+/* Creates the directory 'name' in 'dir' holding one file. */
+void plant(const char* dir, const char* name)
+{
+	char fn[512];
+	snprintf(fn, sizeof(fn), "%s/%s", dir, name);
+	check(mkdir(fn, 0777) == 0 || errno == EEXIST, "directory created", fn);
+	snprintf(fn, sizeof(fn), "%s/%s/Ckpt1-Rank0.fti", dir, name);
+	FILE* fd = fopen(fn, "w");
+	check(fd != NULL, "file created", fn);
+	if (fd != NULL) {
+		fputs("trash\n", fd);
+		fclose(fd);
+	}
+}
+
+int exists(const char* dir, const char* name)
+{
+	char fn[512];
+	struct stat st;
+	snprintf(fn, sizeof(fn), "%s/%s", dir, name);
+	return (stat(fn, &st) == 0);
+}
+
+int main(int argc, char** argv)
+{
+	int rank, i, j;
+	char dirs[2][256];
+
+	if (argc < 3) {
+		printf("Usage: %s config.fti <crash>\n", argv[0]);
+		return 1;
+	}
+	int crash = atoi(argv[2]);
+
+	// the reclaim threads delete the directories while MPI runs
+	MPI_Init(&argc, &argv);
+	FTI_Init(argv[1], MPI_COMM_WORLD);
+	MPI_Comm_rank(FTI_COMM_WORLD, &rank);
+
+	double* data = (double*) malloc(N * sizeof(double));
+	int id = 0;
+	FTI_Protect(0, data, N, FTI_DBLE);
+	FTI_Protect(1, &id, 1, FTI_INTG);
+
+	if (crash) {
+		int levels[4] = {1, 4, 1, 4};
+		for (id = 1; id <= 4; id++) {
+			for (j = 0; j < N; j++) {
+				data[j] = rank * N + j + id;
+			}
+			if (FTI_Checkpoint(id, levels[id - 1]) != FTI_DONE) {
+				printf("FAILED: checkpoint %d (rank %d)\n", id, rank);
+				failures++;
+			}
+		}
+	}
+
+	// the execution ID is in the configuration file after the first
+	// checkpoint, rank 0 is on node 0 with 'Local_test = 1'
+	dictionary* ini = iniparser_load(argv[1]);
+	const char* execId = iniparser_getstring(ini, "Restart:exec_id", "NULL");
+	snprintf(dirs[0], sizeof(dirs[0]), "%s/node0/%s", iniparser_getstring(ini, "Basic:ckpt_dir", "./Local"), execId);
+	snprintf(dirs[1], sizeof(dirs[1]), "%s/%s", iniparser_getstring(ini, "Basic:glbl_dir", "./Global"), execId);
+	iniparser_freedict(ini);
+
+	if (crash) {
+		if (rank == 0) {
+			for (i = 0; i < 2; i++) {
+				for (j = 0; j < sizeof(trash) / sizeof(trash[0]); j++) {
+					plant(dirs[i], trash[j]);
+				}
+				for (j = 0; j < sizeof(decoys) / sizeof(decoys[0]); j++) {
+					plant(dirs[i], decoys[j]);
+				}
+			}
+		}
+		// stops without FTI_Finalize, as a crash
+		MPI_Barrier(MPI_COMM_WORLD);
+		free(data);
+		MPI_Finalize();
+		return (failures > 0);
+	}
+
+	if (rank == 0) {
+		// the trash is queued for the reclaim threads of the process
+		int left = 1, t;
+		for (t = 0; t < TIMEOUT && left; t++) {
+			left = 0;
+			for (i = 0; i < 2; i++) {
+				for (j = 0; j < sizeof(trash) / sizeof(trash[0]); j++) {
+					left += exists(dirs[i], trash[j]);
+				}
+			}
+			if (left) {
+				sleep(1);
+			}
+		}
+		for (i = 0; i < 2; i++) {
+			for (j = 0; j < sizeof(trash) / sizeof(trash[0]); j++) {
+				check(!exists(dirs[i], trash[j]), "trash directory deleted", trash[j]);
+			}
+			for (j = 0; j < sizeof(decoys) / sizeof(decoys[0]); j++) {
+				check(exists(dirs[i], decoys[j]), "other directory kept", decoys[j]);
+			}
+		}
+	}
+
+	if (FTI_Status() == 0 || FTI_Recover() != FTI_SCES) {
+		printf("FAILED: recovery (rank %d)\n", rank);
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	if (id != 4) {
+		printf("FAILED: recovered checkpoint %d instead of 4 (rank %d)\n", id, rank);
+		failures++;
+	}
+	for (j = 0; j < N && failures == 0; j++) {
+		if (data[j] != rank * N + j + 4) {
+			printf("FAILED: data[%d] = %lf (rank %d)\n", j, data[j], rank);
+			failures++;
+		}
+	}
+	int allFailures;
+	MPI_Allreduce(&failures, &allFailures, 1, MPI_INT, MPI_SUM, FTI_COMM_WORLD);
+	if (rank == 0) {
+		if (allFailures > 0) {
+			printf("Reclaim test FAILED: %d checks failed.\n", allFailures);
+		} else {
+			printf("Reclaim test succeed.\n");
+		}
+	}
+	free(data);
+	FTI_Finalize();
+	MPI_Finalize();
+	return (allFailures > 0);
+}
@@ -0,0 +1,168 @@
+/**
+ *  @file   stripe.c
+ *  @date   October, 2026
+ *  @brief  FTI testing program.
+ *
+ *  Program tests the layouts FTI_PlanStripe plans for the L4 files on a
+ *  simulated Lustre file system ('Advanced:lustre_ost_count'): the stripe
+ *  count bounds, the round-robin spread of the first OSTs over the file
+ *  indexes and the striping factor override.
+ *
+ *  Usage: ./stripe
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "interface.h"
+
+#define MB (1024L * 1024L)
+
+static int failures = 0;
+
+void check(int cond, const char* what, int nbOsts, size_t size, int idx)
+{
+	if (!cond) {
+		printf("FAILED: %s (OSTs %d, size %lu, file %d)\n",
+				what, nbOsts, (unsigned long)size, idx);
+		failures++;
+	}
+}
+
+/* Default configuration of conf.c with the simulated OST count. */
+void setConf(FTIT_configuration* conf, int nbOsts)
+{
+	memset(conf, 0, sizeof(FTIT_configuration));
+	conf->stripeUnit = 4194304;
+	conf->stripeFactor = -1;
+	conf->stripeOffset = -1;
+	conf->stripeOstCount = nbOsts;
+	conf->stripeTarget = 1024 * MB;
+}
+
+/* The stripe count grows with the file size, between 1 and the OST count. */
+void testCount(int nbOsts)
+{
+	FTIT_configuration conf;
+	FTIT_stripe layout;
+	size_t sizes[] = {0, 1, 1024 * MB - 1, 1024 * MB, 1024 * MB + 1,
+		5 * 1024 * MB, 100 * 1024 * MB};
+	int i, idx;
+
+	setConf(&conf, nbOsts);
+	check(FTI_StripeOsts(&conf) == nbOsts, "simulated OST count", nbOsts, 0, 0);
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		long expected = (sizes[i] + conf.stripeTarget - 1) / conf.stripeTarget;
+		if (expected < 1) {
+			expected = 1;
+		}
+		if (expected > nbOsts) {
+			expected = nbOsts;
+		}
+		for (idx = 0; idx < 3 * nbOsts; idx++) {
+			int res = FTI_PlanStripe(&conf, FTI_StripeOsts(&conf), sizes[i], idx, &layout);
+			check(res == FTI_SCES, "layout planned", nbOsts, sizes[i], idx);
+			check(layout.count >= 1 && layout.count <= nbOsts, "count in [1, OSTs]",
+					nbOsts, sizes[i], idx);
+			check(layout.count == expected, "count of the file size", nbOsts, sizes[i], idx);
+			check(layout.offset >= 0 && layout.offset < nbOsts, "first OST in range",
+					nbOsts, sizes[i], idx);
+			check(layout.unit == conf.stripeUnit, "stripe unit", nbOsts, sizes[i], idx);
+		}
+	}
+}
+
+/*
+ * File i starts on OST i*count: the stripes of 'nbOsts' consecutive files
+ * cover every OST exactly 'count' times, and single stripe files start on
+ * distinct OSTs.
+ */
+void testSpread(int nbOsts, size_t size, int first)
+{
+	FTIT_configuration conf;
+	FTIT_stripe layout;
+	int* used = (int*) calloc(nbOsts, sizeof(int));
+	int* starts = (int*) calloc(nbOsts, sizeof(int));
+	int idx, j, count = 0;
+
+	setConf(&conf, nbOsts);
+	conf.stripeOffset = first;
+	for (idx = 0; idx < nbOsts; idx++) {
+		FTI_PlanStripe(&conf, nbOsts, size, idx, &layout);
+		check(layout.offset == (idx * layout.count + (first > 0 ? first : 0)) % nbOsts,
+				"first OST round-robin", nbOsts, size, idx);
+		for (j = 0; j < layout.count; j++) {
+			used[(layout.offset + j) % nbOsts]++;
+		}
+		starts[layout.offset]++;
+		count = layout.count;
+	}
+	for (j = 0; j < nbOsts; j++) {
+		check(used[j] == count, "OSTs used evenly", nbOsts, size, j);
+		if (count == 1) {
+			check(starts[j] == 1, "distinct first OSTs", nbOsts, size, j);
+		}
+	}
+	free(used);
+	free(starts);
+}
+
+/* The striping factor replaces the size based count, bounded by the OSTs. */
+void testFactor(int nbOsts)
+{
+	FTIT_configuration conf;
+	FTIT_stripe layout;
+	int factor, idx;
+
+	setConf(&conf, nbOsts);
+	for (factor = 1; factor <= nbOsts + 2; factor++) {
+		conf.stripeFactor = factor;
+		for (idx = 0; idx < nbOsts; idx++) {
+			FTI_PlanStripe(&conf, nbOsts, 1, idx, &layout);
+			check(layout.count == (factor < nbOsts ? factor : nbOsts),
+					"striping factor", nbOsts, 1, idx);
+			FTI_PlanStripe(&conf, nbOsts, 100 * 1024 * MB, idx, &layout);
+			check(layout.count == (factor < nbOsts ? factor : nbOsts),
+					"striping factor", nbOsts, 100 * 1024 * MB, idx);
+			check(layout.offset == (idx * layout.count) % nbOsts,
+					"first OST with striping factor", nbOsts, 1, idx);
+		}
+	}
+}
+
+/* Without OSTs no layout is planned, the files keep the default layout. */
+void testDisabled()
+{
+	FTIT_configuration conf;
+	FTIT_stripe layout;
+
+	setConf(&conf, 0);
+	check(FTI_StripeOsts(&conf) == 0, "no OSTs", 0, 0, 0);
+	check(FTI_PlanStripe(&conf, 0, MB, 0, &layout) == FTI_NSCS, "no layout without OSTs", 0, MB, 0);
+	setConf(&conf, 8);
+	check(FTI_PlanStripe(&conf, 8, MB, -1, &layout) == FTI_NSCS, "no layout for a bad index", 8, MB, -1);
+}
+
+int main(int argc, char** argv)
+{
+	int osts[] = {1, 2, 7, 16, 64};
+	int i;
+
+	for (i = 0; i < sizeof(osts) / sizeof(osts[0]); i++) {
+		testCount(osts[i]);
+		testSpread(osts[i], MB, -1);
+		testSpread(osts[i], MB, 3);
+		testSpread(osts[i], 3 * 1024 * MB, -1);
+		testSpread(osts[i], 3 * 1024 * MB, 5);
+		testFactor(osts[i]);
+	}
+	testDisabled();
+
+	if (failures > 0) {
+		printf("Striping test FAILED: %d checks failed.\n", failures);
+		return 1;
+	}
+	printf("Striping test succeed.\n");
+	return 0;
+}
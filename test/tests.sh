@@ -282,6 +282,134 @@ cd $DIR$(echo test)
 			if [ $? -eq 0 ]; then
 				printSuccess $TEST "$CONFIG"
 			fi
+		elif [ "$TEST" = "stripe" ] || [ "$TEST" = "daly" ] || [ "$TEST" = "groups" ] || [ "$TEST" = "topofile" ]; then
+			printRun $TEST
+			./$TEST
+			rtn=$?
+			if [ $rtn != 0 ]; then
+				exit $rtn
+			fi
+			printSuccess $TEST
+		elif [ "$TEST" = "trace" ]; then
+			printRun $TEST "$CONFIG"
+			cp configs/"$CONFIG" config.fti
+			changeIO config.fti "$CKPT_IO"
+			printf "trace = 1\ntrace_chrome = 1\ntrace_dir = ./Trace\n" >> config.fti
+			mpirun $MPI_ARGS -n 16 ./trace config.fti &> logFile1
+			rtn=$?
+			if [ $rtn != 0 ]; then
+				cat logFile1
+				exit $rtn
+			fi
+			printSuccess $TEST "$CONFIG"
+			rm -r logFile1 ./Local ./Global ./Meta ./Trace
+		elif [ "$TEST" = "helper" ]; then
+			# post-processing in the helper thread, non-inline L2-L4
+			for level in 2 3 4; do
+				printRun $TEST "$CONFIG" $level
+				cp configs/"$CONFIG" config.fti
+				mpirun $MPI_ARGS -n 16 ./$TEST config.fti $level 1 &> logFile1
+				if [ $? != 0 ]; then
+					cat logFile1
+					exit 1
+				fi
+				printResume $TEST "$CONFIG" $level
+				mpirun $MPI_ARGS -n 16 ./$TEST config.fti $level 0 &> logFile2
+				if [ $? != 0 ] || ! grep -q "Recovering successfully from level $level" logFile2; then
+					cat logFile2
+					exit 1
+				fi
+				printSuccess $TEST "$CONFIG" $level
+				rm -rf logFile1 logFile2 ./Local ./Global ./Meta
+			done
+		elif [ "$TEST" = "heads" ]; then
+			# two heads per node, two application ranks each
+			for level in 1 2 3 4; do
+				printRun $TEST "$CONFIG" $level
+				cp configs/"$CONFIG" config.fti
+				changeIO config.fti "$CKPT_IO"
+				sed -i "s/^Head = .*/Head = 2/; s/^Node_size = .*/Node_size = 6/" config.fti
+				mpirun $MPI_ARGS -n 24 ./$TEST config.fti $level 1 &> logFile1
+				if [ $? != 0 ]; then
+					cat logFile1
+					exit 1
+				fi
+				printResume $TEST "$CONFIG" $level
+				mpirun $MPI_ARGS -n 24 ./$TEST config.fti $level 0 &> logFile2
+				if [ $? != 0 ] || ! grep -q "Recovering successfully from level $level" logFile2; then
+					cat logFile2
+					exit 1
+				fi
+				printSuccess $TEST "$CONFIG" $level
+				rm -rf logFile1 logFile2 ./Local ./Global ./Meta
+			done
+		elif [ "$TEST" = "reclaim" ]; then
+			# trash left by a crash, swept by FTI_Init
+			printRun $TEST "$CONFIG"
+			cp configs/"$CONFIG" config.fti
+			printf "reclaim_threads = 1\n" >> config.fti
+			mpirun $MPI_ARGS -n 16 ./$TEST config.fti 1 &> logFile1
+			if [ $? != 0 ]; then
+				cat logFile1
+				exit 1
+			fi
+			printResume $TEST "$CONFIG"
+			mpirun $MPI_ARGS -n 16 ./$TEST config.fti 0 &> logFile2
+			if [ $? != 0 ]; then
+				cat logFile2
+				exit 1
+			fi
+			printSuccess $TEST "$CONFIG"
+			rm -rf logFile1 logFile2 ./Local ./Global ./Meta
+		elif [ "$TEST" = "handoff" ]; then
+			# checkpoint data passed to the heads through shared memory
+			for level in 2 3 4; do
+				printRun $TEST "$CONFIG" $level
+				cp configs/"$CONFIG" config.fti
+				changeIO config.fti 1
+				printf "shm_handoff = 1\n" >> config.fti
+				mpirun $MPI_ARGS -n 16 ./diffSizes config.fti $level 1 0 &> logFile1
+				if [ $? != 0 ] || ! grep -q "Reading ckpt. data from shared memory" logFile1; then
+					cat logFile1
+					exit 1
+				fi
+				printResume $TEST "$CONFIG" $level
+				mpirun $MPI_ARGS -n 16 ./diffSizes config.fti $level 0 0 &> logFile2
+				if [ $? != 0 ] || ! grep -q "Recovering successfully from level $level" logFile2; then
+					cat logFile2
+					exit 1
+				fi
+				printSuccess $TEST "$CONFIG" $level
+				rm -rf logFile1 logFile2 ./Local ./Global ./Meta
+			done
+		elif [ "$TEST" = "shm" ]; then
+			# L1 checkpoints in shared memory, simulated by ./Shm
+			printRun $TEST "$CONFIG" 1
+			cp configs/"$CONFIG" config.fti
+			changeIO config.fti 1
+			sed -i "/Ckpt_io/a Enable_Shm = 1" config.fti
+			printf "shm_dir = ./Shm\n" >> config.fti
+			mkdir -p Shm
+			mpirun $MPI_ARGS -n 16 ./diffSizes config.fti 1 1 0 &> logFile1
+			if [ $? != 0 ]; then
+				cat logFile1
+				exit 1
+			fi
+			checkLog logFile1 patterns/posix_io/L1INIT 0
+			if [ "$(stat -c %a Shm/fti-$(id -u))" != "700" ] || ! ls Shm/fti-$(id -u)/node*/*/l1/Ckpt*-Rank*.fti &> /dev/null; then
+				echo "The L1 checkpoint is not in the shared memory directory of the user."
+				ls -lR Shm
+				exit 1
+			fi
+			printResume $TEST "$CONFIG" 1
+			mpirun $MPI_ARGS -n 16 ./diffSizes config.fti 1 0 0 &> logFile2
+			if [ $? != 0 ]; then
+				cat logFile2
+				exit 1
+			fi
+			checkLog logFile2 patterns/posix_io/L1Clean 0
+			printSuccess $TEST "$CONFIG" 1
+			rm -rf logFile1 logFile2 ./Local ./Global ./Meta ./Shm
 		elif [ "$TEST" = "hdf5" ]; then
 			./hdf5Test.sh
 			if [ $? -eq 0 ]; then
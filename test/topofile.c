@@ -0,0 +1,99 @@
+/**
+ *  @file   topofile.c
+ *  @date   October, 2026
+ *  @brief  FTI testing program.
+ *
+ *  Program tests the topology file: the node names written by
+ *  FTI_SaveTopo are read back by FTI_LoadTopo, for as many, more and
+ *  fewer nodes than saved, names of the former iniparser format are read
+ *  as well, and truncated or missing files are rejected.
+ *
+ *  Usage: ./topofile
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "interface.h"
+
+#define NB_NODES 6
+
+static int failures = 0;
+
+void check(int cond, const char* what, const char* fn)
+{
+	if (!cond) {
+		printf("FAILED: %s (%s)\n", what, fn);
+		failures++;
+	}
+}
+
+int main(void)
+{
+	FTIT_configuration conf;
+	FTIT_topology topo;
+	char mfn[FTI_BUFS];
+	char names[NB_NODES * FTI_BUFS], loaded[(NB_NODES + 2) * FTI_BUFS];
+	int i;
+
+	memset(&conf, 0, sizeof(conf));
+	memset(&topo, 0, sizeof(topo));
+	snprintf(conf.metadDir, FTI_BUFS, ".");
+	snprintf(mfn, FTI_BUFS, "%s/Topology.fti", conf.metadDir);
+	topo.nbNodes = NB_NODES;
+
+	// short, long and unusual names
+	memset(names, 0, sizeof(names));
+	for (i = 0; i < NB_NODES; i++) {
+		snprintf(names + (i * FTI_BUFS), FTI_BUFS, "nid%05d", i * 7);
+	}
+	memset(names + (2 * FTI_BUFS), 'x', FTI_BUFS - 1);
+	snprintf(names + (4 * FTI_BUFS), FTI_BUFS, "node with = spaces");
+
+	check(FTI_SaveTopo(&conf, &topo, names) == FTI_SCES, "topology saved", mfn);
+
+	check(FTI_LoadTopo(mfn, NB_NODES, loaded) == FTI_SCES, "topology loaded", mfn);
+	check(memcmp(names, loaded, sizeof(names)) == 0, "same names", mfn);
+
+	memset(loaded, 'y', sizeof(loaded));
+	check(FTI_LoadTopo(mfn, NB_NODES + 2, loaded) == FTI_SCES, "topology loaded for more nodes", mfn);
+	check(memcmp(names, loaded, sizeof(names)) == 0, "same names for more nodes", mfn);
+	check(loaded[NB_NODES * FTI_BUFS] == '\0' && loaded[(NB_NODES + 1) * FTI_BUFS] == '\0',
+			"new nodes without name", mfn);
+
+	check(FTI_LoadTopo(mfn, 2, loaded) == FTI_SCES, "topology loaded for fewer nodes", mfn);
+	check(memcmp(names, loaded, 2 * FTI_BUFS) == 0, "same names for fewer nodes", mfn);
+
+	// truncated in the middle of the third name
+	FILE* fd = fopen(mfn, "r+b");
+	check(fd != NULL && ftruncate(fileno(fd), 8 + 4 + 2 + 8 + 2 + 8 + 2 + 100) == 0,
+			"topology truncated", mfn);
+	if (fd != NULL) {
+		fclose(fd);
+	}
+	check(FTI_LoadTopo(mfn, NB_NODES, loaded) == FTI_NSCS, "truncated topology rejected", mfn);
+
+	// former iniparser format
+	fd = fopen(mfn, "w");
+	check(fd != NULL, "old topology written", mfn);
+	if (fd != NULL) {
+		fprintf(fd, "[topology]\n0 = nid00000\n1 = nid00007\n3 = nid00021\n");
+		fclose(fd);
+	}
+	check(FTI_LoadTopo(mfn, 4, loaded) == FTI_SCES, "old topology loaded", mfn);
+	check(strcmp(loaded, "nid00000") == 0 && strcmp(loaded + FTI_BUFS, "nid00007") == 0 &&
+			loaded[2 * FTI_BUFS] == '\0' && strcmp(loaded + (3 * FTI_BUFS), "nid00021") == 0,
+			"same names in the old format", mfn);
+
+	unlink(mfn);
+	check(FTI_LoadTopo(mfn, NB_NODES, loaded) == FTI_NSCS, "missing topology rejected", mfn);
+
+	if (failures > 0) {
+		printf("Topology file test FAILED: %d checks failed.\n", failures);
+	} else {
+		printf("Topology file test succeed.\n");
+	}
+	return (failures > 0);
+}
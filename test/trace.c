@@ -0,0 +1,279 @@
+/**
+ *  @file   trace.c
+ *  @date   October, 2026
+ *  @brief  FTI testing program.
+ *
+ *  Program tests the trace files ('Advanced:trace = 1'): it checkpoints
+ *  every level once and checks after FTI_Finalize that every process
+ *  wrote 'trace_dir/<exec. ID>-Rank<rank>.trace' with a valid header,
+ *  valid events and one checkpoint event per level (application
+ *  processes) or at least one request event (heads). With
+ *  'Advanced:trace_chrome = 1', it also checks that 'trace_dir/<exec.
+ *  ID>.json' is valid JSON with one process and one complete event per
+ *  event of the trace files.
+ *
+ *  Usage: ./trace config.fti
+ */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "interface.h"
+
+#define N 4096
+
+static int failures = 0;
+
+void check(int cond, const char* what, const char* fn)
+{
+	if (!cond) {
+		printf("FAILED: %s (%s)\n", what, fn);
+		failures++;
+	}
+}
+
+/* Checks one trace file, returns its number of events. */
+uint64_t checkTraceFile(const char* fn, int rank, int nbLevels)
+{
+	FTIT_traceHeader header;
+	FTIT_traceEvent event;
+	struct stat st;
+	int ckpts[5] = {0}, requests = 0;
+	uint64_t i;
+
+	FILE* fd = fopen(fn, "rb");
+	if (fd == NULL || stat(fn, &st) != 0) {
+		check(0, "trace file readable", fn);
+		return 0;
+	}
+	if (fread(&header, sizeof(FTIT_traceHeader), 1, fd) != 1) {
+		check(0, "trace header", fn);
+		fclose(fd);
+		return 0;
+	}
+	check(memcmp(header.magic, FTI_TRACE_MAGIC, sizeof(header.magic)) == 0, "magic", fn);
+	check(header.version == FTI_TRACE_VERSION, "version", fn);
+	check(header.rank == rank, "rank of the file name", fn);
+	check(header.nbPhases == FTI_TRACE_NBPHASES, "number of phases", fn);
+	check(header.nbDropped == 0, "no event dropped", fn);
+	check(st.st_size == sizeof(FTIT_traceHeader) + header.nbEvents * sizeof(FTIT_traceEvent),
+			"file size of the events", fn);
+	for (i = 0; i < header.nbEvents; i++) {
+		if (fread(&event, sizeof(FTIT_traceEvent), 1, fd) != 1) {
+			check(0, "event readable", fn);
+			break;
+		}
+		check(event.phase < FTI_TRACE_NBPHASES, "phase of the event", fn);
+		check(event.start >= 0 && event.duration >= 0, "time of the event", fn);
+		if (event.phase == FTI_TRACE_CKPT && event.level >= 1 && event.level <= 4) {
+			ckpts[event.level]++;
+		}
+		if (event.phase == FTI_TRACE_REQUEST) {
+			requests++;
+		}
+	}
+	fclose(fd);
+	if (header.isHead) {
+		check(requests > 0, "head handled requests", fn);
+	} else {
+		for (i = 1; i <= nbLevels; i++) {
+			check(ckpts[i] == 1, "one checkpoint event per level", fn);
+		}
+	}
+	return header.nbEvents;
+}
+
+/* Skips a JSON value at 'p', returns the position after it, NULL if invalid. */
+const char* skipValue(const char* p);
+
+const char* skipSpace(const char* p)
+{
+	while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t') {
+		p++;
+	}
+	return p;
+}
+
+const char* skipString(const char* p)
+{
+	if (*p++ != '"') {
+		return NULL;
+	}
+	while (*p != '"') {
+		if (*p == '\0' || (unsigned char)*p < 0x20) {
+			return NULL;
+		}
+		if (*p == '\\' && *++p == '\0') {
+			return NULL;
+		}
+		p++;
+	}
+	return p + 1;
+}
+
+const char* skipValue(const char* p)
+{
+	p = skipSpace(p);
+	if (*p == '{' || *p == '[') {
+		char close = (*p == '{') ? '}' : ']';
+		p = skipSpace(p + 1);
+		if (*p == close) {
+			return p + 1;
+		}
+		while (1) {
+			if (close == '}') {
+				if ((p = skipString(skipSpace(p))) == NULL) {
+					return NULL;
+				}
+				p = skipSpace(p);
+				if (*p++ != ':') {
+					return NULL;
+				}
+			}
+			if ((p = skipValue(p)) == NULL) {
+				return NULL;
+			}
+			p = skipSpace(p);
+			if (*p == close) {
+				return p + 1;
+			}
+			if (*p++ != ',') {
+				return NULL;
+			}
+		}
+	}
+	if (*p == '"') {
+		return skipString(p);
+	}
+	if (strncmp(p, "true", 4) == 0 || strncmp(p, "null", 4) == 0) {
+		return p + 4;
+	}
+	if (strncmp(p, "false", 5) == 0) {
+		return p + 5;
+	}
+	char* end;
+	strtod(p, &end);
+	return (end == p) ? NULL : end;
+}
+
+/* Counts the occurrences of 'str' in 'buf'. */
+uint64_t countStr(const char* buf, const char* str)
+{
+	uint64_t count = 0;
+	while ((buf = strstr(buf, str)) != NULL) {
+		count++;
+		buf++;
+	}
+	return count;
+}
+
+/* Checks the timeline of all the processes. */
+void checkJson(const char* fn, int nbProcs, uint64_t nbEvents)
+{
+	struct stat st;
+	FILE* fd = fopen(fn, "r");
+	if (fd == NULL || stat(fn, &st) != 0) {
+		check(0, "timeline readable", fn);
+		return;
+	}
+	char* buf = (char*) malloc(st.st_size + 1);
+	size_t len = fread(buf, 1, st.st_size, fd);
+	buf[len] = '\0';
+	fclose(fd);
+	const char* end = skipValue(buf);
+	check(end != NULL && *skipSpace(end) == '\0', "valid JSON", fn);
+	check(strncmp(skipSpace(buf), "{\"displayTimeUnit\"", 18) == 0 &&
+			strstr(buf, "\"traceEvents\":[") != NULL, "trace event format", fn);
+	check(countStr(buf, "\"name\":\"process_name\"") == nbProcs, "one process per rank", fn);
+	check(countStr(buf, "\"ph\":\"X\"") == nbEvents, "one complete event per traced event", fn);
+	free(buf);
+}
+
+int main(int argc, char** argv)
+{
+	int rank, nbProcs, i;
+	double data[N];
+	MPI_Comm appComm;
+
+	if (argc < 2) {
+		printf("Usage: %s config.fti\n", argv[0]);
+		return 1;
+	}
+
+	// heads do not return from FTI_Init, the files of all the processes
+	// are checked by the application rank 0
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD, &nbProcs);
+
+	dictionary* ini = iniparser_load(argv[1]);
+	char traceDir[256];
+	snprintf(traceDir, sizeof(traceDir), "%s", iniparser_getstring(ini, "Advanced:trace_dir", "./Trace"));
+	int chrome = iniparser_getboolean(ini, "Advanced:trace_chrome", 0);
+	iniparser_freedict(ini);
+
+	FTI_Init(argv[1], MPI_COMM_WORLD);
+	MPI_Comm_dup(FTI_COMM_WORLD, &appComm);
+	MPI_Comm_rank(appComm, &rank);
+	FTI_Protect(0, data, N, FTI_DBLE);
+	for (i = 1; i <= 4; i++) {
+		int j;
+		for (j = 0; j < N; j++) {
+			data[j] = i + j;
+		}
+		FTI_Checkpoint(i, i);
+	}
+	FTI_Finalize();
+
+	if (rank == 0) {
+		DIR* dir = opendir(traceDir);
+		struct dirent* entry;
+		char fn[512], json[512] = "";
+		int* found = (int*) calloc(nbProcs, sizeof(int));
+		int nbJson = 0;
+		uint64_t nbEvents = 0;
+		while (dir != NULL && (entry = readdir(dir)) != NULL) {
+			char* pos = strstr(entry->d_name, "-Rank");
+			size_t len = strlen(entry->d_name);
+			int r;
+			if (len > 5 && strcmp(entry->d_name + len - 5, ".json") == 0) {
+				snprintf(json, sizeof(json), "%s/%s", traceDir, entry->d_name);
+				nbJson++;
+			}
+			if (pos == NULL || sscanf(pos, "-Rank%d.trace", &r) != 1) {
+				continue;
+			}
+			snprintf(fn, sizeof(fn), "%s/%s", traceDir, entry->d_name);
+			check(r >= 0 && r < nbProcs, "rank of the trace file", fn);
+			if (r >= 0 && r < nbProcs) {
+				found[r]++;
+				nbEvents += checkTraceFile(fn, r, 4);
+			}
+		}
+		check(dir != NULL, "trace directory exists", traceDir);
+		if (dir != NULL) {
+			closedir(dir);
+		}
+		for (i = 0; i < nbProcs; i++) {
+			snprintf(fn, sizeof(fn), "rank %d", i);
+			check(found[i] == 1, "one trace file per process", fn);
+		}
+		free(found);
+		check(nbJson == (chrome ? 1 : 0), "one timeline with 'trace_chrome'", traceDir);
+		if (chrome && nbJson == 1) {
+			checkJson(json, nbProcs, nbEvents);
+		}
+		if (failures > 0) {
+			printf("Trace test FAILED: %d checks failed.\n", failures);
+		} else {
+			printf("Trace test succeed.\n");
+		}
+	}
+
+	MPI_Bcast(&failures, 1, MPI_INT, 0, appComm);
+	MPI_Comm_free(&appComm);
+	MPI_Finalize();
+	return (failures > 0);
+}